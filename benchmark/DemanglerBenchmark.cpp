@@ -0,0 +1,603 @@
+//===--- DemanglerBenchmark.cpp -------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Measures every demangling entry point over the corpora in benchmark/corpus.
+/// There is a typical, a long and an adversarial corpus per mangling scheme:
+///
+///   <scheme>-typical.txt      names as found in real symbol tables
+///   <scheme>-long.txt         long, template- or generic-heavy names
+///   <scheme>-adversarial.txt  deep nesting, back reference chains, truncated
+///                             and malformed input
+///
+/// Each benchmark runs over a corpus once to warm up and then the requested
+/// number of times while timing every symbol. Where the API allows it the
+/// parse and print phases are timed separately. For each phase the report
+/// gives the throughput, the p50 and p99 latency per symbol, the number of
+/// heap allocations per symbol and the peak heap growth while demangling a
+/// single symbol, which for the parse phase is the size of the AST arena.
+///
+/// When built with DEMANGLE_ENABLE_STATS the report also includes the
+/// DemangleStats counters of each phase, averaged per symbol.
+///
+/// The results are written as JSON to stdout (or the file given to --json) and
+/// as a table to stderr.
+///
+//===----------------------------------------------------------------------===//
+
+#include "demangler/Demangle.h"
+#include "demangler/DemangleStats.h"
+#include "demangler/MicrosoftDemangle.h"
+#include "demangler/Utility.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Sanitizers replace the allocation functions themselves.
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define BENCHMARK_HOOK_MALLOC 1
+#include <malloc.h>
+#endif
+
+using namespace demangler;
+using demangler::itanium_demangle::OutputBuffer;
+
+//===----------------------------------------------------------------------===//
+// Heap accounting
+//===----------------------------------------------------------------------===//
+
+namespace {
+// The benchmark is single-threaded, so plain counters are enough.
+uint64_t HeapAllocations = 0;
+size_t   HeapLiveBytes   = 0;
+size_t   HeapPeakBytes   = 0;
+
+void noteAllocation(size_t Size) {
+    ++HeapAllocations;
+    HeapLiveBytes += Size;
+    HeapPeakBytes  = std::max(HeapPeakBytes, HeapLiveBytes);
+}
+
+// Memory allocated before accounting started may be freed too, so the live
+// byte count is clamped instead of being allowed to wrap.
+void noteFree(size_t Size) { HeapLiveBytes -= std::min(Size, HeapLiveBytes); }
+} // namespace
+
+#ifdef BENCHMARK_HOOK_MALLOC
+// The demanglers allocate with both operator new and malloc/realloc, so on
+// glibc the C allocation functions are interposed as well.
+#define BENCHMARK_HEAP_HOOKS "malloc"
+
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void  __libc_free(void*);
+
+void* malloc(size_t Size) {
+    void* P = __libc_malloc(Size);
+    if (P) noteAllocation(malloc_usable_size(P));
+    return P;
+}
+
+void* calloc(size_t Count, size_t Size) {
+    void* P = __libc_calloc(Count, Size);
+    if (P) noteAllocation(malloc_usable_size(P));
+    return P;
+}
+
+void* realloc(void* Ptr, size_t Size) {
+    size_t Old = Ptr ? malloc_usable_size(Ptr) : 0;
+    void*  P   = __libc_realloc(Ptr, Size);
+    if (P) {
+        noteFree(Old);
+        noteAllocation(malloc_usable_size(P));
+    }
+    return P;
+}
+
+void free(void* Ptr) {
+    if (Ptr) noteFree(malloc_usable_size(Ptr));
+    __libc_free(Ptr);
+}
+}
+
+void* operator new(size_t Size) {
+    if (void* P = std::malloc(Size ? Size : 1)) return P;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t Size) { return ::operator new(Size); }
+void  operator delete(void* Ptr) noexcept { std::free(Ptr); }
+void  operator delete[](void* Ptr) noexcept { std::free(Ptr); }
+void  operator delete(void* Ptr, size_t) noexcept { std::free(Ptr); }
+void  operator delete[](void* Ptr, size_t) noexcept { std::free(Ptr); }
+#else
+// Elsewhere only operator new can be replaced portably, so allocations made
+// with malloc or realloc are not counted.
+#define BENCHMARK_HEAP_HOOKS "operator-new"
+
+namespace {
+// Allocations carry their size in front of the returned pointer.
+constexpr size_t HeaderSize = alignof(std::max_align_t);
+} // namespace
+
+void* operator new(size_t Size) {
+    char* P = static_cast<char*>(std::malloc(Size + HeaderSize));
+    if (P == nullptr) throw std::bad_alloc();
+    std::memcpy(P, &Size, sizeof(Size));
+    noteAllocation(Size);
+    return P + HeaderSize;
+}
+void* operator new[](size_t Size) { return ::operator new(Size); }
+void  operator delete(void* Ptr) noexcept {
+    if (Ptr == nullptr) return;
+    char*  P = static_cast<char*>(Ptr) - HeaderSize;
+    size_t Size;
+    std::memcpy(&Size, P, sizeof(Size));
+    noteFree(Size);
+    std::free(P);
+}
+void operator delete[](void* Ptr) noexcept { ::operator delete(Ptr); }
+void operator delete(void* Ptr, size_t) noexcept { ::operator delete(Ptr); }
+void operator delete[](void* Ptr, size_t) noexcept { ::operator delete(Ptr); }
+#endif
+
+//===----------------------------------------------------------------------===//
+// Measurement
+//===----------------------------------------------------------------------===//
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Corpus {
+    std::string Name;
+    std::string Scheme;
+    // std::string keeps every symbol null terminated for the char* APIs.
+    std::vector<std::string> Symbols;
+    size_t                   Bytes = 0;
+};
+
+// Measurements of one phase of one benchmark over one corpus.
+struct Phase {
+    const char*           Name;
+    std::vector<uint32_t> Nanos;
+    uint64_t              Allocations = 0;
+    size_t                PeakBytes   = 0;
+    size_t                Demangled   = 0;
+    DemangleStats         Stats;
+
+    explicit Phase(const char* Name) : Name(Name) {}
+
+    // Run F, attributing its time and heap use to this phase. F returns
+    // whether it succeeded.
+    template <typename Fn>
+    bool run(Fn F) {
+        uint64_t Allocs = HeapAllocations;
+        size_t   Base   = HeapLiveBytes;
+        HeapPeakBytes   = HeapLiveBytes;
+        resetDemangleStats();
+
+        Clock::time_point Start = Clock::now();
+        bool              Ok    = F();
+        Clock::time_point End   = Clock::now();
+
+        uint64_t Ns  = std::chrono::duration_cast<std::chrono::nanoseconds>(End - Start).count();
+        Allocations += HeapAllocations - Allocs;
+        PeakBytes    = std::max(PeakBytes, HeapPeakBytes - Base);
+        Demangled   += Ok;
+        Stats       += takeDemangleStats();
+        Nanos.push_back(static_cast<uint32_t>(std::min<uint64_t>(Ns, UINT32_MAX)));
+        return Ok;
+    }
+};
+
+struct Result {
+    std::string   Benchmark;
+    std::string   Corpus;
+    std::string   Phase;
+    size_t        Symbols;
+    size_t        Demangled;
+    size_t        InputBytes;
+    size_t        Samples;
+    double        Seconds;
+    double        SymbolsPerSecond;
+    double        MBPerSecond;
+    uint64_t      P50;
+    uint64_t      P99;
+    double        AllocationsPerSymbol;
+    size_t        PeakArenaBytes;
+    DemangleStats Stats;
+};
+
+struct Options {
+    std::string CorpusDir  = "benchmark/corpus";
+    std::string JSONPath;
+    std::string Filter;
+    unsigned    Iterations = 20;
+};
+
+// A benchmark demangles one symbol per call, recording into its phases.
+struct Benchmark {
+    const char* Name;
+    // Scheme of the corpora it runs on, or nullptr for all of them.
+    const char* Scheme;
+    std::vector<const char*> Phases;
+    void (*Run)(const std::string& Symbol, Phase* Phases);
+};
+
+// Output shared by the benchmarks that print into an OutputBuffer, rewound
+// before every symbol.
+struct SharedOutput {
+    OutputBuffer OB;
+    char*        Buf = nullptr;
+    size_t       N   = 0;
+
+    ~SharedOutput() {
+        std::free(OB.getBuffer());
+        std::free(Buf);
+    }
+};
+
+SharedOutput& getOutput() {
+    static SharedOutput Out;
+    return Out;
+}
+
+ItaniumDemangleSession& getItaniumSession() {
+    static ItaniumDemangleSession Session;
+    return Session;
+}
+
+MicrosoftDemangleSession& getMicrosoftSession() {
+    static MicrosoftDemangleSession Session;
+    return Session;
+}
+
+void runDemangle(const std::string& Symbol, Phase* P) {
+    P[0].run([&] {
+        std::string Result;
+        return demangle(Symbol, Result);
+    });
+}
+
+void runItaniumDemangle(const std::string& Symbol, Phase* P) {
+    P[0].run([&] {
+        char* Result = itaniumDemangle(Symbol);
+        std::free(Result);
+        return Result != nullptr;
+    });
+}
+
+void runItaniumSession(const std::string& Symbol, Phase* P) {
+    OutputBuffer& OB = getOutput().OB;
+    OB.setCurrentPosition(0);
+    P[0].run([&] { return getItaniumSession().demangle(Symbol, OB); });
+}
+
+void runItaniumPartial(const std::string& Symbol, Phase* P) {
+    static ItaniumPartialDemangler Partial;
+    SharedOutput&                  Out = getOutput();
+    if (!P[0].run([&] { return !Partial.partialDemangle(Symbol.c_str()); })) return;
+    P[1].run([&] {
+        char* Result = Partial.finishDemangle(Out.Buf, &Out.N);
+        if (Result) Out.Buf = Result;
+        return Result != nullptr;
+    });
+}
+
+void runMicrosoftDemangle(const std::string& Symbol, Phase* P) {
+    P[0].run([&] {
+        char* Result = microsoftDemangle(Symbol, nullptr, nullptr);
+        std::free(Result);
+        return Result != nullptr;
+    });
+}
+
+void runMicrosoftSession(const std::string& Symbol, Phase* P) {
+    OutputBuffer& OB = getOutput().OB;
+    OB.setCurrentPosition(0);
+    P[0].run([&] { return getMicrosoftSession().demangle(Symbol, OB, nullptr, nullptr); });
+}
+
+void runMicrosoftNameOnly(const std::string& Symbol, Phase* P) {
+    OutputBuffer& OB = getOutput().OB;
+    OB.setCurrentPosition(0);
+    P[0].run([&] { return getMicrosoftSession().demangle(Symbol, OB, nullptr, nullptr, MSDF_NameOnly); });
+}
+
+void runMicrosoftPartial(const std::string& Symbol, Phase* P) {
+    static MicrosoftPartialDemangler Partial;
+    SharedOutput&                    Out = getOutput();
+    if (!P[0].run([&] { return !Partial.partialDemangle(Symbol); })) return;
+    P[1].run([&] {
+        char* Result = Partial.finishDemangle(Out.Buf, &Out.N);
+        if (Result) Out.Buf = Result;
+        return Result != nullptr;
+    });
+}
+
+// Parser is the virtual ms_demangle::Demangler or the statically dispatched
+// ms_demangle::StaticDemangler.
+template <typename Parser>
+void runMicrosoftParser(const std::string& Symbol, Phase* P) {
+    static Parser            D;
+    OutputBuffer&            OB  = getOutput().OB;
+    ms_demangle::SymbolNode* AST = nullptr;
+    OB.setCurrentPosition(0);
+    if (!P[0].run([&] {
+            D.reset();
+            std::string_view Name = Symbol;
+            AST                   = D.parse(Name);
+            return !D.Error;
+        }))
+        return;
+    P[1].run([&] {
+        AST->print(OB, ms_demangle::OF_Default);
+        return true;
+    });
+}
+
+void runRustDemangle(const std::string& Symbol, Phase* P) {
+    P[0].run([&] {
+        char* Result = rustDemangle(Symbol);
+        std::free(Result);
+        return Result != nullptr;
+    });
+}
+
+void runDLangDemangle(const std::string& Symbol, Phase* P) {
+    P[0].run([&] {
+        char* Result = dlangDemangle(Symbol);
+        std::free(Result);
+        return Result != nullptr;
+    });
+}
+
+const Benchmark Benchmarks[] = {
+    {"demangle",                     nullptr,     {"total"},          runDemangle                                     },
+    {"itaniumDemangle",              "itanium",   {"total"},          runItaniumDemangle                              },
+    {"ItaniumDemangleSession",       "itanium",   {"total"},          runItaniumSession                               },
+    {"ItaniumPartialDemangler",      "itanium",   {"parse", "print"}, runItaniumPartial                               },
+    {"microsoftDemangle",            "microsoft", {"total"},          runMicrosoftDemangle                            },
+    {"MicrosoftDemangleSession",     "microsoft", {"total"},          runMicrosoftSession                             },
+    {"MSDF_NameOnly",                "microsoft", {"total"},          runMicrosoftNameOnly                            },
+    {"MicrosoftPartialDemangler",    "microsoft", {"parse", "print"}, runMicrosoftPartial                             },
+    {"ms_demangle::Demangler",       "microsoft", {"parse", "print"}, runMicrosoftParser<ms_demangle::Demangler>      },
+    {"ms_demangle::StaticDemangler", "microsoft", {"parse", "print"}, runMicrosoftParser<ms_demangle::StaticDemangler>},
+    {"rustDemangle",                 "rust",      {"total"},          runRustDemangle                                 },
+    {"dlangDemangle",                "dlang",     {"total"},          runDLangDemangle                                },
+};
+
+const char* const Schemes[] = {"itanium", "microsoft", "rust", "dlang"};
+const char* const Kinds[]   = {"typical", "long", "adversarial"};
+
+bool loadCorpus(const std::string& Path, Corpus& C) {
+    std::FILE* F = std::fopen(Path.c_str(), "rb");
+    if (F == nullptr) return false;
+    std::string Data;
+    char        Buf[1 << 16];
+    for (size_t Read; (Read = std::fread(Buf, 1, sizeof(Buf), F)) != 0;) Data.append(Buf, Read);
+    std::fclose(F);
+
+    std::string_view Rest = Data;
+    while (!Rest.empty()) {
+        size_t           NL   = Rest.find('\n');
+        std::string_view Line = Rest.substr(0, NL);
+        Rest.remove_prefix(NL == std::string_view::npos ? Rest.size() : NL + 1);
+        if (!Line.empty() && Line.back() == '\r') Line.remove_suffix(1);
+        if (Line.empty()) continue;
+        C.Symbols.emplace_back(Line);
+        C.Bytes += Line.size();
+    }
+    return true;
+}
+
+uint64_t percentile(std::vector<uint32_t>& Nanos, double Fraction) {
+    if (Nanos.empty()) return 0;
+    size_t I = std::min(Nanos.size() - 1, static_cast<size_t>(Fraction * Nanos.size()));
+    std::nth_element(Nanos.begin(), Nanos.begin() + I, Nanos.end());
+    return Nanos[I];
+}
+
+void runBenchmark(const Benchmark& B, const Corpus& C, unsigned Iterations, std::vector<Result>& Results) {
+    std::vector<Phase> Phases;
+    for (const char* Name : B.Phases) Phases.emplace_back(Name);
+
+    for (const std::string& Symbol : C.Symbols) B.Run(Symbol, Phases.data());
+
+    for (Phase& P : Phases) {
+        P.Nanos.clear();
+        P.Nanos.reserve(C.Symbols.size() * Iterations);
+        P.Allocations = 0;
+        P.PeakBytes   = 0;
+        P.Demangled   = 0;
+        P.Stats       = DemangleStats();
+    }
+    for (unsigned I = 0; I != Iterations; ++I)
+        for (const std::string& Symbol : C.Symbols) B.Run(Symbol, Phases.data());
+
+    for (Phase& P : Phases) {
+        Result R;
+        R.Benchmark  = B.Name;
+        R.Corpus     = C.Name;
+        R.Phase      = P.Name;
+        R.Symbols    = C.Symbols.size();
+        R.Demangled  = P.Demangled / Iterations;
+        R.InputBytes = C.Bytes;
+        R.Samples    = P.Nanos.size();
+
+        uint64_t Total = 0;
+        for (uint32_t Ns : P.Nanos) Total += Ns;
+        R.Seconds              = Total / 1e9;
+        R.SymbolsPerSecond     = R.Seconds > 0 ? R.Samples / R.Seconds : 0;
+        R.MBPerSecond          = R.Seconds > 0 ? C.Bytes * double(Iterations) / R.Seconds / 1e6 : 0;
+        R.P50                  = percentile(P.Nanos, 0.50);
+        R.P99                  = percentile(P.Nanos, 0.99);
+        R.AllocationsPerSymbol = R.Samples ? double(P.Allocations) / R.Samples : 0;
+        R.PeakArenaBytes       = P.PeakBytes;
+        R.Stats                = P.Stats;
+        Results.push_back(R);
+    }
+}
+
+// Benchmark and corpus names are plain identifiers, so nothing needs escaping.
+void writeJSON(std::FILE* Out, const Options& Opts, const std::vector<Result>& Results) {
+    std::fprintf(Out, "{\n  \"iterations\": %u,\n  \"heap_hooks\": \"%s\",\n", Opts.Iterations, BENCHMARK_HEAP_HOOKS);
+    std::fprintf(Out, "  \"results\": [");
+    for (size_t I = 0; I != Results.size(); ++I) {
+        const Result& R = Results[I];
+        std::fprintf(
+            Out,
+            "%s\n    {\"benchmark\": \"%s\", \"corpus\": \"%s\", \"phase\": \"%s\", \"symbols\": %zu, "
+            "\"demangled\": %zu, \"input_bytes\": %zu, \"samples\": %zu, \"seconds\": %.6f, "
+            "\"symbols_per_second\": %.1f, \"mb_per_second\": %.3f, \"p50_ns\": %llu, \"p99_ns\": %llu, "
+            "\"allocations_per_symbol\": %.3f, \"peak_arena_bytes\": %zu",
+            I ? "," : "",
+            R.Benchmark.c_str(),
+            R.Corpus.c_str(),
+            R.Phase.c_str(),
+            R.Symbols,
+            R.Demangled,
+            R.InputBytes,
+            R.Samples,
+            R.Seconds,
+            R.SymbolsPerSecond,
+            R.MBPerSecond,
+            static_cast<unsigned long long>(R.P50),
+            static_cast<unsigned long long>(R.P99),
+            R.AllocationsPerSymbol,
+            R.PeakArenaBytes
+        );
+#if DEMANGLE_ENABLE_STATS
+        const DemangleStats& S = R.Stats;
+        double               N = R.Samples ? double(R.Samples) : 1;
+        std::fprintf(
+            Out,
+            ", \"stats\": {\"calls\": %.3f, \"arena_blocks\": %.3f, \"arena_bytes\": %.1f, "
+            "\"massive_allocations\": %.3f, \"output_reallocs\": %.3f, \"output_bytes\": %.1f, \"nodes\": %.1f, "
+            "\"max_depth\": %llu}",
+            S.Calls / N,
+            S.ArenaBlocks / N,
+            S.ArenaBytes / N,
+            S.MassiveAllocations / N,
+            S.OutputReallocs / N,
+            S.OutputBytes / N,
+            S.Nodes / N,
+            static_cast<unsigned long long>(S.MaxDepth)
+        );
+#endif
+        std::fprintf(Out, "}");
+    }
+    std::fprintf(Out, "\n  ]\n}\n");
+}
+
+void writeTable(std::FILE* Out, const std::vector<Result>& Results) {
+    std::fprintf(
+        Out,
+        "%-28s %-22s %-6s %9s %12s %9s %9s %9s %10s\n",
+        "benchmark",
+        "corpus",
+        "phase",
+        "ok/total",
+        "symbols/s",
+        "p50 ns",
+        "p99 ns",
+        "allocs",
+        "peak B"
+    );
+    for (const Result& R : Results) {
+        std::fprintf(
+            Out,
+            "%-28s %-22s %-6s %4zu/%-4zu %12.0f %9llu %9llu %9.2f %10zu\n",
+            R.Benchmark.c_str(),
+            R.Corpus.c_str(),
+            R.Phase.c_str(),
+            R.Demangled,
+            R.Symbols,
+            R.SymbolsPerSecond,
+            static_cast<unsigned long long>(R.P50),
+            static_cast<unsigned long long>(R.P99),
+            R.AllocationsPerSymbol,
+            R.PeakArenaBytes
+        );
+    }
+}
+
+void printUsage(const char* Argv0) {
+    std::fprintf(stderr, "usage: %s [--corpus-dir DIR] [--iterations N] [--filter TEXT] [--json FILE]\n", Argv0);
+    std::fprintf(stderr, "  --corpus-dir DIR  directory holding the corpora (default: benchmark/corpus)\n");
+    std::fprintf(stderr, "  --iterations N    timed passes over each corpus (default: 20)\n");
+    std::fprintf(stderr, "  --filter TEXT     only run benchmarks or corpora whose name contains TEXT\n");
+    std::fprintf(stderr, "  --json FILE       write the JSON report to FILE instead of standard output\n");
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    Options Opts;
+    for (int I = 1; I < argc; ++I) {
+        std::string_view Arg = argv[I];
+        if (Arg == "--corpus-dir" && I + 1 < argc) {
+            Opts.CorpusDir = argv[++I];
+        } else if (Arg == "--iterations" && I + 1 < argc) {
+            Opts.Iterations = std::max(1u, static_cast<unsigned>(std::strtoul(argv[++I], nullptr, 10)));
+        } else if (Arg == "--filter" && I + 1 < argc) {
+            Opts.Filter = argv[++I];
+        } else if (Arg == "--json" && I + 1 < argc) {
+            Opts.JSONPath = argv[++I];
+        } else if (Arg == "-h" || Arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<Corpus> Corpora;
+    for (const char* Scheme : Schemes) {
+        for (const char* Kind : Kinds) {
+            Corpus C;
+            C.Scheme = Scheme;
+            C.Name   = std::string(Scheme) + "-" + Kind;
+            if (!loadCorpus(Opts.CorpusDir + "/" + C.Name + ".txt", C)) {
+                std::fprintf(stderr, "%s: cannot read corpus '%s' in '%s'\n", argv[0], C.Name.c_str(), Opts.CorpusDir.c_str());
+                return 1;
+            }
+            Corpora.push_back(std::move(C));
+        }
+    }
+
+    std::vector<Result> Results;
+    for (const Benchmark& B : Benchmarks) {
+        for (const Corpus& C : Corpora) {
+            if (B.Scheme && C.Scheme != B.Scheme) continue;
+            if (!Opts.Filter.empty() && std::string_view(B.Name).find(Opts.Filter) == std::string_view::npos
+                && C.Name.find(Opts.Filter) == std::string::npos)
+                continue;
+            runBenchmark(B, C, Opts.Iterations, Results);
+        }
+    }
+
+    writeTable(stderr, Results);
+    std::FILE* Out = Opts.JSONPath.empty() ? stdout : std::fopen(Opts.JSONPath.c_str(), "w");
+    if (Out == nullptr) {
+        std::fprintf(stderr, "%s: cannot write '%s'\n", argv[0], Opts.JSONPath.c_str());
+        return 1;
+    }
+    writeJSON(Out, Opts, Results);
+    if (Out != stdout) std::fclose(Out);
+    return 0;
+}
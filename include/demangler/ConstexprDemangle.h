@@ -0,0 +1,242 @@
+//===--- ConstexprDemangle.h ------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Demangling of names known at build time. The Itanium and Microsoft parsers
+// run during constant evaluation with a node allocator built on the transient
+// allocation constant evaluation allows, and print into a fixed array:
+//
+//   constexpr auto Name = demangler::ct::demangle<"?tick@Level@@QEAAXXZ">();
+//   static_assert(std::string_view(Name.data()) == "public: void __cdecl Level::tick(void)");
+//
+// A name that does not demangle fails the compile. So does one whose output
+// does not fit the capacity, which is the second template argument.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEMANGLE_CONSTEXPRDEMANGLE_H
+#define LLVM_DEMANGLE_CONSTEXPRDEMANGLE_H
+
+#include "ItaniumDemangle.h"
+#include "MicrosoftDemangle.h"
+#include "Utility.h"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+namespace demangler::ct {
+
+/// A string literal usable as a template argument.
+template <size_t N>
+struct FixedString {
+    char Data[N]{};
+
+    consteval FixedString(const char (&S)[N]) {
+        for (size_t I = 0; I != N; ++I) Data[I] = S[I];
+    }
+
+    constexpr std::string_view view() const { return std::string_view(Data, N - 1); }
+};
+
+/// The default capacity of the output, including the null terminator.
+inline constexpr size_t DefaultCapacity = 1024;
+
+namespace detail {
+// Every allocation is a Block on one list, and the allocator hands the whole
+// list back when it goes away. The nodes in them are never destroyed, just as
+// the runtime arenas never destroy theirs; constant evaluation cannot run the
+// implicit destructors of the node classes anyway.
+class BlockList {
+protected:
+    struct Block {
+        Block* Next;
+        void (*Release)(Block*);
+    };
+
+    template <typename T>
+    struct Holder : Block {
+        T Value;
+
+        template <typename... Args>
+        constexpr Holder(Block* Next, Args&&... args)
+        : Block{Next, &release},
+          Value(std::forward<Args>(args)...) {}
+
+        static constexpr void release(Block* B) {
+            std::allocator<Holder>().deallocate(static_cast<Holder*>(B), 1);
+        }
+    };
+
+    template <typename T>
+    struct ArrayHolder : Block {
+        T*     Data;
+        size_t Size;
+
+        constexpr ArrayHolder(Block* Next, T* Data, size_t Size) : Block{Next, &release}, Data(Data), Size(Size) {}
+
+        static constexpr void release(Block* B) {
+            ArrayHolder* H = static_cast<ArrayHolder*>(B);
+            std::allocator<T>().deallocate(H->Data, H->Size);
+            std::allocator<ArrayHolder>().deallocate(H, 1);
+        }
+    };
+
+    Block* Head = nullptr;
+
+    template <typename T, typename... Args>
+    constexpr T* allocate(Args&&... args) {
+        Holder<T>* H = std::allocator<Holder<T>>().allocate(1);
+        std::construct_at(H, Head, std::forward<Args>(args)...);
+        Head = H;
+        return &H->Value;
+    }
+
+    // Allocate N value-initialized objects of type T.
+    template <typename T>
+    constexpr T* allocateArray(size_t N) {
+        T* Data = std::allocator<T>().allocate(N);
+        for (size_t I = 0; I != N; ++I) std::construct_at(Data + I);
+        ArrayHolder<T>* H = std::allocator<ArrayHolder<T>>().allocate(1);
+        std::construct_at(H, Head, Data, N);
+        Head = H;
+        return Data;
+    }
+
+public:
+    constexpr BlockList() = default;
+    BlockList(const BlockList&)            = delete;
+    BlockList& operator=(const BlockList&) = delete;
+    constexpr ~BlockList() { reset(); }
+
+    constexpr void reset() {
+        while (Block* B = Head) {
+            Head = B->Next;
+            B->Release(B);
+        }
+    }
+};
+} // namespace detail
+
+/// The node allocator of an Itanium parser that runs during constant
+/// evaluation.
+class ItaniumAllocator : public detail::BlockList {
+public:
+    template <typename T, typename... Args>
+    constexpr T* makeNode(Args&&... args) {
+        return allocate<T>(std::forward<Args>(args)...);
+    }
+
+    constexpr itanium_demangle::Node** allocateNodeArray(size_t sz) {
+        return allocateArray<itanium_demangle::Node*>(sz);
+    }
+};
+
+/// The allocator of a Microsoft parser that runs during constant evaluation,
+/// in place of ms_demangle::ArenaAllocator.
+class MicrosoftAllocator : public detail::BlockList {
+public:
+    template <typename T, typename... Args>
+    constexpr T* alloc(Args&&... ConstructorArgs) {
+        return allocate<T>(std::forward<Args>(ConstructorArgs)...);
+    }
+
+    template <typename T>
+    constexpr T* allocArray(size_t Count) {
+        return allocateArray<T>(Count);
+    }
+
+    constexpr char* allocUnalignedBuffer(size_t Size) { return allocateArray<char>(Size); }
+};
+
+namespace detail {
+// What a demangler printed into a buffer of Capacity characters.
+template <size_t Capacity>
+struct Output {
+    std::array<char, Capacity> Buffer{};
+    size_t                     Size      = 0;
+    bool                       Demangled = false;
+};
+
+template <size_t Capacity>
+constexpr Output<Capacity> itaniumDemangle(std::string_view MangledName) {
+    Output<Capacity> Result;
+    if (MangledName.empty()) return Result;
+
+    itanium_demangle::ManglingParser<ItaniumAllocator> Parser(
+        MangledName.data(),
+        MangledName.data() + MangledName.size()
+    );
+    const itanium_demangle::Node* AST = Parser.parse();
+    if (!AST) return Result;
+
+    itanium_demangle::OutputBuffer OB(Result.Buffer.data(), Capacity - 1);
+    AST->print(OB);
+    Result.Size      = OB.getCurrentPosition();
+    Result.Demangled = true;
+    return Result;
+}
+
+struct MicrosoftDemangler final : ms_demangle::MicrosoftDemanglerBase<MicrosoftDemangler, MicrosoftAllocator> {};
+
+template <size_t Capacity>
+constexpr Output<Capacity> microsoftDemangle(std::string_view MangledName) {
+    Output<Capacity> Result;
+
+    MicrosoftDemangler       D;
+    ms_demangle::SymbolNode* AST = D.parse(MangledName);
+    // Like the Itanium parser, require the whole name to be consumed.
+    if (D.Error || !MangledName.empty()) return Result;
+
+    itanium_demangle::OutputBuffer OB(Result.Buffer.data(), Capacity - 1);
+    AST->print(OB, ms_demangle::OF_Default);
+    Result.Size      = OB.getCurrentPosition();
+    Result.Demangled = true;
+    return Result;
+}
+
+template <size_t Capacity>
+constexpr Output<Capacity> demangle(std::string_view MangledName) {
+    if (MangledName.starts_with('?')) return microsoftDemangle<Capacity>(MangledName);
+    return itaniumDemangle<Capacity>(MangledName);
+}
+
+// Copy a successful Output into an array of exactly its size plus a null
+// terminator.
+template <auto Result>
+consteval auto finish() {
+    static_assert(Result.Demangled, "not a valid mangled name");
+    std::array<char, Result.Size + 1> Name{};
+    for (size_t I = 0; I != Result.Size; ++I) Name[I] = Result.Buffer[I];
+    return Name;
+}
+} // namespace detail
+
+/// Demangle an Itanium name at compile time. The result is null terminated.
+template <FixedString MangledName, size_t Capacity = DefaultCapacity>
+consteval auto itaniumDemangle() {
+    return detail::finish<detail::itaniumDemangle<Capacity>(MangledName.view())>();
+}
+
+/// Demangle a Microsoft name at compile time. The result is null terminated.
+template <FixedString MangledName, size_t Capacity = DefaultCapacity>
+consteval auto microsoftDemangle() {
+    return detail::finish<detail::microsoftDemangle<Capacity>(MangledName.view())>();
+}
+
+/// Demangle a name at compile time. Names starting with '?' are Microsoft
+/// manglings and everything else is taken to be an Itanium one.
+template <FixedString MangledName, size_t Capacity = DefaultCapacity>
+consteval auto demangle() {
+    return detail::finish<detail::demangle<Capacity>(MangledName.view())>();
+}
+
+} // namespace demangler::ct
+
+#endif // LLVM_DEMANGLE_CONSTEXPRDEMANGLE_H
@@ -9,11 +9,25 @@
 #ifndef LLVM_DEMANGLE_DEMANGLE_H
 #define LLVM_DEMANGLE_DEMANGLE_H
 
+#include "DemangleLimits.h"
+
 #include <cstddef>
+#include <cstdint>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace demangler {
+namespace itanium_demangle {
+class OutputBuffer;
+}
+namespace ms_demangle {
+enum class CallingConv : uint8_t;
+enum FuncClassValue : uint16_t;
+class StorageClass;
+} // namespace ms_demangle
+
 /// This is a llvm local version of __cxa_demangle. Other than the name and
 /// being in the llvm namespace it is identical.
 ///
@@ -22,6 +36,9 @@ namespace demangler {
 ///
 /// The *status will be set to a value from the following enumeration
 enum : int {
+    /// The name may be valid, but demangling it reached one of the
+    /// DemangleLimits the caller passed.
+    demangle_limit_exceeded       = -5,
     demangle_unknown_error        = -4,
     demangle_invalid_args         = -3,
     demangle_invalid_mangled_name = -2,
@@ -34,6 +51,121 @@ enum : int {
 /// nullptr if mangled_name is not a valid mangling or is nullptr.
 char* itaniumDemangle(std::string_view mangled_name, bool ParseParams = true);
 
+/// Print the demangled name into OB, appending at its current position. No
+/// null terminator is written, so an OutputBuffer kept alive across calls can
+/// be rewound with setCurrentPosition(0). Returns false and leaves OB as it was
+/// if mangled_name is not a valid mangling. The same convention is used by all
+/// of the OutputBuffer overloads below.
+bool itaniumDemangle(std::string_view mangled_name, itanium_demangle::OutputBuffer& OB, bool ParseParams = true);
+
+/// Like the functions above, but give up once demangling reaches one of
+/// Limits. status receives one of the demangle_ enum entries if it's not
+/// nullptr, demangle_limit_exceeded in that case. The same convention is
+/// used by all of the overloads taking DemangleLimits below.
+char* itaniumDemangle(
+    std::string_view      mangled_name,
+    const DemangleLimits& Limits,
+    int*                  status,
+    bool                  ParseParams = true
+);
+bool itaniumDemangle(
+    std::string_view                mangled_name,
+    itanium_demangle::OutputBuffer& OB,
+    const DemangleLimits&           Limits,
+    int*                            status,
+    bool                            ParseParams = true
+);
+
+/// Where the parts of a demangled Itanium name were printed, as [Begin, End)
+/// offsets into the output. Parts the name does not have are empty. For
+/// "int const& ns::C::f[abi:cxx11]<int>(char) const &" these slice out:
+///
+///   ReturnType   "int const&"     DeclContext "ns::C"   BaseName "f"
+///   AbiTags      "[abi:cxx11]"    TemplateArgs "<int>"
+///   Parameters   "(char)"         Qualifiers  "const &"
+///
+/// ReturnTypeSuffix holds the part of a return type that follows the
+/// parameters: for "int (*h())()" ReturnType is "int (*" and
+/// ReturnTypeSuffix is ")()". For
+/// names of variables only DeclContext, BaseName, TemplateArgs and AbiTags
+/// are set, and special names such as "vtable for X" leave all parts empty.
+struct ItaniumNameComponents {
+    struct Range {
+        size_t Begin = 0;
+        size_t End   = 0;
+
+        bool             empty() const { return Begin == End; }
+        size_t           size() const { return End - Begin; }
+        std::string_view slice(std::string_view Output) const { return Output.substr(Begin, End - Begin); }
+    };
+
+    Range ReturnType;
+    Range DeclContext;
+    Range BaseName;
+    Range TemplateArgs;
+    Range AbiTags;
+    Range Parameters;
+    Range ReturnTypeSuffix;
+    Range Qualifiers;
+};
+
+/// An Itanium demangler that can be reused for many symbols. The parser's
+/// name, substitution and template parameter tables and the AST arena are
+/// kept between calls and only rewound. A session is not thread-safe; use one
+/// instance per thread.
+struct ItaniumDemangleSession {
+    /// RetainedBytes bounds how much arena memory grown past the inline initial
+    /// block is kept for the next symbol instead of being freed.
+    explicit ItaniumDemangleSession(size_t RetainedBytes = 64 * 1024);
+
+    /// Other is left a fresh session with the default settings.
+    ItaniumDemangleSession(ItaniumDemangleSession&& Other);
+    ItaniumDemangleSession& operator=(ItaniumDemangleSession&& Other);
+
+    /// Demangle mangled_name like itaniumDemangle. Buf and N behave like the
+    /// second and third parameters to __cxa_demangle; N receives the size of
+    /// the returned buffer so that it can be passed back in for the next call.
+    char* demangle(std::string_view mangled_name, char* Buf, size_t* N, bool ParseParams = true);
+
+    /// Demangle mangled_name into OB like the itaniumDemangle overload.
+    bool demangle(std::string_view mangled_name, itanium_demangle::OutputBuffer& OB, bool ParseParams = true);
+
+    /// Like the overload above, and record where each part of the name was
+    /// printed. The offsets are relative to the start of OB, not to where the
+    /// name begins.
+    bool demangle(
+        std::string_view                mangled_name,
+        itanium_demangle::OutputBuffer& OB,
+        ItaniumNameComponents&          Components,
+        bool                            ParseParams = true
+    );
+
+    /// Change the arena high-water mark, freeing retained blocks above it.
+    void setRetainedBytes(size_t Bytes);
+
+    /// Demangle every later symbol within Limits, as itaniumDemangle does.
+    /// Parts of a name shared with the previous symbol (see setSharePrefixes)
+    /// are not parsed again and do not count against them.
+    void setLimits(const DemangleLimits& Limits);
+
+    /// The demangle_ status of the last demangle() call.
+    int getStatus() const;
+
+    /// Resume each parse from where the previous symbol's stopped being the
+    /// same, at a component of the scope of its name. Neighbours in a sorted
+    /// symbol table often share their scopes, which are then parsed only once.
+    /// The session keeps a copy of the last symbol for this. Off by default.
+    void setSharePrefixes(bool Enable);
+
+    /// Drop the AST of the last symbol. demangle() calls this itself.
+    void reset();
+
+    ~ItaniumDemangleSession();
+
+private:
+    void* Context;
+};
+
 enum MSDemangleFlags {
     MSDF_None                = 0,
     MSDF_DumpBackrefs        = 1 << 0,
@@ -42,22 +174,114 @@ enum MSDemangleFlags {
     MSDF_NoReturnType        = 1 << 3,
     MSDF_NoMemberType        = 1 << 4,
     MSDF_NoVariableType      = 1 << 5,
+    /// Print only the fully qualified name of the symbol. The function or
+    /// variable encoding that follows the name is not parsed at all, so this
+    /// is much cheaper than hiding the rest of the output with the flags
+    /// above, but a malformed encoding is not detected either. n_read then
+    /// counts only the bytes up to the end of the name.
+    MSDF_NameOnly = 1 << 6,
 };
 
 /// Demangles the Microsoft symbol pointed at by mangled_name and returns it.
 /// Returns a pointer to the start of a null-terminated demangled string on
 /// success, or nullptr on error.
 /// If n_read is non-null and demangling was successful, it receives how many
-/// bytes of the input string were consumed.
+/// bytes of the input string were consumed. With MSDF_NameOnly that excludes
+/// the unparsed encoding of function and variable symbols.
 /// status receives one of the demangle_ enum entries above if it's not nullptr.
 /// Flags controls various details of the demangled representation.
-char* microsoftDemangle(std::string_view mangled_name, size_t* n_read, int* status, MSDemangleFlags Flags = MSDF_None);
+/// Demangling gives up with demangle_limit_exceeded once it reaches one of
+/// Limits.
+char* microsoftDemangle(
+    std::string_view      mangled_name,
+    size_t*               n_read,
+    int*                  status,
+    MSDemangleFlags       Flags  = MSDF_None,
+    const DemangleLimits& Limits = {}
+);
+bool microsoftDemangle(
+    std::string_view                mangled_name,
+    itanium_demangle::OutputBuffer& OB,
+    size_t*                         n_read,
+    int*                            status,
+    MSDemangleFlags                 Flags  = MSDF_None,
+    const DemangleLimits&           Limits = {}
+);
+
+/// A Microsoft demangler that can be reused for many symbols. The arena and
+/// back-reference tables are kept between calls and only rewound, so once the
+/// arena has grown to fit the largest symbol no further allocations happen.
+/// A session is not thread-safe; use one instance per thread.
+struct MicrosoftDemangleSession {
+    MicrosoftDemangleSession();
+
+    /// Other is left a fresh session with the default settings.
+    MicrosoftDemangleSession(MicrosoftDemangleSession&& Other);
+    MicrosoftDemangleSession& operator=(MicrosoftDemangleSession&& Other);
+
+    /// Demangle mangled_name like microsoftDemangle. Buf and N behave like the
+    /// second and third parameters to __cxa_demangle: Buf may be a buffer
+    /// allocated with malloc that is reused (or reallocated) for the result,
+    /// and N receives its size, so passing the previous result back in avoids
+    /// allocating for the output as well. On failure nullptr is returned and
+    /// Buf is left to the caller.
+    char* demangle(
+        std::string_view mangled_name,
+        char*            Buf,
+        size_t*          N,
+        size_t*          n_read,
+        int*             status,
+        MSDemangleFlags  Flags = MSDF_None
+    );
+
+    /// Demangle mangled_name into OB like the microsoftDemangle overload.
+    bool demangle(
+        std::string_view                mangled_name,
+        itanium_demangle::OutputBuffer& OB,
+        size_t*                         n_read,
+        int*                            status,
+        MSDemangleFlags                 Flags = MSDF_None
+    );
+
+    /// Resume each parse from the previous symbol when both start with the
+    /// same fully qualified name, as overloads next to each other in a sorted
+    /// symbol table do. The name is then parsed only once. The session keeps a
+    /// copy of the last symbol for this. Off by default.
+    void setSharePrefixes(bool Enable);
+
+    /// Demangle every later symbol within Limits, as microsoftDemangle does.
+    /// A name resumed from the previous symbol does not count against them.
+    void setLimits(const DemangleLimits& Limits);
+
+    /// Rewind the arena and clear the back-reference tables, keeping the
+    /// allocated blocks. demangle() calls this itself before parsing.
+    void reset();
+
+    ~MicrosoftDemangleSession();
+
+private:
+    void* Context;
+};
 
 // Demangles a Rust v0 mangled symbol.
 char* rustDemangle(std::string_view MangledName);
+bool  rustDemangle(std::string_view MangledName, itanium_demangle::OutputBuffer& OB);
+bool  rustDemangle(
+    std::string_view                MangledName,
+    itanium_demangle::OutputBuffer& OB,
+    const DemangleLimits&           Limits,
+    int*                            Status
+);
 
 // Demangles a D mangled symbol.
 char* dlangDemangle(std::string_view MangledName);
+bool  dlangDemangle(std::string_view MangledName, itanium_demangle::OutputBuffer& OB);
+bool  dlangDemangle(
+    std::string_view                MangledName,
+    itanium_demangle::OutputBuffer& OB,
+    const DemangleLimits&           Limits,
+    int*                            Status
+);
 
 /// Attempt to demangle a string using different demangling schemes.
 /// The function uses heuristics to determine which demangling scheme to use.
@@ -66,12 +290,193 @@ char* dlangDemangle(std::string_view MangledName);
 /// demangling occurred.
 std::string demangle(std::string_view MangledName);
 
+/// Like demangle above, but appends the result (or the input) to Result.
+/// \returns - true if demangling occurred.
+bool demangle(std::string_view MangledName, std::string& Result);
+
+/// Like demangle above, but prints into OB without a null terminator.
+/// \returns - true if demangling occurred.
+bool demangle(std::string_view MangledName, itanium_demangle::OutputBuffer& OB);
+
+/// The outcome of demangling into a fixed-size buffer.
+struct DemangleBufferResult {
+    /// Length of the complete result, excluding the null terminator.
+    size_t Size;
+    /// True if demangling occurred, false if the input was copied instead.
+    bool Demangled;
+    /// True if the buffer could not hold Size + 1 bytes. The buffer then holds
+    /// as much of the result as fits, still null terminated.
+    bool Truncated;
+};
+
+/// Like demangle above, but writes a null-terminated result into Buf.
+DemangleBufferResult demangle(std::string_view MangledName, std::span<char> Buf);
+
+/// Like the demangle functions above, but every scheme that is tried gives up
+/// once it reaches one of Limits. Status, if not nullptr, receives
+/// demangle_success if demangling occurred, demangle_limit_exceeded if a
+/// scheme gave up on a limit, and demangle_invalid_mangled_name otherwise.
+/// The input is copied out on failure, as usual.
+bool demangle(std::string_view MangledName, std::string& Result, const DemangleLimits& Limits, int* Status);
+bool demangle(
+    std::string_view                MangledName,
+    itanium_demangle::OutputBuffer& OB,
+    const DemangleLimits&           Limits,
+    int*                            Status
+);
+DemangleBufferResult
+demangle(std::string_view MangledName, std::span<char> Buf, const DemangleLimits& Limits, int* Status);
+
+/// The mangling schemes that demangle() knows about.
+enum class ManglingScheme : unsigned char {
+    None,
+    /// Itanium C++ ABI, "_Z". Itanium2 to Itanium4 have two to four leading
+    /// underscores instead: "__Z" as on Mach-O, and "___Z" or "____Z" for
+    /// block invocations.
+    Itanium,
+    Itanium2,
+    Itanium3,
+    Itanium4,
+    /// Microsoft Visual C++, "?".
+    Microsoft,
+    /// A Microsoft name too long to be mangled, replaced by its MD5, "??@".
+    MicrosoftMD5,
+    /// Rust v0, "_R".
+    Rust,
+    /// D, "_D".
+    DLang,
+};
+
+/// The number of leading underscores of an Itanium scheme, or 0 if Scheme is
+/// not an Itanium scheme.
+constexpr unsigned getItaniumUnderscores(ManglingScheme Scheme) {
+    switch (Scheme) {
+    case ManglingScheme::Itanium:
+        return 1;
+    case ManglingScheme::Itanium2:
+        return 2;
+    case ManglingScheme::Itanium3:
+        return 3;
+    case ManglingScheme::Itanium4:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+/// Determine the scheme MangledName appears to be mangled with from its prefix
+/// alone, using the same rules as demangle(): non-Microsoft names may have a
+/// leading '.' or one extra leading underscore, and any other name starting
+/// with '?' or '.' is Microsoft. Nothing is parsed, so the name may still fail
+/// to demangle.
+ManglingScheme detectManglingScheme(std::string_view MangledName);
+
+/// Demangle MangledName as Scheme with exactly one attempt, as returned by
+/// detectManglingScheme. Unlike demangle() no other scheme is tried, and a
+/// name that fails is not retried without its leading underscore.
+/// \returns - the demangled string, or a copy of the input string if no
+/// demangling occurred.
+std::string demangle(std::string_view MangledName, ManglingScheme Scheme);
+
+/// Like demangle above, but prints into OB without a null terminator.
+/// \returns - true if demangling occurred; OB is left as it was otherwise.
+bool demangle(std::string_view MangledName, ManglingScheme Scheme, itanium_demangle::OutputBuffer& OB);
+bool demangle(
+    std::string_view                MangledName,
+    ManglingScheme                  Scheme,
+    itanium_demangle::OutputBuffer& OB,
+    const DemangleLimits&           Limits,
+    int*                            Status
+);
+
+/// One symbol of a DemangleBatchResult.
+struct DemangleBatchEntry {
+    /// Offset of the null-terminated result in DemangleBatchResult::Buffer.
+    size_t Offset;
+    /// Length of the result, excluding the null terminator.
+    size_t Size;
+    /// The scheme the symbol was demangled with. If demangling did not occur,
+    /// the scheme detectManglingScheme reports for it.
+    ManglingScheme Scheme;
+    /// True if demangling occurred; otherwise the result is a copy of the input.
+    bool Demangled;
+    /// True if demangling did not occur because a scheme reached a limit.
+    bool LimitExceeded;
+};
+
+/// The demangled names of a batch, stored back to back in one buffer.
+struct DemangleBatchResult {
+    std::vector<char>               Buffer;
+    std::vector<DemangleBatchEntry> Entries;
+
+    size_t size() const { return Entries.size(); }
+
+    std::string_view operator[](size_t I) const { return {Buffer.data() + Entries[I].Offset, Entries[I].Size}; }
+};
+
+/// Demangle every name in MangledNames like demangle() does, on NumThreads
+/// threads (0 means one per hardware thread). Each thread reuses its own
+/// demangler sessions and steals work from the others once it runs out, and
+/// the result is in input order regardless of scheduling. Microsoft names are
+/// demangled with Flags. SharePrefixes turns on setSharePrefixes for the
+/// sessions, which pays off if MangledNames is sorted. Every symbol is
+/// demangled within Limits. WholeNames makes a Microsoft name fail unless the
+/// demangler consumes all of it, as it stops at the end of the symbol and
+/// otherwise ignores what follows; MSDF_NameOnly turns the check off.
+DemangleBatchResult demangleBatch(
+    std::span<const std::string_view> MangledNames,
+    unsigned                          NumThreads    = 0,
+    MSDemangleFlags                   Flags         = MSDF_None,
+    bool                              SharePrefixes = false,
+    const DemangleLimits&             Limits        = {},
+    bool                              WholeNames    = false
+);
+
+/// Demangles batch after batch like demangleBatch, on threads and demangler
+/// sessions that are started once for the pool rather than for every batch.
+/// The parameters are those of demangleBatch. The calling thread works on
+/// each batch as well, so NumThreads - 1 threads are started.
+struct DemangleBatchPool {
+    explicit DemangleBatchPool(
+        unsigned              NumThreads    = 0,
+        MSDemangleFlags       Flags         = MSDF_None,
+        bool                  SharePrefixes = false,
+        const DemangleLimits& Limits        = {},
+        bool                  WholeNames    = false
+    );
+    ~DemangleBatchPool();
+
+    DemangleBatchPool(const DemangleBatchPool&)            = delete;
+    DemangleBatchPool& operator=(const DemangleBatchPool&) = delete;
+
+    /// Like demangleBatch with the settings of the pool. Only one thread may
+    /// call this at a time.
+    DemangleBatchResult demangle(std::span<const std::string_view> MangledNames);
+
+private:
+    void* Context;
+};
+
 bool nonMicrosoftDemangle(
     std::string_view MangledName,
     std::string&     Result,
     bool             CanHaveLeadingDot = true,
     bool             ParseParams       = true
 );
+bool nonMicrosoftDemangle(
+    std::string_view                MangledName,
+    itanium_demangle::OutputBuffer& OB,
+    bool                            CanHaveLeadingDot = true,
+    bool                            ParseParams       = true
+);
+bool nonMicrosoftDemangle(
+    std::string_view                MangledName,
+    itanium_demangle::OutputBuffer& OB,
+    const DemangleLimits&           Limits,
+    int*                            Status,
+    bool                            CanHaveLeadingDot = true,
+    bool                            ParseParams       = true
+);
 
 /// "Partial" demangler. This supports demangling a string into an AST
 /// (typically an intermediate stage in itaniumDemangle) and querying certain
@@ -87,10 +492,20 @@ struct ItaniumPartialDemangler {
     /// \return true on error, false otherwise
     bool partialDemangle(const char* MangledName);
 
+    /// Parse every later symbol within the AST limits of Limits, MaxNodes,
+    /// MaxArenaBytes and MaxDepth. partialDemangle fails on a symbol that
+    /// reaches one.
+    void setLimits(const DemangleLimits& Limits);
+
     /// Just print the entire mangled name into Buf. Buf and N behave like the
     /// second and third parameters to __cxa_demangle.
     char* finishDemangle(char* Buf, size_t* N) const;
 
+    /// Print the entire mangled name into Buf once and record where each part
+    /// of it is, so that the parts can be sliced out instead of being printed
+    /// by the get* functions below one at a time.
+    char* finishDemangle(char* Buf, size_t* N, ItaniumNameComponents& Components) const;
+
     /// Get the base name of a function. This doesn't include trailing template
     /// arguments, ie for "a::b<int>" this function returns "b".
     char* getFunctionBaseName(char* Buf, size_t* N) const;
@@ -99,6 +514,17 @@ struct ItaniumPartialDemangler {
     /// "a::b".
     char* getFunctionDeclContextName(char* Buf, size_t* N) const;
 
+    /// The number of scopes the name of a function or variable is nested in,
+    /// 2 for "a::b<int>::c". The function a local name is nested in is a
+    /// single scope, "f()" for "f()::x". Special names count the scopes of
+    /// what they are for, 1 for "vtable for a::b".
+    size_t getNumScopes() const;
+
+    /// Print the Index-th of those scopes, outermost first, with its template
+    /// arguments. Joined by "::", the scopes of a function are what
+    /// getFunctionDeclContextName prints.
+    char* getScope(size_t Index, char* Buf, size_t* N) const;
+
     /// Get the entire name of this function.
     char* getFunctionName(char* Buf, size_t* N) const;
 
@@ -129,6 +555,110 @@ private:
     void* RootNode;
     void* Context;
 };
+
+/// "Partial" demangler for Microsoft symbols, the counterpart of
+/// ItaniumPartialDemangler. partialDemangle parses a symbol into an AST that
+/// the other member functions query, printing only the part they ask for.
+/// The AST lives in an arena that is rewound, not freed, by the next
+/// partialDemangle, so one instance can be reused for many symbols.
+///
+/// Buf and N behave like the second and third parameters to __cxa_demangle.
+/// Functions returning std::string_view point into the mangled name for
+/// identifiers spelled out in it, so it must outlive them, and into the arena
+/// for synthesized ones such as "`vftable'". Either way they are invalidated
+/// by the next partialDemangle.
+///
+/// The enumerations returned by the classification queries are defined in
+/// MicrosoftDemangleNodes.h.
+struct MicrosoftPartialDemangler {
+    MicrosoftPartialDemangler();
+
+    MicrosoftPartialDemangler(MicrosoftPartialDemangler&& Other);
+    MicrosoftPartialDemangler& operator=(MicrosoftPartialDemangler&& Other);
+
+    /// Demangle into an AST. Subsequent calls to the rest of the member functions
+    /// implicitly operate on the AST this produces.
+    /// \return true on error, false otherwise
+    bool partialDemangle(std::string_view MangledName);
+
+    /// Parse every later symbol within the AST limits of Limits, MaxNodes,
+    /// MaxArenaBytes and MaxDepth. partialDemangle fails on a symbol that
+    /// reaches one.
+    void setLimits(const DemangleLimits& Limits);
+
+    /// Print the entire demangled name into Buf.
+    char* finishDemangle(char* Buf, size_t* N, MSDemangleFlags Flags = MSDF_None) const;
+
+    /// Get the base name of the symbol. This doesn't include trailing template
+    /// arguments, ie for "a::b<int>" this function returns "b".
+    char* getBaseName(char* Buf, size_t* N) const;
+
+    /// The base name if it is a plain identifier (the class name for a
+    /// constructor), or an empty string for operators and other special names.
+    std::string_view getBaseNameRef() const;
+
+    /// Get the context name of the symbol. For "a::b::c", this function returns
+    /// "a::b".
+    char* getDeclContextName(char* Buf, size_t* N) const;
+
+    /// The number of scopes enclosing the symbol, 2 for "a::b::c".
+    size_t getNumScopes() const;
+
+    /// The name of the Index-th enclosing scope, outermost first, without its
+    /// template arguments. It is empty if the scope is not an identifier, such
+    /// as an operator. The function and block a local name is nested in form a
+    /// single scope, "`void __cdecl f(void)'::`2'".
+    std::string_view getScopeRef(size_t Index) const;
+
+    /// Print the Index-th enclosing scope with its template arguments, as
+    /// getDeclContextName prints it.
+    char* getScope(size_t Index, char* Buf, size_t* N) const;
+
+    /// Get the entire qualified name of the symbol.
+    char* getName(char* Buf, size_t* N) const;
+
+    /// Get the parameters for this function, including the parentheses.
+    char* getFunctionParameters(char* Buf, size_t* N) const;
+    char* getFunctionReturnType(char* Buf, size_t* N) const;
+
+    /// The calling convention of this function, or CallingConv::None.
+    ms_demangle::CallingConv getCallingConvention() const;
+
+    /// The FuncClassValue flags of this function, or FC_None.
+    ms_demangle::FuncClassValue getFunctionClass() const;
+
+    /// The storage class of this variable, or StorageClass::None.
+    ms_demangle::StorageClass getStorageClass() const;
+
+    /// "public", "protected" or "private" for class members, or an empty string.
+    std::string_view getAccessSpecifier() const;
+
+    /// If this function has any cv or reference qualifiers. These imply that
+    /// the function is a non-static member function.
+    bool hasFunctionQualifiers() const;
+
+    /// If this symbol describes a constructor or destructor.
+    bool isCtorOrDtor() const;
+
+    /// If this symbol describes a function. This includes compiler-generated
+    /// functions such as thunks and dynamic initializers.
+    bool isFunction() const;
+
+    /// If this symbol describes a variable.
+    bool isData() const;
+
+    /// If this symbol is a special name. These are generally implicitly
+    /// generated by the implementation, such as vftables, RTTI descriptors and
+    /// string literals.
+    bool isSpecialName() const;
+
+    ~MicrosoftPartialDemangler();
+
+private:
+    void* RootNode;
+    void* Context;
+    bool  SpecialName = false;
+};
 } // namespace demangler
 
 #endif
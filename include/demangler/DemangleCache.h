@@ -0,0 +1,122 @@
+//===--- DemangleCache.h ----------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// A thread-safe cache of demangled names for workloads that see the same
+// mangled names over and over again.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEMANGLE_DEMANGLECACHE_H
+#define LLVM_DEMANGLE_DEMANGLECACHE_H
+
+#include "demangler/Demangle.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+namespace demangler {
+
+/// Caches the results of the demangling entry points. The cache is split into
+/// independently locked shards selected by the hash of the mangled name, and
+/// each shard interns its entries into a ring of arena segments within its
+/// share of the byte budget. When a shard runs out of room its oldest segment
+/// is reclaimed CLOCK style: entries that were hit since they were stored get
+/// a second chance and move to the newest segment, the rest are evicted.
+///
+/// Results are returned as views into the cache. A view obtained while the
+/// calling thread holds a ReadGuard stays valid until that guard is
+/// destroyed. Without a guard, a miss on any thread may evict the entry and
+/// free its memory at any time, so an unguarded view is only safe when no
+/// other thread uses the cache.
+///
+/// Reclaimed segments are freed epoch style: a segment is freed once every
+/// guard that was alive when it was reclaimed is gone, so guards that keep
+/// overlapping do not hold memory back forever; only a single long-lived
+/// guard does.
+class DemangleCache {
+public:
+    struct Stats {
+        uint64_t Hits      = 0;
+        uint64_t Misses    = 0;
+        uint64_t Evictions = 0;
+        /// Number of cached results and the arena bytes they occupy.
+        uint64_t Entries = 0;
+        uint64_t Bytes   = 0;
+        /// Arena bytes of reclaimed segments that guards may still be viewing.
+        uint64_t RetiredBytes = 0;
+    };
+
+    /// Keeps the memory behind every view returned while it is alive.
+    class ReadGuard {
+        DemangleCache& Cache;
+        unsigned       Slot;
+
+    public:
+        explicit ReadGuard(DemangleCache& Cache) : Cache(Cache) {
+            // Join the current epoch. If it moved on before the guard was
+            // counted, the reclaimer may not have seen it; join the new one.
+            for (;;) {
+                uint64_t Epoch = Cache.Epoch.load();
+                Slot           = static_cast<unsigned>(Epoch & 1);
+                Cache.Readers[Slot].fetch_add(1);
+                if (Cache.Epoch.load() == Epoch) break;
+                Cache.Readers[Slot].fetch_sub(1);
+            }
+        }
+        ~ReadGuard() { Cache.Readers[Slot].fetch_sub(1); }
+
+        ReadGuard(const ReadGuard&)            = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+    };
+
+    /// ByteBudget is split evenly between NumShards shards, which is rounded
+    /// up to a power of two.
+    explicit DemangleCache(size_t ByteBudget = 64 << 20, unsigned NumShards = 16);
+    ~DemangleCache();
+
+    DemangleCache(const DemangleCache&)            = delete;
+    DemangleCache& operator=(const DemangleCache&) = delete;
+
+    /// Like demangler::demangle: the demangled name, or the input if no
+    /// demangling occurred.
+    std::string_view demangle(std::string_view MangledName);
+
+    /// Like the corresponding entry points in Demangle.h. Failures are cached
+    /// as well; they return false and leave Result empty.
+    bool itaniumDemangle(std::string_view MangledName, std::string_view& Result, bool ParseParams = true);
+    bool microsoftDemangle(std::string_view MangledName, std::string_view& Result, MSDemangleFlags Flags = MSDF_None);
+    bool rustDemangle(std::string_view MangledName, std::string_view& Result);
+    bool dlangDemangle(std::string_view MangledName, std::string_view& Result);
+
+    /// Counters summed over all shards.
+    Stats getStats() const;
+
+    /// Drop every entry. No view returned earlier may be in use.
+    void clear();
+
+private:
+    struct Shard;
+
+    bool     lookup(std::string_view MangledName, uint32_t Mode, std::string_view& Result);
+    uint64_t advanceEpoch();
+
+    std::unique_ptr<Shard[]> Shards;
+    unsigned                 ShardBits;
+    // Guards join the epoch current when they are created, counted in the
+    // slot of its parity. The epoch only advances once the guards of the
+    // previous one are gone.
+    std::atomic<uint64_t> Epoch{0};
+    std::atomic<unsigned> Readers[2] = {};
+};
+
+} // namespace demangler
+
+#endif // LLVM_DEMANGLE_DEMANGLECACHE_H
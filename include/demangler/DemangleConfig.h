@@ -90,6 +90,34 @@
 #define DEMANGLE_ASSERT(__expr, __msg) assert((__expr) && (__msg))
 #endif
 
+// Set DEMANGLE_ENABLE_STATS to 1 to collect demangler::DemangleStats (see
+// DemangleStats.h). It must be set the same way for the library and for code
+// that includes its headers.
+#ifndef DEMANGLE_ENABLE_STATS
+#define DEMANGLE_ENABLE_STATS 0
+#endif
+
+// Set DEMANGLE_ENABLE_PROFILE to 1 to profile the grammar productions of the
+// demanglers into demangler::DemangleProfile (see DemangleProfile.h). Like
+// DEMANGLE_ENABLE_STATS, it must be set the same way everywhere.
+#ifndef DEMANGLE_ENABLE_PROFILE
+#define DEMANGLE_ENABLE_PROFILE 0
+#endif
+
+// The vector instruction set the scanning helpers in StringViewExtras.h use,
+// picked from the target the library is compiled for: AVX2 when it is
+// enabled, else SSE2 (always available on x86-64), else NEON. Define
+// DEMANGLE_DISABLE_SIMD to use their scalar loops only.
+#if !defined(DEMANGLE_DISABLE_SIMD)
+#if defined(__AVX2__)
+#define DEMANGLE_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DEMANGLE_SIMD_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define DEMANGLE_SIMD_NEON 1
+#endif
+#endif
+
 #define DEMANGLE_NAMESPACE_BEGIN                                                                                       \
     namespace demangler {                                                                                              \
     namespace itanium_demangle {
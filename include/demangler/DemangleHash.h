@@ -0,0 +1,50 @@
+//===--- DemangleHash.h -----------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// The string hash shared by DemangleCache, DemangledSymbolTable and the index
+// files. The index files store tables built with it, so changing it changes
+// their format.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEMANGLE_DEMANGLEHASH_H
+#define LLVM_DEMANGLE_DEMANGLEHASH_H
+
+#include <cstdint>
+#include <string_view>
+
+namespace demangler {
+
+namespace detail {
+// The murmur3 finalizer, so that every bit of H affects the high bits that
+// pick shards and buckets.
+constexpr uint64_t mixHash(uint64_t H) {
+    H ^= H >> 33;
+    H *= 0xff51afd7ed558ccdull;
+    H ^= H >> 33;
+    H *= 0xc4ceb9fe1a85ec53ull;
+    H ^= H >> 33;
+    return H;
+}
+
+// FNV-1a of S followed by mixHash. Seed perturbs the starting state, so
+// strings that collide under one seed almost never collide under another;
+// seed 0 is plain FNV-1a.
+constexpr uint64_t hashString(std::string_view S, uint64_t Seed = 0) {
+    uint64_t H = 0xcbf29ce484222325ull ^ mixHash(Seed);
+    for (char C : S) {
+        H ^= static_cast<unsigned char>(C);
+        H *= 0x100000001b3ull;
+    }
+    return mixHash(H);
+}
+} // namespace detail
+
+} // namespace demangler
+
+#endif // LLVM_DEMANGLE_DEMANGLEHASH_H
@@ -0,0 +1,331 @@
+//===--- DemangleIndex.h ----------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// A precomputed, memory-mappable index of demangled symbols. A process that
+// demangles the same symbol table on every launch builds the index once,
+// keyed by a hash of the binary, and later launches map it and answer the
+// partial demangler queries without parsing or printing anything:
+//
+//   DemangleIndexBuilder Builder;
+//   for (std::string_view Name : Exports) Builder.add(Name);
+//   Builder.write("exports.dmidx", BinaryHash);
+//
+//   DemangleIndex Index;
+//   if (Index.open("exports.dmidx", BinaryHash))
+//       if (DemangleIndex::Symbol S = Index.find("?tick@Level@@QEAAXXZ")) use(S.getBaseName());
+//
+// DemangleReverseIndex goes the other way, from a demangled name to the
+// symbols it was demangled from, for resolving hooks written against
+// demangled signatures. Its keys are printed with a set of MSDemangleFlags,
+// so that queries need not spell out access specifiers or calling
+// conventions:
+//
+//   DemangleReverseIndexBuilder Builder(MSDemangleFlags(MSDF_NoAccessSpecifier | MSDF_NoCallingConvention));
+//   for (std::string_view Name : Exports) Builder.add(Name);
+//   Builder.write("exports.dmrdx", BinaryHash);
+//
+//   DemangleReverseIndex Reverse;
+//   if (Reverse.open("exports.dmrdx", BinaryHash))
+//       for (uint32_t I : Reverse.find("void Level::tick(void)")) hook(Reverse.getMangledName(I));
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEMANGLE_DEMANGLEINDEX_H
+#define LLVM_DEMANGLE_DEMANGLEINDEX_H
+
+#include "demangler/Demangle.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace demangler {
+
+namespace detail {
+// A string in the string table of an index.
+struct IndexStringRef {
+    uint32_t Offset;
+    uint32_t Size;
+};
+
+// One symbol of an index, as laid out in the file.
+struct IndexSymbolRecord {
+    IndexStringRef Mangled;
+    IndexStringRef Demangled;
+    IndexStringRef Name;
+    IndexStringRef BaseName;
+    IndexStringRef DeclContext;
+    IndexStringRef Parameters;
+    IndexStringRef ReturnType;
+    uint16_t       FunctionClass;
+    uint8_t        Scheme;
+    uint8_t        Flags;
+    uint8_t        CallingConvention;
+    uint8_t        StorageClass;
+    uint8_t        Reserved[2];
+};
+
+// One key of a reverse index and the range of symbols it maps to.
+struct ReverseIndexSlot {
+    IndexStringRef Key;
+    uint32_t       FirstMatch;
+    uint32_t       NumMatches;
+};
+} // namespace detail
+
+/// A read-only view of an index file, usually mapped from disk. Lookups do not
+/// allocate, and every string returned points into the mapping, so it stays
+/// valid until the index is closed.
+class DemangleIndex {
+public:
+    /// One symbol of the index, or no symbol if it converts to false. The
+    /// queries mirror ItaniumPartialDemangler and MicrosoftPartialDemangler;
+    /// parts a symbol does not have are empty. Rust and D symbols only have
+    /// their mangled and demangled names.
+    class Symbol {
+        const detail::IndexSymbolRecord* Record = nullptr;
+        const DemangleIndex*             Index  = nullptr;
+
+        friend class DemangleIndex;
+
+        Symbol(const detail::IndexSymbolRecord* Record, const DemangleIndex* Index) : Record(Record), Index(Index) {}
+
+    public:
+        Symbol() = default;
+
+        explicit operator bool() const { return Record != nullptr; }
+
+        /// The symbol as it was added to the index.
+        std::string_view getMangledName() const { return Index->str(Record->Mangled); }
+
+        /// What demangle() returns for the symbol: the demangled name, or the
+        /// mangled name if it could not be demangled.
+        std::string_view getDemangledName() const { return Index->str(Record->Demangled); }
+
+        /// The qualified name, "a::b<int>" for "void a::b<int>(char)".
+        std::string_view getName() const { return Index->str(Record->Name); }
+
+        /// The base name without template arguments, "b" for "a::b<int>".
+        std::string_view getBaseName() const { return Index->str(Record->BaseName); }
+
+        /// The context of the name, "a" for "a::b<int>".
+        std::string_view getDeclContextName() const { return Index->str(Record->DeclContext); }
+
+        /// The parameters of a function, including the parentheses.
+        std::string_view getFunctionParameters() const { return Index->str(Record->Parameters); }
+        std::string_view getFunctionReturnType() const { return Index->str(Record->ReturnType); }
+
+        /// The scheme detectManglingScheme reports for the symbol.
+        ManglingScheme getScheme() const { return static_cast<ManglingScheme>(Record->Scheme); }
+
+        /// The calling convention, FuncClass flags and storage class of a
+        /// Microsoft symbol, which are defined in MicrosoftDemangleNodes.h.
+        ms_demangle::CallingConv    getCallingConvention() const;
+        ms_demangle::FuncClassValue getFunctionClass() const;
+        ms_demangle::StorageClass   getStorageClass() const;
+
+        bool isDemangled() const;
+        bool isFunction() const;
+        bool isData() const;
+        bool isSpecialName() const;
+        bool isCtorOrDtor() const;
+        bool hasFunctionQualifiers() const;
+    };
+
+    DemangleIndex() = default;
+    ~DemangleIndex();
+
+    DemangleIndex(DemangleIndex&& Other);
+    DemangleIndex& operator=(DemangleIndex&& Other);
+
+    DemangleIndex(const DemangleIndex&)            = delete;
+    DemangleIndex& operator=(const DemangleIndex&) = delete;
+
+    /// Map the index file at Path. Fails if it cannot be mapped, is not an
+    /// index in the current format, or was written with another Key.
+    bool open(const char* Path, uint64_t Key);
+
+    /// Use an index that is already in memory, such as one produced by
+    /// DemangleIndexBuilder::serialize. Data must be aligned to 8 bytes and
+    /// stay alive and unchanged while the index is in use.
+    bool load(std::span<const char> Data, uint64_t Key);
+
+    /// Drop the index. Every Symbol and string obtained from it becomes
+    /// invalid.
+    void close();
+
+    /// The number of symbols, which are numbered in the order they were added.
+    size_t size() const { return NumSymbols; }
+
+    Symbol operator[](size_t I) const { return Symbol(&Records[I], this); }
+
+    /// The symbol with the given mangled name, if there is one.
+    Symbol find(std::string_view MangledName) const;
+
+private:
+    std::string_view str(detail::IndexStringRef Ref) const;
+
+    const char*                      Mapping     = nullptr;
+    size_t                           MappingSize = 0;
+    const detail::IndexSymbolRecord* Records     = nullptr;
+    const uint32_t*                  Buckets     = nullptr;
+    const char*                      Strings     = nullptr;
+    size_t                           StringsSize = 0;
+    uint32_t                         NumSymbols  = 0;
+    uint32_t                         NumBuckets  = 0;
+    bool                             Mapped      = false;
+};
+
+/// Demangles symbols and writes them as a DemangleIndex. Strings shared by
+/// several symbols, such as scopes and parameter lists, are stored once, and
+/// parts of a demangled name are stored as references into it.
+class DemangleIndexBuilder {
+public:
+    DemangleIndexBuilder();
+    ~DemangleIndexBuilder();
+
+    DemangleIndexBuilder(const DemangleIndexBuilder&)            = delete;
+    DemangleIndexBuilder& operator=(const DemangleIndexBuilder&) = delete;
+
+    /// Demangle MangledName and add it as the next symbol. Adding a name that
+    /// is already in the index adds it again, but find() returns the first.
+    void add(std::string_view MangledName);
+
+    /// The number of symbols added so far.
+    size_t size() const { return Records.size(); }
+
+    /// The index file contents for Key. Returns false if the strings do not
+    /// fit the 4 GiB the format can address.
+    bool serialize(uint64_t Key, std::vector<char>& Result) const;
+
+    /// Write the index file for Key to Path.
+    bool write(const char* Path, uint64_t Key) const;
+
+private:
+    detail::IndexStringRef addString(std::string_view S);
+    detail::IndexStringRef addPart(std::string_view Part, detail::IndexStringRef Whole, std::string_view WholeText);
+    void                   addItanium(detail::IndexSymbolRecord& R);
+    void                   addMicrosoft(detail::IndexSymbolRecord& R);
+
+    std::vector<detail::IndexSymbolRecord>    Records;
+    std::string                               Strings;
+    std::unordered_map<std::string, uint32_t> Interned;
+    ItaniumPartialDemangler                   Itanium;
+    MicrosoftPartialDemangler                 Microsoft;
+    // Scratch space for the partial demanglers.
+    std::string Name;
+    char*       Buf      = nullptr;
+    size_t      BufSize  = 0;
+    bool        Overflow = false;
+};
+
+/// A read-only view of a reverse index file, usually mapped from disk. The
+/// keys form a perfect hash, so a lookup hashes the name once and
+/// compares it with a single key, without allocating.
+class DemangleReverseIndex {
+public:
+    DemangleReverseIndex() = default;
+    ~DemangleReverseIndex();
+
+    DemangleReverseIndex(DemangleReverseIndex&& Other);
+    DemangleReverseIndex& operator=(DemangleReverseIndex&& Other);
+
+    DemangleReverseIndex(const DemangleReverseIndex&)            = delete;
+    DemangleReverseIndex& operator=(const DemangleReverseIndex&) = delete;
+
+    /// Map the reverse index file at Path. Fails if it cannot be mapped, is
+    /// not a reverse index in the current format, or was written with another
+    /// Key.
+    bool open(const char* Path, uint64_t Key);
+
+    /// Use a reverse index that is already in memory, such as one produced by
+    /// DemangleReverseIndexBuilder::serialize. Data must be aligned to 8 bytes
+    /// and stay alive and unchanged while the index is in use.
+    bool load(std::span<const char> Data, uint64_t Key);
+
+    /// Drop the index. Every span and string obtained from it becomes invalid.
+    void close();
+
+    /// The flags the Microsoft keys were printed with.
+    MSDemangleFlags getFlags() const { return Flags; }
+
+    /// The number of symbols, which are numbered in the order they were added.
+    size_t size() const { return NumSymbols; }
+
+    /// The number of distinct demangled names.
+    size_t getNumKeys() const { return NumKeys; }
+
+    /// The symbols that demangle to DemangledName, in the order they were
+    /// added. Names are compared exactly, so DemangledName must be printed
+    /// the way demangle() prints it with getFlags().
+    std::span<const uint32_t> find(std::string_view DemangledName) const;
+
+    /// The mangled name of the I-th symbol.
+    std::string_view getMangledName(uint32_t I) const;
+
+private:
+    std::string_view str(detail::IndexStringRef Ref) const;
+
+    const char*                     Mapping     = nullptr;
+    size_t                          MappingSize = 0;
+    const uint32_t*                 Pilots      = nullptr;
+    const detail::ReverseIndexSlot* Slots       = nullptr;
+    const uint32_t*                 Matches     = nullptr;
+    const detail::IndexStringRef*   Symbols     = nullptr;
+    const char*                     Strings     = nullptr;
+    size_t                          StringsSize = 0;
+    uint64_t                        Seed        = 0;
+    uint32_t                        NumPilots   = 0;
+    uint32_t                        NumKeys     = 0;
+    uint32_t                        NumSlots    = 0;
+    uint32_t                        NumMatches  = 0;
+    uint32_t                        NumSymbols  = 0;
+    MSDemangleFlags                 Flags       = MSDF_None;
+    bool                            Mapped      = false;
+};
+
+/// Demangles a symbol table and writes it as a DemangleReverseIndex. Names
+/// that do not demangle are left out of the keys but keep their number.
+class DemangleReverseIndexBuilder {
+public:
+    /// Microsoft names are printed with Flags to form the keys; other names
+    /// are printed as demangle() prints them.
+    explicit DemangleReverseIndexBuilder(MSDemangleFlags Flags = MSDF_None);
+
+    DemangleReverseIndexBuilder(const DemangleReverseIndexBuilder&)            = delete;
+    DemangleReverseIndexBuilder& operator=(const DemangleReverseIndexBuilder&) = delete;
+
+    /// Add MangledName as the next symbol. It is copied, and demangled only
+    /// when the index is serialized.
+    void add(std::string_view MangledName);
+
+    /// The number of symbols added so far.
+    size_t size() const { return Symbols.size(); }
+
+    /// Demangle every symbol on NumThreads threads (0 means one per hardware
+    /// thread) and build the index file contents for Key. Returns false if
+    /// the strings do not fit the 4 GiB the format can address, or if no
+    /// seed tried yields a perfect hash of the keys.
+    bool serialize(uint64_t Key, std::vector<char>& Result, unsigned NumThreads = 0) const;
+
+    /// Write the reverse index file for Key to Path.
+    bool write(const char* Path, uint64_t Key, unsigned NumThreads = 0) const;
+
+private:
+    std::vector<detail::IndexStringRef> Symbols;
+    std::string                         Strings;
+    MSDemangleFlags                     Flags;
+};
+
+} // namespace demangler
+
+#endif // LLVM_DEMANGLE_DEMANGLEINDEX_H
@@ -0,0 +1,132 @@
+//===--- DemangleLimits.h ---------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Caps on the work demangling one symbol may take. A few bytes of Itanium
+// mangling can expand, through substitutions, parameter packs and forward
+// template references, into a huge AST or output; a Microsoft name can do the
+// same with back references. Callers that demangle untrusted symbols pass
+// DemangleLimits to bound each call:
+//
+//   DemangleLimits Limits;
+//   Limits.MaxNodes      = 100000;
+//   Limits.MaxOutputSize = 64 * 1024;
+//   int Status;
+//   if (!demangle(Name, OB, Limits, &Status) && Status == demangle_limit_exceeded) reject(Name);
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEMANGLE_DEMANGLELIMITS_H
+#define LLVM_DEMANGLE_DEMANGLELIMITS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace demangler {
+
+/// Caps on demangling one symbol. A cap of 0 is no cap. A demangler that
+/// reaches one gives up at its next level of recursion, and the call fails
+/// with demangle_limit_exceeded.
+///
+/// The Rust and D demanglers print as they parse and build no AST, so only
+/// MaxOutputSize and MaxDepth apply to them.
+struct DemangleLimits {
+    /// Bytes the parser may allocate for the AST.
+    size_t MaxArenaBytes = 0;
+    /// AST nodes the parser may create. As printing follows the AST, this
+    /// also bounds how deep printing recurses.
+    size_t MaxNodes = 0;
+    /// Characters the demangled name may have.
+    size_t MaxOutputSize = 0;
+    /// How deep the parser may recurse.
+    size_t MaxDepth = 0;
+};
+
+namespace detail {
+// What one parse has used of its DemangleLimits. Parsers count what they
+// allocate, open a Scope at each level of recursion, and stop as soon as
+// Exceeded is set. Without limits every check is a comparison against
+// SIZE_MAX.
+class LimitTracker {
+    size_t MaxArenaBytes = SIZE_MAX;
+    size_t MaxNodes      = SIZE_MAX;
+    size_t MaxDepth      = SIZE_MAX;
+    size_t ArenaBytes    = 0;
+    size_t Nodes         = 0;
+    size_t Depth         = 0;
+
+    static constexpr size_t orMax(size_t Limit) { return Limit == 0 ? SIZE_MAX : Limit; }
+
+public:
+    bool Exceeded = false;
+
+    constexpr void setLimits(const DemangleLimits& Limits) {
+        MaxArenaBytes = orMax(Limits.MaxArenaBytes);
+        MaxNodes      = orMax(Limits.MaxNodes);
+        MaxDepth      = orMax(Limits.MaxDepth);
+    }
+
+    // Start counting for the next symbol.
+    constexpr void restart() {
+        ArenaBytes = 0;
+        Nodes      = 0;
+        Depth      = 0;
+        Exceeded   = false;
+    }
+
+    constexpr void addNode(size_t Bytes) {
+        ++Nodes;
+        addBytes(Bytes);
+        if (Nodes > MaxNodes) Exceeded = true;
+    }
+
+    constexpr void addBytes(size_t Bytes) {
+        ArenaBytes += Bytes;
+        if (ArenaBytes > MaxArenaBytes) Exceeded = true;
+    }
+
+    class Scope {
+        LimitTracker& Tracker;
+
+    public:
+        constexpr explicit Scope(LimitTracker& Tracker) : Tracker(Tracker) {
+            if (++Tracker.Depth > Tracker.MaxDepth) Tracker.Exceeded = true;
+        }
+        constexpr ~Scope() { --Tracker.Depth; }
+
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+};
+
+// The output limit of an OutputBuffer that holds Start characters, for a
+// MaxOutputSize of Limit.
+constexpr size_t getPrintLimit(size_t Start, size_t Limit) {
+    return Limit == 0 || Limit > SIZE_MAX - Start ? SIZE_MAX : Start + Limit;
+}
+
+// Call Print, which appends to OB, with the print limit of OB set
+// MaxOutputSize past the current position. Returns false, with OB rewound, if
+// the output went past it.
+template <typename Buffer, typename Fn>
+constexpr bool printWithinLimit(Buffer& OB, size_t MaxOutputSize, Fn&& Print) {
+    // Nothing may be drained that a rewind would have to take back.
+    typename Buffer::Hold KeepOutput(OB, MaxOutputSize != 0);
+    size_t                Start = OB.getCurrentPosition();
+    size_t                Saved = OB.getPrintLimit();
+    OB.setPrintLimit(getPrintLimit(Start, MaxOutputSize));
+    Print();
+    bool Fits = !OB.isPastPrintLimit();
+    OB.setPrintLimit(Saved);
+    if (!Fits) OB.setCurrentPosition(Start);
+    return Fits;
+}
+} // namespace detail
+
+} // namespace demangler
+
+#endif // LLVM_DEMANGLE_DEMANGLELIMITS_H
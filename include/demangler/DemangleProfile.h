@@ -0,0 +1,161 @@
+//===--- DemangleProfile.h --------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Per-thread profiles of the main grammar productions of every front-end, the
+// ones listed in DemangleProductions.def. They are only collected when
+// DEMANGLE_ENABLE_PROFILE is set; otherwise DEMANGLE_PROFILE_SCOPE expands to
+// nothing. Like the DemangleStats hooks, the scopes do nothing during
+// constant evaluation.
+//
+//   resetDemangleProfile();
+//   for (std::string_view Name : Symbols) demangle(Name, Result);
+//   dumpDemangleProfile(takeDemangleProfile());
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEMANGLE_DEMANGLEPROFILE_H
+#define LLVM_DEMANGLE_DEMANGLEPROFILE_H
+
+#include "DemangleConfig.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <type_traits>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace demangler {
+
+/// A production instrumented with DEMANGLE_PROFILE_SCOPE.
+enum class DemangleProduction : uint8_t {
+#define PRODUCTION(Id, Function) Id,
+#include "DemangleProductions.def"
+#undef PRODUCTION
+};
+
+constexpr size_t NumDemangleProductions = 0
+#define PRODUCTION(Id, Function) +1
+#include "DemangleProductions.def"
+#undef PRODUCTION
+    ;
+
+/// The function that parses P, such as "AbstractManglingParser::parseExpr".
+const char* getDemangleProductionName(DemangleProduction P);
+
+/// What the calling thread spent in one production.
+struct DemangleProductionProfile {
+    /// Calls of the function that parses it.
+    uint64_t Calls = 0;
+    /// Time spent in it, including what it calls. A call made while the
+    /// production is already being parsed adds no time, so recursion is not
+    /// counted twice. The unit is the time stamp counter on x86 and
+    /// std::chrono::steady_clock ticks elsewhere.
+    uint64_t Ticks = 0;
+    /// Deepest nesting of the production in itself.
+    uint64_t MaxDepth = 0;
+
+    DemangleProductionProfile& operator+=(const DemangleProductionProfile& Other) {
+        Calls    += Other.Calls;
+        Ticks    += Other.Ticks;
+        MaxDepth  = std::max(MaxDepth, Other.MaxDepth);
+        return *this;
+    }
+};
+
+/// The profile of every production on the calling thread since it was last
+/// reset. Sum the per-thread profiles with operator+=.
+struct DemangleProfile {
+    DemangleProductionProfile Productions[NumDemangleProductions];
+
+    DemangleProductionProfile& operator[](DemangleProduction P) { return Productions[static_cast<size_t>(P)]; }
+    const DemangleProductionProfile& operator[](DemangleProduction P) const {
+        return Productions[static_cast<size_t>(P)];
+    }
+
+    DemangleProfile& operator+=(const DemangleProfile& Other) {
+        for (size_t I = 0; I != NumDemangleProductions; ++I) Productions[I] += Other.Productions[I];
+        return *this;
+    }
+};
+
+namespace detail {
+struct DemangleProfileState {
+    DemangleProfile Profile;
+    uint32_t        Depth[NumDemangleProductions] = {};
+};
+
+inline thread_local DemangleProfileState ThreadDemangleProfile;
+
+inline uint64_t readProfileClock() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// Counts one call of a production, and the time until the outermost call of
+// it returns.
+class DemangleProfileScope {
+    size_t   Index;
+    uint64_t Start = 0;
+
+public:
+    explicit constexpr DemangleProfileScope(DemangleProduction P) : Index(static_cast<size_t>(P)) {
+        if (std::is_constant_evaluated()) return;
+        DemangleProfileState&      S = ThreadDemangleProfile;
+        DemangleProductionProfile& C = S.Profile.Productions[Index];
+        ++C.Calls;
+        C.MaxDepth = std::max<uint64_t>(C.MaxDepth, ++S.Depth[Index]);
+        if (S.Depth[Index] == 1) Start = readProfileClock();
+    }
+    constexpr ~DemangleProfileScope() {
+        if (std::is_constant_evaluated()) return;
+        DemangleProfileState& S = ThreadDemangleProfile;
+        if (--S.Depth[Index] == 0) S.Profile.Productions[Index].Ticks += readProfileClock() - Start;
+    }
+
+    DemangleProfileScope(const DemangleProfileScope&)            = delete;
+    DemangleProfileScope& operator=(const DemangleProfileScope&) = delete;
+};
+} // namespace detail
+
+/// The profile of the calling thread. It stays zero unless the library was
+/// built with DEMANGLE_ENABLE_PROFILE.
+inline const DemangleProfile& getDemangleProfile() { return detail::ThreadDemangleProfile.Profile; }
+
+/// Zero the profile of the calling thread.
+inline void resetDemangleProfile() { detail::ThreadDemangleProfile.Profile = DemangleProfile(); }
+
+/// Return the profile of the calling thread and zero it.
+inline DemangleProfile takeDemangleProfile() {
+    DemangleProfile Result = detail::ThreadDemangleProfile.Profile;
+    resetDemangleProfile();
+    return Result;
+}
+
+/// Print a table of the productions Profile has seen, the most time first.
+void dumpDemangleProfile(const DemangleProfile& Profile, std::FILE* Out = stderr);
+
+} // namespace demangler
+
+#if DEMANGLE_ENABLE_PROFILE
+#define DEMANGLE_PROFILE_SCOPE(Production)                                                                             \
+    ::demangler::detail::DemangleProfileScope DemangleProfileScope_(::demangler::DemangleProduction::Production)
+#else
+#define DEMANGLE_PROFILE_SCOPE(Production) ((void)0)
+#endif
+
+#endif // LLVM_DEMANGLE_DEMANGLEPROFILE_H
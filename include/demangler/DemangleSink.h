@@ -0,0 +1,139 @@
+//===--- DemangleSink.h -----------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Destinations for demangled names other than a string. Callers that only
+// need the length of a name, a hash of it, or to write it straight into a
+// buffer of their own pass a sink, and the name is passed on in pieces as it
+// is printed instead of being collected first:
+//
+//   CountingSink Length;
+//   demangle(Name, Length);
+//   Table.reserve(Length.size());
+//
+//   HashingSink Key;
+//   demangle(Name, Key);
+//   Lookup.find(Key.hash());
+//
+// Nodes still print into an OutputBuffer, which drains into the sink whenever
+// it fills up. It only keeps what printing may still go back over: the
+// element of a parameter or argument list being printed, which may turn out
+// to be an empty pack, or, with MaxOutputSize set, the whole name. The Rust and D demanglers go back over everything they
+// have printed, so their names reach the sink in one piece at the end. The
+// buffer is a per-thread one, so once it has grown, demangling into a sink
+// allocates nothing. A sink may demangle from its write(); that call prints
+// into a buffer of its own.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEMANGLE_DEMANGLESINK_H
+#define LLVM_DEMANGLE_DEMANGLESINK_H
+
+#include "demangler/Demangle.h"
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace demangler {
+
+/// Something demangled names can be written into, in one or more pieces.
+template <typename T>
+concept DemangleSink = requires(T& Sink, std::string_view S) { Sink.write(S); };
+
+/// Counts the characters written into it.
+class CountingSink {
+    size_t Size = 0;
+
+public:
+    void write(std::string_view S) { Size += S.size(); }
+
+    size_t size() const { return Size; }
+    void   reset() { Size = 0; }
+};
+
+/// Computes the XXH64 hash of the characters written into it. The hash only
+/// depends on the characters and the seed, not on how they were split into
+/// writes, and is the same on every platform.
+class HashingSink {
+    uint64_t Seed;
+    uint64_t Acc[4];
+    uint64_t Total;
+    // The start of a 32-byte stripe that has not been hashed yet.
+    unsigned char Pending[32];
+    size_t        PendingSize;
+
+public:
+    explicit HashingSink(uint64_t Seed = 0) { reset(Seed); }
+
+    void write(std::string_view S);
+
+    /// The hash of everything written so far. Further writes continue it.
+    uint64_t hash() const;
+
+    /// Start over, with no characters written.
+    void reset() { reset(Seed); }
+    void reset(uint64_t NewSeed);
+};
+
+/// Writes into a buffer of the caller's, and moves into a string of its own
+/// once the buffer is full. No null terminator is written.
+class FixedBufferSink {
+    std::span<char> Buf;
+    size_t          Size = 0;
+    std::string     Spill;
+    bool            Spilled = false;
+
+public:
+    explicit FixedBufferSink(std::span<char> Buf) : Buf(Buf) {}
+
+    void write(std::string_view S);
+
+    /// What was written, in the caller's buffer unless it spilled.
+    std::string_view str() const { return Spilled ? std::string_view(Spill) : std::string_view(Buf.data(), Size); }
+
+    size_t size() const { return Spilled ? Spill.size() : Size; }
+
+    /// Whether the output outgrew the caller's buffer.
+    bool spilled() const { return Spilled; }
+
+    /// Forget the output and write into the caller's buffer again. The spill
+    /// string keeps its memory.
+    void reset() {
+        Size    = 0;
+        Spilled = false;
+        Spill.clear();
+    }
+};
+
+namespace detail {
+// A sink behind a function pointer, so that the demangling itself stays out
+// of the header.
+struct SinkRef {
+    void* Sink;
+    void (*Write)(void* Sink, std::string_view S);
+};
+
+bool demangle(std::string_view MangledName, SinkRef Sink, const DemangleLimits& Limits, int* Status);
+} // namespace detail
+
+/// Like demangle above, but writes the result (or the input) into Sink, in
+/// one or more pieces. Limits and Status work as for the other demangle
+/// functions.
+/// \returns - true if demangling occurred.
+template <DemangleSink Sink>
+bool demangle(std::string_view MangledName, Sink& Out, const DemangleLimits& Limits = {}, int* Status = nullptr) {
+    detail::SinkRef Ref{&Out, [](void* S, std::string_view Str) { static_cast<Sink*>(S)->write(Str); }};
+    return detail::demangle(MangledName, Ref, Limits, Status);
+}
+
+} // namespace demangler
+
+#endif // LLVM_DEMANGLE_DEMANGLESINK_H
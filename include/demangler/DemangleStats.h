@@ -0,0 +1,126 @@
+//===--- DemangleStats.h ----------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Per-thread counters describing what the demanglers allocated and how deep
+// they recursed. They are only collected when DEMANGLE_ENABLE_STATS is set;
+// otherwise the DEMANGLE_STATS_* hooks expand to nothing. The hooks do nothing
+// during constant evaluation either, so the parsers stay usable in constexpr.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEMANGLE_DEMANGLESTATS_H
+#define LLVM_DEMANGLE_DEMANGLESTATS_H
+
+#include "DemangleConfig.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace demangler {
+
+/// What the demanglers did on the calling thread since the statistics were
+/// last reset. Take the statistics after each call to look at one symbol, or
+/// let them accumulate and sum the per-thread results with operator+=.
+struct DemangleStats {
+    /// Calls of a front-end entry point (itaniumDemangle, microsoftDemangle,
+    /// rustDemangle, dlangDemangle and their session variants).
+    uint64_t Calls = 0;
+    /// Arena blocks obtained from the heap.
+    uint64_t ArenaBlocks = 0;
+    /// Bytes bump-allocated from arenas.
+    uint64_t ArenaBytes = 0;
+    /// Itanium allocations too large for an arena block, which get their own.
+    uint64_t MassiveAllocations = 0;
+    /// Times an OutputBuffer had to reallocate.
+    uint64_t OutputReallocs = 0;
+    /// Total length of the demangled names printed, excluding terminators.
+    uint64_t OutputBytes = 0;
+    /// AST nodes created.
+    uint64_t Nodes = 0;
+    /// Deepest parser recursion seen.
+    uint64_t MaxDepth = 0;
+
+    DemangleStats& operator+=(const DemangleStats& Other) {
+        Calls              += Other.Calls;
+        ArenaBlocks        += Other.ArenaBlocks;
+        ArenaBytes         += Other.ArenaBytes;
+        MassiveAllocations += Other.MassiveAllocations;
+        OutputReallocs     += Other.OutputReallocs;
+        OutputBytes        += Other.OutputBytes;
+        Nodes              += Other.Nodes;
+        MaxDepth            = std::max(MaxDepth, Other.MaxDepth);
+        return *this;
+    }
+};
+
+namespace detail {
+struct DemangleStatsState {
+    DemangleStats Stats;
+    uint64_t      Depth = 0;
+};
+
+inline thread_local DemangleStatsState ThreadDemangleStats;
+
+struct DemangleDepthScope {
+    constexpr DemangleDepthScope() {
+        if (std::is_constant_evaluated()) return;
+        DemangleStatsState& S = ThreadDemangleStats;
+        S.Stats.MaxDepth      = std::max(S.Stats.MaxDepth, ++S.Depth);
+    }
+    constexpr ~DemangleDepthScope() {
+        if (!std::is_constant_evaluated()) --ThreadDemangleStats.Depth;
+    }
+};
+
+// Counts one entry point call and the length of what it printed into OB.
+// Failed calls leave OB where it was and so add no output.
+template <typename Buffer>
+struct DemangleCallScope {
+    Buffer& OB;
+    size_t  Start;
+
+    explicit constexpr DemangleCallScope(Buffer& OB) : OB(OB), Start(OB.getCurrentPosition()) {
+        if (!std::is_constant_evaluated()) ++ThreadDemangleStats.Stats.Calls;
+    }
+    constexpr ~DemangleCallScope() {
+        if (std::is_constant_evaluated() || OB.getCurrentPosition() <= Start) return;
+        ThreadDemangleStats.Stats.OutputBytes += OB.getCurrentPosition() - Start;
+    }
+};
+} // namespace detail
+
+/// The statistics of the calling thread. They stay zero unless the library
+/// was built with DEMANGLE_ENABLE_STATS.
+inline const DemangleStats& getDemangleStats() { return detail::ThreadDemangleStats.Stats; }
+
+/// Zero the statistics of the calling thread.
+inline void resetDemangleStats() { detail::ThreadDemangleStats.Stats = DemangleStats(); }
+
+/// Return the statistics of the calling thread and zero them.
+inline DemangleStats takeDemangleStats() {
+    DemangleStats Result = detail::ThreadDemangleStats.Stats;
+    resetDemangleStats();
+    return Result;
+}
+
+} // namespace demangler
+
+#if DEMANGLE_ENABLE_STATS
+#define DEMANGLE_STATS_ADD(Field, N)                                                                                   \
+    (std::is_constant_evaluated() ? (void)0 : (void)(::demangler::detail::ThreadDemangleStats.Stats.Field += (N)))
+#define DEMANGLE_STATS_DEPTH()       ::demangler::detail::DemangleDepthScope DemangleDepthScope_
+#define DEMANGLE_STATS_CALL(OB)      ::demangler::detail::DemangleCallScope DemangleCallScope_(OB)
+#else
+#define DEMANGLE_STATS_ADD(Field, N) ((void)0)
+#define DEMANGLE_STATS_DEPTH()       ((void)0)
+#define DEMANGLE_STATS_CALL(OB)      ((void)0)
+#endif
+
+#endif // LLVM_DEMANGLE_DEMANGLESTATS_H
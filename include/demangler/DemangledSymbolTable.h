@@ -0,0 +1,178 @@
+//===--- DemangledSymbolTable.h ---------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// A resident set of demangled names for symbol search, smaller than a string
+// per name. The partial demanglers split each name into the scopes it is
+// nested in, the name itself, and what is printed around it, such as a return
+// type and a parameter list. The scopes form a trie and every piece is an
+// interned string, so "std::" or a long template argument list is stored once
+// however many names share it:
+//
+//   DemangledSymbolTable Table;
+//   for (std::string_view Name : Exports) Table.add(Name);
+//
+//   DemangledSymbolTable::ScopeId Level = Table.findScope(DemangledSymbolTable::GlobalScope, "Level");
+//   Table.forEachSymbol(Level, [&](uint32_t I) { show(Table.getDemangledName(I)); });
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEMANGLE_DEMANGLEDSYMBOLTABLE_H
+#define LLVM_DEMANGLE_DEMANGLEDSYMBOLTABLE_H
+
+#include "demangler/Demangle.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace demangler {
+
+/// Demangled names stored as paths in a trie of scopes. Names are numbered in
+/// the order they were added, and each one reads back as exactly what
+/// demangle() returns for its mangled name.
+class DemangledSymbolTable {
+public:
+    /// A node of the scope trie. Scopes are identified by their components,
+    /// such as "Level" and "tick()" for the local names in Level::tick().
+    using ScopeId = uint32_t;
+
+    /// The scope of names that are not nested in any other, and of names the
+    /// partial demanglers cannot split up.
+    static constexpr ScopeId GlobalScope = 0;
+
+    /// A scope that is not in the table.
+    static constexpr ScopeId NoScope = UINT32_MAX;
+
+    DemangledSymbolTable();
+    ~DemangledSymbolTable();
+
+    DemangledSymbolTable(const DemangledSymbolTable&)            = delete;
+    DemangledSymbolTable& operator=(const DemangledSymbolTable&) = delete;
+
+    /// Demangle MangledName and add it as the next name. Returns its number.
+    uint32_t add(std::string_view MangledName);
+
+    /// The number of names added so far.
+    size_t size() const { return Symbols.size(); }
+
+    /// Write the I-th name into Buf, null terminated, as demangle(Name, Buf)
+    /// would have.
+    DemangleBufferResult getDemangledName(size_t I, std::span<char> Buf) const;
+    std::string          getDemangledName(size_t I) const;
+
+    /// Whether the I-th name was demangled, rather than kept as it was added.
+    bool isDemangled(size_t I) const { return Symbols[I].Demangled; }
+
+    /// The scheme detectManglingScheme reported for the I-th name.
+    ManglingScheme getScheme(size_t I) const { return static_cast<ManglingScheme>(Symbols[I].Scheme); }
+
+    /// The innermost scope the I-th name is nested in.
+    ScopeId getSymbolScope(size_t I) const { return Symbols[I].Scope; }
+
+    /// The name without its scopes or what is printed around it, "tick" for
+    /// "public: void __cdecl Level::tick(void)".
+    std::string_view getSymbolName(size_t I) const { return str(Symbols[I].Name); }
+
+    /// The child of Parent named Component, such as "vector<int, std::allocator<int>>"
+    /// in "std", or NoScope if no name is nested in it.
+    ScopeId findScope(ScopeId Parent, std::string_view Component) const;
+
+    /// The scope named by the components of Path joined by "::", or NoScope.
+    /// The path is not split inside brackets or parentheses, so "a<b::c>::d"
+    /// has the components "a<b::c>" and "d".
+    ScopeId findScope(std::string_view Path) const;
+
+    ScopeId          getParentScope(ScopeId Scope) const { return Scopes[Scope].Parent; }
+    std::string_view getScopeName(ScopeId Scope) const { return str(Scopes[Scope].Name); }
+
+    /// Call F with the number of every name in Scope and the scopes nested in
+    /// it, outer scopes first and names of a scope in the order they were
+    /// added.
+    template <typename Fn>
+    void forEachSymbol(ScopeId Scope, Fn&& F) const {
+        if (Scope >= Scopes.size()) return;
+        for (ScopeId S = Scope;;) {
+            for (uint32_t I = Scopes[S].FirstSymbol; I != None; I = Symbols[I].NextInScope) F(I);
+            // Depth first: the first child, else the next sibling of the
+            // closest scope that has one, without leaving Scope.
+            if (Scopes[S].FirstChild != None) {
+                S = Scopes[S].FirstChild;
+                continue;
+            }
+            while (S != Scope && Scopes[S].NextSibling == None) S = Scopes[S].Parent;
+            if (S == Scope) return;
+            S = Scopes[S].NextSibling;
+        }
+    }
+
+    /// The number of bytes the table has allocated.
+    size_t memoryUsage() const;
+
+private:
+    static constexpr uint32_t None = UINT32_MAX;
+
+    struct ScopeNode {
+        ScopeId  Parent;
+        uint32_t Name;
+        ScopeId  FirstChild;
+        ScopeId  NextSibling;
+        ScopeId  LastChild;
+        uint32_t FirstSymbol;
+        uint32_t LastSymbol;
+    };
+
+    // A name reads as Prefix, the components of Scope each followed by "::",
+    // Name and Suffix.
+    struct SymbolRecord {
+        ScopeId  Scope;
+        uint32_t Prefix;
+        uint32_t Name;
+        uint32_t Suffix;
+        uint32_t NextInScope;
+        uint8_t  Scheme;
+        bool     Demangled;
+    };
+
+    std::string_view str(uint32_t Id) const {
+        return std::string_view(Chars).substr(Offsets[Id], Offsets[Id + 1] - Offsets[Id]);
+    }
+
+    uint32_t intern(std::string_view S);
+    uint32_t findString(std::string_view S) const;
+    ScopeId  addScope(ScopeId Parent, uint32_t Name);
+    ScopeId  findChild(ScopeId Parent, uint32_t Name) const;
+    void     addSymbol(SymbolRecord& R, std::string_view Text, std::string_view Name, std::string_view Leaf);
+    template <typename Demangler>
+    bool addScopes(const Demangler& D, std::string_view& Leaf);
+    bool     addItanium(SymbolRecord& R);
+    bool     addMicrosoft(SymbolRecord& R);
+
+    // The interned strings, string I being [Offsets[I], Offsets[I + 1]) of
+    // Chars, and open-addressed tables of one plus a string or scope number.
+    std::string               Chars;
+    std::vector<uint32_t>     Offsets;
+    std::vector<uint32_t>     StringTable;
+    std::vector<ScopeNode>    Scopes;
+    std::vector<uint32_t>     ScopeTable;
+    std::vector<SymbolRecord> Symbols;
+    ItaniumPartialDemangler   Itanium;
+    MicrosoftPartialDemangler Microsoft;
+    // Scratch space for the partial demanglers.
+    std::vector<uint32_t> Path;
+    std::string           Name;
+    std::string           Text;
+    char*                 Buf     = nullptr;
+    size_t                BufSize = 0;
+};
+
+} // namespace demangler
+
+#endif // LLVM_DEMANGLE_DEMANGLEDSYMBOLTABLE_H
@@ -0,0 +1,32 @@
+//===--- FileMapping.h ------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Read-only mapping of whole files, shared by the index files and
+// SymbolFile. Not part of the public API.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEMANGLE_FILEMAPPING_H
+#define LLVM_DEMANGLE_FILEMAPPING_H
+
+#include <cstddef>
+
+namespace demangler {
+
+namespace detail {
+// Map the file at Path read-only into Data and Size. Fails if it cannot be
+// opened or mapped, or is empty.
+bool mapFile(const char* Path, const char*& Data, size_t& Size);
+
+// Unmap what mapFile mapped.
+void unmapFile(const char* Data, size_t Size);
+} // namespace detail
+
+} // namespace demangler
+
+#endif // LLVM_DEMANGLE_FILEMAPPING_H
@@ -0,0 +1,253 @@
+//===--- ItaniumAllocator.h -------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// The arena allocator behind the Itanium demangler. The block size and the
+// size of the inline initial buffer are template parameters, so a parser can
+// be instantiated with large blocks for batch jobs or with a small footprint
+// for constrained contexts:
+//
+//   ManglingParser<DefaultAllocator<64 * 1024>>  Batch(First, Last);
+//   ManglingParser<DefaultAllocator<1024, 512>> Small(First, Last);
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEMANGLE_ITANIUMALLOCATOR_H
+#define LLVM_DEMANGLE_ITANIUMALLOCATOR_H
+
+#include "DemangleConfig.h"
+#include "DemangleStats.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <new>
+#include <utility>
+
+DEMANGLE_NAMESPACE_BEGIN
+
+class Node;
+
+// The blocks of BlockSize bytes released on this thread, shared by every
+// BumpPointerAllocator with that block size whatever its initial size. Each
+// thread keeps up to 256 KiB of them per block size.
+template <size_t BlockSize>
+class ArenaBlockPool {
+    struct FreeBlock {
+        FreeBlock* Next;
+    };
+
+    static constexpr size_t PoolBytes    = 256 * 1024;
+    static constexpr size_t MaxPoolCount = PoolBytes / BlockSize ? PoolBytes / BlockSize : 1;
+
+    // It is trivially destructible, so it stays usable by allocators destroyed
+    // after the PoolReaper during thread exit.
+    struct BlockPool {
+        FreeBlock* Head  = nullptr;
+        size_t     Count = 0;
+        bool       Dead  = false;
+    };
+    static inline thread_local BlockPool Pool;
+
+    struct PoolReaper {
+        ~PoolReaper() {
+            while (FreeBlock* Tmp = Pool.Head) {
+                Pool.Head = Tmp->Next;
+                std::free(Tmp);
+            }
+            Pool.Count = 0;
+            Pool.Dead  = true;
+        }
+    };
+
+public:
+    // A released block, or nullptr if there is none.
+    static void* take() {
+        FreeBlock* Block = Pool.Head;
+        if (Block != nullptr) {
+            Pool.Head = Block->Next;
+            --Pool.Count;
+        }
+        return Block;
+    }
+
+    // Keep Block, a block of BlockSize bytes from std::malloc, or free it if
+    // the pool is full.
+    static void give(void* Block) {
+        static thread_local PoolReaper Reaper;
+        (void)Reaper;
+        if (Pool.Dead || Pool.Count == MaxPoolCount) {
+            std::free(Block);
+            return;
+        }
+        Pool.Head = new (Block) FreeBlock{Pool.Head};
+        ++Pool.Count;
+    }
+};
+
+template <size_t BlockSize = 4096, size_t InitialSize = BlockSize>
+class BumpPointerAllocator {
+    struct BlockMeta {
+        BlockMeta* Next;
+        size_t     Current;
+    };
+
+    static_assert(BlockSize >= 2 * sizeof(BlockMeta) + 16, "BumpPointerAllocator blocks are too small");
+    static_assert(InitialSize >= sizeof(BlockMeta) + 16, "BumpPointerAllocator initial buffer is too small");
+
+    static constexpr size_t UsableBlockSize   = BlockSize - sizeof(BlockMeta);
+    static constexpr size_t UsableInitialSize = InitialSize - sizeof(BlockMeta);
+
+    alignas(long double) char InitialBuffer[InitialSize];
+    BlockMeta* BlockList     = nullptr;
+    BlockMeta* MassiveList   = nullptr;
+    size_t     BlockCapacity = UsableInitialSize;
+
+    // Blocks handed back by reset() that grow() reuses before the thread pool.
+    BlockMeta* FreeList      = nullptr;
+    size_t     NumFreeBlocks = 0;
+    size_t     MaxFreeBlocks = 0;
+
+    static BlockMeta* takeFromPool() { return static_cast<BlockMeta*>(ArenaBlockPool<BlockSize>::take()); }
+    static void       returnToPool(BlockMeta* Block) { ArenaBlockPool<BlockSize>::give(Block); }
+
+    void grow() {
+        BlockMeta* NewMeta = FreeList;
+        if (NewMeta != nullptr) {
+            FreeList = NewMeta->Next;
+            --NumFreeBlocks;
+        } else if ((NewMeta = takeFromPool()) == nullptr) {
+            NewMeta = static_cast<BlockMeta*>(std::malloc(BlockSize));
+            if (NewMeta == nullptr) std::terminate();
+            DEMANGLE_STATS_ADD(ArenaBlocks, 1);
+        }
+        BlockList     = new (NewMeta) BlockMeta{BlockList, 0};
+        BlockCapacity = UsableBlockSize;
+    }
+
+    void* allocateMassive(size_t NBytes) {
+        NBytes             += sizeof(BlockMeta);
+        BlockMeta* NewMeta  = reinterpret_cast<BlockMeta*>(std::malloc(NBytes));
+        if (NewMeta == nullptr) std::terminate();
+        DEMANGLE_STATS_ADD(MassiveAllocations, 1);
+        MassiveList = new (NewMeta) BlockMeta{MassiveList, 0};
+        return static_cast<void*>(NewMeta + 1);
+    }
+
+    void trimFreeList() {
+        while (NumFreeBlocks > MaxFreeBlocks) {
+            BlockMeta* Tmp = FreeList;
+            FreeList       = FreeList->Next;
+            --NumFreeBlocks;
+            returnToPool(Tmp);
+        }
+    }
+
+public:
+    BumpPointerAllocator() : BlockList(new(InitialBuffer) BlockMeta{nullptr, 0}) {}
+
+    BumpPointerAllocator(const BumpPointerAllocator&)            = delete;
+    BumpPointerAllocator& operator=(const BumpPointerAllocator&) = delete;
+
+    void* allocate(size_t N) {
+        N = (N + 15u) & ~15u;
+        DEMANGLE_STATS_ADD(ArenaBytes, N);
+        if (N + BlockList->Current >= BlockCapacity) {
+            if (N > UsableBlockSize) return allocateMassive(N);
+            grow();
+        }
+        BlockList->Current += N;
+        return static_cast<void*>(reinterpret_cast<char*>(BlockList + 1) + BlockList->Current - N);
+    }
+
+    // Keep up to Bytes worth of grown blocks across reset() calls, on top of the
+    // inline initial buffer. Further blocks go to the thread's pool, and
+    // oversized blocks are never kept.
+    void setRetainedBytes(size_t Bytes) {
+        MaxFreeBlocks = Bytes / BlockSize;
+        trimFreeList();
+    }
+
+    // A position in the arena that rewind() can return to.
+    struct Watermark {
+        BlockMeta* Block;
+        size_t     Current;
+        BlockMeta* Massive;
+    };
+
+    Watermark watermark() const { return {BlockList, BlockList->Current, MassiveList}; }
+
+    // Release what was allocated after W and keep what was allocated before.
+    // W must have been taken since the last reset().
+    void rewind(Watermark W) {
+        while (MassiveList != W.Massive) {
+            BlockMeta* Tmp = MassiveList;
+            MassiveList    = MassiveList->Next;
+            std::free(Tmp);
+        }
+        while (BlockList != W.Block) {
+            BlockMeta* Tmp = BlockList;
+            BlockList      = BlockList->Next;
+            Tmp->Next      = FreeList;
+            FreeList       = Tmp;
+            ++NumFreeBlocks;
+        }
+        trimFreeList();
+        BlockList->Current = W.Current;
+        BlockCapacity      = reinterpret_cast<char*>(BlockList) == InitialBuffer ? UsableInitialSize : UsableBlockSize;
+    }
+
+    void reset() {
+        while (MassiveList) {
+            BlockMeta* Tmp = MassiveList;
+            MassiveList    = MassiveList->Next;
+            std::free(Tmp);
+        }
+        while (BlockList) {
+            BlockMeta* Tmp = BlockList;
+            BlockList      = BlockList->Next;
+            if (reinterpret_cast<char*>(Tmp) == InitialBuffer) continue;
+            Tmp->Next = FreeList;
+            FreeList  = Tmp;
+            ++NumFreeBlocks;
+        }
+        trimFreeList();
+        BlockList     = new (InitialBuffer) BlockMeta{nullptr, 0};
+        BlockCapacity = UsableInitialSize;
+    }
+
+    ~BumpPointerAllocator() {
+        MaxFreeBlocks = 0;
+        reset();
+    }
+};
+
+template <size_t BlockSize = 4096, size_t InitialSize = BlockSize>
+class DefaultAllocator {
+    BumpPointerAllocator<BlockSize, InitialSize> Alloc;
+
+public:
+    using Watermark = typename BumpPointerAllocator<BlockSize, InitialSize>::Watermark;
+
+    void reset() { Alloc.reset(); }
+
+    Watermark watermark() const { return Alloc.watermark(); }
+    void      rewind(Watermark W) { Alloc.rewind(W); }
+
+    void setRetainedBytes(size_t Bytes) { Alloc.setRetainedBytes(Bytes); }
+
+    template <typename T, typename... Args>
+    T* makeNode(Args&&... args) {
+        return new (Alloc.allocate(sizeof(T))) T(std::forward<Args>(args)...);
+    }
+
+    Node** allocateNodeArray(size_t sz) { return new (Alloc.allocate(sizeof(Node*) * sz)) Node*[sz]; }
+};
+
+DEMANGLE_NAMESPACE_END
+
+#endif // LLVM_DEMANGLE_ITANIUMALLOCATOR_H
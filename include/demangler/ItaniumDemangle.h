@@ -17,6 +17,8 @@
 #define DEMANGLE_ITANIUMDEMANGLE_H
 
 #include "DemangleConfig.h"
+#include "DemangleLimits.h"
+#include "DemangleProfile.h"
 #include "StringViewExtras.h"
 #include "Utility.h"
 #include <algorithm>
@@ -45,17 +47,28 @@ class PODSmallVector {
     T* Cap       = nullptr;
     T  Inline[N] = {};
 
-    bool isInline() const { return First == Inline; }
+    constexpr bool isInline() const { return First == Inline; }
 
-    void clearInline() {
+    constexpr void clearInline() {
         First = Inline;
         Last  = Inline;
         Cap   = Inline + N;
     }
 
-    void reserve(size_t NewCap) {
+    // Constant evaluation cannot call malloc(), so it allocates with new[].
+    static constexpr void release(T* P) {
+        if (std::is_constant_evaluated()) delete[] P;
+        else std::free(P);
+    }
+
+    constexpr void reserve(size_t NewCap) {
         size_t S = size();
-        if (isInline()) {
+        if (std::is_constant_evaluated()) {
+            T* Tmp = new T[NewCap];
+            std::copy(First, Last, Tmp);
+            if (!isInline()) release(First);
+            First = Tmp;
+        } else if (isInline()) {
             auto* Tmp = static_cast<T*>(std::malloc(NewCap * sizeof(T)));
             if (Tmp == nullptr) std::abort();
             std::copy(First, Last, Tmp);
@@ -69,12 +82,12 @@ class PODSmallVector {
     }
 
 public:
-    PODSmallVector() : First(Inline), Last(First), Cap(Inline + N) {}
+    constexpr PODSmallVector() : First(Inline), Last(First), Cap(Inline + N) {}
 
     PODSmallVector(const PODSmallVector&)            = delete;
     PODSmallVector& operator=(const PODSmallVector&) = delete;
 
-    PODSmallVector(PODSmallVector&& Other) : PODSmallVector() {
+    constexpr PODSmallVector(PODSmallVector&& Other) : PODSmallVector() {
         if (Other.isInline()) {
             std::copy(Other.begin(), Other.end(), First);
             Last = First + Other.size();
@@ -88,10 +101,10 @@ public:
         Other.clearInline();
     }
 
-    PODSmallVector& operator=(PODSmallVector&& Other) {
+    constexpr PODSmallVector& operator=(PODSmallVector&& Other) {
         if (Other.isInline()) {
             if (!isInline()) {
-                std::free(First);
+                release(First);
                 clearInline();
             }
             std::copy(Other.begin(), Other.end(), First);
@@ -116,39 +129,39 @@ public:
     }
 
     // NOLINTNEXTLINE(readability-identifier-naming)
-    void push_back(const T& Elem) {
+    constexpr void push_back(const T& Elem) {
         if (Last == Cap) reserve(size() * 2);
         *Last++ = Elem;
     }
 
     // NOLINTNEXTLINE(readability-identifier-naming)
-    void pop_back() {
+    constexpr void pop_back() {
         DEMANGLE_ASSERT(Last != First, "Popping empty vector!");
         --Last;
     }
 
-    void shrinkToSize(size_t Index) {
+    constexpr void shrinkToSize(size_t Index) {
         DEMANGLE_ASSERT(Index <= size(), "shrinkToSize() can't expand!");
         Last = First + Index;
     }
 
-    T* begin() { return First; }
-    T* end() { return Last; }
+    constexpr T* begin() { return First; }
+    constexpr T* end() { return Last; }
 
-    bool   empty() const { return First == Last; }
-    size_t size() const { return static_cast<size_t>(Last - First); }
-    T&     back() {
+    constexpr bool   empty() const { return First == Last; }
+    constexpr size_t size() const { return static_cast<size_t>(Last - First); }
+    constexpr T&     back() {
         DEMANGLE_ASSERT(Last != First, "Calling back() on empty vector!");
         return *(Last - 1);
     }
-    T& operator[](size_t Index) {
+    constexpr T& operator[](size_t Index) {
         DEMANGLE_ASSERT(Index < size(), "Invalid access!");
         return *(begin() + Index);
     }
-    void clear() { Last = First; }
+    constexpr void clear() { Last = First; }
 
-    ~PODSmallVector() {
-        if (!isInline()) std::free(First);
+    constexpr ~PODSmallVector() {
+        if (!isInline()) release(First);
     }
 };
 
@@ -215,7 +228,7 @@ protected:
     Cache FunctionCache : 2;
 
 public:
-    Node(
+    constexpr Node(
         Kind  K_,
         Prec  Precedence_        = Prec::Primary,
         Cache RHSComponentCache_ = Cache::No,
@@ -227,12 +240,12 @@ public:
       RHSComponentCache(RHSComponentCache_),
       ArrayCache(ArrayCache_),
       FunctionCache(FunctionCache_) {}
-    Node(Kind K_, Cache RHSComponentCache_, Cache ArrayCache_ = Cache::No, Cache FunctionCache_ = Cache::No)
+    constexpr Node(Kind K_, Cache RHSComponentCache_, Cache ArrayCache_ = Cache::No, Cache FunctionCache_ = Cache::No)
     : Node(K_, Prec::Primary, RHSComponentCache_, ArrayCache_, FunctionCache_) {}
 
     /// Visit the most-derived object corresponding to this object.
     template <typename Fn>
-    void visit(Fn F) const;
+    constexpr void visit(Fn F) const;
 
     // The following function is provided by all derived classes:
     //
@@ -240,65 +253,66 @@ public:
     // would construct an equivalent node.
     // template<typename Fn> void match(Fn F) const;
 
-    bool hasRHSComponent(OutputBuffer& OB) const {
+    constexpr bool hasRHSComponent(OutputBuffer& OB) const {
         if (RHSComponentCache != Cache::Unknown) return RHSComponentCache == Cache::Yes;
         return hasRHSComponentSlow(OB);
     }
 
-    bool hasArray(OutputBuffer& OB) const {
+    constexpr bool hasArray(OutputBuffer& OB) const {
         if (ArrayCache != Cache::Unknown) return ArrayCache == Cache::Yes;
         return hasArraySlow(OB);
     }
 
-    bool hasFunction(OutputBuffer& OB) const {
+    constexpr bool hasFunction(OutputBuffer& OB) const {
         if (FunctionCache != Cache::Unknown) return FunctionCache == Cache::Yes;
         return hasFunctionSlow(OB);
     }
 
-    Kind getKind() const { return K; }
+    constexpr Kind getKind() const { return K; }
 
-    Prec  getPrecedence() const { return Precedence; }
-    Cache getRHSComponentCache() const { return RHSComponentCache; }
-    Cache getArrayCache() const { return ArrayCache; }
-    Cache getFunctionCache() const { return FunctionCache; }
+    constexpr Prec  getPrecedence() const { return Precedence; }
+    constexpr Cache getRHSComponentCache() const { return RHSComponentCache; }
+    constexpr Cache getArrayCache() const { return ArrayCache; }
+    constexpr Cache getFunctionCache() const { return FunctionCache; }
 
-    virtual bool hasRHSComponentSlow(OutputBuffer&) const { return false; }
-    virtual bool hasArraySlow(OutputBuffer&) const { return false; }
-    virtual bool hasFunctionSlow(OutputBuffer&) const { return false; }
+    constexpr virtual bool hasRHSComponentSlow(OutputBuffer&) const { return false; }
+    constexpr virtual bool hasArraySlow(OutputBuffer&) const { return false; }
+    constexpr virtual bool hasFunctionSlow(OutputBuffer&) const { return false; }
 
     // Dig through "glue" nodes like ParameterPack and ForwardTemplateReference to
     // get at a node that actually represents some concrete syntax.
-    virtual const Node* getSyntaxNode(OutputBuffer&) const { return this; }
+    constexpr virtual const Node* getSyntaxNode(OutputBuffer&) const { return this; }
 
     // Print this node as an expression operand, surrounding it in parentheses if
     // its precedence is [Strictly] weaker than P.
-    void printAsOperand(OutputBuffer& OB, Prec P = Prec::Default, bool StrictlyWorse = false) const {
+    constexpr void printAsOperand(OutputBuffer& OB, Prec P = Prec::Default, bool StrictlyWorse = false) const {
         bool Paren = unsigned(getPrecedence()) >= unsigned(P) + unsigned(StrictlyWorse);
         if (Paren) OB.printOpen();
         print(OB);
         if (Paren) OB.printClose();
     }
 
-    void print(OutputBuffer& OB) const {
+    constexpr void print(OutputBuffer& OB) const {
+        if (OB.isPastPrintLimit()) return;
         printLeft(OB);
         if (RHSComponentCache != Cache::No) printRight(OB);
     }
 
     // Print the "left" side of this Node into OutputBuffer.
-    virtual void printLeft(OutputBuffer&) const = 0;
+    constexpr virtual void printLeft(OutputBuffer&) const = 0;
 
     // Print the "right". This distinction is necessary to represent C++ types
     // that appear on the RHS of their subtype, such as arrays or functions.
     // Since most types don't have such a component, provide a default
     // implementation.
-    virtual void printRight(OutputBuffer&) const {}
+    constexpr virtual void printRight(OutputBuffer&) const {}
 
     // Print an initializer list of this type. Returns true if we printed a custom
     // representation, false if nothing has been printed and the default
     // representation should be used.
-    virtual bool printInitListAsType(OutputBuffer&, const NodeArray&) const { return false; }
+    constexpr virtual bool printInitListAsType(OutputBuffer&, const NodeArray&) const { return false; }
 
-    virtual std::string_view getBaseName() const { return {}; }
+    constexpr virtual std::string_view getBaseName() const { return {}; }
 
     // Silence compiler warnings, this dtor will never be called.
     virtual ~Node() = default;
@@ -313,21 +327,22 @@ class NodeArray {
     size_t NumElements;
 
 public:
-    NodeArray() : Elements(nullptr), NumElements(0) {}
-    NodeArray(Node** Elements_, size_t NumElements_) : Elements(Elements_), NumElements(NumElements_) {}
+    constexpr NodeArray() : Elements(nullptr), NumElements(0) {}
+    constexpr NodeArray(Node** Elements_, size_t NumElements_) : Elements(Elements_), NumElements(NumElements_) {}
 
-    bool   empty() const { return NumElements == 0; }
-    size_t size() const { return NumElements; }
+    constexpr bool   empty() const { return NumElements == 0; }
+    constexpr size_t size() const { return NumElements; }
 
-    Node** begin() const { return Elements; }
-    Node** end() const { return Elements + NumElements; }
+    constexpr Node** begin() const { return Elements; }
+    constexpr Node** end() const { return Elements + NumElements; }
 
-    Node* operator[](size_t Idx) const { return Elements[Idx]; }
+    constexpr Node* operator[](size_t Idx) const { return Elements[Idx]; }
 
-    void printWithComma(OutputBuffer& OB) const {
+    constexpr void printWithComma(OutputBuffer& OB) const {
         bool FirstElement = true;
         for (size_t Idx = 0; Idx != NumElements; ++Idx) {
-            size_t BeforeComma = OB.getCurrentPosition();
+            OutputBuffer::Hold KeepComma(OB);
+            size_t             BeforeComma = OB.getCurrentPosition();
             if (!FirstElement) OB += ", ";
             size_t AfterComma = OB.getCurrentPosition();
             Elements[Idx]->printAsOperand(OB, Node::Prec::Comma);
@@ -345,19 +360,19 @@ public:
 
     // Print an array of integer literals as a string literal. Returns whether we
     // could do so.
-    bool printAsString(OutputBuffer& OB) const;
+    constexpr bool printAsString(OutputBuffer& OB) const;
 };
 
 struct NodeArrayNode : Node {
     NodeArray Array;
-    NodeArrayNode(NodeArray Array_) : Node(KNodeArrayNode), Array(Array_) {}
+    constexpr NodeArrayNode(NodeArray Array_) : Node(KNodeArrayNode), Array(Array_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Array);
     }
 
-    void printLeft(OutputBuffer& OB) const override { Array.printWithComma(OB); }
+    constexpr void printLeft(OutputBuffer& OB) const override { Array.printWithComma(OB); }
 };
 
 class DotSuffix final : public Node {
@@ -365,14 +380,17 @@ class DotSuffix final : public Node {
     const std::string_view Suffix;
 
 public:
-    DotSuffix(const Node* Prefix_, std::string_view Suffix_) : Node(KDotSuffix), Prefix(Prefix_), Suffix(Suffix_) {}
+    constexpr DotSuffix(const Node* Prefix_, std::string_view Suffix_)
+    : Node(KDotSuffix),
+      Prefix(Prefix_),
+      Suffix(Suffix_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Prefix, Suffix);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Prefix->print(OB);
         OB += " (";
         OB += Suffix;
@@ -386,22 +404,22 @@ class VendorExtQualType final : public Node {
     const Node*      TA;
 
 public:
-    VendorExtQualType(const Node* Ty_, std::string_view Ext_, const Node* TA_)
+    constexpr VendorExtQualType(const Node* Ty_, std::string_view Ext_, const Node* TA_)
     : Node(KVendorExtQualType),
       Ty(Ty_),
       Ext(Ext_),
       TA(TA_) {}
 
-    const Node*      getTy() const { return Ty; }
-    std::string_view getExt() const { return Ext; }
-    const Node*      getTA() const { return TA; }
+    constexpr const Node*      getTy() const { return Ty; }
+    constexpr std::string_view getExt() const { return Ext; }
+    constexpr const Node*      getTA() const { return TA; }
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Ty, Ext, TA);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Ty->print(OB);
         OB += " ";
         OB += Ext;
@@ -422,57 +440,57 @@ enum Qualifiers {
     QualRestrict = 0x4,
 };
 
-inline Qualifiers operator|=(Qualifiers& Q1, Qualifiers Q2) { return Q1 = static_cast<Qualifiers>(Q1 | Q2); }
+constexpr Qualifiers operator|=(Qualifiers& Q1, Qualifiers Q2) { return Q1 = static_cast<Qualifiers>(Q1 | Q2); }
 
 class QualType final : public Node {
 protected:
     const Qualifiers Quals;
     const Node*      Child;
 
-    void printQuals(OutputBuffer& OB) const {
+    constexpr void printQuals(OutputBuffer& OB) const {
         if (Quals & QualConst) OB += " const";
         if (Quals & QualVolatile) OB += " volatile";
         if (Quals & QualRestrict) OB += " restrict";
     }
 
 public:
-    QualType(const Node* Child_, Qualifiers Quals_)
+    constexpr QualType(const Node* Child_, Qualifiers Quals_)
     : Node(KQualType, Child_->getRHSComponentCache(), Child_->getArrayCache(), Child_->getFunctionCache()),
       Quals(Quals_),
       Child(Child_) {}
 
-    Qualifiers  getQuals() const { return Quals; }
-    const Node* getChild() const { return Child; }
+    constexpr Qualifiers  getQuals() const { return Quals; }
+    constexpr const Node* getChild() const { return Child; }
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Child, Quals);
     }
 
-    bool hasRHSComponentSlow(OutputBuffer& OB) const override { return Child->hasRHSComponent(OB); }
-    bool hasArraySlow(OutputBuffer& OB) const override { return Child->hasArray(OB); }
-    bool hasFunctionSlow(OutputBuffer& OB) const override { return Child->hasFunction(OB); }
+    constexpr bool hasRHSComponentSlow(OutputBuffer& OB) const override { return Child->hasRHSComponent(OB); }
+    constexpr bool hasArraySlow(OutputBuffer& OB) const override { return Child->hasArray(OB); }
+    constexpr bool hasFunctionSlow(OutputBuffer& OB) const override { return Child->hasFunction(OB); }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Child->printLeft(OB);
         printQuals(OB);
     }
 
-    void printRight(OutputBuffer& OB) const override { Child->printRight(OB); }
+    constexpr void printRight(OutputBuffer& OB) const override { Child->printRight(OB); }
 };
 
 class ConversionOperatorType final : public Node {
     const Node* Ty;
 
 public:
-    ConversionOperatorType(const Node* Ty_) : Node(KConversionOperatorType), Ty(Ty_) {}
+    constexpr ConversionOperatorType(const Node* Ty_) : Node(KConversionOperatorType), Ty(Ty_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Ty);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += "operator ";
         Ty->print(OB);
     }
@@ -483,17 +501,17 @@ class PostfixQualifiedType final : public Node {
     const std::string_view Postfix;
 
 public:
-    PostfixQualifiedType(const Node* Ty_, std::string_view Postfix_)
+    constexpr PostfixQualifiedType(const Node* Ty_, std::string_view Postfix_)
     : Node(KPostfixQualifiedType),
       Ty(Ty_),
       Postfix(Postfix_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Ty, Postfix);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Ty->printLeft(OB);
         OB += Postfix;
     }
@@ -503,17 +521,17 @@ class NameType final : public Node {
     const std::string_view Name;
 
 public:
-    NameType(std::string_view Name_) : Node(KNameType), Name(Name_) {}
+    constexpr NameType(std::string_view Name_) : Node(KNameType), Name(Name_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Name);
     }
 
-    std::string_view getName() const { return Name; }
-    std::string_view getBaseName() const override { return Name; }
+    constexpr std::string_view getName() const { return Name; }
+    constexpr std::string_view getBaseName() const override { return Name; }
 
-    void printLeft(OutputBuffer& OB) const override { OB += Name; }
+    constexpr void printLeft(OutputBuffer& OB) const override { OB += Name; }
 };
 
 class BitIntType final : public Node {
@@ -521,14 +539,14 @@ class BitIntType final : public Node {
     bool        Signed;
 
 public:
-    BitIntType(const Node* Size_, bool Signed_) : Node(KBitIntType), Size(Size_), Signed(Signed_) {}
+    constexpr BitIntType(const Node* Size_, bool Signed_) : Node(KBitIntType), Size(Size_), Signed(Signed_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Size, Signed);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         if (!Signed) OB += "unsigned ";
         OB += "_BitInt";
         OB.printOpen();
@@ -542,17 +560,17 @@ class ElaboratedTypeSpefType : public Node {
     Node*            Child;
 
 public:
-    ElaboratedTypeSpefType(std::string_view Kind_, Node* Child_)
+    constexpr ElaboratedTypeSpefType(std::string_view Kind_, Node* Child_)
     : Node(KElaboratedTypeSpefType),
       Kind(Kind_),
       Child(Child_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Kind, Child);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += Kind;
         OB += ' ';
         Child->print(OB);
@@ -564,17 +582,17 @@ class TransformedType : public Node {
     Node*            BaseType;
 
 public:
-    TransformedType(std::string_view Transform_, Node* BaseType_)
+    constexpr TransformedType(std::string_view Transform_, Node* BaseType_)
     : Node(KTransformedType),
       Transform(Transform_),
       BaseType(BaseType_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Transform, BaseType);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += Transform;
         OB += '(';
         BaseType->print(OB);
@@ -586,19 +604,19 @@ struct AbiTagAttr : Node {
     Node*            Base;
     std::string_view Tag;
 
-    AbiTagAttr(Node* Base_, std::string_view Tag_)
+    constexpr AbiTagAttr(Node* Base_, std::string_view Tag_)
     : Node(KAbiTagAttr, Base_->getRHSComponentCache(), Base_->getArrayCache(), Base_->getFunctionCache()),
       Base(Base_),
       Tag(Tag_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Base, Tag);
     }
 
-    std::string_view getBaseName() const override { return Base->getBaseName(); }
+    constexpr std::string_view getBaseName() const override { return Base->getBaseName(); }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Base->printLeft(OB);
         OB += "[abi:";
         OB += Tag;
@@ -610,14 +628,14 @@ class EnableIfAttr : public Node {
     NodeArray Conditions;
 
 public:
-    EnableIfAttr(NodeArray Conditions_) : Node(KEnableIfAttr), Conditions(Conditions_) {}
+    constexpr EnableIfAttr(NodeArray Conditions_) : Node(KEnableIfAttr), Conditions(Conditions_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Conditions);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += " [enable_if:";
         Conditions.printWithComma(OB);
         OB += ']';
@@ -631,18 +649,21 @@ class ObjCProtoName : public Node {
     friend class PointerType;
 
 public:
-    ObjCProtoName(const Node* Ty_, std::string_view Protocol_) : Node(KObjCProtoName), Ty(Ty_), Protocol(Protocol_) {}
+    constexpr ObjCProtoName(const Node* Ty_, std::string_view Protocol_)
+    : Node(KObjCProtoName),
+      Ty(Ty_),
+      Protocol(Protocol_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Ty, Protocol);
     }
 
-    bool isObjCObject() const {
+    constexpr bool isObjCObject() const {
         return Ty->getKind() == KNameType && static_cast<const NameType*>(Ty)->getName() == "objc_object";
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Ty->print(OB);
         OB += "<";
         OB += Protocol;
@@ -654,18 +675,20 @@ class PointerType final : public Node {
     const Node* Pointee;
 
 public:
-    PointerType(const Node* Pointee_) : Node(KPointerType, Pointee_->getRHSComponentCache()), Pointee(Pointee_) {}
+    constexpr PointerType(const Node* Pointee_)
+    : Node(KPointerType, Pointee_->getRHSComponentCache()),
+      Pointee(Pointee_) {}
 
-    const Node* getPointee() const { return Pointee; }
+    constexpr const Node* getPointee() const { return Pointee; }
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Pointee);
     }
 
-    bool hasRHSComponentSlow(OutputBuffer& OB) const override { return Pointee->hasRHSComponent(OB); }
+    constexpr bool hasRHSComponentSlow(OutputBuffer& OB) const override { return Pointee->hasRHSComponent(OB); }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         // We rewrite objc_object<SomeProtocol>* into id<SomeProtocol>.
         if (Pointee->getKind() != KObjCProtoName || !static_cast<const ObjCProtoName*>(Pointee)->isObjCObject()) {
             Pointee->printLeft(OB);
@@ -680,7 +703,7 @@ public:
         }
     }
 
-    void printRight(OutputBuffer& OB) const override {
+    constexpr void printRight(OutputBuffer& OB) const override {
         if (Pointee->getKind() != KObjCProtoName || !static_cast<const ObjCProtoName*>(Pointee)->isObjCObject()) {
             if (Pointee->hasArray(OB) || Pointee->hasFunction(OB)) OB += ")";
             Pointee->printRight(OB);
@@ -698,7 +721,11 @@ class ReferenceType : public Node {
     const Node*   Pointee;
     ReferenceKind RK;
 
-    mutable bool Printing = false;
+    bool Printing = false;
+
+    // Printing is set while printing, through a const this. It is not mutable
+    // only because GCC 12 cannot read mutable members in constant evaluation.
+    constexpr bool& printing() const { return const_cast<ReferenceType*>(this)->Printing; }
 
     // Dig through any refs to refs, collapsing the ReferenceTypes as we go. The
     // rule here is rvalue ref to rvalue ref collapses to a rvalue ref, and any
@@ -707,7 +734,7 @@ class ReferenceType : public Node {
     // A combination of a TemplateForwardReference and a back-ref Substitution
     // from an ill-formed string may have created a cycle; use cycle detection to
     // avoid looping forever.
-    std::pair<ReferenceKind, const Node*> collapse(OutputBuffer& OB) const {
+    constexpr std::pair<ReferenceKind, const Node*> collapse(OutputBuffer& OB) const {
         auto SoFar = std::make_pair(RK, Pointee);
         // Track the chain of nodes for the Floyd's 'tortoise and hare'
         // cycle-detection algorithm, since getSyntaxNode(S) is impure
@@ -731,21 +758,21 @@ class ReferenceType : public Node {
     }
 
 public:
-    ReferenceType(const Node* Pointee_, ReferenceKind RK_)
+    constexpr ReferenceType(const Node* Pointee_, ReferenceKind RK_)
     : Node(KReferenceType, Pointee_->getRHSComponentCache()),
       Pointee(Pointee_),
       RK(RK_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Pointee, RK);
     }
 
-    bool hasRHSComponentSlow(OutputBuffer& OB) const override { return Pointee->hasRHSComponent(OB); }
+    constexpr bool hasRHSComponentSlow(OutputBuffer& OB) const override { return Pointee->hasRHSComponent(OB); }
 
-    void printLeft(OutputBuffer& OB) const override {
-        if (Printing) return;
-        ScopedOverride<bool>                  SavePrinting(Printing, true);
+    constexpr void printLeft(OutputBuffer& OB) const override {
+        if (printing()) return;
+        ScopedOverride<bool>                  SavePrinting(printing(), true);
         std::pair<ReferenceKind, const Node*> Collapsed = collapse(OB);
         if (!Collapsed.second) return;
         Collapsed.second->printLeft(OB);
@@ -754,9 +781,9 @@ public:
 
         OB += (Collapsed.first == ReferenceKind::LValue ? "&" : "&&");
     }
-    void printRight(OutputBuffer& OB) const override {
-        if (Printing) return;
-        ScopedOverride<bool>                  SavePrinting(Printing, true);
+    constexpr void printRight(OutputBuffer& OB) const override {
+        if (printing()) return;
+        ScopedOverride<bool>                  SavePrinting(printing(), true);
         std::pair<ReferenceKind, const Node*> Collapsed = collapse(OB);
         if (!Collapsed.second) return;
         if (Collapsed.second->hasArray(OB) || Collapsed.second->hasFunction(OB)) OB += ")";
@@ -769,19 +796,19 @@ class PointerToMemberType final : public Node {
     const Node* MemberType;
 
 public:
-    PointerToMemberType(const Node* ClassType_, const Node* MemberType_)
+    constexpr PointerToMemberType(const Node* ClassType_, const Node* MemberType_)
     : Node(KPointerToMemberType, MemberType_->getRHSComponentCache()),
       ClassType(ClassType_),
       MemberType(MemberType_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(ClassType, MemberType);
     }
 
-    bool hasRHSComponentSlow(OutputBuffer& OB) const override { return MemberType->hasRHSComponent(OB); }
+    constexpr bool hasRHSComponentSlow(OutputBuffer& OB) const override { return MemberType->hasRHSComponent(OB); }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         MemberType->printLeft(OB);
         if (MemberType->hasArray(OB) || MemberType->hasFunction(OB)) OB += "(";
         else OB += " ";
@@ -789,7 +816,7 @@ public:
         OB += "::*";
     }
 
-    void printRight(OutputBuffer& OB) const override {
+    constexpr void printRight(OutputBuffer& OB) const override {
         if (MemberType->hasArray(OB) || MemberType->hasFunction(OB)) OB += ")";
         MemberType->printRight(OB);
     }
@@ -800,7 +827,7 @@ class ArrayType final : public Node {
     Node*       Dimension;
 
 public:
-    ArrayType(const Node* Base_, Node* Dimension_)
+    constexpr ArrayType(const Node* Base_, Node* Dimension_)
     : Node(
           KArrayType,
           /*RHSComponentCache=*/Cache::Yes,
@@ -810,16 +837,16 @@ public:
       Dimension(Dimension_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Base, Dimension);
     }
 
-    bool hasRHSComponentSlow(OutputBuffer&) const override { return true; }
-    bool hasArraySlow(OutputBuffer&) const override { return true; }
+    constexpr bool hasRHSComponentSlow(OutputBuffer&) const override { return true; }
+    constexpr bool hasArraySlow(OutputBuffer&) const override { return true; }
 
-    void printLeft(OutputBuffer& OB) const override { Base->printLeft(OB); }
+    constexpr void printLeft(OutputBuffer& OB) const override { Base->printLeft(OB); }
 
-    void printRight(OutputBuffer& OB) const override {
+    constexpr void printRight(OutputBuffer& OB) const override {
         if (OB.back() != ']') OB += " ";
         OB += "[";
         if (Dimension) Dimension->print(OB);
@@ -827,7 +854,7 @@ public:
         Base->printRight(OB);
     }
 
-    bool printInitListAsType(OutputBuffer& OB, const NodeArray& Elements) const override {
+    constexpr bool printInitListAsType(OutputBuffer& OB, const NodeArray& Elements) const override {
         if (Base->getKind() == KNameType && static_cast<const NameType*>(Base)->getName() == "char") {
             return Elements.printAsString(OB);
         }
@@ -843,7 +870,7 @@ class FunctionType final : public Node {
     const Node*     ExceptionSpec;
 
 public:
-    FunctionType(
+    constexpr FunctionType(
         const Node*     Ret_,
         NodeArray       Params_,
         Qualifiers      CVQuals_,
@@ -863,12 +890,12 @@ public:
       ExceptionSpec(ExceptionSpec_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Ret, Params, CVQuals, RefQual, ExceptionSpec);
     }
 
-    bool hasRHSComponentSlow(OutputBuffer&) const override { return true; }
-    bool hasFunctionSlow(OutputBuffer&) const override { return true; }
+    constexpr bool hasRHSComponentSlow(OutputBuffer&) const override { return true; }
+    constexpr bool hasFunctionSlow(OutputBuffer&) const override { return true; }
 
     // Handle C++'s ... quirky decl grammar by using the left & right
     // distinction. Consider:
@@ -877,12 +904,12 @@ public:
     // that takes a char and returns an int. If we're trying to print f, start
     // by printing out the return types's left, then print our parameters, then
     // finally print right of the return type.
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Ret->printLeft(OB);
         OB += " ";
     }
 
-    void printRight(OutputBuffer& OB) const override {
+    constexpr void printRight(OutputBuffer& OB) const override {
         OB.printOpen();
         Params.printWithComma(OB);
         OB.printClose();
@@ -906,14 +933,14 @@ class NoexceptSpec : public Node {
     const Node* E;
 
 public:
-    NoexceptSpec(const Node* E_) : Node(KNoexceptSpec), E(E_) {}
+    constexpr NoexceptSpec(const Node* E_) : Node(KNoexceptSpec), E(E_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(E);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += "noexcept";
         OB.printOpen();
         E->printAsOperand(OB);
@@ -925,14 +952,14 @@ class DynamicExceptionSpec : public Node {
     NodeArray Types;
 
 public:
-    DynamicExceptionSpec(NodeArray Types_) : Node(KDynamicExceptionSpec), Types(Types_) {}
+    constexpr DynamicExceptionSpec(NodeArray Types_) : Node(KDynamicExceptionSpec), Types(Types_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Types);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += "throw";
         OB.printOpen();
         Types.printWithComma(OB);
@@ -951,16 +978,16 @@ class ExplicitObjectParameter final : public Node {
     Node* Base;
 
 public:
-    ExplicitObjectParameter(Node* Base_) : Node(KExplicitObjectParameter), Base(Base_) {
+    constexpr ExplicitObjectParameter(Node* Base_) : Node(KExplicitObjectParameter), Base(Base_) {
         DEMANGLE_ASSERT(Base != nullptr, "Creating an ExplicitObjectParameter without a valid Base Node.");
     }
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Base);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += "this ";
         Base->print(OB);
     }
@@ -976,7 +1003,7 @@ class FunctionEncoding final : public Node {
     FunctionRefQual RefQual;
 
 public:
-    FunctionEncoding(
+    constexpr FunctionEncoding(
         const Node*     Ret_,
         const Node*     Name_,
         NodeArray       Params_,
@@ -1000,21 +1027,23 @@ public:
       RefQual(RefQual_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Ret, Name, Params, Attrs, Requires, CVQuals, RefQual);
     }
 
-    Qualifiers      getCVQuals() const { return CVQuals; }
-    FunctionRefQual getRefQual() const { return RefQual; }
-    NodeArray       getParams() const { return Params; }
-    const Node*     getReturnType() const { return Ret; }
+    constexpr Qualifiers      getCVQuals() const { return CVQuals; }
+    constexpr FunctionRefQual getRefQual() const { return RefQual; }
+    constexpr NodeArray       getParams() const { return Params; }
+    constexpr const Node*     getReturnType() const { return Ret; }
+    constexpr const Node*     getAttrs() const { return Attrs; }
+    constexpr const Node*     getRequires() const { return Requires; }
 
-    bool hasRHSComponentSlow(OutputBuffer&) const override { return true; }
-    bool hasFunctionSlow(OutputBuffer&) const override { return true; }
+    constexpr bool hasRHSComponentSlow(OutputBuffer&) const override { return true; }
+    constexpr bool hasFunctionSlow(OutputBuffer&) const override { return true; }
 
-    const Node* getName() const { return Name; }
+    constexpr const Node* getName() const { return Name; }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         if (Ret) {
             Ret->printLeft(OB);
             if (!Ret->hasRHSComponent(OB)) OB += " ";
@@ -1022,7 +1051,7 @@ public:
         Name->print(OB);
     }
 
-    void printRight(OutputBuffer& OB) const override {
+    constexpr void printRight(OutputBuffer& OB) const override {
         OB.printOpen();
         Params.printWithComma(OB);
         OB.printClose();
@@ -1048,14 +1077,14 @@ class LiteralOperator : public Node {
     const Node* OpName;
 
 public:
-    LiteralOperator(const Node* OpName_) : Node(KLiteralOperator), OpName(OpName_) {}
+    constexpr LiteralOperator(const Node* OpName_) : Node(KLiteralOperator), OpName(OpName_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(OpName);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += "operator\"\" ";
         OpName->print(OB);
     }
@@ -1066,14 +1095,17 @@ class SpecialName final : public Node {
     const Node*            Child;
 
 public:
-    SpecialName(std::string_view Special_, const Node* Child_) : Node(KSpecialName), Special(Special_), Child(Child_) {}
+    constexpr SpecialName(std::string_view Special_, const Node* Child_)
+    : Node(KSpecialName),
+      Special(Special_),
+      Child(Child_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Special, Child);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += Special;
         Child->print(OB);
     }
@@ -1084,17 +1116,17 @@ class CtorVtableSpecialName final : public Node {
     const Node* SecondType;
 
 public:
-    CtorVtableSpecialName(const Node* FirstType_, const Node* SecondType_)
+    constexpr CtorVtableSpecialName(const Node* FirstType_, const Node* SecondType_)
     : Node(KCtorVtableSpecialName),
       FirstType(FirstType_),
       SecondType(SecondType_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(FirstType, SecondType);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += "construction vtable for ";
         FirstType->print(OB);
         OB += "-in-";
@@ -1106,16 +1138,16 @@ struct NestedName : Node {
     Node* Qual;
     Node* Name;
 
-    NestedName(Node* Qual_, Node* Name_) : Node(KNestedName), Qual(Qual_), Name(Name_) {}
+    constexpr NestedName(Node* Qual_, Node* Name_) : Node(KNestedName), Qual(Qual_), Name(Name_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Qual, Name);
     }
 
-    std::string_view getBaseName() const override { return Name->getBaseName(); }
+    constexpr std::string_view getBaseName() const override { return Name->getBaseName(); }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Qual->print(OB);
         OB += "::";
         Name->print(OB);
@@ -1126,16 +1158,16 @@ struct MemberLikeFriendName : Node {
     Node* Qual;
     Node* Name;
 
-    MemberLikeFriendName(Node* Qual_, Node* Name_) : Node(KMemberLikeFriendName), Qual(Qual_), Name(Name_) {}
+    constexpr MemberLikeFriendName(Node* Qual_, Node* Name_) : Node(KMemberLikeFriendName), Qual(Qual_), Name(Name_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Qual, Name);
     }
 
-    std::string_view getBaseName() const override { return Name->getBaseName(); }
+    constexpr std::string_view getBaseName() const override { return Name->getBaseName(); }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Qual->print(OB);
         OB += "::friend ";
         Name->print(OB);
@@ -1147,18 +1179,18 @@ struct ModuleName : Node {
     Node*       Name;
     bool        IsPartition;
 
-    ModuleName(ModuleName* Parent_, Node* Name_, bool IsPartition_ = false)
+    constexpr ModuleName(ModuleName* Parent_, Node* Name_, bool IsPartition_ = false)
     : Node(KModuleName),
       Parent(Parent_),
       Name(Name_),
       IsPartition(IsPartition_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Parent, Name, IsPartition);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         if (Parent) Parent->print(OB);
         if (Parent || IsPartition) OB += IsPartition ? ':' : '.';
         Name->print(OB);
@@ -1169,16 +1201,16 @@ struct ModuleEntity : Node {
     ModuleName* Module;
     Node*       Name;
 
-    ModuleEntity(ModuleName* Module_, Node* Name_) : Node(KModuleEntity), Module(Module_), Name(Name_) {}
+    constexpr ModuleEntity(ModuleName* Module_, Node* Name_) : Node(KModuleEntity), Module(Module_), Name(Name_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Module, Name);
     }
 
-    std::string_view getBaseName() const override { return Name->getBaseName(); }
+    constexpr std::string_view getBaseName() const override { return Name->getBaseName(); }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Name->print(OB);
         OB += '@';
         Module->print(OB);
@@ -1189,14 +1221,14 @@ struct LocalName : Node {
     Node* Encoding;
     Node* Entity;
 
-    LocalName(Node* Encoding_, Node* Entity_) : Node(KLocalName), Encoding(Encoding_), Entity(Entity_) {}
+    constexpr LocalName(Node* Encoding_, Node* Entity_) : Node(KLocalName), Encoding(Encoding_), Entity(Entity_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Encoding, Entity);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Encoding->print(OB);
         OB += "::";
         Entity->print(OB);
@@ -1209,19 +1241,19 @@ class QualifiedName final : public Node {
     const Node* Name;
 
 public:
-    QualifiedName(const Node* Qualifier_, const Node* Name_)
+    constexpr QualifiedName(const Node* Qualifier_, const Node* Name_)
     : Node(KQualifiedName),
       Qualifier(Qualifier_),
       Name(Name_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Qualifier, Name);
     }
 
-    std::string_view getBaseName() const override { return Name->getBaseName(); }
+    constexpr std::string_view getBaseName() const override { return Name->getBaseName(); }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Qualifier->print(OB);
         OB += "::";
         Name->print(OB);
@@ -1233,20 +1265,20 @@ class VectorType final : public Node {
     const Node* Dimension;
 
 public:
-    VectorType(const Node* BaseType_, const Node* Dimension_)
+    constexpr VectorType(const Node* BaseType_, const Node* Dimension_)
     : Node(KVectorType),
       BaseType(BaseType_),
       Dimension(Dimension_) {}
 
-    const Node* getBaseType() const { return BaseType; }
-    const Node* getDimension() const { return Dimension; }
+    constexpr const Node* getBaseType() const { return BaseType; }
+    constexpr const Node* getDimension() const { return Dimension; }
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(BaseType, Dimension);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         BaseType->print(OB);
         OB += " vector[";
         if (Dimension) Dimension->print(OB);
@@ -1258,14 +1290,14 @@ class PixelVectorType final : public Node {
     const Node* Dimension;
 
 public:
-    PixelVectorType(const Node* Dimension_) : Node(KPixelVectorType), Dimension(Dimension_) {}
+    constexpr PixelVectorType(const Node* Dimension_) : Node(KPixelVectorType), Dimension(Dimension_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Dimension);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         // FIXME: This should demangle as "vector pixel".
         OB += "pixel vector[";
         Dimension->print(OB);
@@ -1277,14 +1309,14 @@ class BinaryFPType final : public Node {
     const Node* Dimension;
 
 public:
-    BinaryFPType(const Node* Dimension_) : Node(KBinaryFPType), Dimension(Dimension_) {}
+    constexpr BinaryFPType(const Node* Dimension_) : Node(KBinaryFPType), Dimension(Dimension_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Dimension);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += "_Float";
         Dimension->print(OB);
     }
@@ -1303,17 +1335,17 @@ class SyntheticTemplateParamName final : public Node {
     unsigned          Index;
 
 public:
-    SyntheticTemplateParamName(TemplateParamKind Kind_, unsigned Index_)
+    constexpr SyntheticTemplateParamName(TemplateParamKind Kind_, unsigned Index_)
     : Node(KSyntheticTemplateParamName),
       Kind(Kind_),
       Index(Index_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Kind, Index);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         switch (Kind) {
         case TemplateParamKind::Type:
             OB += "$T";
@@ -1334,16 +1366,19 @@ class TemplateParamQualifiedArg final : public Node {
     Node* Arg;
 
 public:
-    TemplateParamQualifiedArg(Node* Param_, Node* Arg_) : Node(KTemplateParamQualifiedArg), Param(Param_), Arg(Arg_) {}
+    constexpr TemplateParamQualifiedArg(Node* Param_, Node* Arg_)
+    : Node(KTemplateParamQualifiedArg),
+      Param(Param_),
+      Arg(Arg_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Param, Arg);
     }
 
-    Node* getArg() { return Arg; }
+    constexpr Node* getArg() { return Arg; }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         // Don't print Param to keep the output consistent.
         Arg->print(OB);
     }
@@ -1354,16 +1389,16 @@ class TypeTemplateParamDecl final : public Node {
     Node* Name;
 
 public:
-    TypeTemplateParamDecl(Node* Name_) : Node(KTypeTemplateParamDecl, Cache::Yes), Name(Name_) {}
+    constexpr TypeTemplateParamDecl(Node* Name_) : Node(KTypeTemplateParamDecl, Cache::Yes), Name(Name_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Name);
     }
 
-    void printLeft(OutputBuffer& OB) const override { OB += "typename "; }
+    constexpr void printLeft(OutputBuffer& OB) const override { OB += "typename "; }
 
-    void printRight(OutputBuffer& OB) const override { Name->print(OB); }
+    constexpr void printRight(OutputBuffer& OB) const override { Name->print(OB); }
 };
 
 /// A constrained template type parameter declaration, 'C<U> T'.
@@ -1372,22 +1407,22 @@ class ConstrainedTypeTemplateParamDecl final : public Node {
     Node* Name;
 
 public:
-    ConstrainedTypeTemplateParamDecl(Node* Constraint_, Node* Name_)
+    constexpr ConstrainedTypeTemplateParamDecl(Node* Constraint_, Node* Name_)
     : Node(KConstrainedTypeTemplateParamDecl, Cache::Yes),
       Constraint(Constraint_),
       Name(Name_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Constraint, Name);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Constraint->print(OB);
         OB += " ";
     }
 
-    void printRight(OutputBuffer& OB) const override { Name->print(OB); }
+    constexpr void printRight(OutputBuffer& OB) const override { Name->print(OB); }
 };
 
 /// A non-type template parameter declaration, 'int N'.
@@ -1396,22 +1431,22 @@ class NonTypeTemplateParamDecl final : public Node {
     Node* Type;
 
 public:
-    NonTypeTemplateParamDecl(Node* Name_, Node* Type_)
+    constexpr NonTypeTemplateParamDecl(Node* Name_, Node* Type_)
     : Node(KNonTypeTemplateParamDecl, Cache::Yes),
       Name(Name_),
       Type(Type_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Name, Type);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Type->printLeft(OB);
         if (!Type->hasRHSComponent(OB)) OB += " ";
     }
 
-    void printRight(OutputBuffer& OB) const override {
+    constexpr void printRight(OutputBuffer& OB) const override {
         Name->print(OB);
         Type->printRight(OB);
     }
@@ -1425,25 +1460,25 @@ class TemplateTemplateParamDecl final : public Node {
     Node*     Requires;
 
 public:
-    TemplateTemplateParamDecl(Node* Name_, NodeArray Params_, Node* Requires_)
+    constexpr TemplateTemplateParamDecl(Node* Name_, NodeArray Params_, Node* Requires_)
     : Node(KTemplateTemplateParamDecl, Cache::Yes),
       Name(Name_),
       Params(Params_),
       Requires(Requires_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Name, Params, Requires);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         ScopedOverride<unsigned> LT(OB.GtIsGt, 0);
         OB += "template<";
         Params.printWithComma(OB);
         OB += "> typename ";
     }
 
-    void printRight(OutputBuffer& OB) const override {
+    constexpr void printRight(OutputBuffer& OB) const override {
         Name->print(OB);
         if (Requires != nullptr) {
             OB += " requires ";
@@ -1457,19 +1492,19 @@ class TemplateParamPackDecl final : public Node {
     Node* Param;
 
 public:
-    TemplateParamPackDecl(Node* Param_) : Node(KTemplateParamPackDecl, Cache::Yes), Param(Param_) {}
+    constexpr TemplateParamPackDecl(Node* Param_) : Node(KTemplateParamPackDecl, Cache::Yes), Param(Param_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Param);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Param->printLeft(OB);
         OB += "...";
     }
 
-    void printRight(OutputBuffer& OB) const override { Param->printRight(OB); }
+    constexpr void printRight(OutputBuffer& OB) const override { Param->printRight(OB); }
 };
 
 /// An unexpanded parameter pack (either in the expression or type context). If
@@ -1485,7 +1520,7 @@ class ParameterPack final : public Node {
 
     // Setup OutputBuffer for a pack expansion, unless we're already expanding
     // one.
-    void initializePackExpansion(OutputBuffer& OB) const {
+    constexpr void initializePackExpansion(OutputBuffer& OB) const {
         if (OB.CurrentPackMax == std::numeric_limits<unsigned>::max()) {
             OB.CurrentPackMax   = static_cast<unsigned>(Data.size());
             OB.CurrentPackIndex = 0;
@@ -1493,7 +1528,7 @@ class ParameterPack final : public Node {
     }
 
 public:
-    ParameterPack(NodeArray Data_) : Node(KParameterPack), Data(Data_) {
+    constexpr ParameterPack(NodeArray Data_) : Node(KParameterPack), Data(Data_) {
         ArrayCache = FunctionCache = RHSComponentCache = Cache::Unknown;
         if (std::all_of(Data.begin(), Data.end(), [](Node* P) { return P->getArrayCache() == Cache::No; }))
             ArrayCache = Cache::No;
@@ -1504,37 +1539,37 @@ public:
     }
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Data);
     }
 
-    bool hasRHSComponentSlow(OutputBuffer& OB) const override {
+    constexpr bool hasRHSComponentSlow(OutputBuffer& OB) const override {
         initializePackExpansion(OB);
         size_t Idx = OB.CurrentPackIndex;
         return Idx < Data.size() && Data[Idx]->hasRHSComponent(OB);
     }
-    bool hasArraySlow(OutputBuffer& OB) const override {
+    constexpr bool hasArraySlow(OutputBuffer& OB) const override {
         initializePackExpansion(OB);
         size_t Idx = OB.CurrentPackIndex;
         return Idx < Data.size() && Data[Idx]->hasArray(OB);
     }
-    bool hasFunctionSlow(OutputBuffer& OB) const override {
+    constexpr bool hasFunctionSlow(OutputBuffer& OB) const override {
         initializePackExpansion(OB);
         size_t Idx = OB.CurrentPackIndex;
         return Idx < Data.size() && Data[Idx]->hasFunction(OB);
     }
-    const Node* getSyntaxNode(OutputBuffer& OB) const override {
+    constexpr const Node* getSyntaxNode(OutputBuffer& OB) const override {
         initializePackExpansion(OB);
         size_t Idx = OB.CurrentPackIndex;
         return Idx < Data.size() ? Data[Idx]->getSyntaxNode(OB) : this;
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         initializePackExpansion(OB);
         size_t Idx = OB.CurrentPackIndex;
         if (Idx < Data.size()) Data[Idx]->printLeft(OB);
     }
-    void printRight(OutputBuffer& OB) const override {
+    constexpr void printRight(OutputBuffer& OB) const override {
         initializePackExpansion(OB);
         size_t Idx = OB.CurrentPackIndex;
         if (Idx < Data.size()) Data[Idx]->printRight(OB);
@@ -1550,16 +1585,16 @@ class TemplateArgumentPack final : public Node {
     NodeArray Elements;
 
 public:
-    TemplateArgumentPack(NodeArray Elements_) : Node(KTemplateArgumentPack), Elements(Elements_) {}
+    constexpr TemplateArgumentPack(NodeArray Elements_) : Node(KTemplateArgumentPack), Elements(Elements_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Elements);
     }
 
-    NodeArray getElements() const { return Elements; }
+    constexpr NodeArray getElements() const { return Elements; }
 
-    void printLeft(OutputBuffer& OB) const override { Elements.printWithComma(OB); }
+    constexpr void printLeft(OutputBuffer& OB) const override { Elements.printWithComma(OB); }
 };
 
 /// A pack expansion. Below this node, there are some unexpanded ParameterPacks
@@ -1568,16 +1603,16 @@ class ParameterPackExpansion final : public Node {
     const Node* Child;
 
 public:
-    ParameterPackExpansion(const Node* Child_) : Node(KParameterPackExpansion), Child(Child_) {}
+    constexpr ParameterPackExpansion(const Node* Child_) : Node(KParameterPackExpansion), Child(Child_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Child);
     }
 
-    const Node* getChild() const { return Child; }
+    constexpr const Node* getChild() const { return Child; }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         constexpr unsigned       Max = std::numeric_limits<unsigned>::max();
         ScopedOverride<unsigned> SavePackIdx(OB.CurrentPackIndex, Max);
         ScopedOverride<unsigned> SavePackMax(OB.CurrentPackMax, Max);
@@ -1585,7 +1620,10 @@ public:
 
         // Print the first element in the pack. If Child contains a ParameterPack,
         // it will set up S.CurrentPackMax and print the first element.
-        Child->print(OB);
+        {
+            OutputBuffer::Hold KeepFirst(OB);
+            Child->print(OB);
+        }
 
         // No ParameterPack was found in Child. This can occur if we've found a pack
         // expansion on a <function-param>.
@@ -1615,16 +1653,19 @@ class TemplateArgs final : public Node {
     Node*     Requires;
 
 public:
-    TemplateArgs(NodeArray Params_, Node* Requires_) : Node(KTemplateArgs), Params(Params_), Requires(Requires_) {}
+    constexpr TemplateArgs(NodeArray Params_, Node* Requires_)
+    : Node(KTemplateArgs),
+      Params(Params_),
+      Requires(Requires_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Params, Requires);
     }
 
-    NodeArray getParams() { return Params; }
+    constexpr NodeArray getParams() { return Params; }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         ScopedOverride<unsigned> LT(OB.GtIsGt, 0);
         OB += "<";
         Params.printWithComma(OB);
@@ -1659,9 +1700,13 @@ struct ForwardTemplateReference : Node {
     // a forward template reference to refer to itself via a substitution. This
     // creates a cyclic AST, which will stack overflow printing. To fix this, bail
     // out if more than one print* function is active.
-    mutable bool Printing = false;
+    bool Printing = false;
+
+    // Printing is set while printing, through a const this. It is not mutable
+    // only because GCC 12 cannot read mutable members in constant evaluation.
+    constexpr bool& printing() const { return const_cast<ForwardTemplateReference*>(this)->Printing; }
 
-    ForwardTemplateReference(size_t Index_)
+    constexpr ForwardTemplateReference(size_t Index_)
     : Node(KForwardTemplateReference, Cache::Unknown, Cache::Unknown, Cache::Unknown),
       Index(Index_) {}
 
@@ -1671,35 +1716,35 @@ struct ForwardTemplateReference : Node {
     template <typename Fn>
     void match(Fn F) const = delete;
 
-    bool hasRHSComponentSlow(OutputBuffer& OB) const override {
-        if (Printing) return false;
-        ScopedOverride<bool> SavePrinting(Printing, true);
+    constexpr bool hasRHSComponentSlow(OutputBuffer& OB) const override {
+        if (printing()) return false;
+        ScopedOverride<bool> SavePrinting(printing(), true);
         return Ref->hasRHSComponent(OB);
     }
-    bool hasArraySlow(OutputBuffer& OB) const override {
-        if (Printing) return false;
-        ScopedOverride<bool> SavePrinting(Printing, true);
+    constexpr bool hasArraySlow(OutputBuffer& OB) const override {
+        if (printing()) return false;
+        ScopedOverride<bool> SavePrinting(printing(), true);
         return Ref->hasArray(OB);
     }
-    bool hasFunctionSlow(OutputBuffer& OB) const override {
-        if (Printing) return false;
-        ScopedOverride<bool> SavePrinting(Printing, true);
+    constexpr bool hasFunctionSlow(OutputBuffer& OB) const override {
+        if (printing()) return false;
+        ScopedOverride<bool> SavePrinting(printing(), true);
         return Ref->hasFunction(OB);
     }
-    const Node* getSyntaxNode(OutputBuffer& OB) const override {
-        if (Printing) return this;
-        ScopedOverride<bool> SavePrinting(Printing, true);
+    constexpr const Node* getSyntaxNode(OutputBuffer& OB) const override {
+        if (printing()) return this;
+        ScopedOverride<bool> SavePrinting(printing(), true);
         return Ref->getSyntaxNode(OB);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
-        if (Printing) return;
-        ScopedOverride<bool> SavePrinting(Printing, true);
+    constexpr void printLeft(OutputBuffer& OB) const override {
+        if (printing()) return;
+        ScopedOverride<bool> SavePrinting(printing(), true);
         Ref->printLeft(OB);
     }
-    void printRight(OutputBuffer& OB) const override {
-        if (Printing) return;
-        ScopedOverride<bool> SavePrinting(Printing, true);
+    constexpr void printRight(OutputBuffer& OB) const override {
+        if (printing()) return;
+        ScopedOverride<bool> SavePrinting(printing(), true);
         Ref->printRight(OB);
     }
 };
@@ -1709,19 +1754,19 @@ struct NameWithTemplateArgs : Node {
     Node* Name;
     Node* TemplateArgs;
 
-    NameWithTemplateArgs(Node* Name_, Node* TemplateArgs_)
+    constexpr NameWithTemplateArgs(Node* Name_, Node* TemplateArgs_)
     : Node(KNameWithTemplateArgs),
       Name(Name_),
       TemplateArgs(TemplateArgs_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Name, TemplateArgs);
     }
 
-    std::string_view getBaseName() const override { return Name->getBaseName(); }
+    constexpr std::string_view getBaseName() const override { return Name->getBaseName(); }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Name->print(OB);
         TemplateArgs->print(OB);
     }
@@ -1731,16 +1776,16 @@ class GlobalQualifiedName final : public Node {
     Node* Child;
 
 public:
-    GlobalQualifiedName(Node* Child_) : Node(KGlobalQualifiedName), Child(Child_) {}
+    constexpr GlobalQualifiedName(Node* Child_) : Node(KGlobalQualifiedName), Child(Child_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Child);
     }
 
-    std::string_view getBaseName() const override { return Child->getBaseName(); }
+    constexpr std::string_view getBaseName() const override { return Child->getBaseName(); }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += "::";
         Child->print(OB);
     }
@@ -1760,22 +1805,22 @@ class ExpandedSpecialSubstitution : public Node {
 protected:
     SpecialSubKind SSK;
 
-    ExpandedSpecialSubstitution(SpecialSubKind SSK_, Kind K_) : Node(K_), SSK(SSK_) {}
+    constexpr ExpandedSpecialSubstitution(SpecialSubKind SSK_, Kind K_) : Node(K_), SSK(SSK_) {}
 
 public:
-    ExpandedSpecialSubstitution(SpecialSubKind SSK_)
+    constexpr ExpandedSpecialSubstitution(SpecialSubKind SSK_)
     : ExpandedSpecialSubstitution(SSK_, KExpandedSpecialSubstitution) {}
-    inline ExpandedSpecialSubstitution(SpecialSubstitution const*);
+    constexpr ExpandedSpecialSubstitution(SpecialSubstitution const*);
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(SSK);
     }
 
 protected:
-    bool isInstantiation() const { return unsigned(SSK) >= unsigned(SpecialSubKind::string); }
+    constexpr bool isInstantiation() const { return unsigned(SSK) >= unsigned(SpecialSubKind::string); }
 
-    std::string_view getBaseName() const override {
+    constexpr std::string_view getBaseName() const override {
         switch (SSK) {
         case SpecialSubKind::allocator:
             return {"allocator"};
@@ -1794,7 +1839,7 @@ protected:
     }
 
 private:
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB << "std::" << getBaseName();
         if (isInstantiation()) {
             OB << "<char, std::char_traits<char>";
@@ -1806,14 +1851,14 @@ private:
 
 class SpecialSubstitution final : public ExpandedSpecialSubstitution {
 public:
-    SpecialSubstitution(SpecialSubKind SSK_) : ExpandedSpecialSubstitution(SSK_, KSpecialSubstitution) {}
+    constexpr SpecialSubstitution(SpecialSubKind SSK_) : ExpandedSpecialSubstitution(SSK_, KSpecialSubstitution) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(SSK);
     }
 
-    std::string_view getBaseName() const override {
+    constexpr std::string_view getBaseName() const override {
         std::string_view SV = ExpandedSpecialSubstitution::getBaseName();
         if (isInstantiation()) {
             // The instantiations are typedefs that drop the "basic_" prefix.
@@ -1823,10 +1868,10 @@ public:
         return SV;
     }
 
-    void printLeft(OutputBuffer& OB) const override { OB << "std::" << getBaseName(); }
+    constexpr void printLeft(OutputBuffer& OB) const override { OB << "std::" << getBaseName(); }
 };
 
-inline ExpandedSpecialSubstitution::ExpandedSpecialSubstitution(SpecialSubstitution const* SS)
+constexpr ExpandedSpecialSubstitution::ExpandedSpecialSubstitution(SpecialSubstitution const* SS)
 : ExpandedSpecialSubstitution(SS->SSK) {}
 
 class CtorDtorName final : public Node {
@@ -1835,18 +1880,18 @@ class CtorDtorName final : public Node {
     const int   Variant;
 
 public:
-    CtorDtorName(const Node* Basename_, bool IsDtor_, int Variant_)
+    constexpr CtorDtorName(const Node* Basename_, bool IsDtor_, int Variant_)
     : Node(KCtorDtorName),
       Basename(Basename_),
       IsDtor(IsDtor_),
       Variant(Variant_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Basename, IsDtor, Variant);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         if (IsDtor) OB += "~";
         OB += Basename->getBaseName();
     }
@@ -1856,14 +1901,14 @@ class DtorName : public Node {
     const Node* Base;
 
 public:
-    DtorName(const Node* Base_) : Node(KDtorName), Base(Base_) {}
+    constexpr DtorName(const Node* Base_) : Node(KDtorName), Base(Base_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Base);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += "~";
         Base->printLeft(OB);
     }
@@ -1873,14 +1918,14 @@ class UnnamedTypeName : public Node {
     const std::string_view Count;
 
 public:
-    UnnamedTypeName(std::string_view Count_) : Node(KUnnamedTypeName), Count(Count_) {}
+    constexpr UnnamedTypeName(std::string_view Count_) : Node(KUnnamedTypeName), Count(Count_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Count);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += "'unnamed";
         OB += Count;
         OB += "\'";
@@ -1895,7 +1940,7 @@ class ClosureTypeName : public Node {
     std::string_view Count;
 
 public:
-    ClosureTypeName(
+    constexpr ClosureTypeName(
         NodeArray        TemplateParams_,
         const Node*      Requires1_,
         NodeArray        Params_,
@@ -1910,11 +1955,11 @@ public:
       Count(Count_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(TemplateParams, Requires1, Params, Requires2, Count);
     }
 
-    void printDeclarator(OutputBuffer& OB) const {
+    constexpr void printDeclarator(OutputBuffer& OB) const {
         if (!TemplateParams.empty()) {
             ScopedOverride<unsigned> LT(OB.GtIsGt, 0);
             OB += "<";
@@ -1935,7 +1980,7 @@ public:
         }
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         // FIXME: This demangling is not particularly readable.
         OB += "\'lambda";
         OB += Count;
@@ -1948,14 +1993,14 @@ class StructuredBindingName : public Node {
     NodeArray Bindings;
 
 public:
-    StructuredBindingName(NodeArray Bindings_) : Node(KStructuredBindingName), Bindings(Bindings_) {}
+    constexpr StructuredBindingName(NodeArray Bindings_) : Node(KStructuredBindingName), Bindings(Bindings_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Bindings);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB.printOpen('[');
         Bindings.printWithComma(OB);
         OB.printClose(']');
@@ -1970,18 +2015,18 @@ class BinaryExpr : public Node {
     const Node*            RHS;
 
 public:
-    BinaryExpr(const Node* LHS_, std::string_view InfixOperator_, const Node* RHS_, Prec Prec_)
+    constexpr BinaryExpr(const Node* LHS_, std::string_view InfixOperator_, const Node* RHS_, Prec Prec_)
     : Node(KBinaryExpr, Prec_),
       LHS(LHS_),
       InfixOperator(InfixOperator_),
       RHS(RHS_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(LHS, InfixOperator, RHS, getPrecedence());
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         bool ParenAll = OB.isGtInsideTemplateArgs() && (InfixOperator == ">" || InfixOperator == ">>");
         if (ParenAll) OB.printOpen();
         // Assignment is right associative, with special LHS precedence.
@@ -2001,17 +2046,17 @@ class ArraySubscriptExpr : public Node {
     const Node* Op2;
 
 public:
-    ArraySubscriptExpr(const Node* Op1_, const Node* Op2_, Prec Prec_)
+    constexpr ArraySubscriptExpr(const Node* Op1_, const Node* Op2_, Prec Prec_)
     : Node(KArraySubscriptExpr, Prec_),
       Op1(Op1_),
       Op2(Op2_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Op1, Op2, getPrecedence());
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Op1->printAsOperand(OB, getPrecedence());
         OB.printOpen('[');
         Op2->printAsOperand(OB);
@@ -2024,17 +2069,17 @@ class PostfixExpr : public Node {
     const std::string_view Operator;
 
 public:
-    PostfixExpr(const Node* Child_, std::string_view Operator_, Prec Prec_)
+    constexpr PostfixExpr(const Node* Child_, std::string_view Operator_, Prec Prec_)
     : Node(KPostfixExpr, Prec_),
       Child(Child_),
       Operator(Operator_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Child, Operator, getPrecedence());
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Child->printAsOperand(OB, getPrecedence(), true);
         OB += Operator;
     }
@@ -2046,18 +2091,18 @@ class ConditionalExpr : public Node {
     const Node* Else;
 
 public:
-    ConditionalExpr(const Node* Cond_, const Node* Then_, const Node* Else_, Prec Prec_)
+    constexpr ConditionalExpr(const Node* Cond_, const Node* Then_, const Node* Else_, Prec Prec_)
     : Node(KConditionalExpr, Prec_),
       Cond(Cond_),
       Then(Then_),
       Else(Else_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Cond, Then, Else, getPrecedence());
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Cond->printAsOperand(OB, getPrecedence());
         OB += " ? ";
         Then->printAsOperand(OB);
@@ -2072,18 +2117,18 @@ class MemberExpr : public Node {
     const Node*            RHS;
 
 public:
-    MemberExpr(const Node* LHS_, std::string_view Kind_, const Node* RHS_, Prec Prec_)
+    constexpr MemberExpr(const Node* LHS_, std::string_view Kind_, const Node* RHS_, Prec Prec_)
     : Node(KMemberExpr, Prec_),
       LHS(LHS_),
       Kind(Kind_),
       RHS(RHS_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(LHS, Kind, RHS, getPrecedence());
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         LHS->printAsOperand(OB, getPrecedence(), true);
         OB += Kind;
         RHS->printAsOperand(OB, getPrecedence(), false);
@@ -2098,7 +2143,7 @@ class SubobjectExpr : public Node {
     bool             OnePastTheEnd;
 
 public:
-    SubobjectExpr(
+    constexpr SubobjectExpr(
         const Node*      Type_,
         const Node*      SubExpr_,
         std::string_view Offset_,
@@ -2113,11 +2158,11 @@ public:
       OnePastTheEnd(OnePastTheEnd_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Type, SubExpr, Offset, UnionSelectors, OnePastTheEnd);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         SubExpr->print(OB);
         OB += ".<";
         Type->print(OB);
@@ -2140,17 +2185,17 @@ class EnclosingExpr : public Node {
     const std::string_view Postfix;
 
 public:
-    EnclosingExpr(std::string_view Prefix_, const Node* Infix_, Prec Prec_ = Prec::Primary)
+    constexpr EnclosingExpr(std::string_view Prefix_, const Node* Infix_, Prec Prec_ = Prec::Primary)
     : Node(KEnclosingExpr, Prec_),
       Prefix(Prefix_),
       Infix(Infix_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Prefix, Infix, getPrecedence());
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += Prefix;
         OB.printOpen();
         Infix->print(OB);
@@ -2166,18 +2211,18 @@ class CastExpr : public Node {
     const Node*            From;
 
 public:
-    CastExpr(std::string_view CastKind_, const Node* To_, const Node* From_, Prec Prec_)
+    constexpr CastExpr(std::string_view CastKind_, const Node* To_, const Node* From_, Prec Prec_)
     : Node(KCastExpr, Prec_),
       CastKind(CastKind_),
       To(To_),
       From(From_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(CastKind, To, From, getPrecedence());
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += CastKind;
         {
             ScopedOverride<unsigned> LT(OB.GtIsGt, 0);
@@ -2195,14 +2240,14 @@ class SizeofParamPackExpr : public Node {
     const Node* Pack;
 
 public:
-    SizeofParamPackExpr(const Node* Pack_) : Node(KSizeofParamPackExpr), Pack(Pack_) {}
+    constexpr SizeofParamPackExpr(const Node* Pack_) : Node(KSizeofParamPackExpr), Pack(Pack_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Pack);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += "sizeof...";
         OB.printOpen();
         ParameterPackExpansion PPE(Pack);
@@ -2216,14 +2261,17 @@ class CallExpr : public Node {
     NodeArray   Args;
 
 public:
-    CallExpr(const Node* Callee_, NodeArray Args_, Prec Prec_) : Node(KCallExpr, Prec_), Callee(Callee_), Args(Args_) {}
+    constexpr CallExpr(const Node* Callee_, NodeArray Args_, Prec Prec_)
+    : Node(KCallExpr, Prec_),
+      Callee(Callee_),
+      Args(Args_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Callee, Args, getPrecedence());
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         Callee->print(OB);
         OB.printOpen();
         Args.printWithComma(OB);
@@ -2239,7 +2287,7 @@ class NewExpr : public Node {
     bool      IsGlobal; // ::operator new ?
     bool      IsArray;  // new[] ?
 public:
-    NewExpr(NodeArray ExprList_, Node* Type_, NodeArray InitList_, bool IsGlobal_, bool IsArray_, Prec Prec_)
+    constexpr NewExpr(NodeArray ExprList_, Node* Type_, NodeArray InitList_, bool IsGlobal_, bool IsArray_, Prec Prec_)
     : Node(KNewExpr, Prec_),
       ExprList(ExprList_),
       Type(Type_),
@@ -2248,11 +2296,11 @@ public:
       IsArray(IsArray_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(ExprList, Type, InitList, IsGlobal, IsArray, getPrecedence());
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         if (IsGlobal) OB += "::";
         OB += "new";
         if (IsArray) OB += "[]";
@@ -2277,18 +2325,18 @@ class DeleteExpr : public Node {
     bool  IsArray;
 
 public:
-    DeleteExpr(Node* Op_, bool IsGlobal_, bool IsArray_, Prec Prec_)
+    constexpr DeleteExpr(Node* Op_, bool IsGlobal_, bool IsArray_, Prec Prec_)
     : Node(KDeleteExpr, Prec_),
       Op(Op_),
       IsGlobal(IsGlobal_),
       IsArray(IsArray_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Op, IsGlobal, IsArray, getPrecedence());
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         if (IsGlobal) OB += "::";
         OB += "delete";
         if (IsArray) OB += "[]";
@@ -2302,17 +2350,17 @@ class PrefixExpr : public Node {
     Node*            Child;
 
 public:
-    PrefixExpr(std::string_view Prefix_, Node* Child_, Prec Prec_)
+    constexpr PrefixExpr(std::string_view Prefix_, Node* Child_, Prec Prec_)
     : Node(KPrefixExpr, Prec_),
       Prefix(Prefix_),
       Child(Child_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Prefix, Child, getPrecedence());
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += Prefix;
         Child->printAsOperand(OB, getPrecedence());
     }
@@ -2322,14 +2370,14 @@ class FunctionParam : public Node {
     std::string_view Number;
 
 public:
-    FunctionParam(std::string_view Number_) : Node(KFunctionParam), Number(Number_) {}
+    constexpr FunctionParam(std::string_view Number_) : Node(KFunctionParam), Number(Number_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Number);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += "fp";
         OB += Number;
     }
@@ -2340,17 +2388,17 @@ class ConversionExpr : public Node {
     NodeArray   Expressions;
 
 public:
-    ConversionExpr(const Node* Type_, NodeArray Expressions_, Prec Prec_)
+    constexpr ConversionExpr(const Node* Type_, NodeArray Expressions_, Prec Prec_)
     : Node(KConversionExpr, Prec_),
       Type(Type_),
       Expressions(Expressions_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Type, Expressions, getPrecedence());
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB.printOpen();
         Type->print(OB);
         OB.printClose();
@@ -2366,18 +2414,23 @@ class PointerToMemberConversionExpr : public Node {
     std::string_view Offset;
 
 public:
-    PointerToMemberConversionExpr(const Node* Type_, const Node* SubExpr_, std::string_view Offset_, Prec Prec_)
+    constexpr PointerToMemberConversionExpr(
+        const Node*      Type_,
+        const Node*      SubExpr_,
+        std::string_view Offset_,
+        Prec             Prec_
+    )
     : Node(KPointerToMemberConversionExpr, Prec_),
       Type(Type_),
       SubExpr(SubExpr_),
       Offset(Offset_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Type, SubExpr, Offset, getPrecedence());
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB.printOpen();
         Type->print(OB);
         OB.printClose();
@@ -2392,14 +2445,14 @@ class InitListExpr : public Node {
     NodeArray   Inits;
 
 public:
-    InitListExpr(const Node* Ty_, NodeArray Inits_) : Node(KInitListExpr), Ty(Ty_), Inits(Inits_) {}
+    constexpr InitListExpr(const Node* Ty_, NodeArray Inits_) : Node(KInitListExpr), Ty(Ty_), Inits(Inits_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Ty, Inits);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         if (Ty) {
             if (Ty->printInitListAsType(OB, Inits)) return;
             Ty->print(OB);
@@ -2416,18 +2469,18 @@ class BracedExpr : public Node {
     bool        IsArray;
 
 public:
-    BracedExpr(const Node* Elem_, const Node* Init_, bool IsArray_)
+    constexpr BracedExpr(const Node* Elem_, const Node* Init_, bool IsArray_)
     : Node(KBracedExpr),
       Elem(Elem_),
       Init(Init_),
       IsArray(IsArray_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Elem, Init, IsArray);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         if (IsArray) {
             OB += '[';
             Elem->print(OB);
@@ -2447,18 +2500,18 @@ class BracedRangeExpr : public Node {
     const Node* Init;
 
 public:
-    BracedRangeExpr(const Node* First_, const Node* Last_, const Node* Init_)
+    constexpr BracedRangeExpr(const Node* First_, const Node* Last_, const Node* Init_)
     : Node(KBracedRangeExpr),
       First(First_),
       Last(Last_),
       Init(Init_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(First, Last, Init);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += '[';
         First->print(OB);
         OB += " ... ";
@@ -2475,7 +2528,7 @@ class FoldExpr : public Node {
     bool             IsLeftFold;
 
 public:
-    FoldExpr(bool IsLeftFold_, std::string_view OperatorName_, const Node* Pack_, const Node* Init_)
+    constexpr FoldExpr(bool IsLeftFold_, std::string_view OperatorName_, const Node* Pack_, const Node* Init_)
     : Node(KFoldExpr),
       Pack(Pack_),
       Init(Init_),
@@ -2483,11 +2536,11 @@ public:
       IsLeftFold(IsLeftFold_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(IsLeftFold, OperatorName, Pack, Init);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         auto PrintPack = [&] {
             OB.printOpen();
             ParameterPackExpansion(Pack).print(OB);
@@ -2519,14 +2572,14 @@ class ThrowExpr : public Node {
     const Node* Op;
 
 public:
-    ThrowExpr(const Node* Op_) : Node(KThrowExpr), Op(Op_) {}
+    constexpr ThrowExpr(const Node* Op_) : Node(KThrowExpr), Op(Op_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Op);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += "throw ";
         Op->print(OB);
     }
@@ -2536,14 +2589,14 @@ class BoolExpr : public Node {
     bool Value;
 
 public:
-    BoolExpr(bool Value_) : Node(KBoolExpr), Value(Value_) {}
+    constexpr BoolExpr(bool Value_) : Node(KBoolExpr), Value(Value_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Value);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += Value ? std::string_view("true") : std::string_view("false");
     }
 };
@@ -2552,14 +2605,14 @@ class StringLiteral : public Node {
     const Node* Type;
 
 public:
-    StringLiteral(const Node* Type_) : Node(KStringLiteral), Type(Type_) {}
+    constexpr StringLiteral(const Node* Type_) : Node(KStringLiteral), Type(Type_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Type);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += "\"<";
         Type->print(OB);
         OB += ">\"";
@@ -2570,14 +2623,14 @@ class LambdaExpr : public Node {
     const Node* Type;
 
 public:
-    LambdaExpr(const Node* Type_) : Node(KLambdaExpr), Type(Type_) {}
+    constexpr LambdaExpr(const Node* Type_) : Node(KLambdaExpr), Type(Type_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Type);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += "[]";
         if (Type->getKind() == KClosureTypeName) static_cast<const ClosureTypeName*>(Type)->printDeclarator(OB);
         OB += "{...}";
@@ -2590,14 +2643,17 @@ class EnumLiteral : public Node {
     std::string_view Integer;
 
 public:
-    EnumLiteral(const Node* Ty_, std::string_view Integer_) : Node(KEnumLiteral), Ty(Ty_), Integer(Integer_) {}
+    constexpr EnumLiteral(const Node* Ty_, std::string_view Integer_)
+    : Node(KEnumLiteral),
+      Ty(Ty_),
+      Integer(Integer_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Ty, Integer);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB.printOpen();
         Ty->print(OB);
         OB.printClose();
@@ -2612,17 +2668,17 @@ class IntegerLiteral : public Node {
     std::string_view Value;
 
 public:
-    IntegerLiteral(std::string_view Type_, std::string_view Value_)
+    constexpr IntegerLiteral(std::string_view Type_, std::string_view Value_)
     : Node(KIntegerLiteral),
       Type(Type_),
       Value(Value_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Type, Value);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         if (Type.size() > 3) {
             OB.printOpen();
             OB += Type;
@@ -2635,7 +2691,7 @@ public:
         if (Type.size() <= 3) OB += Type;
     }
 
-    std::string_view value() const { return Value; }
+    constexpr std::string_view value() const { return Value; }
 };
 
 class RequiresExpr : public Node {
@@ -2643,17 +2699,17 @@ class RequiresExpr : public Node {
     NodeArray Requirements;
 
 public:
-    RequiresExpr(NodeArray Parameters_, NodeArray Requirements_)
+    constexpr RequiresExpr(NodeArray Parameters_, NodeArray Requirements_)
     : Node(KRequiresExpr),
       Parameters(Parameters_),
       Requirements(Requirements_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Parameters, Requirements);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += "requires";
         if (!Parameters.empty()) {
             OB += ' ';
@@ -2677,18 +2733,18 @@ class ExprRequirement : public Node {
     const Node* TypeConstraint;
 
 public:
-    ExprRequirement(const Node* Expr_, bool IsNoexcept_, const Node* TypeConstraint_)
+    constexpr ExprRequirement(const Node* Expr_, bool IsNoexcept_, const Node* TypeConstraint_)
     : Node(KExprRequirement),
       Expr(Expr_),
       IsNoexcept(IsNoexcept_),
       TypeConstraint(TypeConstraint_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Expr, IsNoexcept, TypeConstraint);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += " ";
         if (IsNoexcept || TypeConstraint) OB.printOpen('{');
         Expr->print(OB);
@@ -2706,14 +2762,14 @@ class TypeRequirement : public Node {
     const Node* Type;
 
 public:
-    TypeRequirement(const Node* Type_) : Node(KTypeRequirement), Type(Type_) {}
+    constexpr TypeRequirement(const Node* Type_) : Node(KTypeRequirement), Type(Type_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Type);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += " typename ";
         Type->print(OB);
         OB += ';';
@@ -2724,14 +2780,14 @@ class NestedRequirement : public Node {
     const Node* Constraint;
 
 public:
-    NestedRequirement(const Node* Constraint_) : Node(KNestedRequirement), Constraint(Constraint_) {}
+    constexpr NestedRequirement(const Node* Constraint_) : Node(KNestedRequirement), Constraint(Constraint_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Constraint);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         OB += " requires ";
         Constraint->print(OB);
         OB += ';';
@@ -2754,14 +2810,14 @@ class FloatLiteralImpl : public Node {
     static constexpr Kind KindForClass = float_literal_impl::getFloatLiteralKind((Float*)nullptr);
 
 public:
-    FloatLiteralImpl(std::string_view Contents_) : Node(KindForClass), Contents(Contents_) {}
+    constexpr FloatLiteralImpl(std::string_view Contents_) : Node(KindForClass), Contents(Contents_) {}
 
     template <typename Fn>
-    void match(Fn F) const {
+    constexpr void match(Fn F) const {
         F(Contents);
     }
 
-    void printLeft(OutputBuffer& OB) const override {
+    constexpr void printLeft(OutputBuffer& OB) const override {
         const size_t N = FloatData<Float>::mangled_size;
         if (Contents.size() >= N) {
             union {
@@ -2772,9 +2828,9 @@ public:
             const char* last = t + N;
             char*       e    = buf;
             for (; t != last; ++t, ++e) {
-                unsigned d1 = isdigit(*t) ? static_cast<unsigned>(*t - '0') : static_cast<unsigned>(*t - 'a' + 10);
+                unsigned d1 = is_digit(*t) ? static_cast<unsigned>(*t - '0') : static_cast<unsigned>(*t - 'a' + 10);
                 ++t;
-                unsigned d0 = isdigit(*t) ? static_cast<unsigned>(*t - '0') : static_cast<unsigned>(*t - 'a' + 10);
+                unsigned d0 = is_digit(*t) ? static_cast<unsigned>(*t - '0') : static_cast<unsigned>(*t - 'a' + 10);
                 *e          = static_cast<char>((d1 << 4) + d0);
             }
 #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
@@ -2794,7 +2850,7 @@ using LongDoubleLiteral = FloatLiteralImpl<long double>;
 /// Visit the node. Calls \c F(P), where \c P is the node cast to the
 /// appropriate derived class.
 template <typename Fn>
-void Node::visit(Fn F) const {
+constexpr void Node::visit(Fn F) const {
     switch (K) {
 #define NODE(X)                                                                                                        \
     case K##X:                                                                                                         \
@@ -2815,8 +2871,9 @@ struct NodeKind;
     };
 #include "ItaniumNodes.def"
 
-inline bool NodeArray::printAsString(OutputBuffer& OB) const {
-    auto StartPos = OB.getCurrentPosition();
+constexpr bool NodeArray::printAsString(OutputBuffer& OB) const {
+    OutputBuffer::Hold KeepString(OB);
+    auto               StartPos = OB.getCurrentPosition();
     auto Fail     = [&OB, StartPos] {
         OB.setCurrentPosition(StartPos);
         return false;
@@ -2897,6 +2954,54 @@ inline bool NodeArray::printAsString(OutputBuffer& OB) const {
     return true;
 }
 
+// 0 for any byte that is not an ASCII letter, 1-52 for the letters.
+struct EncodingLetterSlots {
+    unsigned char Slot[256] = {};
+
+    constexpr EncodingLetterSlots() {
+        for (unsigned C = 'a'; C <= 'z'; ++C) Slot[C] = static_cast<unsigned char>(C - 'a' + 1);
+        for (unsigned C = 'A'; C <= 'Z'; ++C) Slot[C] = static_cast<unsigned char>(C - 'A' + 27);
+    }
+    constexpr unsigned operator[](char C) const { return Slot[static_cast<unsigned char>(C)]; }
+};
+
+inline constexpr EncodingLetterSlots EncodingLetters{};
+
+// Finds the entry of a table of encodings that the next one or two letters of
+// a mangled name select with a few loads, instead of a search. It is built at
+// compile time from the table itself, so the two cannot drift apart. Every
+// encoding in the table is one or two ASCII letters; a one-letter encoding
+// matches whatever follows it.
+class EncodingIndex {
+    static constexpr unsigned NumSlots = 53;
+
+    // The position of an entry in the table plus one, or 0 for no entry.
+    unsigned char Index[NumSlots][NumSlots] = {};
+    bool          Valid                     = true;
+
+public:
+    template <typename Entry, size_t N>
+    constexpr explicit EncodingIndex(const Entry (&Table)[N]) {
+        static_assert(N < 256, "entry positions must fit in a byte");
+        for (size_t I = 0; I != N; ++I) {
+            unsigned A = EncodingLetters[Table[I].Enc[0]], B = EncodingLetters[Table[I].Enc[1]];
+            if (A == 0 || (B == 0 && Table[I].Enc[1] != '\0')) Valid = false;
+            for (unsigned J = B; J != (B == 0 ? NumSlots : B + 1); ++J) {
+                if (Index[A][J] != 0) Valid = false;
+                Index[A][J] = static_cast<unsigned char>(I + 1);
+            }
+        }
+    }
+
+    // Whether every encoding is one or two letters, and none of them shadows
+    // another.
+    constexpr bool isValid() const { return Valid; }
+
+    // The position in the table of the entry for the encoding that starts
+    // with A B, plus one, or 0 if there is none.
+    constexpr unsigned find(char A, char B) const { return Index[EncodingLetters[A]][EncodingLetters[B]]; }
+};
+
 template <typename Derived, typename Alloc>
 struct AbstractManglingParser {
     const char* First;
@@ -2922,16 +3027,16 @@ struct AbstractManglingParser {
         TemplateParamList       Params;
 
     public:
-        ScopedTemplateParamList(AbstractManglingParser* TheParser)
+        constexpr ScopedTemplateParamList(AbstractManglingParser* TheParser)
         : Parser(TheParser),
           OldNumTemplateParamLists(TheParser->TemplateParams.size()) {
             Parser->TemplateParams.push_back(&Params);
         }
-        ~ScopedTemplateParamList() {
+        constexpr ~ScopedTemplateParamList() {
             DEMANGLE_ASSERT(Parser->TemplateParams.size() >= OldNumTemplateParamLists, "");
             Parser->TemplateParams.shrinkToSize(OldNumTemplateParamLists);
         }
-        TemplateParamList* params() { return &Params; }
+        constexpr TemplateParamList* params() { return &Params; }
     };
 
     // Template parameter table. Like the above, but referenced like "T42_".
@@ -2952,13 +3057,13 @@ struct AbstractManglingParser {
         decltype(OuterTemplateParams) OldOuterParams;
 
     public:
-        SaveTemplateParams(AbstractManglingParser* TheParser) : Parser(TheParser) {
+        constexpr SaveTemplateParams(AbstractManglingParser* TheParser) : Parser(TheParser) {
             OldParams      = std::move(Parser->TemplateParams);
             OldOuterParams = std::move(Parser->OuterTemplateParams);
             Parser->TemplateParams.clear();
             Parser->OuterTemplateParams.clear();
         }
-        ~SaveTemplateParams() {
+        constexpr ~SaveTemplateParams() {
             Parser->TemplateParams      = std::move(OldParams);
             Parser->OuterTemplateParams = std::move(OldOuterParams);
         }
@@ -2975,47 +3080,77 @@ struct AbstractManglingParser {
 
     unsigned NumSyntheticTemplateParameters[3] = {};
 
+    // What this parse has used of its DemangleLimits. Once Exceeded is set the
+    // productions that recurse fail, and so does the parse.
+    detail::LimitTracker Limits;
+
     Alloc ASTAllocator;
 
-    AbstractManglingParser(const char* First_, const char* Last_) : First(First_), Last(Last_) {}
+    constexpr AbstractManglingParser(const char* First_, const char* Last_) : First(First_), Last(Last_) {}
+
+    constexpr Derived& getDerived() { return static_cast<Derived&>(*this); }
 
-    Derived& getDerived() { return static_cast<Derived&>(*this); }
+    constexpr void reset(const char* First_, const char* Last_) {
+        restart(First_, Last_);
+        ASTAllocator.reset();
+    }
 
-    void reset(const char* First_, const char* Last_) {
+    // Like reset(), but keep the nodes allocated so far.
+    constexpr void restart(const char* First_, const char* Last_) {
         First = First_;
         Last  = Last_;
         Names.clear();
         Subs.clear();
         TemplateParams.clear();
-        ParsingLambdaParamsAtLevel      = (size_t)-1;
-        TryToParseTemplateArgs          = true;
-        PermitForwardTemplateReferences = false;
+        OuterTemplateParams.clear();
+        ForwardTemplateRefs.clear();
+        ParsingLambdaParamsAtLevel             = (size_t)-1;
+        TryToParseTemplateArgs                 = true;
+        PermitForwardTemplateReferences        = false;
+        HasIncompleteTemplateParameterTracking = false;
         for (int I = 0; I != 3; ++I) NumSyntheticTemplateParameters[I] = 0;
-        ASTAllocator.reset();
+        Limits.restart();
+    }
+
+    // True if template arguments are parsed the way restart() leaves them to
+    // be, whatever template parameters are in scope.
+    constexpr bool hasDefaultTemplateMode() const {
+        return ForwardTemplateRefs.empty() && TryToParseTemplateArgs && !PermitForwardTemplateReferences
+            && !HasIncompleteTemplateParameterTracking && ParsingLambdaParamsAtLevel == (size_t)-1
+            && NumSyntheticTemplateParameters[0] == 0 && NumSyntheticTemplateParameters[1] == 0
+            && NumSyntheticTemplateParameters[2] == 0;
+    }
+
+    // True if nothing but Names, Subs and the AST carries over from what has
+    // been parsed so far to what comes next.
+    constexpr bool hasDefaultTemplateState() const {
+        return TemplateParams.empty() && OuterTemplateParams.empty() && hasDefaultTemplateMode();
     }
 
     template <class T, class... Args>
-    Node* make(Args&&... args) {
+    constexpr Node* make(Args&&... args) {
+        DEMANGLE_STATS_ADD(Nodes, 1);
+        Limits.addNode(sizeof(T));
         return ASTAllocator.template makeNode<T>(std::forward<Args>(args)...);
     }
 
     template <class It>
-    NodeArray makeNodeArray(It begin, It end) {
-        size_t sz   = static_cast<size_t>(end - begin);
-        void*  mem  = ASTAllocator.allocateNodeArray(sz);
-        Node** data = new (mem) Node*[sz];
+    constexpr NodeArray makeNodeArray(It begin, It end) {
+        size_t sz = static_cast<size_t>(end - begin);
+        Limits.addBytes(sz * sizeof(Node*));
+        Node** data = ASTAllocator.allocateNodeArray(sz);
         std::copy(begin, end, data);
         return NodeArray(data, sz);
     }
 
-    NodeArray popTrailingNodeArray(size_t FromPosition) {
+    constexpr NodeArray popTrailingNodeArray(size_t FromPosition) {
         DEMANGLE_ASSERT(FromPosition <= Names.size(), "");
         NodeArray res = makeNodeArray(Names.begin() + (long)FromPosition, Names.end());
         Names.shrinkToSize(FromPosition);
         return res;
     }
 
-    bool consumeIf(std::string_view S) {
+    constexpr bool consumeIf(std::string_view S) {
         if (starts_with(std::string_view(First, Last - First), S)) {
             First += S.size();
             return true;
@@ -3023,7 +3158,7 @@ struct AbstractManglingParser {
         return false;
     }
 
-    bool consumeIf(char C) {
+    constexpr bool consumeIf(char C) {
         if (First != Last && *First == C) {
             ++First;
             return true;
@@ -3031,61 +3166,61 @@ struct AbstractManglingParser {
         return false;
     }
 
-    char consume() { return First != Last ? *First++ : '\0'; }
+    constexpr char consume() { return First != Last ? *First++ : '\0'; }
 
-    char look(unsigned Lookahead = 0) const {
+    constexpr char look(unsigned Lookahead = 0) const {
         if (static_cast<size_t>(Last - First) <= Lookahead) return '\0';
         return First[Lookahead];
     }
 
-    size_t numLeft() const { return static_cast<size_t>(Last - First); }
+    constexpr size_t numLeft() const { return static_cast<size_t>(Last - First); }
 
-    std::string_view parseNumber(bool AllowNegative = false);
-    Qualifiers       parseCVQualifiers();
-    bool             parsePositiveInteger(size_t* Out);
-    std::string_view parseBareSourceName();
+    constexpr std::string_view parseNumber(bool AllowNegative = false);
+    constexpr Qualifiers       parseCVQualifiers();
+    constexpr bool             parsePositiveInteger(size_t* Out);
+    constexpr std::string_view parseBareSourceName();
 
-    bool  parseSeqId(size_t* Out);
-    Node* parseSubstitution();
-    Node* parseTemplateParam();
-    Node* parseTemplateParamDecl(TemplateParamList* Params);
-    Node* parseTemplateArgs(bool TagTemplates = false);
-    Node* parseTemplateArg();
+    constexpr bool  parseSeqId(size_t* Out);
+    constexpr Node* parseSubstitution();
+    constexpr Node* parseTemplateParam();
+    constexpr Node* parseTemplateParamDecl(TemplateParamList* Params);
+    constexpr Node* parseTemplateArgs(bool TagTemplates = false);
+    constexpr Node* parseTemplateArg();
 
-    bool isTemplateParamDecl() {
+    constexpr bool isTemplateParamDecl() {
         return look() == 'T' && std::string_view("yptnk").find(look(1)) != std::string_view::npos;
     }
 
     /// Parse the <expression> production.
-    Node* parseExpr();
-    Node* parsePrefixExpr(std::string_view Kind, Node::Prec Prec);
-    Node* parseBinaryExpr(std::string_view Kind, Node::Prec Prec);
-    Node* parseIntegerLiteral(std::string_view Lit);
-    Node* parseExprPrimary();
+    constexpr Node* parseExpr();
+    constexpr Node* parsePrefixExpr(std::string_view Kind, Node::Prec Prec);
+    constexpr Node* parseBinaryExpr(std::string_view Kind, Node::Prec Prec);
+    constexpr Node* parseIntegerLiteral(std::string_view Lit);
+    constexpr Node* parseExprPrimary();
     template <class Float>
-    Node* parseFloatingLiteral();
-    Node* parseFunctionParam();
-    Node* parseConversionExpr();
-    Node* parseBracedExpr();
-    Node* parseFoldExpr();
-    Node* parsePointerToMemberConversionExpr(Node::Prec Prec);
-    Node* parseSubobjectExpr();
-    Node* parseConstraintExpr();
-    Node* parseRequiresExpr();
+    constexpr Node* parseFloatingLiteral();
+    constexpr Node* parseFunctionParam();
+    constexpr Node* parseConversionExpr();
+    constexpr Node* parseBracedExpr();
+    constexpr Node* parseFoldExpr();
+    constexpr Node* parsePointerToMemberConversionExpr(Node::Prec Prec);
+    constexpr Node* parseSubobjectExpr();
+    constexpr Node* parseConstraintExpr();
+    constexpr Node* parseRequiresExpr();
 
     /// Parse the <type> production.
-    Node* parseType();
-    Node* parseFunctionType();
-    Node* parseVectorType();
-    Node* parseDecltype();
-    Node* parseArrayType();
-    Node* parsePointerToMemberType();
-    Node* parseClassEnumType();
-    Node* parseQualifiedType();
-
-    Node* parseEncoding(bool ParseParams = true);
-    bool  parseCallOffset();
-    Node* parseSpecialName();
+    constexpr Node* parseType();
+    constexpr Node* parseFunctionType();
+    constexpr Node* parseVectorType();
+    constexpr Node* parseDecltype();
+    constexpr Node* parseArrayType();
+    constexpr Node* parsePointerToMemberType();
+    constexpr Node* parseClassEnumType();
+    constexpr Node* parseQualifiedType();
+
+    constexpr Node* parseEncoding(bool ParseParams = true);
+    constexpr bool  parseCallOffset();
+    constexpr Node* parseSpecialName();
 
     /// Holds some extra information about a <name> that is being parsed. This
     /// information is only pertinent if the <name> refers to an <encoding>.
@@ -3097,11 +3232,11 @@ struct AbstractManglingParser {
         size_t          ForwardTemplateRefsBegin;
         bool            HasExplicitObjectParameter = false;
 
-        NameState(AbstractManglingParser* Enclosing)
+        constexpr NameState(AbstractManglingParser* Enclosing)
         : ForwardTemplateRefsBegin(Enclosing->ForwardTemplateRefs.size()) {}
     };
 
-    bool resolveForwardTemplateRefs(NameState& State) {
+    constexpr bool resolveForwardTemplateRefs(NameState& State) {
         size_t I = State.ForwardTemplateRefsBegin;
         size_t E = ForwardTemplateRefs.size();
         for (; I < E; ++I) {
@@ -3114,18 +3249,26 @@ struct AbstractManglingParser {
     }
 
     /// Parse the <name> production>
-    Node* parseName(NameState* State = nullptr);
-    Node* parseLocalName(NameState* State);
-    Node* parseOperatorName(NameState* State);
-    bool  parseModuleNameOpt(ModuleName*& Module);
-    Node* parseUnqualifiedName(NameState* State, Node* Scope, ModuleName* Module);
-    Node* parseUnnamedTypeName(NameState* State);
-    Node* parseSourceName(NameState* State);
-    Node* parseUnscopedName(NameState* State, bool* isSubstName);
-    Node* parseNestedName(NameState* State);
-    Node* parseCtorDtorName(Node*& SoFar, NameState* State);
-
-    Node* parseAbiTags(Node* N);
+    constexpr Node* parseName(NameState* State = nullptr);
+    constexpr Node* parseLocalName(NameState* State);
+    constexpr Node* parseOperatorName(NameState* State);
+    constexpr bool  parseModuleNameOpt(ModuleName*& Module);
+    constexpr Node* parseUnqualifiedName(NameState* State, Node* Scope, ModuleName* Module);
+    constexpr Node* parseUnnamedTypeName(NameState* State);
+    constexpr Node* parseSourceName(NameState* State);
+    constexpr Node* parseUnscopedName(NameState* State, bool* isSubstName);
+    constexpr Node* parseNestedName(NameState* State);
+    constexpr Node* parseCtorDtorName(Node*& SoFar, NameState* State);
+
+    // Hooks for a Derived parser that resumes from a prefix it shares with an
+    // earlier name. parseNestedName calls enterNestedName before the loop over
+    // the components of the <prefix> that starts at PrefixBegin, which may move
+    // First past components whose SoFar and Subs it restores, and
+    // leaveNestedNamePrefix after each component.
+    constexpr void enterNestedName(const char* /*PrefixBegin*/, NameState* /*State*/, Node*& /*SoFar*/) {}
+    constexpr void leaveNestedNamePrefix(const char* /*PrefixBegin*/, NameState* /*State*/, Node* /*SoFar*/) {}
+
+    constexpr Node* parseAbiTags(Node* N);
 
     struct OperatorInfo {
         enum OIKind : unsigned char {
@@ -3161,13 +3304,7 @@ struct AbstractManglingParser {
           Name{N} {}
 
     public:
-        bool operator<(const OperatorInfo& Other) const { return *this < Other.Enc; }
-        bool operator<(const char* Peek) const { return Enc[0] < Peek[0] || (Enc[0] == Peek[0] && Enc[1] < Peek[1]); }
-        bool operator==(const char* Peek) const { return Enc[0] == Peek[0] && Enc[1] == Peek[1]; }
-        bool operator!=(const char* Peek) const { return !this->operator==(Peek); }
-
-    public:
-        std::string_view getSymbol() const {
+        constexpr std::string_view getSymbol() const {
             std::string_view Res = Name;
             if (Kind < Unnameable) {
                 DEMANGLE_ASSERT(starts_with(Res, "operator"), "operator name does not start with 'operator'");
@@ -3176,27 +3313,181 @@ struct AbstractManglingParser {
             }
             return Res;
         }
-        std::string_view getName() const { return Name; }
-        OIKind           getKind() const { return Kind; }
-        bool             getFlag() const { return Flag; }
-        Node::Prec       getPrecedence() const { return Prec; }
+        constexpr std::string_view getName() const { return Name; }
+        constexpr OIKind           getKind() const { return Kind; }
+        constexpr bool             getFlag() const { return Flag; }
+        constexpr Node::Prec       getPrecedence() const { return Prec; }
     };
-    static const OperatorInfo Ops[];
-    static const size_t       NumOps;
-    const OperatorInfo*       parseOperatorEncoding();
+
+    // Operator encodings
+    static constexpr OperatorInfo Ops[] = {
+        // Keep ordered by encoding
+        {"aN", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator&="       },
+        {"aS", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator="        },
+        {"aa", OperatorInfo::Binary,      false,           Node::Prec::AndIf,          "operator&&"       },
+        {"ad", OperatorInfo::Prefix,      false,           Node::Prec::Unary,          "operator&"        },
+        {"an", OperatorInfo::Binary,      false,           Node::Prec::And,            "operator&"        },
+        {"at", OperatorInfo::OfIdOp,      /*Type*/ true,   Node::Prec::Unary,          "alignof "         },
+        {"aw", OperatorInfo::NameOnly,    false,           Node::Prec::Primary,        "operator co_await"},
+        {"az", OperatorInfo::OfIdOp,      /*Type*/ false,  Node::Prec::Unary,          "alignof "         },
+        {"cc", OperatorInfo::NamedCast,   false,           Node::Prec::Postfix,        "const_cast"       },
+        {"cl", OperatorInfo::Call,        false,           Node::Prec::Postfix,        "operator()"       },
+        {"cm", OperatorInfo::Binary,      false,           Node::Prec::Comma,          "operator,"        },
+        {"co", OperatorInfo::Prefix,      false,           Node::Prec::Unary,          "operator~"        },
+        {"cv", OperatorInfo::CCast,       false,           Node::Prec::Cast,           "operator"         }, // C Cast
+        {"dV", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator/="       },
+        {"da", OperatorInfo::Del,         /*Ary*/ true,    Node::Prec::Unary,          "operator delete[]"},
+        {"dc", OperatorInfo::NamedCast,   false,           Node::Prec::Postfix,        "dynamic_cast"     },
+        {"de", OperatorInfo::Prefix,      false,           Node::Prec::Unary,          "operator*"        },
+        {"dl", OperatorInfo::Del,         /*Ary*/ false,   Node::Prec::Unary,          "operator delete"  },
+        {"ds", OperatorInfo::Member,      /*Named*/ false, Node::Prec::PtrMem,         "operator.*"       },
+        {"dt", OperatorInfo::Member,      /*Named*/ false, Node::Prec::Postfix,        "operator."        },
+        {"dv", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator/"        },
+        {"eO", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator^="       },
+        {"eo", OperatorInfo::Binary,      false,           Node::Prec::Xor,            "operator^"        },
+        {"eq", OperatorInfo::Binary,      false,           Node::Prec::Equality,       "operator=="       },
+        {"ge", OperatorInfo::Binary,      false,           Node::Prec::Relational,     "operator>="       },
+        {"gt", OperatorInfo::Binary,      false,           Node::Prec::Relational,     "operator>"        },
+        {"ix", OperatorInfo::Array,       false,           Node::Prec::Postfix,        "operator[]"       },
+        {"lS", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator<<="      },
+        {"le", OperatorInfo::Binary,      false,           Node::Prec::Relational,     "operator<="       },
+        {"ls", OperatorInfo::Binary,      false,           Node::Prec::Shift,          "operator<<"       },
+        {"lt", OperatorInfo::Binary,      false,           Node::Prec::Relational,     "operator<"        },
+        {"mI", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator-="       },
+        {"mL", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator*="       },
+        {"mi", OperatorInfo::Binary,      false,           Node::Prec::Additive,       "operator-"        },
+        {"ml", OperatorInfo::Binary,      false,           Node::Prec::Multiplicative, "operator*"        },
+        {"mm", OperatorInfo::Postfix,     false,           Node::Prec::Postfix,        "operator--"       },
+        {"na", OperatorInfo::New,         /*Ary*/ true,    Node::Prec::Unary,          "operator new[]"   },
+        {"ne", OperatorInfo::Binary,      false,           Node::Prec::Equality,       "operator!="       },
+        {"ng", OperatorInfo::Prefix,      false,           Node::Prec::Unary,          "operator-"        },
+        {"nt", OperatorInfo::Prefix,      false,           Node::Prec::Unary,          "operator!"        },
+        {"nw", OperatorInfo::New,         /*Ary*/ false,   Node::Prec::Unary,          "operator new"     },
+        {"oR", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator|="       },
+        {"oo", OperatorInfo::Binary,      false,           Node::Prec::OrIf,           "operator||"       },
+        {"or", OperatorInfo::Binary,      false,           Node::Prec::Ior,            "operator|"        },
+        {"pL", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator+="       },
+        {"pl", OperatorInfo::Binary,      false,           Node::Prec::Additive,       "operator+"        },
+        {"pm", OperatorInfo::Member,      /*Named*/ false, Node::Prec::PtrMem,         "operator->*"      },
+        {"pp", OperatorInfo::Postfix,     false,           Node::Prec::Postfix,        "operator++"       },
+        {"ps", OperatorInfo::Prefix,      false,           Node::Prec::Unary,          "operator+"        },
+        {"pt", OperatorInfo::Member,      /*Named*/ true,  Node::Prec::Postfix,        "operator->"       },
+        {"qu", OperatorInfo::Conditional, false,           Node::Prec::Conditional,    "operator?"        },
+        {"rM", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator%="       },
+        {"rS", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator>>="      },
+        {"rc", OperatorInfo::NamedCast,   false,           Node::Prec::Postfix,        "reinterpret_cast" },
+        {"rm", OperatorInfo::Binary,      false,           Node::Prec::Multiplicative, "operator%"        },
+        {"rs", OperatorInfo::Binary,      false,           Node::Prec::Shift,          "operator>>"       },
+        {"sc", OperatorInfo::NamedCast,   false,           Node::Prec::Postfix,        "static_cast"      },
+        {"ss", OperatorInfo::Binary,      false,           Node::Prec::Spaceship,      "operator<=>"      },
+        {"st", OperatorInfo::OfIdOp,      /*Type*/ true,   Node::Prec::Unary,          "sizeof "          },
+        {"sz", OperatorInfo::OfIdOp,      /*Type*/ false,  Node::Prec::Unary,          "sizeof "          },
+        {"te", OperatorInfo::OfIdOp,      /*Type*/ false,  Node::Prec::Postfix,        "typeid "          },
+        {"ti", OperatorInfo::OfIdOp,      /*Type*/ true,   Node::Prec::Postfix,        "typeid "          },
+    };
+    static constexpr EncodingIndex OpIndex{Ops};
+    static_assert(OpIndex.isValid(), "operator encodings must be distinct pairs of letters");
+
+    constexpr const OperatorInfo* parseOperatorEncoding();
+
+    // A <builtin-type> that is only a name.
+    struct BuiltinTypeInfo {
+        char        Enc[2]; // Encoding, NUL-padded
+        const char* Name;   // Spelling
+
+        template <size_t N>
+        constexpr BuiltinTypeInfo(const char (&E)[N], const char* Nm)
+        : Enc{E[0], E[1]},
+          Name{Nm} {}
+    };
+
+    static constexpr BuiltinTypeInfo BuiltinTypes[] = {
+        {"v",  "void"              }, // void
+        {"w",  "wchar_t"           }, // wchar_t
+        {"b",  "bool"              }, // bool
+        {"c",  "char"              }, // char
+        {"a",  "signed char"       }, // signed char
+        {"h",  "unsigned char"     }, // unsigned char
+        {"s",  "short"             }, // short
+        {"t",  "unsigned short"    }, // unsigned short
+        {"i",  "int"               }, // int
+        {"j",  "unsigned int"      }, // unsigned int
+        {"l",  "long"              }, // long
+        {"m",  "unsigned long"     }, // unsigned long
+        {"x",  "long long"         }, // long long, __int64
+        {"y",  "unsigned long long"}, // unsigned long long, __int64
+        {"n",  "__int128"          }, // __int128
+        {"o",  "unsigned __int128" }, // unsigned __int128
+        {"f",  "float"             }, // float
+        {"d",  "double"            }, // double
+        {"e",  "long double"       }, // long double, __float80
+        {"g",  "__float128"        }, // __float128
+        {"z",  "..."               }, // ellipsis
+        {"Dd", "decimal64"         }, // IEEE 754r decimal floating point (64 bits)
+        {"De", "decimal128"        }, // IEEE 754r decimal floating point (128 bits)
+        {"Df", "decimal32"         }, // IEEE 754r decimal floating point (32 bits)
+        {"Dh", "half"              }, // IEEE 754r half-precision floating point (16 bits)
+        {"Di", "char32_t"          }, // char32_t
+        {"Ds", "char16_t"          }, // char16_t
+        {"Du", "char8_t"           }, // char8_t (C++2a, not yet in the Itanium spec)
+        {"Da", "auto"              }, // auto (in dependent new-expressions)
+        {"Dc", "decltype(auto)"    }, // decltype(auto)
+        {"Dn", "std::nullptr_t"    }, // std::nullptr_t (i.e., decltype(nullptr))
+    };
+    static constexpr EncodingIndex BuiltinTypeIndex{BuiltinTypes};
+    static_assert(BuiltinTypeIndex.isValid(), "builtin type encodings must be distinct");
+
+    // A <substitution> for a std:: entity, which is not a substitution
+    // candidate itself.
+    struct SpecialSubInfo {
+        char           Enc[2]; // Encoding
+        SpecialSubKind Kind;
+    };
+
+    static constexpr SpecialSubInfo SpecialSubs[] = {
+        {{'S', 'a'}, SpecialSubKind::allocator   }, // std::allocator
+        {{'S', 'b'}, SpecialSubKind::basic_string}, // std::basic_string
+        {{'S', 'd'}, SpecialSubKind::iostream    }, // std::basic_iostream<char, std::char_traits<char> >
+        {{'S', 'i'}, SpecialSubKind::istream     }, // std::basic_istream<char, std::char_traits<char> >
+        {{'S', 'o'}, SpecialSubKind::ostream     }, // std::basic_ostream<char, std::char_traits<char> >
+        {{'S', 's'}, SpecialSubKind::string      }, // std::basic_string<char, ...>
+    };
+    static constexpr EncodingIndex SpecialSubIndex{SpecialSubs};
+    static_assert(SpecialSubIndex.isValid(), "special substitution encodings must be distinct");
 
     /// Parse the <unresolved-name> production.
-    Node* parseUnresolvedName(bool Global);
-    Node* parseSimpleId();
-    Node* parseBaseUnresolvedName();
-    Node* parseUnresolvedType();
-    Node* parseDestructorName();
+    constexpr Node* parseUnresolvedName(bool Global);
+    constexpr Node* parseSimpleId();
+    constexpr Node* parseBaseUnresolvedName();
+    constexpr Node* parseUnresolvedType();
+    constexpr Node* parseDestructorName();
 
     /// Top-level entry point into the parser.
-    Node* parse(bool ParseParams = true);
+    constexpr Node* parse(bool ParseParams = true);
 };
 
-const char* parse_discriminator(const char* first, const char* last);
+// <discriminator> := _ <non-negative number>      # when number < 10
+//                 := __ <non-negative number> _   # when number >= 10
+//  extension      := decimal-digit+               # at the end of string
+constexpr const char* parse_discriminator(const char* first, const char* last) {
+    // parse but ignore discriminator
+    if (first != last) {
+        if (*first == '_') {
+            const char* t1 = first + 1;
+            if (t1 != last) {
+                if (is_digit(*t1)) first = t1 + 1;
+                else if (*t1 == '_') {
+                    ++t1;
+                    t1 += span_digits(std::string_view(t1, last - t1));
+                    if (t1 != last && *t1 == '_') first = t1 + 1;
+                }
+            }
+        } else if (is_digit(*first)) {
+            if (span_digits(std::string_view(first, last - first)) == size_t(last - first)) first = last;
+        }
+    }
+    return first;
+}
 
 // <name> ::= <nested-name> // N
 //        ::= <local-name> # See Scope Encoding below  // Z
@@ -3206,7 +3497,11 @@ const char* parse_discriminator(const char* first, const char* last);
 // <unscoped-template-name> ::= <unscoped-name>
 //                          ::= <substitution>
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseName(NameState* State) {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseName(NameState* State) {
+    DEMANGLE_PROFILE_SCOPE(ItaniumName);
+    DEMANGLE_STATS_DEPTH();
+    detail::LimitTracker::Scope LimitScope(Limits);
+    if (Limits.Exceeded) return nullptr;
     if (look() == 'N') return getDerived().parseNestedName(State);
     if (look() == 'Z') return getDerived().parseLocalName(State);
 
@@ -3237,7 +3532,8 @@ Node* AbstractManglingParser<Derived, Alloc>::parseName(NameState* State) {
 //              := Z <function encoding> E s [<discriminator>]
 //              := Z <function encoding> Ed [ <parameter number> ] _ <entity name>
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseLocalName(NameState* State) {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseLocalName(NameState* State) {
+    DEMANGLE_PROFILE_SCOPE(ItaniumLocalName);
     if (!consumeIf('Z')) return nullptr;
     Node* Encoding = getDerived().parseEncoding();
     if (Encoding == nullptr || !consumeIf('E')) return nullptr;
@@ -3271,7 +3567,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseLocalName(NameState* State) {
 //                 ::= St <unqualified-name>   # ::std::
 // [*] extension
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseUnscopedName(NameState* State, bool* IsSubst) {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseUnscopedName(NameState* State, bool* IsSubst) {
 
     Node* Std = nullptr;
     if (consumeIf("St")) {
@@ -3307,7 +3603,9 @@ Node* AbstractManglingParser<Derived, Alloc>::parseUnscopedName(NameState* State
 //			# structured binding declaration
 //                    ::= [<module-name>] L? DC <source-name>+ E
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseUnqualifiedName(NameState* State, Node* Scope, ModuleName* Module) {
+constexpr Node*
+AbstractManglingParser<Derived, Alloc>::parseUnqualifiedName(NameState* State, Node* Scope, ModuleName* Module) {
+    DEMANGLE_PROFILE_SCOPE(ItaniumUnqualifiedName);
     if (getDerived().parseModuleNameOpt(Module)) return nullptr;
 
     bool IsMemberLikeFriend = Scope && consumeIf('F');
@@ -3350,7 +3648,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseUnqualifiedName(NameState* St
 // <module-subname> ::= W <source-name>
 //		    ::= W P <source-name>
 template <typename Derived, typename Alloc>
-bool AbstractManglingParser<Derived, Alloc>::parseModuleNameOpt(ModuleName*& Module) {
+constexpr bool AbstractManglingParser<Derived, Alloc>::parseModuleNameOpt(ModuleName*& Module) {
     while (consumeIf('W')) {
         bool  IsPartition = consumeIf('P');
         Node* Sub         = getDerived().parseSourceName(nullptr);
@@ -3370,7 +3668,7 @@ bool AbstractManglingParser<Derived, Alloc>::parseModuleNameOpt(ModuleName*& Mod
 // <lambda-sig> ::= <template-param-decl>* [Q <requires-clause expression>]
 //                  <parameter type>+  # or "v" if the lambda has no parameters
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseUnnamedTypeName(NameState* State) {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseUnnamedTypeName(NameState* State) {
     // <template-params> refer to the innermost <template-args>. Clear out any
     // outer args that we may have inserted into TemplateParams.
     if (State != nullptr) TemplateParams.clear();
@@ -3453,7 +3751,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseUnnamedTypeName(NameState* St
 
 // <source-name> ::= <positive length number> <identifier>
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseSourceName(NameState*) {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseSourceName(NameState*) {
     size_t Length = 0;
     if (parsePositiveInteger(&Length)) return nullptr;
     if (numLeft() < Length || Length == 0) return nullptr;
@@ -3463,102 +3761,25 @@ Node* AbstractManglingParser<Derived, Alloc>::parseSourceName(NameState*) {
     return make<NameType>(Name);
 }
 
-// Operator encodings
-template <typename Derived, typename Alloc>
-const typename AbstractManglingParser<Derived, Alloc>::OperatorInfo AbstractManglingParser<Derived, Alloc>::Ops[] = {
-    // Keep ordered by encoding
-    {"aN", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator&="       },
-    {"aS", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator="        },
-    {"aa", OperatorInfo::Binary,      false,           Node::Prec::AndIf,          "operator&&"       },
-    {"ad", OperatorInfo::Prefix,      false,           Node::Prec::Unary,          "operator&"        },
-    {"an", OperatorInfo::Binary,      false,           Node::Prec::And,            "operator&"        },
-    {"at", OperatorInfo::OfIdOp,      /*Type*/ true,   Node::Prec::Unary,          "alignof "         },
-    {"aw", OperatorInfo::NameOnly,    false,           Node::Prec::Primary,        "operator co_await"},
-    {"az", OperatorInfo::OfIdOp,      /*Type*/ false,  Node::Prec::Unary,          "alignof "         },
-    {"cc", OperatorInfo::NamedCast,   false,           Node::Prec::Postfix,        "const_cast"       },
-    {"cl", OperatorInfo::Call,        false,           Node::Prec::Postfix,        "operator()"       },
-    {"cm", OperatorInfo::Binary,      false,           Node::Prec::Comma,          "operator,"        },
-    {"co", OperatorInfo::Prefix,      false,           Node::Prec::Unary,          "operator~"        },
-    {"cv", OperatorInfo::CCast,       false,           Node::Prec::Cast,           "operator"         }, // C Cast
-    {"dV", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator/="       },
-    {"da", OperatorInfo::Del,         /*Ary*/ true,    Node::Prec::Unary,          "operator delete[]"},
-    {"dc", OperatorInfo::NamedCast,   false,           Node::Prec::Postfix,        "dynamic_cast"     },
-    {"de", OperatorInfo::Prefix,      false,           Node::Prec::Unary,          "operator*"        },
-    {"dl", OperatorInfo::Del,         /*Ary*/ false,   Node::Prec::Unary,          "operator delete"  },
-    {"ds", OperatorInfo::Member,      /*Named*/ false, Node::Prec::PtrMem,         "operator.*"       },
-    {"dt", OperatorInfo::Member,      /*Named*/ false, Node::Prec::Postfix,        "operator."        },
-    {"dv", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator/"        },
-    {"eO", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator^="       },
-    {"eo", OperatorInfo::Binary,      false,           Node::Prec::Xor,            "operator^"        },
-    {"eq", OperatorInfo::Binary,      false,           Node::Prec::Equality,       "operator=="       },
-    {"ge", OperatorInfo::Binary,      false,           Node::Prec::Relational,     "operator>="       },
-    {"gt", OperatorInfo::Binary,      false,           Node::Prec::Relational,     "operator>"        },
-    {"ix", OperatorInfo::Array,       false,           Node::Prec::Postfix,        "operator[]"       },
-    {"lS", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator<<="      },
-    {"le", OperatorInfo::Binary,      false,           Node::Prec::Relational,     "operator<="       },
-    {"ls", OperatorInfo::Binary,      false,           Node::Prec::Shift,          "operator<<"       },
-    {"lt", OperatorInfo::Binary,      false,           Node::Prec::Relational,     "operator<"        },
-    {"mI", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator-="       },
-    {"mL", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator*="       },
-    {"mi", OperatorInfo::Binary,      false,           Node::Prec::Additive,       "operator-"        },
-    {"ml", OperatorInfo::Binary,      false,           Node::Prec::Multiplicative, "operator*"        },
-    {"mm", OperatorInfo::Postfix,     false,           Node::Prec::Postfix,        "operator--"       },
-    {"na", OperatorInfo::New,         /*Ary*/ true,    Node::Prec::Unary,          "operator new[]"   },
-    {"ne", OperatorInfo::Binary,      false,           Node::Prec::Equality,       "operator!="       },
-    {"ng", OperatorInfo::Prefix,      false,           Node::Prec::Unary,          "operator-"        },
-    {"nt", OperatorInfo::Prefix,      false,           Node::Prec::Unary,          "operator!"        },
-    {"nw", OperatorInfo::New,         /*Ary*/ false,   Node::Prec::Unary,          "operator new"     },
-    {"oR", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator|="       },
-    {"oo", OperatorInfo::Binary,      false,           Node::Prec::OrIf,           "operator||"       },
-    {"or", OperatorInfo::Binary,      false,           Node::Prec::Ior,            "operator|"        },
-    {"pL", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator+="       },
-    {"pl", OperatorInfo::Binary,      false,           Node::Prec::Additive,       "operator+"        },
-    {"pm", OperatorInfo::Member,      /*Named*/ false, Node::Prec::PtrMem,         "operator->*"      },
-    {"pp", OperatorInfo::Postfix,     false,           Node::Prec::Postfix,        "operator++"       },
-    {"ps", OperatorInfo::Prefix,      false,           Node::Prec::Unary,          "operator+"        },
-    {"pt", OperatorInfo::Member,      /*Named*/ true,  Node::Prec::Postfix,        "operator->"       },
-    {"qu", OperatorInfo::Conditional, false,           Node::Prec::Conditional,    "operator?"        },
-    {"rM", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator%="       },
-    {"rS", OperatorInfo::Binary,      false,           Node::Prec::Assign,         "operator>>="      },
-    {"rc", OperatorInfo::NamedCast,   false,           Node::Prec::Postfix,        "reinterpret_cast" },
-    {"rm", OperatorInfo::Binary,      false,           Node::Prec::Multiplicative, "operator%"        },
-    {"rs", OperatorInfo::Binary,      false,           Node::Prec::Shift,          "operator>>"       },
-    {"sc", OperatorInfo::NamedCast,   false,           Node::Prec::Postfix,        "static_cast"      },
-    {"ss", OperatorInfo::Binary,      false,           Node::Prec::Spaceship,      "operator<=>"      },
-    {"st", OperatorInfo::OfIdOp,      /*Type*/ true,   Node::Prec::Unary,          "sizeof "          },
-    {"sz", OperatorInfo::OfIdOp,      /*Type*/ false,  Node::Prec::Unary,          "sizeof "          },
-    {"te", OperatorInfo::OfIdOp,      /*Type*/ false,  Node::Prec::Postfix,        "typeid "          },
-    {"ti", OperatorInfo::OfIdOp,      /*Type*/ true,   Node::Prec::Postfix,        "typeid "          },
-};
-template <typename Derived, typename Alloc>
-const size_t AbstractManglingParser<Derived, Alloc>::NumOps = sizeof(Ops) / sizeof(Ops[0]);
-
 // If the next 2 chars are an operator encoding, consume them and return their
 // OperatorInfo.  Otherwise return nullptr.
 template <typename Derived, typename Alloc>
-const typename AbstractManglingParser<Derived, Alloc>::OperatorInfo*
+constexpr const typename AbstractManglingParser<Derived, Alloc>::OperatorInfo*
 AbstractManglingParser<Derived, Alloc>::parseOperatorEncoding() {
     if (numLeft() < 2) return nullptr;
 
-    // We can't use lower_bound as that can link to symbols in the C++ library,
-    // and this must remain independent of that.
-    size_t lower = 0u, upper = NumOps - 1; // Inclusive bounds.
-    while (upper != lower) {
-        size_t middle = (upper + lower) / 2;
-        if (Ops[middle] < First) lower = middle + 1;
-        else upper = middle;
-    }
-    if (Ops[lower] != First) return nullptr;
+    unsigned Entry = OpIndex.find(First[0], First[1]);
+    if (Entry == 0) return nullptr;
 
     First += 2;
-    return &Ops[lower];
+    return &Ops[Entry - 1];
 }
 
 //   <operator-name> ::= See parseOperatorEncoding()
 //                   ::= li <source-name>  # operator ""
 //                   ::= v <digit> <source-name>  # vendor extended operator
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseOperatorName(NameState* State) {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseOperatorName(NameState* State) {
     if (const auto* Op = parseOperatorEncoding()) {
         if (Op->getKind() == OperatorInfo::CCast) {
             //              ::= cv <type>    # (cast)
@@ -3616,7 +3837,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseOperatorName(NameState* State
 //   extension      ::= D4  # gcc old-style "[unified]" destructor
 //   extension      ::= D5  # the COMDAT used for dtors
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseCtorDtorName(Node*& SoFar, NameState* State) {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseCtorDtorName(Node*& SoFar, NameState* State) {
     if (SoFar->getKind() == Node::KSpecialSubstitution) {
         // Expand the special substitution.
         SoFar = make<ExpandedSpecialSubstitution>(static_cast<SpecialSubstitution*>(SoFar));
@@ -3665,7 +3886,8 @@ Node* AbstractManglingParser<Derived, Alloc>::parseCtorDtorName(Node*& SoFar, Na
 //                   ::= <template-param>
 //                   ::= <substitution>
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseNestedName(NameState* State) {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseNestedName(NameState* State) {
+    DEMANGLE_PROFILE_SCOPE(ItaniumNestedName);
     if (!consumeIf('N')) return nullptr;
 
     // 'H' specifies that the encoding that follows
@@ -3685,7 +3907,9 @@ Node* AbstractManglingParser<Derived, Alloc>::parseNestedName(NameState* State)
         State->HasExplicitObjectParameter = true;
     }
 
-    Node* SoFar = nullptr;
+    Node*       SoFar       = nullptr;
+    const char* PrefixBegin = First;
+    getDerived().enterNestedName(PrefixBegin, State, SoFar);
     while (!consumeIf('E')) {
         if (State)
             // Only set end-with-template on the case that does that.
@@ -3744,6 +3968,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseNestedName(NameState* State)
         // No longer used.
         // <data-member-prefix> := <member source-name> [<template-args>] M
         consumeIf('M');
+        getDerived().leaveNestedNamePrefix(PrefixBegin, State, SoFar);
     }
 
     if (SoFar == nullptr || Subs.empty()) return nullptr;
@@ -3754,7 +3979,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseNestedName(NameState* State)
 
 // <simple-id> ::= <source-name> [ <template-args> ]
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseSimpleId() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseSimpleId() {
     Node* SN = getDerived().parseSourceName(/*NameState=*/nullptr);
     if (SN == nullptr) return nullptr;
     if (look() == 'I') {
@@ -3768,9 +3993,9 @@ Node* AbstractManglingParser<Derived, Alloc>::parseSimpleId() {
 // <destructor-name> ::= <unresolved-type>  # e.g., ~T or ~decltype(f())
 //                   ::= <simple-id>        # e.g., ~A<2*N>
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseDestructorName() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseDestructorName() {
     Node* Result;
-    if (std::isdigit(look())) Result = getDerived().parseSimpleId();
+    if (is_digit(look())) Result = getDerived().parseSimpleId();
     else Result = getDerived().parseUnresolvedType();
     if (Result == nullptr) return nullptr;
     return make<DtorName>(Result);
@@ -3780,7 +4005,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseDestructorName() {
 //                   ::= <decltype>
 //                   ::= <substitution>
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseUnresolvedType() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseUnresolvedType() {
     if (look() == 'T') {
         Node* TP = getDerived().parseTemplateParam();
         if (TP == nullptr) return nullptr;
@@ -3804,8 +4029,8 @@ Node* AbstractManglingParser<Derived, Alloc>::parseUnresolvedType() {
 //                        ::= dn <destructor-name>                       # destructor or pseudo-destructor;
 //                                                                         # e.g. ~X or ~X<N-1>
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseBaseUnresolvedName() {
-    if (std::isdigit(look())) return getDerived().parseSimpleId();
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseBaseUnresolvedName() {
+    if (is_digit(look())) return getDerived().parseSimpleId();
 
     if (consumeIf("dn")) return getDerived().parseDestructorName();
 
@@ -3834,7 +4059,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseBaseUnresolvedName() {
 //
 // <unresolved-qualifier-level> ::= <simple-id>
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseUnresolvedName(bool Global) {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseUnresolvedName(bool Global) {
     Node* SoFar = nullptr;
 
     // srN <unresolved-type> [<template-args>] <unresolved-qualifier-level>* E <base-unresolved-name>
@@ -3871,7 +4096,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseUnresolvedName(bool Global) {
     }
 
     // [gs] sr <unresolved-qualifier-level>+ E   <base-unresolved-name>
-    if (std::isdigit(look())) {
+    if (is_digit(look())) {
         do {
             Node* Qual = getDerived().parseSimpleId();
             if (Qual == nullptr) return nullptr;
@@ -3905,7 +4130,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseUnresolvedName(bool Global) {
 // <abi-tags> ::= <abi-tag> [<abi-tags>]
 // <abi-tag> ::= B <source-name>
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseAbiTags(Node* N) {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseAbiTags(Node* N) {
     while (consumeIf('B')) {
         std::string_view SN = parseBareSourceName();
         if (SN.empty()) return nullptr;
@@ -3917,17 +4142,18 @@ Node* AbstractManglingParser<Derived, Alloc>::parseAbiTags(Node* N) {
 
 // <number> ::= [n] <non-negative decimal integer>
 template <typename Alloc, typename Derived>
-std::string_view AbstractManglingParser<Alloc, Derived>::parseNumber(bool AllowNegative) {
+constexpr std::string_view AbstractManglingParser<Alloc, Derived>::parseNumber(bool AllowNegative) {
     const char* Tmp = First;
     if (AllowNegative) consumeIf('n');
-    if (numLeft() == 0 || !std::isdigit(*First)) return std::string_view();
-    while (numLeft() != 0 && std::isdigit(*First)) ++First;
+    size_t Digits = span_digits(std::string_view(First, numLeft()));
+    if (Digits == 0) return std::string_view();
+    First += Digits;
     return std::string_view(Tmp, First - Tmp);
 }
 
 // <positive length number> ::= [0-9]*
 template <typename Alloc, typename Derived>
-bool AbstractManglingParser<Alloc, Derived>::parsePositiveInteger(size_t* Out) {
+constexpr bool AbstractManglingParser<Alloc, Derived>::parsePositiveInteger(size_t* Out) {
     *Out = 0;
     if (look() < '0' || look() > '9') return true;
     while (look() >= '0' && look() <= '9') {
@@ -3938,7 +4164,7 @@ bool AbstractManglingParser<Alloc, Derived>::parsePositiveInteger(size_t* Out) {
 }
 
 template <typename Alloc, typename Derived>
-std::string_view AbstractManglingParser<Alloc, Derived>::parseBareSourceName() {
+constexpr std::string_view AbstractManglingParser<Alloc, Derived>::parseBareSourceName() {
     size_t Int = 0;
     if (parsePositiveInteger(&Int) || numLeft() < Int) return {};
     std::string_view R(First, Int);
@@ -3955,7 +4181,8 @@ std::string_view AbstractManglingParser<Alloc, Derived>::parseBareSourceName() {
 // <ref-qualifier> ::= R                   # & ref-qualifier
 // <ref-qualifier> ::= O                   # && ref-qualifier
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseFunctionType() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseFunctionType() {
+    DEMANGLE_PROFILE_SCOPE(ItaniumFunctionType);
     Qualifiers CVQuals = parseCVQualifiers();
 
     Node* ExceptionSpec = nullptr;
@@ -4013,7 +4240,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseFunctionType() {
 // <extended element type> ::= <element type>
 //                         ::= p # AltiVec vector pixel
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseVectorType() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseVectorType() {
     if (!consumeIf("Dv")) return nullptr;
     if (look() >= '1' && look() <= '9') {
         Node* DimensionNumber = make<NameType>(parseNumber());
@@ -4041,7 +4268,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseVectorType() {
 // <decltype>  ::= Dt <expression> E  # decltype of an id-expression or class member access (C++0x)
 //             ::= DT <expression> E  # decltype of an expression (C++0x)
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseDecltype() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseDecltype() {
     if (!consumeIf('D')) return nullptr;
     if (!consumeIf('t') && !consumeIf('T')) return nullptr;
     Node* E = getDerived().parseExpr();
@@ -4053,12 +4280,12 @@ Node* AbstractManglingParser<Derived, Alloc>::parseDecltype() {
 // <array-type> ::= A <positive dimension number> _ <element type>
 //              ::= A [<dimension expression>] _ <element type>
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseArrayType() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseArrayType() {
     if (!consumeIf('A')) return nullptr;
 
     Node* Dimension = nullptr;
 
-    if (std::isdigit(look())) {
+    if (is_digit(look())) {
         Dimension = make<NameType>(parseNumber());
         if (!Dimension) return nullptr;
         if (!consumeIf('_')) return nullptr;
@@ -4076,7 +4303,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseArrayType() {
 
 // <pointer-to-member-type> ::= M <class type> <member type>
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parsePointerToMemberType() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parsePointerToMemberType() {
     if (!consumeIf('M')) return nullptr;
     Node* ClassType = getDerived().parseType();
     if (ClassType == nullptr) return nullptr;
@@ -4090,7 +4317,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parsePointerToMemberType() {
 //                   ::= Tu <name>  # dependent elaborated type specifier using 'union'
 //                   ::= Te <name>  # dependent elaborated type specifier using 'enum'
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseClassEnumType() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseClassEnumType() {
     std::string_view ElabSpef;
     if (consumeIf("Ts")) ElabSpef = "struct";
     else if (consumeIf("Tu")) ElabSpef = "union";
@@ -4108,7 +4335,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseClassEnumType() {
 // <qualifiers> ::= <extended-qualifier>* <CV-qualifiers>
 // <extended-qualifier> ::= U <source-name> [<template-args>] # vendor extended type qualifier
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseQualifiedType() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseQualifiedType() {
     if (consumeIf('U')) {
         std::string_view Qual = parseBareSourceName();
         if (Qual.empty()) return nullptr;
@@ -4168,9 +4395,20 @@ Node* AbstractManglingParser<Derived, Alloc>::parseQualifiedType() {
 // <objc-name> ::= <k0 number> objcproto <k1 number> <identifier>  # k0 = 9 + <number of digits in k1> + k1
 // <objc-type> ::= <source-name>  # PU<11+>objcproto 11objc_object<source-name> 11objc_object -> id<source-name>
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseType() {
-    Node* Result = nullptr;
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseType() {
+    DEMANGLE_PROFILE_SCOPE(ItaniumType);
+    DEMANGLE_STATS_DEPTH();
+    detail::LimitTracker::Scope LimitScope(Limits);
+    if (Limits.Exceeded) return nullptr;
 
+    // <builtin-type>s that are only a name; see BuiltinTypes.
+    if (unsigned Entry = BuiltinTypeIndex.find(look(), look(1))) {
+        const BuiltinTypeInfo& Builtin  = BuiltinTypes[Entry - 1];
+        First                          += Builtin.Enc[1] == '\0' ? 1 : 2;
+        return make<NameType>(Builtin.Name);
+    }
+
+    Node* Result = nullptr;
     switch (look()) {
     //             ::= <qualified-type>
     case 'r':
@@ -4194,91 +4432,6 @@ Node* AbstractManglingParser<Derived, Alloc>::parseType() {
         Result = getDerived().parseQualifiedType();
         break;
     }
-    // <builtin-type> ::= v    # void
-    case 'v':
-        ++First;
-        return make<NameType>("void");
-    //                ::= w    # wchar_t
-    case 'w':
-        ++First;
-        return make<NameType>("wchar_t");
-    //                ::= b    # bool
-    case 'b':
-        ++First;
-        return make<NameType>("bool");
-    //                ::= c    # char
-    case 'c':
-        ++First;
-        return make<NameType>("char");
-    //                ::= a    # signed char
-    case 'a':
-        ++First;
-        return make<NameType>("signed char");
-    //                ::= h    # unsigned char
-    case 'h':
-        ++First;
-        return make<NameType>("unsigned char");
-    //                ::= s    # short
-    case 's':
-        ++First;
-        return make<NameType>("short");
-    //                ::= t    # unsigned short
-    case 't':
-        ++First;
-        return make<NameType>("unsigned short");
-    //                ::= i    # int
-    case 'i':
-        ++First;
-        return make<NameType>("int");
-    //                ::= j    # unsigned int
-    case 'j':
-        ++First;
-        return make<NameType>("unsigned int");
-    //                ::= l    # long
-    case 'l':
-        ++First;
-        return make<NameType>("long");
-    //                ::= m    # unsigned long
-    case 'm':
-        ++First;
-        return make<NameType>("unsigned long");
-    //                ::= x    # long long, __int64
-    case 'x':
-        ++First;
-        return make<NameType>("long long");
-    //                ::= y    # unsigned long long, __int64
-    case 'y':
-        ++First;
-        return make<NameType>("unsigned long long");
-    //                ::= n    # __int128
-    case 'n':
-        ++First;
-        return make<NameType>("__int128");
-    //                ::= o    # unsigned __int128
-    case 'o':
-        ++First;
-        return make<NameType>("unsigned __int128");
-    //                ::= f    # float
-    case 'f':
-        ++First;
-        return make<NameType>("float");
-    //                ::= d    # double
-    case 'd':
-        ++First;
-        return make<NameType>("double");
-    //                ::= e    # long double, __float80
-    case 'e':
-        ++First;
-        return make<NameType>("long double");
-    //                ::= g    # __float128
-    case 'g':
-        ++First;
-        return make<NameType>("__float128");
-    //                ::= z    # ellipsis
-    case 'z':
-        ++First;
-        return make<NameType>("...");
-
     // <builtin-type> ::= u <source-name>    # vendor extended type
     case 'u': {
         ++First;
@@ -4297,22 +4450,6 @@ Node* AbstractManglingParser<Derived, Alloc>::parseType() {
     }
     case 'D':
         switch (look(1)) {
-        //                ::= Dd   # IEEE 754r decimal floating point (64 bits)
-        case 'd':
-            First += 2;
-            return make<NameType>("decimal64");
-        //                ::= De   # IEEE 754r decimal floating point (128 bits)
-        case 'e':
-            First += 2;
-            return make<NameType>("decimal128");
-        //                ::= Df   # IEEE 754r decimal floating point (32 bits)
-        case 'f':
-            First += 2;
-            return make<NameType>("decimal32");
-        //                ::= Dh   # IEEE 754r half-precision floating point (16 bits)
-        case 'h':
-            First += 2;
-            return make<NameType>("half");
         //                ::= DF <number> _ # ISO/IEC TS 18661 binary floating point (N bits)
         case 'F': {
             First                 += 2;
@@ -4329,31 +4466,11 @@ Node* AbstractManglingParser<Derived, Alloc>::parseType() {
         case 'U': {
             bool Signed  = look(1) == 'B';
             First       += 2;
-            Node* Size   = std::isdigit(look()) ? make<NameType>(parseNumber()) : getDerived().parseExpr();
+            Node* Size   = is_digit(look()) ? make<NameType>(parseNumber()) : getDerived().parseExpr();
             if (!Size) return nullptr;
             if (!consumeIf('_')) return nullptr;
             return make<BitIntType>(Size, Signed);
         }
-        //                ::= Di   # char32_t
-        case 'i':
-            First += 2;
-            return make<NameType>("char32_t");
-        //                ::= Ds   # char16_t
-        case 's':
-            First += 2;
-            return make<NameType>("char16_t");
-        //                ::= Du   # char8_t (C++2a, not yet in the Itanium spec)
-        case 'u':
-            First += 2;
-            return make<NameType>("char8_t");
-        //                ::= Da   # auto (in dependent new-expressions)
-        case 'a':
-            First += 2;
-            return make<NameType>("auto");
-        //                ::= Dc   # decltype(auto)
-        case 'c':
-            First += 2;
-            return make<NameType>("decltype(auto)");
         //                ::= Dk <type-constraint> # constrained auto
         //                ::= DK <type-constraint> # constrained decltype(auto)
         case 'k':
@@ -4364,11 +4481,6 @@ Node* AbstractManglingParser<Derived, Alloc>::parseType() {
             if (!Constraint) return nullptr;
             return make<PostfixQualifiedType>(Constraint, Kind);
         }
-        //                ::= Dn   # std::nullptr_t (i.e., decltype(nullptr))
-        case 'n':
-            First += 2;
-            return make<NameType>("std::nullptr_t");
-
         //             ::= <decltype>
         case 't':
         case 'T': {
@@ -4528,14 +4640,14 @@ Node* AbstractManglingParser<Derived, Alloc>::parseType() {
 }
 
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parsePrefixExpr(std::string_view Kind, Node::Prec Prec) {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parsePrefixExpr(std::string_view Kind, Node::Prec Prec) {
     Node* E = getDerived().parseExpr();
     if (E == nullptr) return nullptr;
     return make<PrefixExpr>(Kind, E, Prec);
 }
 
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseBinaryExpr(std::string_view Kind, Node::Prec Prec) {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseBinaryExpr(std::string_view Kind, Node::Prec Prec) {
     Node* LHS = getDerived().parseExpr();
     if (LHS == nullptr) return nullptr;
     Node* RHS = getDerived().parseExpr();
@@ -4544,7 +4656,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseBinaryExpr(std::string_view K
 }
 
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseIntegerLiteral(std::string_view Lit) {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseIntegerLiteral(std::string_view Lit) {
     std::string_view Tmp = parseNumber(true);
     if (!Tmp.empty() && consumeIf('E')) return make<IntegerLiteral>(Lit, Tmp);
     return nullptr;
@@ -4552,7 +4664,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseIntegerLiteral(std::string_vi
 
 // <CV-Qualifiers> ::= [r] [V] [K]
 template <typename Alloc, typename Derived>
-Qualifiers AbstractManglingParser<Alloc, Derived>::parseCVQualifiers() {
+constexpr Qualifiers AbstractManglingParser<Alloc, Derived>::parseCVQualifiers() {
     Qualifiers CVR = QualNone;
     if (consumeIf('r')) CVR |= QualRestrict;
     if (consumeIf('V')) CVR |= QualVolatile;
@@ -4568,7 +4680,7 @@ Qualifiers AbstractManglingParser<Alloc, Derived>::parseCVQualifiers() {
 //                  L > 0, second and later parameters
 //                  ::= fpT      # 'this' expression (not part of standard?)
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseFunctionParam() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseFunctionParam() {
     if (consumeIf("fpT")) return make<NameType>("this");
     if (consumeIf("fp")) {
         parseCVQualifiers();
@@ -4590,7 +4702,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseFunctionParam() {
 // cv <type> <expression>                               # conversion with one argument
 // cv <type> _ <expression>* E                          # conversion with a different number of arguments
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseConversionExpr() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseConversionExpr() {
     if (!consumeIf("cv")) return nullptr;
     Node* Ty;
     {
@@ -4624,7 +4736,8 @@ Node* AbstractManglingParser<Derived, Alloc>::parseConversionExpr() {
 // FIXME:         ::= L <type> <real-part float> _ <imag-part float> E   # complex floating point literal (C 2000)
 //                ::= L <mangled-name> E                                 # external name
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseExprPrimary() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseExprPrimary() {
+    DEMANGLE_PROFILE_SCOPE(ItaniumExprPrimary);
     if (!consumeIf('L')) return nullptr;
     switch (look()) {
     case 'w':
@@ -4732,7 +4845,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseExprPrimary() {
 //                     ::= dx <index expression> <braced-expression>     # [expr] = expr
 //                     ::= dX <range begin expression> <range end expression> <braced-expression>
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseBracedExpr() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseBracedExpr() {
     if (look() == 'd') {
         switch (look(1)) {
         case 'i': {
@@ -4772,7 +4885,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseBracedExpr() {
 //             ::= fl <binary-operator-name> <expression>
 //             ::= fr <binary-operator-name> <expression>
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseFoldExpr() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseFoldExpr() {
     if (!consumeIf('f')) return nullptr;
 
     bool IsLeftFold = false, HasInitializer = false;
@@ -4818,7 +4931,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseFoldExpr() {
 //
 // Not yet in the spec: https://github.com/itanium-cxx-abi/cxx-abi/issues/47
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parsePointerToMemberConversionExpr(Node::Prec Prec) {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parsePointerToMemberConversionExpr(Node::Prec Prec) {
     Node* Ty = getDerived().parseType();
     if (!Ty) return nullptr;
     Node* Expr = getDerived().parseExpr();
@@ -4833,7 +4946,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parsePointerToMemberConversionExpr
 //
 // Not yet in the spec: https://github.com/itanium-cxx-abi/cxx-abi/issues/47
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseSubobjectExpr() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseSubobjectExpr() {
     Node* Ty = getDerived().parseType();
     if (!Ty) return nullptr;
     Node* Expr = getDerived().parseExpr();
@@ -4851,7 +4964,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseSubobjectExpr() {
 }
 
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseConstraintExpr() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseConstraintExpr() {
     // Within this expression, all enclosing template parameter lists are in
     // scope.
     ScopedOverride<bool> SaveIncompleteTemplateParameterTracking(HasIncompleteTemplateParameterTracking, true);
@@ -4859,7 +4972,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseConstraintExpr() {
 }
 
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseRequiresExpr() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseRequiresExpr() {
     NodeArray Params;
     if (consumeIf("rQ")) {
         // <expression> ::= rQ <bare-function-type> _ <requirement>+ E
@@ -4960,7 +5073,11 @@ Node* AbstractManglingParser<Derived, Alloc>::parseRequiresExpr() {
 //              ::= fr <binary-operator-name> <expression>
 //              ::= <expr-primary>
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseExpr() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseExpr() {
+    DEMANGLE_PROFILE_SCOPE(ItaniumExpr);
+    DEMANGLE_STATS_DEPTH();
+    detail::LimitTracker::Scope LimitScope(Limits);
+    if (Limits.Exceeded) return nullptr;
     bool Global = consumeIf("gs");
 
     const auto* Op = parseOperatorEncoding();
@@ -5106,7 +5223,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseExpr() {
     if (look() == 'T') return getDerived().parseTemplateParam();
     if (look() == 'f') {
         // Disambiguate a fold expression from a <function-param>.
-        if (look(1) == 'p' || (look(1) == 'L' && std::isdigit(look(2)))) return getDerived().parseFunctionParam();
+        if (look(1) == 'p' || (look(1) == 'L' && is_digit(look(2)))) return getDerived().parseFunctionParam();
         return getDerived().parseFoldExpr();
     }
     if (consumeIf("il")) {
@@ -5215,7 +5332,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseExpr() {
 // <v-offset>  ::= <offset number> _ <virtual offset number>
 //               # virtual base override, with vcall offset
 template <typename Alloc, typename Derived>
-bool AbstractManglingParser<Alloc, Derived>::parseCallOffset() {
+constexpr bool AbstractManglingParser<Alloc, Derived>::parseCallOffset() {
     // Just scan through the call offset, we never add this information into the
     // output.
     if (consumeIf('h')) return parseNumber(true).empty() || !consumeIf('_');
@@ -5246,7 +5363,8 @@ bool AbstractManglingParser<Alloc, Derived>::parseCallOffset() {
 //      extension ::= GR <object name> # reference temporary for object
 //      extension ::= GI <module name> # module global initializer
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseSpecialName() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseSpecialName() {
+    DEMANGLE_PROFILE_SCOPE(ItaniumSpecialName);
     switch (look()) {
     case 'T':
         switch (look(1)) {
@@ -5370,7 +5488,11 @@ Node* AbstractManglingParser<Derived, Alloc>::parseSpecialName() {
 //            ::= <data name>
 //            ::= <special-name>
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseEncoding(bool ParseParams) {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseEncoding(bool ParseParams) {
+    DEMANGLE_PROFILE_SCOPE(ItaniumEncoding);
+    DEMANGLE_STATS_DEPTH();
+    detail::LimitTracker::Scope LimitScope(Limits);
+    if (Limits.Exceeded) return nullptr;
     // The template parameters of an encoding are unrelated to those of the
     // enclosing context.
     SaveTemplateParams SaveTemplateParamsScope(this);
@@ -5491,7 +5613,7 @@ struct FloatData<long double> {
 
 template <typename Alloc, typename Derived>
 template <class Float>
-Node* AbstractManglingParser<Alloc, Derived>::parseFloatingLiteral() {
+constexpr Node* AbstractManglingParser<Alloc, Derived>::parseFloatingLiteral() {
     const size_t N = FloatData<Float>::mangled_size;
     if (numLeft() <= N) return nullptr;
     std::string_view Data(First, N);
@@ -5504,7 +5626,7 @@ Node* AbstractManglingParser<Alloc, Derived>::parseFloatingLiteral() {
 
 // <seq-id> ::= <0-9A-Z>+
 template <typename Alloc, typename Derived>
-bool AbstractManglingParser<Alloc, Derived>::parseSeqId(size_t* Out) {
+constexpr bool AbstractManglingParser<Alloc, Derived>::parseSeqId(size_t* Out) {
     if (!(look() >= '0' && look() <= '9') && !(look() >= 'A' && look() <= 'Z')) return true;
 
     size_t Id = 0;
@@ -5535,35 +5657,15 @@ bool AbstractManglingParser<Alloc, Derived>::parseSeqId(size_t* Out) {
 // <substitution> ::= Sd # ::std::basic_iostream<char, std::char_traits<char> >
 // The St case is handled specially in parseNestedName.
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseSubstitution() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseSubstitution() {
+    DEMANGLE_PROFILE_SCOPE(ItaniumSubstitution);
     if (!consumeIf('S')) return nullptr;
 
     if (look() >= 'a' && look() <= 'z') {
-        SpecialSubKind Kind;
-        switch (look()) {
-        case 'a':
-            Kind = SpecialSubKind::allocator;
-            break;
-        case 'b':
-            Kind = SpecialSubKind::basic_string;
-            break;
-        case 'd':
-            Kind = SpecialSubKind::iostream;
-            break;
-        case 'i':
-            Kind = SpecialSubKind::istream;
-            break;
-        case 'o':
-            Kind = SpecialSubKind::ostream;
-            break;
-        case 's':
-            Kind = SpecialSubKind::string;
-            break;
-        default:
-            return nullptr;
-        }
+        unsigned Entry = SpecialSubIndex.find('S', look());
+        if (Entry == 0) return nullptr;
         ++First;
-        auto* SpecialSub = make<SpecialSubstitution>(Kind);
+        auto* SpecialSub = make<SpecialSubstitution>(SpecialSubs[Entry - 1].Kind);
         if (!SpecialSub) return nullptr;
 
         // Itanium C++ ABI 5.1.2: If a name that would use a built-in <substitution>
@@ -5596,7 +5698,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseSubstitution() {
 //                  ::= TL <level-1> __
 //                  ::= TL <level-1> _ <parameter-2 non-negative number> _
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseTemplateParam() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseTemplateParam() {
     const char* Begin = First;
     if (!consumeIf('T')) return nullptr;
 
@@ -5656,7 +5758,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseTemplateParam() {
 //                       ::= Tt <template-param-decl>* E # template parameter
 //                       ::= Tp <template-param-decl>    # parameter pack
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseTemplateParamDecl(TemplateParamList* Params) {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseTemplateParamDecl(TemplateParamList* Params) {
     auto InventTemplateParamName = [&](TemplateParamKind Kind) {
         unsigned Index = NumSyntheticTemplateParameters[(int)Kind]++;
         Node*    N     = make<SyntheticTemplateParamName>(Kind, Index);
@@ -5727,7 +5829,11 @@ Node* AbstractManglingParser<Derived, Alloc>::parseTemplateParamDecl(TemplatePar
 //                ::= LZ <encoding> E           # extension
 //                ::= <template-param-decl> <template-arg>
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseTemplateArg() {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseTemplateArg() {
+    DEMANGLE_PROFILE_SCOPE(ItaniumTemplateArg);
+    DEMANGLE_STATS_DEPTH();
+    detail::LimitTracker::Scope LimitScope(Limits);
+    if (Limits.Exceeded) return nullptr;
     switch (look()) {
     case 'X': {
         ++First;
@@ -5774,7 +5880,8 @@ Node* AbstractManglingParser<Derived, Alloc>::parseTemplateArg() {
 // <template-args> ::= I <template-arg>* [Q <requires-clause expr>] E
 //     extension, the abi says <template-arg>+
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parseTemplateArgs(bool TagTemplates) {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parseTemplateArgs(bool TagTemplates) {
+    DEMANGLE_PROFILE_SCOPE(ItaniumTemplateArgs);
     if (!consumeIf('I')) return nullptr;
 
     // <template-params> refer to the innermost <template-args>. Clear out any
@@ -5821,7 +5928,7 @@ Node* AbstractManglingParser<Derived, Alloc>::parseTemplateArgs(bool TagTemplate
 // extension      ::= ___Z <encoding> _block_invoke<decimal-digit>+
 // extension      ::= ___Z <encoding> _block_invoke_<decimal-digit>+
 template <typename Derived, typename Alloc>
-Node* AbstractManglingParser<Derived, Alloc>::parse(bool ParseParams) {
+constexpr Node* AbstractManglingParser<Derived, Alloc>::parse(bool ParseParams) {
     if (consumeIf("_Z") || consumeIf("__Z")) {
         Node* Encoding = getDerived().parseEncoding(ParseParams);
         if (Encoding == nullptr) return nullptr;
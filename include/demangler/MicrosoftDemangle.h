@@ -9,9 +9,22 @@
 #ifndef LLVM_DEMANGLE_MICROSOFTDEMANGLE_H
 #define LLVM_DEMANGLE_MICROSOFTDEMANGLE_H
 
+#include "demangler/DemangleConfig.h"
+#include "demangler/DemangleLimits.h"
+#include "demangler/DemangleProfile.h"
+#include "demangler/DemangleStats.h"
 #include "demangler/MicrosoftDemangleNodes.h"
+#include "demangler/StringViewExtras.h"
+#include "demangler/Utility.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
 namespace demangler {
@@ -32,6 +45,18 @@ class ArenaAllocator {
     };
 
     void addNode(size_t Capacity) {
+        // Prefer a block kept alive by reset() over a fresh allocation.
+        for (AllocatorNode** P = &Spare; *P; P = &(*P)->Next) {
+            AllocatorNode* N = *P;
+            if (N->Capacity < Capacity) continue;
+            *P      = N->Next;
+            N->Next = Head;
+            N->Used = 0;
+            Head    = N;
+            return;
+        }
+
+        DEMANGLE_STATS_ADD(ArenaBlocks, 1);
         AllocatorNode* NewHead = new AllocatorNode;
         NewHead->Buf           = new uint8_t[Capacity];
         NewHead->Next          = Head;
@@ -44,23 +69,54 @@ public:
     ArenaAllocator() { addNode(AllocUnit); }
 
     ~ArenaAllocator() {
-        while (Head) {
-            DEMANGLE_ASSERT(Head->Buf, "ArenaAllocator::~ArenaAllocator");
-            delete[] Head->Buf;
-            AllocatorNode* Next = Head->Next;
-            delete Head;
-            Head = Next;
-        }
+        freeNodes(Head);
+        freeNodes(Spare);
     }
 
     // Delete the copy constructor and the copy assignment operator.
     ArenaAllocator(const ArenaAllocator&)            = delete;
     ArenaAllocator& operator=(const ArenaAllocator&) = delete;
 
+    // Release everything allocated so far without returning any memory to the
+    // system. The oldest block becomes the head again and all other blocks are
+    // reused by later allocations before a new one is created.
+    void reset() {
+        DEMANGLE_ASSERT(Head, "ArenaAllocator::reset");
+        while (Head->Next) {
+            AllocatorNode* Next = Head->Next;
+            Head->Next          = Spare;
+            Spare               = Head;
+            Head                = Next;
+        }
+        Head->Used = 0;
+    }
+
+    // A position in the arena that rewind() can return to.
+    struct Watermark {
+        AllocatorNode* Node;
+        size_t         Used;
+    };
+
+    Watermark watermark() const { return {Head, Head->Used}; }
+
+    // Release what was allocated after W and keep what was allocated before,
+    // like reset() does for everything. W must have been taken since the last
+    // reset().
+    void rewind(Watermark W) {
+        while (Head != W.Node) {
+            AllocatorNode* Next = Head->Next;
+            Head->Next          = Spare;
+            Spare               = Head;
+            Head                = Next;
+        }
+        Head->Used = W.Used;
+    }
+
     char* allocUnalignedBuffer(size_t Size) {
         DEMANGLE_ASSERT(Head && Head->Buf, "ArenaAllocator::allocUnalignedBuffer");
 
         uint8_t* P = Head->Buf + Head->Used;
+        DEMANGLE_STATS_ADD(ArenaBytes, Size);
 
         Head->Used += Size;
         if (Head->Used <= Head->Capacity) return reinterpret_cast<char*>(P);
@@ -79,6 +135,7 @@ public:
         uintptr_t AlignedP   = (((size_t)P + alignof(T) - 1) & ~(size_t)(alignof(T) - 1));
         uint8_t*  PP         = (uint8_t*)AlignedP;
         size_t    Adjustment = AlignedP - P;
+        DEMANGLE_STATS_ADD(ArenaBytes, Size);
 
         Head->Used += Size + Adjustment;
         if (Head->Used <= Head->Capacity) return new (PP) T[Count]();
@@ -97,6 +154,8 @@ public:
         uintptr_t AlignedP   = (((size_t)P + alignof(T) - 1) & ~(size_t)(alignof(T) - 1));
         uint8_t*  PP         = (uint8_t*)AlignedP;
         size_t    Adjustment = AlignedP - P;
+        DEMANGLE_STATS_ADD(ArenaBytes, Size);
+        if constexpr (std::is_base_of_v<Node, T>) DEMANGLE_STATS_ADD(Nodes, 1);
 
         Head->Used += Size + Adjustment;
         if (Head->Used <= Head->Capacity) return new (PP) T(std::forward<Args>(ConstructorArgs)...);
@@ -108,7 +167,44 @@ public:
     }
 
 private:
-    AllocatorNode* Head = nullptr;
+    static void freeNodes(AllocatorNode* N) {
+        while (N) {
+            DEMANGLE_ASSERT(N->Buf, "ArenaAllocator::~ArenaAllocator");
+            delete[] N->Buf;
+            AllocatorNode* Next = N->Next;
+            delete N;
+            N = Next;
+        }
+    }
+
+    AllocatorNode* Head  = nullptr;
+    AllocatorNode* Spare = nullptr;
+};
+
+// An Alloc that counts what it hands out in Limits, which is how the parser
+// keeps to its DemangleLimits without a check at every allocation.
+template <typename Alloc>
+class LimitedAllocator : public Alloc {
+public:
+    detail::LimitTracker Limits;
+
+    template <typename T, typename... Args>
+    constexpr T* alloc(Args&&... ConstructorArgs) {
+        if constexpr (std::is_base_of_v<Node, T>) Limits.addNode(sizeof(T));
+        else Limits.addBytes(sizeof(T));
+        return Alloc::template alloc<T>(std::forward<Args>(ConstructorArgs)...);
+    }
+
+    template <typename T>
+    constexpr T* allocArray(size_t Count) {
+        Limits.addBytes(Count * sizeof(T));
+        return Alloc::template allocArray<T>(Count);
+    }
+
+    constexpr char* allocUnalignedBuffer(size_t Size) {
+        Limits.addBytes(Size);
+        return Alloc::allocUnalignedBuffer(Size);
+    }
 };
 
 struct BackrefContext {
@@ -118,11 +214,32 @@ struct BackrefContext {
     size_t    FunctionParamCount = 0;
 
     // The first 10 BackReferences in a mangled name can be back-referenced by
-    // special name @[0-9]. This is a storage for the first 10 BackReferences.
+    // special name @[0-9]. This is a storage for the first 10 BackReferences,
+    // with the length of each name, which is compared before the name itself
+    // is looked up.
     NamedIdentifierNode* Names[Max];
+    size_t               NameSizes[Max];
     size_t               NamesCount = 0;
+
+    constexpr bool hasName(std::string_view S) const {
+        for (size_t I = 0; I < NamesCount; ++I)
+            if (NameSizes[I] == S.size() && Names[I]->Name == S) return true;
+        return false;
+    }
+};
+
+// The back-reference context of one template argument list. Each nesting
+// depth has one, which every argument list at that depth reuses, so entering
+// an argument list only resets two counts.
+struct BackrefFrame : BackrefContext {
+    // The frame of the next depth, in the arena, once one was needed.
+    BackrefFrame* Inner = nullptr;
 };
 
+// Where memorizeIdentifier renders template names before they are compared
+// with the back-reference table. Each thread has one, which keeps its memory.
+OutputBuffer& getBackrefScratchBuffer();
+
 enum class QualifierMangleMode { Drop, Mangle, Result };
 
 enum NameBackrefBehavior : uint8_t {
@@ -133,106 +250,554 @@ enum NameBackrefBehavior : uint8_t {
 
 enum class FunctionIdentifierCodeGroup { Basic, Under, DoubleUnder };
 
-// Demangler class takes the main role in demangling symbols.
-// It has a set of functions to parse mangled symbols into Type instances.
-// It also has a set of functions to convert Type instances to strings.
-class Demangler {
+constexpr bool startsWithDigit(std::string_view S) { return !S.empty() && S.front() >= '0' && S.front() <= '9'; }
+
+struct NodeList {
+    Node*     N    = nullptr;
+    NodeList* Next = nullptr;
+};
+
+constexpr bool consumeFront(std::string_view& S, char C) {
+    if (!demangler::itanium_demangle::starts_with(S, C)) return false;
+    S.remove_prefix(1);
+    return true;
+}
+
+constexpr bool consumeFront(std::string_view& S, std::string_view C) {
+    if (!demangler::itanium_demangle::starts_with(S, C)) return false;
+    S.remove_prefix(C.size());
+    return true;
+}
+
+constexpr bool consumeFront(std::string_view& S, std::string_view PrefixA, std::string_view PrefixB, bool A) {
+    const std::string_view& Prefix = A ? PrefixA : PrefixB;
+    return consumeFront(S, Prefix);
+}
+
+constexpr bool startsWith(std::string_view S, std::string_view PrefixA, std::string_view PrefixB, bool A) {
+    const std::string_view& Prefix = A ? PrefixA : PrefixB;
+    return demangler::itanium_demangle::starts_with(S, Prefix);
+}
+
+constexpr bool isMemberPointer(std::string_view MangledName, bool& Error) {
+    Error        = false;
+    const char F = MangledName.front();
+    MangledName.remove_prefix(1);
+    switch (F) {
+    case '$':
+        // This is probably an rvalue reference (e.g. $$Q), and you cannot have an
+        // rvalue reference to a member.
+        return false;
+    case 'A':
+        // 'A' indicates a reference, and you cannot have a reference to a member
+        // function or member.
+        return false;
+    case 'P':
+    case 'Q':
+    case 'R':
+    case 'S':
+        // These 4 values indicate some kind of pointer, but we still don't know
+        // what.
+        break;
+    default:
+        // isMemberPointer() is called only if isPointerType() returns true,
+        // and it rejects other prefixes.
+        DEMANGLE_UNREACHABLE;
+    }
+
+    // If it starts with a number, then 6 indicates a non-member function
+    // pointer, and 8 indicates a member function pointer.
+    if (startsWithDigit(MangledName)) {
+        if (MangledName[0] != '6' && MangledName[0] != '8') {
+            Error = true;
+            return false;
+        }
+        return (MangledName[0] == '8');
+    }
+
+    // Remove ext qualifiers since those can appear on either type and are
+    // therefore not indicative.
+    consumeFront(MangledName, 'E'); // 64-bit
+    consumeFront(MangledName, 'I'); // restrict
+    consumeFront(MangledName, 'F'); // unaligned
+
+    if (MangledName.empty()) {
+        Error = true;
+        return false;
+    }
+
+    // The next value should be either ABCD (non-member) or QRST (member).
+    switch (MangledName.front()) {
+    case 'A':
+    case 'B':
+    case 'C':
+    case 'D':
+        return false;
+    case 'Q':
+    case 'R':
+    case 'S':
+    case 'T':
+        return true;
+    default:
+        Error = true;
+        return false;
+    }
+}
+
+constexpr SpecialIntrinsicKind consumeSpecialIntrinsicKind(std::string_view& MangledName) {
+    if (consumeFront(MangledName, "?_7")) return SpecialIntrinsicKind::Vftable;
+    if (consumeFront(MangledName, "?_8")) return SpecialIntrinsicKind::Vbtable;
+    if (consumeFront(MangledName, "?_9")) return SpecialIntrinsicKind::VcallThunk;
+    if (consumeFront(MangledName, "?_A")) return SpecialIntrinsicKind::Typeof;
+    if (consumeFront(MangledName, "?_B")) return SpecialIntrinsicKind::LocalStaticGuard;
+    if (consumeFront(MangledName, "?_C")) return SpecialIntrinsicKind::StringLiteralSymbol;
+    if (consumeFront(MangledName, "?_P")) return SpecialIntrinsicKind::UdtReturning;
+    if (consumeFront(MangledName, "?_R0")) return SpecialIntrinsicKind::RttiTypeDescriptor;
+    if (consumeFront(MangledName, "?_R1")) return SpecialIntrinsicKind::RttiBaseClassDescriptor;
+    if (consumeFront(MangledName, "?_R2")) return SpecialIntrinsicKind::RttiBaseClassArray;
+    if (consumeFront(MangledName, "?_R3")) return SpecialIntrinsicKind::RttiClassHierarchyDescriptor;
+    if (consumeFront(MangledName, "?_R4")) return SpecialIntrinsicKind::RttiCompleteObjLocator;
+    if (consumeFront(MangledName, "?_S")) return SpecialIntrinsicKind::LocalVftable;
+    if (consumeFront(MangledName, "?__E")) return SpecialIntrinsicKind::DynamicInitializer;
+    if (consumeFront(MangledName, "?__F")) return SpecialIntrinsicKind::DynamicAtexitDestructor;
+    if (consumeFront(MangledName, "?__J")) return SpecialIntrinsicKind::LocalStaticThreadGuard;
+    return SpecialIntrinsicKind::None;
+}
+
+constexpr bool startsWithLocalScopePattern(std::string_view S) {
+    if (!consumeFront(S, '?')) return false;
+
+    size_t End = S.find('?');
+    if (End == std::string_view::npos) return false;
+    std::string_view Candidate = S.substr(0, End);
+    if (Candidate.empty()) return false;
+
+    // \?[0-9]\?
+    // ?@? is the discriminator 0.
+    if (Candidate.size() == 1) return Candidate[0] == '@' || (Candidate[0] >= '0' && Candidate[0] <= '9');
+
+    // If it's not 0-9, then it's an encoded number terminated with an @
+    if (Candidate.back() != '@') return false;
+    Candidate.remove_suffix(1);
+
+    // An encoded number starts with B-P and all subsequent digits are in A-P.
+    // Note that the reason the first digit cannot be A is two fold.  First, it
+    // would create an ambiguity with ?A which delimits the beginning of an
+    // anonymous namespace.  Second, A represents 0, and you don't start a multi
+    // digit number with a leading 0.  Presumably the anonymous namespace
+    // ambiguity is also why single digit encoded numbers use 0-9 rather than A-J.
+    if (Candidate[0] < 'B' || Candidate[0] > 'P') return false;
+    Candidate.remove_prefix(1);
+    while (!Candidate.empty()) {
+        if (Candidate[0] < 'A' || Candidate[0] > 'P') return false;
+        Candidate.remove_prefix(1);
+    }
+
+    return true;
+}
+
+constexpr bool isTagType(std::string_view S) {
+    switch (S.front()) {
+    case 'T': // union
+    case 'U': // struct
+    case 'V': // class
+    case 'W': // enum
+        return true;
+    }
+    return false;
+}
+
+constexpr bool isCustomType(std::string_view S) { return S[0] == '?'; }
+
+constexpr bool isPointerType(std::string_view S) {
+    if (demangler::itanium_demangle::starts_with(S, "$$Q")) // foo &&
+        return true;
+
+    switch (S.front()) {
+    case 'A': // foo &
+    case 'P': // foo *
+    case 'Q': // foo *const
+    case 'R': // foo *volatile
+    case 'S': // foo *const volatile
+        return true;
+    }
+    return false;
+}
+
+constexpr bool isArrayType(std::string_view S) { return S[0] == 'Y'; }
+
+constexpr bool isFunctionType(std::string_view S) {
+    return demangler::itanium_demangle::starts_with(S, "$$A8@@") || demangler::itanium_demangle::starts_with(S, "$$A6");
+}
+
+constexpr FunctionRefQualifier demangleFunctionRefQualifier(std::string_view& MangledName) {
+    if (consumeFront(MangledName, 'G')) return FunctionRefQualifier::Reference;
+    else if (consumeFront(MangledName, 'H')) return FunctionRefQualifier::RValueReference;
+    return FunctionRefQualifier::None;
+}
+
+constexpr std::pair<Qualifiers, PointerAffinity> demanglePointerCVQualifiers(std::string_view& MangledName) {
+    if (consumeFront(MangledName, "$$Q")) return std::make_pair(Q_None, PointerAffinity::RValueReference);
+
+    const char F = MangledName.front();
+    MangledName.remove_prefix(1);
+    switch (F) {
+    case 'A':
+        return std::make_pair(Q_None, PointerAffinity::Reference);
+    case 'P':
+        return std::make_pair(Q_None, PointerAffinity::Pointer);
+    case 'Q':
+        return std::make_pair(Q_Const, PointerAffinity::Pointer);
+    case 'R':
+        return std::make_pair(Q_Volatile, PointerAffinity::Pointer);
+    case 'S':
+        return std::make_pair(Qualifiers(Q_Const | Q_Volatile), PointerAffinity::Pointer);
+    }
+    // This function is only called if isPointerType() returns true,
+    // and it only returns true for the six cases listed above.
+    DEMANGLE_UNREACHABLE;
+}
+
+template <typename Alloc>
+constexpr NamedIdentifierNode* synthesizeNamedIdentifier(Alloc& Arena, std::string_view Name) {
+    NamedIdentifierNode* Id = Arena.template alloc<NamedIdentifierNode>();
+    Id->Name                = Name;
+    return Id;
+}
+
+template <typename Alloc>
+constexpr QualifiedNameNode* synthesizeQualifiedName(Alloc& Arena, IdentifierNode* Identifier) {
+    QualifiedNameNode* QN    = Arena.template alloc<QualifiedNameNode>();
+    QN->Components           = Arena.template alloc<NodeArrayNode>();
+    QN->Components->Count    = 1;
+    QN->Components->Nodes    = Arena.template allocArray<Node*>(1);
+    QN->Components->Nodes[0] = Identifier;
+    return QN;
+}
+
+template <typename Alloc>
+constexpr QualifiedNameNode* synthesizeQualifiedName(Alloc& Arena, std::string_view Name) {
+    NamedIdentifierNode* Id = synthesizeNamedIdentifier(Arena, Name);
+    return synthesizeQualifiedName(Arena, Id);
+}
+
+template <typename Alloc>
+constexpr VariableSymbolNode* synthesizeVariable(Alloc& Arena, TypeNode* Type, std::string_view VariableName) {
+    VariableSymbolNode* VSN = Arena.template alloc<VariableSymbolNode>();
+    VSN->Type               = Type;
+    VSN->Name               = synthesizeQualifiedName(Arena, VariableName);
+    return VSN;
+}
+
+constexpr bool isRebasedHexDigit(char C) { return (C >= 'A' && C <= 'P'); }
+
+constexpr uint8_t rebasedHexDigitToNumber(char C) {
+    assert(isRebasedHexDigit(C));
+    return (C <= 'J') ? (C - 'A') : (10 + C - 'K');
+}
+
+constexpr void writeHexDigit(char* Buffer, uint8_t Digit) {
+    assert(Digit <= 15);
+    *Buffer = (Digit < 10) ? ('0' + Digit) : ('A' + Digit - 10);
+}
+
+constexpr void outputHex(OutputBuffer& OB, unsigned C) {
+    assert(C != 0);
+
+    // It's easier to do the math if we can work from right to left, but we need
+    // to print the numbers from left to right.  So render this into a temporary
+    // buffer first, then output the temporary buffer.  Each byte is of the form
+    // \xAB, which means that each byte needs 4 characters.  Since there are at
+    // most 4 bytes, we need a 4*4+1 = 17 character temporary buffer.
+    char TempBuffer[17] = {};
+
+    constexpr int MaxPos = sizeof(TempBuffer) - 1;
+
+    int Pos = MaxPos - 1; // TempBuffer[MaxPos] is the terminating \0.
+    while (C != 0) {
+        for (int I = 0; I < 2; ++I) {
+            writeHexDigit(&TempBuffer[Pos--], C % 16);
+            C /= 16;
+        }
+    }
+    TempBuffer[Pos--] = 'x';
+    assert(Pos >= 0);
+    TempBuffer[Pos--] = '\\';
+    OB << std::string_view(&TempBuffer[Pos + 1]);
+}
+
+constexpr void outputEscapedChar(OutputBuffer& OB, unsigned C) {
+    switch (C) {
+    case '\0': // nul
+        OB << "\\0";
+        return;
+    case '\'': // single quote
+        OB << "\\\'";
+        return;
+    case '\"': // double quote
+        OB << "\\\"";
+        return;
+    case '\\': // backslash
+        OB << "\\\\";
+        return;
+    case '\a': // bell
+        OB << "\\a";
+        return;
+    case '\b': // backspace
+        OB << "\\b";
+        return;
+    case '\f': // form feed
+        OB << "\\f";
+        return;
+    case '\n': // new line
+        OB << "\\n";
+        return;
+    case '\r': // carriage return
+        OB << "\\r";
+        return;
+    case '\t': // tab
+        OB << "\\t";
+        return;
+    case '\v': // vertical tab
+        OB << "\\v";
+        return;
+    default:
+        break;
+    }
+
+    if (C > 0x1F && C < 0x7F) {
+        // Standard ascii char.
+        OB << (char)C;
+        return;
+    }
+
+    outputHex(OB, C);
+}
+
+constexpr unsigned countTrailingNullBytes(const uint8_t* StringBytes, int Length) {
+    const uint8_t* End   = StringBytes + Length - 1;
+    unsigned       Count = 0;
+    while (Length > 0 && *End == 0) {
+        --Length;
+        --End;
+        ++Count;
+    }
+    return Count;
+}
+
+constexpr unsigned countEmbeddedNulls(const uint8_t* StringBytes, unsigned Length) {
+    unsigned Result = 0;
+    for (unsigned I = 0; I < Length; ++I) {
+        if (*StringBytes++ == 0) ++Result;
+    }
+    return Result;
+}
+
+// A mangled (non-wide) string literal stores the total length of the string it
+// refers to (passed in NumBytes), and it contains up to 32 bytes of actual text
+// (passed in StringBytes, NumChars).
+constexpr unsigned guessCharByteSize(const uint8_t* StringBytes, unsigned NumChars, uint64_t NumBytes) {
+    assert(NumBytes > 0);
+
+    // If the number of bytes is odd, this is guaranteed to be a char string.
+    if (NumBytes % 2 == 1) return 1;
+
+    // All strings can encode at most 32 bytes of data.  If it's less than that,
+    // then we encoded the entire string.  In this case we check for a 1-byte,
+    // 2-byte, or 4-byte null terminator.
+    if (NumBytes < 32) {
+        unsigned TrailingNulls = countTrailingNullBytes(StringBytes, NumChars);
+        if (TrailingNulls >= 4 && NumBytes % 4 == 0) return 4;
+        if (TrailingNulls >= 2) return 2;
+        return 1;
+    }
+
+    // The whole string was not able to be encoded.  Try to look at embedded null
+    // terminators to guess.  The heuristic is that we count all embedded null
+    // terminators.  If more than 2/3 are null, it's a char32.  If more than 1/3
+    // are null, it's a char16.  Otherwise it's a char8.  This obviously isn't
+    // perfect and is biased towards languages that have ascii alphabets, but this
+    // was always going to be best effort since the encoding is lossy.
+    unsigned Nulls = countEmbeddedNulls(StringBytes, NumChars);
+    if (Nulls >= 2 * NumChars / 3 && NumBytes % 4 == 0) return 4;
+    if (Nulls >= NumChars / 3) return 2;
+    return 1;
+}
+
+constexpr unsigned decodeMultiByteChar(const uint8_t* StringBytes, unsigned CharIndex, unsigned CharBytes) {
+    assert(CharBytes == 1 || CharBytes == 2 || CharBytes == 4);
+    unsigned Offset = CharIndex * CharBytes;
+    unsigned Result = 0;
+    StringBytes     = StringBytes + Offset;
+    for (unsigned I = 0; I < CharBytes; ++I) {
+        unsigned C  = static_cast<unsigned>(StringBytes[I]);
+        Result     |= C << (8 * I);
+    }
+    return Result;
+}
+
+template <typename Alloc>
+constexpr NodeArrayNode* nodeListToNodeArray(Alloc& Arena, NodeList* Head, size_t Count) {
+    NodeArrayNode* N = Arena.template alloc<NodeArrayNode>();
+    N->Count         = Count;
+    N->Nodes         = Arena.template allocArray<Node*>(Count);
+    for (size_t I = 0; I < Count; ++I) {
+        N->Nodes[I] = Head->N;
+        Head        = Head->Next;
+    }
+    return N;
+}
+
+// MicrosoftDemanglerBase is a recursive-descent parser for MSVC-style mangled
+// names. Like AbstractManglingParser for Itanium, it is a CRTP base: every
+// production calls the next one through getDerived(), so a derived class can
+// replace any production by declaring a member with the same signature, and
+// the call is bound statically.
+//
+//   struct NoTemplateArgs : MicrosoftDemanglerBase<NoTemplateArgs> {
+//       NodeArrayNode* demangleTemplateParameterList(std::string_view& MangledName);
+//   };
+//
+// Demangler below provides the same productions as virtual functions.
+template <typename Derived, typename Alloc = ArenaAllocator>
+class MicrosoftDemanglerBase {
 public:
-    Demangler()          = default;
-    virtual ~Demangler() = default;
+    MicrosoftDemanglerBase() = default;
+
+    MicrosoftDemanglerBase(const MicrosoftDemanglerBase&)            = delete;
+    MicrosoftDemanglerBase& operator=(const MicrosoftDemanglerBase&) = delete;
+
+    constexpr Derived& getDerived() { return static_cast<Derived&>(*this); }
 
     // You are supposed to call parse() first and then check if error is true.  If
     // it is false, call output() to write the formatted name to the given stream.
-    virtual SymbolNode* parse(std::string_view& MangledName);
+    constexpr SymbolNode* parse(std::string_view& MangledName);
 
-    virtual TagTypeNode* parseTagUniqueName(std::string_view& MangledName);
+    // Like parse(), but stop after the fully qualified name of functions and
+    // variables and return it. Other symbols are parsed in full and their name
+    // is returned, or the symbol itself if it has none.
+    constexpr Node* parseName(std::string_view& MangledName);
+
+    constexpr TagTypeNode* parseTagUniqueName(std::string_view& MangledName);
+
+    // Forget the previous symbol so that another one can be parsed. The arena
+    // keeps its blocks, which makes every node from earlier parses invalid.
+    constexpr void reset();
 
     // True if an error occurred.
     bool Error = false;
 
-    virtual void dumpBackReferences();
+    void dumpBackReferences();
+
+    // Hooks for a Derived demangler that resumes from a prefix it shares with
+    // an earlier name. demangleDeclaratorName calls resumeSymbolName first,
+    // which may consume a name and return it as QN, and otherwise parses the
+    // name and calls symbolNameParsed with where it began.
+    constexpr bool resumeSymbolName(std::string_view& /*MangledName*/, QualifiedNameNode*& /*QN*/) { return false; }
+    constexpr void
+    symbolNameParsed(const char* /*Begin*/, std::string_view /*MangledName*/, QualifiedNameNode* /*QN*/) {}
 
 public:
-    virtual SymbolNode* demangleEncodedSymbol(std::string_view& MangledName, QualifiedNameNode* QN);
-    virtual SymbolNode* demangleDeclarator(std::string_view& MangledName);
-    virtual SymbolNode* demangleMD5Name(std::string_view& MangledName);
-    virtual SymbolNode* demangleTypeinfoName(std::string_view& MangledName);
+    constexpr SymbolNode* demangleEncodedSymbol(std::string_view& MangledName, QualifiedNameNode* QN);
+    constexpr SymbolNode* demangleDeclarator(std::string_view& MangledName);
+    constexpr SymbolNode* demangleMD5Name(std::string_view& MangledName);
+    constexpr SymbolNode* demangleTypeinfoName(std::string_view& MangledName);
 
-    virtual VariableSymbolNode* demangleVariableEncoding(std::string_view& MangledName, StorageClass SC);
-    virtual FunctionSymbolNode* demangleFunctionEncoding(std::string_view& MangledName);
+    constexpr QualifiedNameNode* demangleDeclaratorName(std::string_view& MangledName);
 
-    virtual Qualifiers demanglePointerExtQualifiers(std::string_view& MangledName);
+    constexpr VariableSymbolNode* demangleVariableEncoding(std::string_view& MangledName, StorageClass SC);
+    constexpr FunctionSymbolNode* demangleFunctionEncoding(std::string_view& MangledName);
+
+    constexpr Qualifiers demanglePointerExtQualifiers(std::string_view& MangledName);
 
     // Parser functions. This is a recursive-descent parser.
-    virtual TypeNode*              demangleType(std::string_view& MangledName, QualifierMangleMode QMM);
-    virtual PrimitiveTypeNode*     demanglePrimitiveType(std::string_view& MangledName);
-    virtual CustomTypeNode*        demangleCustomType(std::string_view& MangledName);
-    virtual TagTypeNode*           demangleClassType(std::string_view& MangledName);
-    virtual PointerTypeNode*       demanglePointerType(std::string_view& MangledName);
-    virtual PointerTypeNode*       demangleMemberPointerType(std::string_view& MangledName);
-    virtual FunctionSignatureNode* demangleFunctionType(std::string_view& MangledName, bool HasThisQuals);
+    constexpr TypeNode*              demangleType(std::string_view& MangledName, QualifierMangleMode QMM);
+    constexpr PrimitiveTypeNode*     demanglePrimitiveType(std::string_view& MangledName);
+    constexpr CustomTypeNode*        demangleCustomType(std::string_view& MangledName);
+    constexpr TagTypeNode*           demangleClassType(std::string_view& MangledName);
+    constexpr PointerTypeNode*       demanglePointerType(std::string_view& MangledName);
+    constexpr PointerTypeNode*       demangleMemberPointerType(std::string_view& MangledName);
+    constexpr FunctionSignatureNode* demangleFunctionType(std::string_view& MangledName, bool HasThisQuals);
 
-    virtual ArrayTypeNode* demangleArrayType(std::string_view& MangledName);
+    constexpr ArrayTypeNode* demangleArrayType(std::string_view& MangledName);
 
-    virtual NodeArrayNode* demangleFunctionParameterList(std::string_view& MangledName, bool& IsVariadic);
-    virtual NodeArrayNode* demangleTemplateParameterList(std::string_view& MangledName);
+    constexpr NodeArrayNode* demangleFunctionParameterList(std::string_view& MangledName, bool& IsVariadic);
+    constexpr NodeArrayNode* demangleTemplateParameterList(std::string_view& MangledName);
 
-    virtual std::pair<uint64_t, bool> demangleNumber(std::string_view& MangledName);
-    virtual uint64_t                  demangleUnsigned(std::string_view& MangledName);
-    virtual int64_t                   demangleSigned(std::string_view& MangledName);
+    constexpr std::pair<uint64_t, bool> demangleNumber(std::string_view& MangledName);
+    constexpr uint64_t                  demangleUnsigned(std::string_view& MangledName);
+    constexpr int64_t                   demangleSigned(std::string_view& MangledName);
 
-    virtual void memorizeString(std::string_view s);
-    virtual void memorizeIdentifier(IdentifierNode* Identifier);
+    constexpr void memorizeString(std::string_view s);
+    constexpr void memorizeIdentifier(IdentifierNode* Identifier);
+    constexpr void addBackrefName(std::string_view S);
+    constexpr void resetBackrefs();
 
     /// Allocate a copy of \p Borrowed into memory that we own.
-    virtual std::string_view copyString(std::string_view Borrowed);
+    constexpr std::string_view copyString(std::string_view Borrowed);
 
-    virtual QualifiedNameNode* demangleFullyQualifiedTypeName(std::string_view& MangledName);
-    virtual QualifiedNameNode* demangleFullyQualifiedSymbolName(std::string_view& MangledName);
+    constexpr QualifiedNameNode* demangleFullyQualifiedTypeName(std::string_view& MangledName);
+    constexpr QualifiedNameNode* demangleFullyQualifiedSymbolName(std::string_view& MangledName);
 
-    virtual IdentifierNode* demangleUnqualifiedTypeName(std::string_view& MangledName, bool Memorize);
-    virtual IdentifierNode* demangleUnqualifiedSymbolName(std::string_view& MangledName, NameBackrefBehavior NBB);
+    constexpr IdentifierNode* demangleUnqualifiedTypeName(std::string_view& MangledName, bool Memorize);
+    constexpr IdentifierNode* demangleUnqualifiedSymbolName(std::string_view& MangledName, NameBackrefBehavior NBB);
 
-    virtual QualifiedNameNode* demangleNameScopeChain(std::string_view& MangledName, IdentifierNode* UnqualifiedName);
-    virtual IdentifierNode*    demangleNameScopePiece(std::string_view& MangledName);
+    constexpr QualifiedNameNode* demangleNameScopeChain(std::string_view& MangledName, IdentifierNode* UnqualifiedName);
+    constexpr IdentifierNode*    demangleNameScopePiece(std::string_view& MangledName);
 
-    virtual NamedIdentifierNode* demangleBackRefName(std::string_view& MangledName);
-    virtual IdentifierNode* demangleTemplateInstantiationName(std::string_view& MangledName, NameBackrefBehavior NBB);
-    virtual IntrinsicFunctionKind translateIntrinsicFunctionCode(char CH, FunctionIdentifierCodeGroup Group);
-    virtual IdentifierNode*       demangleFunctionIdentifierCode(std::string_view& MangledName);
-    virtual IdentifierNode*
-    demangleFunctionIdentifierCode(std::string_view& MangledName, FunctionIdentifierCodeGroup Group);
-    virtual StructorIdentifierNode* demangleStructorIdentifier(std::string_view& MangledName, bool IsDestructor);
-    virtual ConversionOperatorIdentifierNode* demangleConversionOperatorIdentifier(std::string_view& MangledName);
-    virtual LiteralOperatorIdentifierNode*    demangleLiteralOperatorIdentifier(std::string_view& MangledName);
+    constexpr NamedIdentifierNode*  demangleBackRefName(std::string_view& MangledName);
+    constexpr IdentifierNode*       demangleTemplateInstantiationName(
+        std::string_view&   MangledName,
+        NameBackrefBehavior NBB
+    );
+    constexpr IntrinsicFunctionKind translateIntrinsicFunctionCode(char CH, FunctionIdentifierCodeGroup Group);
+    constexpr IdentifierNode*       demangleFunctionIdentifierCode(std::string_view& MangledName);
+    constexpr IdentifierNode* demangleFunctionIdentifierCode(
+        std::string_view&           MangledName,
+        FunctionIdentifierCodeGroup Group
+    );
 
-    virtual SymbolNode* demangleSpecialIntrinsic(std::string_view& MangledName);
-    virtual SpecialTableSymbolNode*
-    demangleSpecialTableSymbolNode(std::string_view& MangledName, SpecialIntrinsicKind SIK);
-    virtual LocalStaticGuardVariableNode* demangleLocalStaticGuard(std::string_view& MangledName, bool IsThread);
-    virtual VariableSymbolNode* demangleUntypedVariable(std::string_view& MangledName, std::string_view VariableName);
-    virtual VariableSymbolNode* demangleRttiBaseClassDescriptorNode(std::string_view& MangledName);
-    virtual FunctionSymbolNode* demangleInitFiniStub(std::string_view& MangledName, bool IsDestructor);
+    constexpr StructorIdentifierNode*           demangleStructorIdentifier(
+        std::string_view& MangledName,
+        bool              IsDestructor
+    );
+    constexpr ConversionOperatorIdentifierNode* demangleConversionOperatorIdentifier(std::string_view& MangledName);
+    constexpr LiteralOperatorIdentifierNode*    demangleLiteralOperatorIdentifier(std::string_view& MangledName);
 
-    virtual NamedIdentifierNode*      demangleSimpleName(std::string_view& MangledName, bool Memorize);
-    virtual NamedIdentifierNode*      demangleAnonymousNamespaceName(std::string_view& MangledName);
-    virtual NamedIdentifierNode*      demangleLocallyScopedNamePiece(std::string_view& MangledName);
-    virtual EncodedStringLiteralNode* demangleStringLiteral(std::string_view& MangledName);
-    virtual FunctionSymbolNode*       demangleVcallThunkNode(std::string_view& MangledName);
+    constexpr SymbolNode*             demangleSpecialIntrinsic(std::string_view& MangledName);
+    constexpr SpecialTableSymbolNode* demangleSpecialTableSymbolNode(
+        std::string_view&    MangledName,
+        SpecialIntrinsicKind SIK
+    );
+    constexpr LocalStaticGuardVariableNode* demangleLocalStaticGuard(std::string_view& MangledName, bool IsThread);
+    constexpr VariableSymbolNode* demangleUntypedVariable(std::string_view& MangledName, std::string_view VariableName);
+    constexpr VariableSymbolNode* demangleRttiBaseClassDescriptorNode(std::string_view& MangledName);
+    constexpr FunctionSymbolNode* demangleInitFiniStub(std::string_view& MangledName, bool IsDestructor);
 
-    virtual std::string_view demangleSimpleString(std::string_view& MangledName, bool Memorize);
+    constexpr NamedIdentifierNode*      demangleSimpleName(std::string_view& MangledName, bool Memorize);
+    constexpr NamedIdentifierNode*      demangleAnonymousNamespaceName(std::string_view& MangledName);
+    constexpr NamedIdentifierNode*      demangleLocallyScopedNamePiece(std::string_view& MangledName);
+    constexpr EncodedStringLiteralNode* demangleStringLiteral(std::string_view& MangledName);
+    constexpr FunctionSymbolNode*       demangleVcallThunkNode(std::string_view& MangledName);
 
-    virtual FuncClass    demangleFunctionClass(std::string_view& MangledName);
-    virtual CallingConv  demangleCallingConvention(std::string_view& MangledName);
-    virtual StorageClass demangleVariableStorageClass(std::string_view& MangledName);
-    virtual bool         demangleThrowSpecification(std::string_view& MangledName);
-    virtual wchar_t      demangleWcharLiteral(std::string_view& MangledName);
-    virtual uint8_t      demangleCharLiteral(std::string_view& MangledName);
+    constexpr std::string_view demangleSimpleString(std::string_view& MangledName, bool Memorize);
 
-    virtual std::pair<Qualifiers, bool> demangleQualifiers(std::string_view& MangledName);
+    constexpr FuncClass    demangleFunctionClass(std::string_view& MangledName);
+    constexpr CallingConv  demangleCallingConvention(std::string_view& MangledName);
+    constexpr StorageClass demangleVariableStorageClass(std::string_view& MangledName);
+    constexpr bool         demangleThrowSpecification(std::string_view& MangledName);
+    constexpr wchar_t      demangleWcharLiteral(std::string_view& MangledName);
+    constexpr uint8_t      demangleCharLiteral(std::string_view& MangledName);
 
-    // Memory allocator.
-    ArenaAllocator Arena;
+    constexpr std::pair<Qualifiers, bool> demangleQualifiers(std::string_view& MangledName);
+
+    // Memory allocator. It also keeps track of the DemangleLimits of the
+    // parse, and once they are exceeded the productions that recurse fail.
+    LimitedAllocator<Alloc> Arena;
+
+    // Decorations of the nodes in Arena, for clients of this class to fill
+    // and read; see NodeDecorations. Cleared with the arena by reset().
+    NodeDecorationTable Decorations;
 
     // A single type uses one global back-ref table for all function params.
     // This means back-refs can even go "into" other types.  Examples:
@@ -247,9 +812,2141 @@ public:
     //  // back-ref map.
     //  using F = void(*)(int*);
     //  F G(int *);
-    BackrefContext Backrefs;
+    //
+    // Template argument lists have contexts of their own, nested in a stack of
+    // frames. Backrefs is the frame of the innermost list being parsed.
+    BackrefFrame  RootBackrefs;
+    BackrefFrame* Backrefs = &RootBackrefs;
+};
+
+template <typename Derived, typename Alloc>
+constexpr std::string_view MicrosoftDemanglerBase<Derived, Alloc>::copyString(std::string_view Borrowed) {
+    char* Stable = Arena.allocUnalignedBuffer(Borrowed.size());
+    // This is not a micro-optimization, it avoids UB, should Borrowed be an null
+    // buffer.
+    if (Borrowed.size()) std::copy_n(Borrowed.data(), Borrowed.size(), Stable);
+
+    return {Stable, Borrowed.size()};
+}
+
+template <typename Derived, typename Alloc>
+constexpr SpecialTableSymbolNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleSpecialTableSymbolNode(
+    std::string_view&    MangledName,
+    SpecialIntrinsicKind K
+) {
+    NamedIdentifierNode* NI = Arena.template alloc<NamedIdentifierNode>();
+    switch (K) {
+    case SpecialIntrinsicKind::Vftable:
+        NI->Name = "`vftable'";
+        break;
+    case SpecialIntrinsicKind::Vbtable:
+        NI->Name = "`vbtable'";
+        break;
+    case SpecialIntrinsicKind::LocalVftable:
+        NI->Name = "`local vftable'";
+        break;
+    case SpecialIntrinsicKind::RttiCompleteObjLocator:
+        NI->Name = "`RTTI Complete Object Locator'";
+        break;
+    default:
+        DEMANGLE_UNREACHABLE;
+    }
+    QualifiedNameNode*      QN   = getDerived().demangleNameScopeChain(MangledName, NI);
+    SpecialTableSymbolNode* STSN = Arena.template alloc<SpecialTableSymbolNode>();
+    STSN->Name                   = QN;
+    bool IsMember                = false;
+    if (MangledName.empty()) {
+        Error = true;
+        return nullptr;
+    }
+    char Front = MangledName.front();
+    MangledName.remove_prefix(1);
+    if (Front != '6' && Front != '7') {
+        Error = true;
+        return nullptr;
+    }
+
+    std::tie(STSN->Quals, IsMember) = getDerived().demangleQualifiers(MangledName);
+    if (!consumeFront(MangledName, '@')) STSN->TargetName = getDerived().demangleFullyQualifiedTypeName(MangledName);
+    return STSN;
+}
+
+template <typename Derived, typename Alloc>
+constexpr LocalStaticGuardVariableNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleLocalStaticGuard(std::string_view& MangledName, bool IsThread) {
+    LocalStaticGuardIdentifierNode* LSGI = Arena.template alloc<LocalStaticGuardIdentifierNode>();
+    LSGI->IsThread                       = IsThread;
+    QualifiedNameNode*            QN     = getDerived().demangleNameScopeChain(MangledName, LSGI);
+    LocalStaticGuardVariableNode* LSGVN  = Arena.template alloc<LocalStaticGuardVariableNode>();
+    LSGVN->Name                          = QN;
+
+    if (consumeFront(MangledName, "4IA")) LSGVN->IsVisible = false;
+    else if (consumeFront(MangledName, "5")) LSGVN->IsVisible = true;
+    else {
+        Error = true;
+        return nullptr;
+    }
+
+    if (!MangledName.empty()) LSGI->ScopeIndex = getDerived().demangleUnsigned(MangledName);
+    return LSGVN;
+}
+
+template <typename Derived, typename Alloc>
+constexpr VariableSymbolNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleUntypedVariable(
+    std::string_view& MangledName,
+    std::string_view  VariableName
+) {
+    NamedIdentifierNode* NI  = synthesizeNamedIdentifier(Arena, VariableName);
+    QualifiedNameNode*   QN  = getDerived().demangleNameScopeChain(MangledName, NI);
+    VariableSymbolNode*  VSN = Arena.template alloc<VariableSymbolNode>();
+    VSN->Name                = QN;
+    if (consumeFront(MangledName, "8")) return VSN;
+
+    Error = true;
+    return nullptr;
+}
+
+template <typename Derived, typename Alloc>
+constexpr VariableSymbolNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleRttiBaseClassDescriptorNode(std::string_view& MangledName) {
+    RttiBaseClassDescriptorNode* RBCDN = Arena.template alloc<RttiBaseClassDescriptorNode>();
+    RBCDN->NVOffset                    = getDerived().demangleUnsigned(MangledName);
+    RBCDN->VBPtrOffset                 = getDerived().demangleSigned(MangledName);
+    RBCDN->VBTableOffset               = getDerived().demangleUnsigned(MangledName);
+    RBCDN->Flags                       = getDerived().demangleUnsigned(MangledName);
+    if (Error) return nullptr;
+
+    VariableSymbolNode* VSN = Arena.template alloc<VariableSymbolNode>();
+    VSN->Name               = getDerived().demangleNameScopeChain(MangledName, RBCDN);
+    consumeFront(MangledName, '8');
+    return VSN;
+}
+
+template <typename Derived, typename Alloc>
+constexpr FunctionSymbolNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleInitFiniStub(std::string_view& MangledName, bool IsDestructor) {
+    DynamicStructorIdentifierNode* DSIN = Arena.template alloc<DynamicStructorIdentifierNode>();
+    DSIN->IsDestructor                  = IsDestructor;
+
+    bool IsKnownStaticDataMember = false;
+    if (consumeFront(MangledName, '?')) IsKnownStaticDataMember = true;
+
+    SymbolNode* Symbol = getDerived().demangleDeclarator(MangledName);
+    if (Error) return nullptr;
+
+    FunctionSymbolNode* FSN = nullptr;
+
+    if (Symbol->kind() == NodeKind::VariableSymbol) {
+        DSIN->Variable = static_cast<VariableSymbolNode*>(Symbol);
+
+        // Older versions of clang mangled this type of symbol incorrectly.  They
+        // would omit the leading ? and they would only emit a single @ at the end.
+        // The correct mangling is a leading ? and 2 trailing @ signs.  Handle
+        // both cases.
+        int AtCount = IsKnownStaticDataMember ? 2 : 1;
+        for (int I = 0; I < AtCount; ++I) {
+            if (consumeFront(MangledName, '@')) continue;
+            Error = true;
+            return nullptr;
+        }
+
+        FSN = getDerived().demangleFunctionEncoding(MangledName);
+        if (FSN) FSN->Name = synthesizeQualifiedName(Arena, DSIN);
+    } else {
+        if (IsKnownStaticDataMember) {
+            // This was supposed to be a static data member, but we got a function.
+            Error = true;
+            return nullptr;
+        }
+
+        FSN        = static_cast<FunctionSymbolNode*>(Symbol);
+        DSIN->Name = Symbol->Name;
+        FSN->Name  = synthesizeQualifiedName(Arena, DSIN);
+    }
+
+    return FSN;
+}
+
+template <typename Derived, typename Alloc>
+constexpr SymbolNode* MicrosoftDemanglerBase<Derived, Alloc>::demangleSpecialIntrinsic(std::string_view& MangledName) {
+    DEMANGLE_PROFILE_SCOPE(MicrosoftSpecialIntrinsic);
+    SpecialIntrinsicKind SIK = consumeSpecialIntrinsicKind(MangledName);
+
+    switch (SIK) {
+    case SpecialIntrinsicKind::None:
+        return nullptr;
+    case SpecialIntrinsicKind::StringLiteralSymbol:
+        return getDerived().demangleStringLiteral(MangledName);
+    case SpecialIntrinsicKind::Vftable:
+    case SpecialIntrinsicKind::Vbtable:
+    case SpecialIntrinsicKind::LocalVftable:
+    case SpecialIntrinsicKind::RttiCompleteObjLocator:
+        return getDerived().demangleSpecialTableSymbolNode(MangledName, SIK);
+    case SpecialIntrinsicKind::VcallThunk:
+        return getDerived().demangleVcallThunkNode(MangledName);
+    case SpecialIntrinsicKind::LocalStaticGuard:
+        return getDerived().demangleLocalStaticGuard(MangledName, /*IsThread=*/false);
+    case SpecialIntrinsicKind::LocalStaticThreadGuard:
+        return getDerived().demangleLocalStaticGuard(MangledName, /*IsThread=*/true);
+    case SpecialIntrinsicKind::RttiTypeDescriptor: {
+        TypeNode* T = getDerived().demangleType(MangledName, QualifierMangleMode::Result);
+        if (Error) break;
+        if (!consumeFront(MangledName, "@8")) break;
+        if (!MangledName.empty()) break;
+        return synthesizeVariable(Arena, T, "`RTTI Type Descriptor'");
+    }
+    case SpecialIntrinsicKind::RttiBaseClassArray:
+        return getDerived().demangleUntypedVariable(MangledName, "`RTTI Base Class Array'");
+    case SpecialIntrinsicKind::RttiClassHierarchyDescriptor:
+        return getDerived().demangleUntypedVariable(MangledName, "`RTTI Class Hierarchy Descriptor'");
+    case SpecialIntrinsicKind::RttiBaseClassDescriptor:
+        return getDerived().demangleRttiBaseClassDescriptorNode(MangledName);
+    case SpecialIntrinsicKind::DynamicInitializer:
+        return getDerived().demangleInitFiniStub(MangledName, /*IsDestructor=*/false);
+    case SpecialIntrinsicKind::DynamicAtexitDestructor:
+        return getDerived().demangleInitFiniStub(MangledName, /*IsDestructor=*/true);
+    case SpecialIntrinsicKind::Typeof:
+    case SpecialIntrinsicKind::UdtReturning:
+        // It's unclear which tools produces these manglings, so demangling
+        // support is not (yet?) implemented.
+        break;
+    case SpecialIntrinsicKind::Unknown:
+        DEMANGLE_UNREACHABLE; // Never returned by consumeSpecialIntrinsicKind.
+    }
+    Error = true;
+    return nullptr;
+}
+
+template <typename Derived, typename Alloc>
+constexpr IdentifierNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleFunctionIdentifierCode(std::string_view& MangledName) {
+    assert(demangler::itanium_demangle::starts_with(MangledName, '?'));
+    MangledName.remove_prefix(1);
+    if (MangledName.empty()) {
+        Error = true;
+        return nullptr;
+    }
+
+    if (consumeFront(MangledName, "__"))
+        return getDerived().demangleFunctionIdentifierCode(MangledName, FunctionIdentifierCodeGroup::DoubleUnder);
+    if (consumeFront(MangledName, "_"))
+        return getDerived().demangleFunctionIdentifierCode(MangledName, FunctionIdentifierCodeGroup::Under);
+    return getDerived().demangleFunctionIdentifierCode(MangledName, FunctionIdentifierCodeGroup::Basic);
+}
+
+template <typename Derived, typename Alloc>
+constexpr StructorIdentifierNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleStructorIdentifier(
+    std::string_view& /*MangledName*/,
+    bool              IsDestructor
+) {
+    StructorIdentifierNode* N = Arena.template alloc<StructorIdentifierNode>();
+    N->IsDestructor           = IsDestructor;
+    return N;
+}
+
+template <typename Derived, typename Alloc>
+constexpr ConversionOperatorIdentifierNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleConversionOperatorIdentifier(std::string_view& /*MangledName*/) {
+    ConversionOperatorIdentifierNode* N = Arena.template alloc<ConversionOperatorIdentifierNode>();
+    return N;
+}
+
+template <typename Derived, typename Alloc>
+constexpr LiteralOperatorIdentifierNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleLiteralOperatorIdentifier(std::string_view& MangledName) {
+    LiteralOperatorIdentifierNode* N = Arena.template alloc<LiteralOperatorIdentifierNode>();
+    N->Name                          = getDerived().demangleSimpleString(MangledName, /*Memorize=*/false);
+    return N;
+}
+
+// The intrinsic functions that the codes after ?, ?_ and ?__ name, indexed by
+// the code: 0-9, then A-Z. Not all ? identifiers are intrinsic *functions*, so
+// some entries are IntrinsicFunctionKind::None; the others are handled
+// elsewhere.
+inline constexpr IntrinsicFunctionKind BasicIntrinsicCodes[36] = {
+    IntrinsicFunctionKind::None,             // ?0 # Foo::Foo()
+    IntrinsicFunctionKind::None,             // ?1 # Foo::~Foo()
+    IntrinsicFunctionKind::New,              // ?2 # operator new
+    IntrinsicFunctionKind::Delete,           // ?3 # operator delete
+    IntrinsicFunctionKind::Assign,           // ?4 # operator=
+    IntrinsicFunctionKind::RightShift,       // ?5 # operator>>
+    IntrinsicFunctionKind::LeftShift,        // ?6 # operator<<
+    IntrinsicFunctionKind::LogicalNot,       // ?7 # operator!
+    IntrinsicFunctionKind::Equals,           // ?8 # operator==
+    IntrinsicFunctionKind::NotEquals,        // ?9 # operator!=
+    IntrinsicFunctionKind::ArraySubscript,   // ?A # operator[]
+    IntrinsicFunctionKind::None,             // ?B # Foo::operator <type>()
+    IntrinsicFunctionKind::Pointer,          // ?C # operator->
+    IntrinsicFunctionKind::Dereference,      // ?D # operator*
+    IntrinsicFunctionKind::Increment,        // ?E # operator++
+    IntrinsicFunctionKind::Decrement,        // ?F # operator--
+    IntrinsicFunctionKind::Minus,            // ?G # operator-
+    IntrinsicFunctionKind::Plus,             // ?H # operator+
+    IntrinsicFunctionKind::BitwiseAnd,       // ?I # operator&
+    IntrinsicFunctionKind::MemberPointer,    // ?J # operator->*
+    IntrinsicFunctionKind::Divide,           // ?K # operator/
+    IntrinsicFunctionKind::Modulus,          // ?L # operator%
+    IntrinsicFunctionKind::LessThan,         // ?M operator<
+    IntrinsicFunctionKind::LessThanEqual,    // ?N operator<=
+    IntrinsicFunctionKind::GreaterThan,      // ?O operator>
+    IntrinsicFunctionKind::GreaterThanEqual, // ?P operator>=
+    IntrinsicFunctionKind::Comma,            // ?Q operator,
+    IntrinsicFunctionKind::Parens,           // ?R operator()
+    IntrinsicFunctionKind::BitwiseNot,       // ?S operator~
+    IntrinsicFunctionKind::BitwiseXor,       // ?T operator^
+    IntrinsicFunctionKind::BitwiseOr,        // ?U operator|
+    IntrinsicFunctionKind::LogicalAnd,       // ?V operator&&
+    IntrinsicFunctionKind::LogicalOr,        // ?W operator||
+    IntrinsicFunctionKind::TimesEqual,       // ?X operator*=
+    IntrinsicFunctionKind::PlusEqual,        // ?Y operator+=
+    IntrinsicFunctionKind::MinusEqual,       // ?Z operator-=
+};
+
+inline constexpr IntrinsicFunctionKind UnderIntrinsicCodes[36] = {
+    IntrinsicFunctionKind::DivEqual,                // ?_0 operator/=
+    IntrinsicFunctionKind::ModEqual,                // ?_1 operator%=
+    IntrinsicFunctionKind::RshEqual,                // ?_2 operator>>=
+    IntrinsicFunctionKind::LshEqual,                // ?_3 operator<<=
+    IntrinsicFunctionKind::BitwiseAndEqual,         // ?_4 operator&=
+    IntrinsicFunctionKind::BitwiseOrEqual,          // ?_5 operator|=
+    IntrinsicFunctionKind::BitwiseXorEqual,         // ?_6 operator^=
+    IntrinsicFunctionKind::None,                    // ?_7 # vftable
+    IntrinsicFunctionKind::None,                    // ?_8 # vbtable
+    IntrinsicFunctionKind::None,                    // ?_9 # vcall
+    IntrinsicFunctionKind::None,                    // ?_A # typeof
+    IntrinsicFunctionKind::None,                    // ?_B # local static guard
+    IntrinsicFunctionKind::None,                    // ?_C # string literal
+    IntrinsicFunctionKind::VbaseDtor,               // ?_D # vbase destructor
+    IntrinsicFunctionKind::VecDelDtor,              // ?_E # vector deleting destructor
+    IntrinsicFunctionKind::DefaultCtorClosure,      // ?_F # default constructor closure
+    IntrinsicFunctionKind::ScalarDelDtor,           // ?_G # scalar deleting destructor
+    IntrinsicFunctionKind::VecCtorIter,             // ?_H # vector constructor iterator
+    IntrinsicFunctionKind::VecDtorIter,             // ?_I # vector destructor iterator
+    IntrinsicFunctionKind::VecVbaseCtorIter,        // ?_J # vector vbase constructor iterator
+    IntrinsicFunctionKind::VdispMap,                // ?_K # virtual displacement map
+    IntrinsicFunctionKind::EHVecCtorIter,           // ?_L # eh vector constructor iterator
+    IntrinsicFunctionKind::EHVecDtorIter,           // ?_M # eh vector destructor iterator
+    IntrinsicFunctionKind::EHVecVbaseCtorIter,      // ?_N # eh vector vbase constructor iterator
+    IntrinsicFunctionKind::CopyCtorClosure,         // ?_O # copy constructor closure
+    IntrinsicFunctionKind::None,                    // ?_P<name> # udt returning <name>
+    IntrinsicFunctionKind::None,                    // ?_Q # <unknown>
+    IntrinsicFunctionKind::None,                    // ?_R0 - ?_R4 # RTTI Codes
+    IntrinsicFunctionKind::None,                    // ?_S # local vftable
+    IntrinsicFunctionKind::LocalVftableCtorClosure, // ?_T # local vftable constructor closure
+    IntrinsicFunctionKind::ArrayNew,                // ?_U operator new[]
+    IntrinsicFunctionKind::ArrayDelete,             // ?_V operator delete[]
+    IntrinsicFunctionKind::None,                    // ?_W <unused>
+    IntrinsicFunctionKind::None,                    // ?_X <unused>
+    IntrinsicFunctionKind::None,                    // ?_Y <unused>
+    IntrinsicFunctionKind::None,                    // ?_Z <unused>
 };
 
+inline constexpr IntrinsicFunctionKind DoubleUnderIntrinsicCodes[36] = {
+    IntrinsicFunctionKind::None,                       // ?__0 <unused>
+    IntrinsicFunctionKind::None,                       // ?__1 <unused>
+    IntrinsicFunctionKind::None,                       // ?__2 <unused>
+    IntrinsicFunctionKind::None,                       // ?__3 <unused>
+    IntrinsicFunctionKind::None,                       // ?__4 <unused>
+    IntrinsicFunctionKind::None,                       // ?__5 <unused>
+    IntrinsicFunctionKind::None,                       // ?__6 <unused>
+    IntrinsicFunctionKind::None,                       // ?__7 <unused>
+    IntrinsicFunctionKind::None,                       // ?__8 <unused>
+    IntrinsicFunctionKind::None,                       // ?__9 <unused>
+    IntrinsicFunctionKind::ManVectorCtorIter,          // ?__A managed vector ctor iterator
+    IntrinsicFunctionKind::ManVectorDtorIter,          // ?__B managed vector dtor iterator
+    IntrinsicFunctionKind::EHVectorCopyCtorIter,       // ?__C EH vector copy ctor iterator
+    IntrinsicFunctionKind::EHVectorVbaseCopyCtorIter,  // ?__D EH vector vbase copy ctor iter
+    IntrinsicFunctionKind::None,                       // ?__E dynamic initializer for `T'
+    IntrinsicFunctionKind::None,                       // ?__F dynamic atexit destructor for `T'
+    IntrinsicFunctionKind::VectorCopyCtorIter,         // ?__G vector copy constructor iter
+    IntrinsicFunctionKind::VectorVbaseCopyCtorIter,    // ?__H vector vbase copy ctor iter
+    IntrinsicFunctionKind::ManVectorVbaseCopyCtorIter, // ?__I managed vector vbase copy ctor iter
+    IntrinsicFunctionKind::None,                       // ?__J local static thread guard
+    IntrinsicFunctionKind::None,                       // ?__K operator ""_name
+    IntrinsicFunctionKind::CoAwait,                    // ?__L operator co_await
+    IntrinsicFunctionKind::Spaceship,                  // ?__M operator<=>
+    IntrinsicFunctionKind::None,                       // ?__N <unused>
+    IntrinsicFunctionKind::None,                       // ?__O <unused>
+    IntrinsicFunctionKind::None,                       // ?__P <unused>
+    IntrinsicFunctionKind::None,                       // ?__Q <unused>
+    IntrinsicFunctionKind::None,                       // ?__R <unused>
+    IntrinsicFunctionKind::None,                       // ?__S <unused>
+    IntrinsicFunctionKind::None,                       // ?__T <unused>
+    IntrinsicFunctionKind::None,                       // ?__U <unused>
+    IntrinsicFunctionKind::None,                       // ?__V <unused>
+    IntrinsicFunctionKind::None,                       // ?__W <unused>
+    IntrinsicFunctionKind::None,                       // ?__X <unused>
+    IntrinsicFunctionKind::None,                       // ?__Y <unused>
+    IntrinsicFunctionKind::None,                       // ?__Z <unused>
+};
+
+template <typename Derived, typename Alloc>
+constexpr IntrinsicFunctionKind
+MicrosoftDemanglerBase<Derived, Alloc>::translateIntrinsicFunctionCode(char CH, FunctionIdentifierCodeGroup Group) {
+    using IFK = IntrinsicFunctionKind;
+    if (!(CH >= '0' && CH <= '9') && !(CH >= 'A' && CH <= 'Z')) {
+        Error = true;
+        return IFK::None;
+    }
+
+
+    int Index = (CH >= '0' && CH <= '9') ? (CH - '0') : (CH - 'A' + 10);
+    switch (Group) {
+    case FunctionIdentifierCodeGroup::Basic:
+        return BasicIntrinsicCodes[Index];
+    case FunctionIdentifierCodeGroup::Under:
+        return UnderIntrinsicCodes[Index];
+    case FunctionIdentifierCodeGroup::DoubleUnder:
+        return DoubleUnderIntrinsicCodes[Index];
+    }
+    DEMANGLE_UNREACHABLE;
+}
+
+template <typename Derived, typename Alloc>
+constexpr IdentifierNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleFunctionIdentifierCode(
+    std::string_view&           MangledName,
+    FunctionIdentifierCodeGroup Group
+) {
+    if (MangledName.empty()) {
+        Error = true;
+        return nullptr;
+    }
+    const char CH = MangledName.front();
+    switch (Group) {
+    case FunctionIdentifierCodeGroup::Basic:
+        MangledName.remove_prefix(1);
+        switch (CH) {
+        case '0':
+        case '1':
+            return getDerived().demangleStructorIdentifier(MangledName, CH == '1');
+        case 'B':
+            return getDerived().demangleConversionOperatorIdentifier(MangledName);
+        default:
+            return Arena.template alloc<IntrinsicFunctionIdentifierNode>(
+                getDerived().translateIntrinsicFunctionCode(CH, Group)
+            );
+        }
+    case FunctionIdentifierCodeGroup::Under:
+        MangledName.remove_prefix(1);
+        return Arena.template alloc<IntrinsicFunctionIdentifierNode>(
+            getDerived().translateIntrinsicFunctionCode(CH, Group)
+        );
+    case FunctionIdentifierCodeGroup::DoubleUnder:
+        MangledName.remove_prefix(1);
+        switch (CH) {
+        case 'K':
+            return getDerived().demangleLiteralOperatorIdentifier(MangledName);
+        default:
+            return Arena.template alloc<IntrinsicFunctionIdentifierNode>(
+                getDerived().translateIntrinsicFunctionCode(CH, Group)
+            );
+        }
+    }
+
+    DEMANGLE_UNREACHABLE;
+}
+
+template <typename Derived, typename Alloc>
+constexpr SymbolNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleEncodedSymbol(std::string_view& MangledName, QualifiedNameNode* Name) {
+    DEMANGLE_PROFILE_SCOPE(MicrosoftEncodedSymbol);
+    if (MangledName.empty()) {
+        Error = true;
+        return nullptr;
+    }
+
+    // Read a variable.
+    switch (MangledName.front()) {
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4': {
+        StorageClass SC = getDerived().demangleVariableStorageClass(MangledName);
+        return getDerived().demangleVariableEncoding(MangledName, SC);
+    }
+    }
+    FunctionSymbolNode* FSN = getDerived().demangleFunctionEncoding(MangledName);
+
+    IdentifierNode* UQN = Name->getUnqualifiedIdentifier();
+    if (UQN->kind() == NodeKind::ConversionOperatorIdentifier) {
+        ConversionOperatorIdentifierNode* COIN = static_cast<ConversionOperatorIdentifierNode*>(UQN);
+        if (FSN) COIN->TargetType = FSN->Signature->ReturnType;
+    }
+    return FSN;
+}
+
+template <typename Derived, typename Alloc>
+constexpr SymbolNode* MicrosoftDemanglerBase<Derived, Alloc>::demangleDeclarator(std::string_view& MangledName) {
+    // What follows is a main symbol name. This may include namespaces or class
+    // back references.
+    QualifiedNameNode* QN = demangleDeclaratorName(MangledName);
+    if (Error) return nullptr;
+
+    SymbolNode* Symbol = getDerived().demangleEncodedSymbol(MangledName, QN);
+    if (Error) return nullptr;
+    Symbol->Name = QN;
+
+    IdentifierNode* UQN = QN->getUnqualifiedIdentifier();
+    if (UQN->kind() == NodeKind::ConversionOperatorIdentifier) {
+        ConversionOperatorIdentifierNode* COIN = static_cast<ConversionOperatorIdentifierNode*>(UQN);
+        if (!COIN->TargetType) {
+            Error = true;
+            return nullptr;
+        }
+    }
+    return Symbol;
+}
+
+// The fully qualified name of a declarator, through the resumeSymbolName and
+// symbolNameParsed hooks.
+template <typename Derived, typename Alloc>
+constexpr QualifiedNameNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleDeclaratorName(std::string_view& MangledName) {
+    QualifiedNameNode* QN = nullptr;
+    if (getDerived().resumeSymbolName(MangledName, QN)) return QN;
+
+    const char* Begin = MangledName.data();
+    QN                = getDerived().demangleFullyQualifiedSymbolName(MangledName);
+    if (!Error) getDerived().symbolNameParsed(Begin, MangledName, QN);
+    return QN;
+}
+
+template <typename Derived, typename Alloc>
+constexpr SymbolNode* MicrosoftDemanglerBase<Derived, Alloc>::demangleMD5Name(std::string_view& MangledName) {
+    assert(demangler::itanium_demangle::starts_with(MangledName, "??@"));
+    // This is an MD5 mangled name.  We can't demangle it, just return the
+    // mangled name.
+    // An MD5 mangled name is ??@ followed by 32 characters and a terminating @.
+    size_t MD5Last = MangledName.find('@', strlen("??@"));
+    if (MD5Last == std::string_view::npos) {
+        Error = true;
+        return nullptr;
+    }
+    const char*  Start     = MangledName.data();
+    const size_t StartSize = MangledName.size();
+    MangledName.remove_prefix(MD5Last + 1);
+
+    // There are two additional special cases for MD5 names:
+    // 1. For complete object locators where the object name is long enough
+    //    for the object to have an MD5 name, the complete object locator is
+    //    called ??@...@??_R4@ (with a trailing "??_R4@" instead of the usual
+    //    leading "??_R4". This is handled here.
+    // 2. For catchable types, in versions of MSVC before 2015 (<1900) or after
+    //    2017.2 (>= 1914), the catchable type mangling is _CT??@...@??@...@8
+    //    instead of_CT??@...@8 with just one MD5 name. Since we don't yet
+    //    demangle catchable types anywhere, this isn't handled for MD5 names
+    //    either.
+    consumeFront(MangledName, "??_R4@");
+
+    assert(MangledName.size() < StartSize);
+    const size_t     Count = StartSize - MangledName.size();
+    std::string_view MD5(Start, Count);
+    SymbolNode*      S = Arena.template alloc<SymbolNode>(NodeKind::Md5Symbol);
+    S->Name            = synthesizeQualifiedName(Arena, MD5);
+
+    return S;
+}
+
+template <typename Derived, typename Alloc>
+constexpr SymbolNode* MicrosoftDemanglerBase<Derived, Alloc>::demangleTypeinfoName(std::string_view& MangledName) {
+    assert(demangler::itanium_demangle::starts_with(MangledName, '.'));
+    consumeFront(MangledName, '.');
+
+    TypeNode* T = getDerived().demangleType(MangledName, QualifierMangleMode::Result);
+    if (Error || !MangledName.empty()) {
+        Error = true;
+        return nullptr;
+    }
+    return synthesizeVariable(Arena, T, "`RTTI Type Descriptor Name'");
+}
+
+// Parser entry point.
+template <typename Derived, typename Alloc>
+constexpr SymbolNode* MicrosoftDemanglerBase<Derived, Alloc>::parse(std::string_view& MangledName) {
+    DEMANGLE_PROFILE_SCOPE(MicrosoftSymbol);
+    // Typeinfo names are strings stored in RTTI data. They're not symbol names.
+    // It's still useful to demangle them. They're the only demangled entity
+    // that doesn't start with a "?" but a ".".
+    if (demangler::itanium_demangle::starts_with(MangledName, '.'))
+        return getDerived().demangleTypeinfoName(MangledName);
+
+    if (demangler::itanium_demangle::starts_with(MangledName, "??@")) return getDerived().demangleMD5Name(MangledName);
+
+    // MSVC-style mangled symbols must start with '?'.
+    if (!demangler::itanium_demangle::starts_with(MangledName, '?')) {
+        Error = true;
+        return nullptr;
+    }
+
+    consumeFront(MangledName, '?');
+
+    // ?$ is a template instantiation, but all other names that start with ? are
+    // operators / special names.
+    if (SymbolNode* SI = getDerived().demangleSpecialIntrinsic(MangledName)) return SI;
+
+    return getDerived().demangleDeclarator(MangledName);
+}
+
+template <typename Derived, typename Alloc>
+constexpr Node* MicrosoftDemanglerBase<Derived, Alloc>::parseName(std::string_view& MangledName) {
+    // Only declarators have an encoding that can be skipped. Special intrinsics
+    // are parsed together with their name, and the name of a conversion
+    // operator, templated ("?$?B") or not, includes the return type from its
+    // encoding.
+    SpecialIntrinsicKind SIK            = SpecialIntrinsicKind::Unknown;
+    bool                 IsDeclarator   = false;
+    bool                 IsTypeinfoName = demangler::itanium_demangle::starts_with(MangledName, '.');
+    if (demangler::itanium_demangle::starts_with(MangledName, '?')
+        && !demangler::itanium_demangle::starts_with(MangledName, "??@")) {
+        std::string_view Name = MangledName.substr(1);
+        SIK                   = consumeSpecialIntrinsicKind(Name);
+        IsDeclarator          = SIK == SpecialIntrinsicKind::None
+                    && !demangler::itanium_demangle::starts_with(Name, "?B")
+                    && !demangler::itanium_demangle::starts_with(Name, "?$?B");
+    }
+
+    if (IsDeclarator) {
+        consumeFront(MangledName, '?');
+        QualifiedNameNode* QN = demangleDeclaratorName(MangledName);
+        return Error ? nullptr : QN;
+    }
+
+    SymbolNode* Symbol = getDerived().parse(MangledName);
+    if (Error) return nullptr;
+
+    // String literals, type descriptors and typeinfo names are only named by
+    // what they describe, so they are returned whole.
+    if (!Symbol->Name || SIK == SpecialIntrinsicKind::RttiTypeDescriptor || IsTypeinfoName) return Symbol;
+    return Symbol->Name;
+}
+
+template <typename Derived, typename Alloc>
+constexpr TagTypeNode* MicrosoftDemanglerBase<Derived, Alloc>::parseTagUniqueName(std::string_view& MangledName) {
+    if (!consumeFront(MangledName, ".?A")) {
+        Error = true;
+        return nullptr;
+    }
+    consumeFront(MangledName, ".?A");
+    if (MangledName.empty()) {
+        Error = true;
+        return nullptr;
+    }
+
+    return getDerived().demangleClassType(MangledName);
+}
+
+template <typename Derived, typename Alloc>
+constexpr void MicrosoftDemanglerBase<Derived, Alloc>::reset() {
+    Error = false;
+    Arena.reset();
+    Arena.Limits.restart();
+    Decorations.clear();
+    resetBackrefs();
+}
+
+// Empty the back-reference tables. The frames of nested argument lists were in
+// the arena, so they are dropped.
+template <typename Derived, typename Alloc>
+constexpr void MicrosoftDemanglerBase<Derived, Alloc>::resetBackrefs() {
+    RootBackrefs.FunctionParamCount = 0;
+    RootBackrefs.NamesCount         = 0;
+    RootBackrefs.Inner              = nullptr;
+    Backrefs                        = &RootBackrefs;
+}
+
+// <type-encoding> ::= <storage-class> <variable-type>
+// <storage-class> ::= 0  # private static member
+//                 ::= 1  # protected static member
+//                 ::= 2  # public static member
+//                 ::= 3  # global
+//                 ::= 4  # static local
+template <typename Derived, typename Alloc>
+
+constexpr VariableSymbolNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleVariableEncoding(std::string_view& MangledName, StorageClass SC) {
+    VariableSymbolNode* VSN = Arena.template alloc<VariableSymbolNode>();
+
+    VSN->Type = getDerived().demangleType(MangledName, QualifierMangleMode::Drop);
+    VSN->SC   = SC;
+
+    if (Error) return nullptr;
+
+    // <variable-type> ::= <type> <cvr-qualifiers>
+    //                 ::= <type> <pointee-cvr-qualifiers> # pointers, references
+    switch (VSN->Type->kind()) {
+    case NodeKind::PointerType: {
+        PointerTypeNode* PTN = static_cast<PointerTypeNode*>(VSN->Type);
+
+        Qualifiers ExtraChildQuals = Q_None;
+        PTN->Quals                 = Qualifiers(
+            VSN->Type->Quals | getDerived().demanglePointerExtQualifiers(MangledName)
+        );
+
+        bool IsMember                       = false;
+        std::tie(ExtraChildQuals, IsMember) = getDerived().demangleQualifiers(MangledName);
+
+        if (PTN->ClassParent) {
+            QualifiedNameNode* BackRefName = getDerived().demangleFullyQualifiedTypeName(MangledName);
+            (void)BackRefName;
+        }
+        PTN->Pointee->Quals = Qualifiers(PTN->Pointee->Quals | ExtraChildQuals);
+
+        break;
+    }
+    default:
+        VSN->Type->Quals = getDerived().demangleQualifiers(MangledName).first;
+        break;
+    }
+
+    return VSN;
+}
+
+// Sometimes numbers are encoded in mangled symbols. For example,
+// "int (*x)[20]" is a valid C type (x is a pointer to an array of
+// length 20), so we need some way to embed numbers as part of symbols.
+// This function parses it.
+//
+// <number>               ::= [?] <non-negative integer>
+//
+// <non-negative integer> ::= <decimal digit> # when 1 <= Number <= 10
+//                        ::= <hex digit>+ @  # when Number == 0 or >= 10
+//
+// <hex-digit>            ::= [A-P]           # A = 0, B = 1, ...
+template <typename Derived, typename Alloc>
+constexpr std::pair<uint64_t, bool>
+MicrosoftDemanglerBase<Derived, Alloc>::demangleNumber(std::string_view& MangledName) {
+    bool IsNegative = consumeFront(MangledName, '?');
+
+    if (startsWithDigit(MangledName)) {
+        uint64_t Ret = MangledName[0] - '0' + 1;
+        MangledName.remove_prefix(1);
+        return {Ret, IsNegative};
+    }
+
+    uint64_t Ret = 0;
+    for (size_t i = 0; i < MangledName.size(); ++i) {
+        char C = MangledName[i];
+        if (C == '@') {
+            MangledName.remove_prefix(i + 1);
+            return {Ret, IsNegative};
+        }
+        if ('A' <= C && C <= 'P') {
+            Ret = (Ret << 4) + (C - 'A');
+            continue;
+        }
+        break;
+    }
+
+    Error = true;
+    return {0ULL, false};
+}
+
+template <typename Derived, typename Alloc>
+constexpr uint64_t MicrosoftDemanglerBase<Derived, Alloc>::demangleUnsigned(std::string_view& MangledName) {
+    bool     IsNegative          = false;
+    uint64_t Number              = 0;
+    std::tie(Number, IsNegative) = getDerived().demangleNumber(MangledName);
+    if (IsNegative) Error = true;
+    return Number;
+}
+
+template <typename Derived, typename Alloc>
+constexpr int64_t MicrosoftDemanglerBase<Derived, Alloc>::demangleSigned(std::string_view& MangledName) {
+    bool     IsNegative          = false;
+    uint64_t Number              = 0;
+    std::tie(Number, IsNegative) = getDerived().demangleNumber(MangledName);
+    if (Number > INT64_MAX) Error = true;
+    int64_t I = static_cast<int64_t>(Number);
+    return IsNegative ? -I : I;
+}
+
+// First 10 strings can be referenced by special BackReferences ?0, ?1, ..., ?9.
+// Memorize it.
+template <typename Derived, typename Alloc>
+constexpr void MicrosoftDemanglerBase<Derived, Alloc>::memorizeString(std::string_view S) {
+    if (Backrefs->NamesCount >= BackrefContext::Max) return;
+    if (!Backrefs->hasName(S)) addBackrefName(S);
+}
+
+// Add S, which the arena owns, to the name back-reference table.
+template <typename Derived, typename Alloc>
+constexpr void MicrosoftDemanglerBase<Derived, Alloc>::addBackrefName(std::string_view S) {
+    size_t               I = Backrefs->NamesCount++;
+    NamedIdentifierNode* N = Arena.template alloc<NamedIdentifierNode>();
+    N->Name                = S;
+    Backrefs->Names[I]     = N;
+    Backrefs->NameSizes[I] = S.size();
+}
+
+template <typename Derived, typename Alloc>
+constexpr NamedIdentifierNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleBackRefName(std::string_view& MangledName) {
+    assert(startsWithDigit(MangledName));
+
+    size_t I = MangledName[0] - '0';
+    if (I >= Backrefs->NamesCount) {
+        Error = true;
+        return nullptr;
+    }
+
+    MangledName.remove_prefix(1);
+    return Backrefs->Names[I];
+}
+
+template <typename Derived, typename Alloc>
+constexpr void MicrosoftDemanglerBase<Derived, Alloc>::memorizeIdentifier(IdentifierNode* Identifier) {
+    if (Backrefs->NamesCount >= BackrefContext::Max) return;
+
+    // Render this class template name into a string buffer so that we can
+    // memorize it for the purpose of back-referencing. Only a name the table
+    // does not hold yet is copied into the arena; it still goes through
+    // memorizeString, so that a derived demangler sees every name.
+    auto Memorize = [&](OutputBuffer& OB) {
+        Identifier->print(OB, OF_Default);
+        std::string_view S = OB;
+        if (!Backrefs->hasName(S)) getDerived().memorizeString(getDerived().copyString(S));
+    };
+    if (std::is_constant_evaluated()) {
+        OutputBuffer OB;
+        Memorize(OB);
+        OB.freeBuffer();
+        return;
+    }
+    OutputBuffer& OB = getBackrefScratchBuffer();
+    OB.setCurrentPosition(0);
+    Memorize(OB);
+}
+
+template <typename Derived, typename Alloc>
+constexpr IdentifierNode* MicrosoftDemanglerBase<Derived, Alloc>::demangleTemplateInstantiationName(
+    std::string_view&   MangledName,
+    NameBackrefBehavior NBB
+) {
+    DEMANGLE_PROFILE_SCOPE(MicrosoftTemplateInstantiationName);
+    assert(demangler::itanium_demangle::starts_with(MangledName, "?$"));
+    consumeFront(MangledName, "?$");
+
+    // The argument list has a back-reference context of its own.
+    BackrefFrame* Outer = Backrefs;
+    if (Outer->Inner == nullptr) Outer->Inner = Arena.template alloc<BackrefFrame>();
+    Backrefs                     = Outer->Inner;
+    Backrefs->FunctionParamCount = 0;
+    Backrefs->NamesCount         = 0;
+
+    IdentifierNode* Identifier = getDerived().demangleUnqualifiedSymbolName(MangledName, NBB_Simple);
+    if (!Error) Identifier->TemplateParams = getDerived().demangleTemplateParameterList(MangledName);
+
+    Backrefs = Outer;
+    if (Error) return nullptr;
+
+    if (NBB & NBB_Template) {
+        // NBB_Template is only set for types and non-leaf names ("a::" in "a::b").
+        // Structors and conversion operators only makes sense in a leaf name, so
+        // reject them in NBB_Template contexts.
+        if (Identifier->kind() == NodeKind::ConversionOperatorIdentifier
+            || Identifier->kind() == NodeKind::StructorIdentifier) {
+            Error = true;
+            return nullptr;
+        }
+
+        getDerived().memorizeIdentifier(Identifier);
+    }
+
+    return Identifier;
+}
+
+template <typename Derived, typename Alloc>
+constexpr NamedIdentifierNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleSimpleName(std::string_view& MangledName, bool Memorize) {
+    std::string_view S = getDerived().demangleSimpleString(MangledName, Memorize);
+    if (Error) return nullptr;
+
+    NamedIdentifierNode* Name = Arena.template alloc<NamedIdentifierNode>();
+    Name->Name                = S;
+    return Name;
+}
+
+template <typename Derived, typename Alloc>
+constexpr uint8_t MicrosoftDemanglerBase<Derived, Alloc>::demangleCharLiteral(std::string_view& MangledName) {
+    assert(!MangledName.empty());
+    auto Fail = [this] {
+        Error = true;
+        return uint8_t('\0');
+    };
+
+    if (!demangler::itanium_demangle::starts_with(MangledName, '?')) {
+        const uint8_t F = MangledName.front();
+        MangledName.remove_prefix(1);
+        return F;
+    }
+
+    MangledName.remove_prefix(1);
+    if (MangledName.empty()) return Fail();
+
+    if (consumeFront(MangledName, '$')) {
+        // Two hex digits
+        if (MangledName.size() < 2) return Fail();
+        std::string_view Nibbles = MangledName.substr(0, 2);
+        if (!isRebasedHexDigit(Nibbles[0]) || !isRebasedHexDigit(Nibbles[1])) return Fail();
+        // Don't append the null terminator.
+        uint8_t C1 = rebasedHexDigitToNumber(Nibbles[0]);
+        uint8_t C2 = rebasedHexDigitToNumber(Nibbles[1]);
+        MangledName.remove_prefix(2);
+        return (C1 << 4) | C2;
+    }
+
+    if (startsWithDigit(MangledName)) {
+        const char* Lookup = ",/\\:. \n\t'-";
+        char        C      = Lookup[MangledName[0] - '0'];
+        MangledName.remove_prefix(1);
+        return C;
+    }
+
+    if (MangledName[0] >= 'a' && MangledName[0] <= 'z') {
+        char Lookup[26] = {'\xE1', '\xE2', '\xE3', '\xE4', '\xE5', '\xE6', '\xE7', '\xE8', '\xE9',
+                           '\xEA', '\xEB', '\xEC', '\xED', '\xEE', '\xEF', '\xF0', '\xF1', '\xF2',
+                           '\xF3', '\xF4', '\xF5', '\xF6', '\xF7', '\xF8', '\xF9', '\xFA'};
+        char C          = Lookup[MangledName[0] - 'a'];
+        MangledName.remove_prefix(1);
+        return C;
+    }
+
+    if (MangledName[0] >= 'A' && MangledName[0] <= 'Z') {
+        char Lookup[26] = {'\xC1', '\xC2', '\xC3', '\xC4', '\xC5', '\xC6', '\xC7', '\xC8', '\xC9',
+                           '\xCA', '\xCB', '\xCC', '\xCD', '\xCE', '\xCF', '\xD0', '\xD1', '\xD2',
+                           '\xD3', '\xD4', '\xD5', '\xD6', '\xD7', '\xD8', '\xD9', '\xDA'};
+        char C          = Lookup[MangledName[0] - 'A'];
+        MangledName.remove_prefix(1);
+        return C;
+    }
+
+    return Fail();
+}
+
+template <typename Derived, typename Alloc>
+constexpr wchar_t MicrosoftDemanglerBase<Derived, Alloc>::demangleWcharLiteral(std::string_view& MangledName) {
+    uint8_t C1 = getDerived().demangleCharLiteral(MangledName);
+    if (Error || MangledName.empty()) {
+        Error = true;
+        return L'\0';
+    }
+    uint8_t C2 = getDerived().demangleCharLiteral(MangledName);
+    if (Error) return L'\0';
+
+    return ((wchar_t)C1 << 8) | (wchar_t)C2;
+}
+
+template <typename Derived, typename Alloc>
+constexpr FunctionSymbolNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleVcallThunkNode(std::string_view& MangledName) {
+    FunctionSymbolNode*       FSN  = Arena.template alloc<FunctionSymbolNode>();
+    VcallThunkIdentifierNode* VTIN = Arena.template alloc<VcallThunkIdentifierNode>();
+    FSN->Signature                 = Arena.template alloc<ThunkSignatureNode>();
+    FSN->Signature->FunctionClass  = FC_NoParameterList;
+
+    FSN->Name = getDerived().demangleNameScopeChain(MangledName, VTIN);
+    if (!Error) Error = !consumeFront(MangledName, "$B");
+    if (!Error) VTIN->OffsetInVTable = getDerived().demangleUnsigned(MangledName);
+    if (!Error) Error = !consumeFront(MangledName, 'A');
+    if (!Error) FSN->Signature->CallConvention = getDerived().demangleCallingConvention(MangledName);
+    return (Error) ? nullptr : FSN;
+}
+
+template <typename Derived, typename Alloc>
+constexpr EncodedStringLiteralNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleStringLiteral(std::string_view& MangledName) {
+    OutputBuffer     OB;
+    std::string_view CRC;
+    uint64_t         StringByteSize;
+    bool             IsWcharT   = false;
+    bool             IsNegative = false;
+    size_t           CrcEndPos  = 0;
+    char             F;
+
+    EncodedStringLiteralNode* Result = Arena.template alloc<EncodedStringLiteralNode>();
+
+    auto Fail = [&] {
+        Error = true;
+        OB.freeBuffer();
+        return nullptr;
+    };
+
+    // Prefix indicating the beginning of a string literal
+    if (!consumeFront(MangledName, "@_")) return Fail();
+    if (MangledName.empty()) return Fail();
+
+    // Char Type (regular or wchar_t)
+    F = MangledName.front();
+    MangledName.remove_prefix(1);
+    switch (F) {
+    case '1':
+        IsWcharT = true;
+        DEMANGLE_FALLTHROUGH;
+    case '0':
+        break;
+    default:
+        return Fail();
+    }
+
+    // Encoded Length
+    std::tie(StringByteSize, IsNegative) = getDerived().demangleNumber(MangledName);
+    if (Error || IsNegative || StringByteSize < (IsWcharT ? 2 : 1)) return Fail();
+
+    // CRC 32 (always 8 characters plus a terminator)
+    CrcEndPos = demangler::itanium_demangle::find_char(MangledName, '@');
+    if (CrcEndPos == std::string_view::npos) return Fail();
+    CRC = MangledName.substr(0, CrcEndPos);
+    MangledName.remove_prefix(CrcEndPos + 1);
+    if (MangledName.empty()) return Fail();
+
+    if (IsWcharT) {
+        Result->Char = CharKind::Wchar;
+        if (StringByteSize > 64) Result->IsTruncated = true;
+
+        while (!consumeFront(MangledName, '@')) {
+            if (MangledName.size() < 2) return Fail();
+            wchar_t W = getDerived().demangleWcharLiteral(MangledName);
+            if (StringByteSize != 2 || Result->IsTruncated) outputEscapedChar(OB, W);
+            StringByteSize -= 2;
+            if (Error) return Fail();
+        }
+    } else {
+        // The max byte length is actually 32, but some compilers mangled strings
+        // incorrectly, so we have to assume it can go higher.
+        constexpr unsigned MaxStringByteLength = 32 * 4;
+        uint8_t            StringBytes[MaxStringByteLength];
+
+        unsigned BytesDecoded = 0;
+        while (!consumeFront(MangledName, '@')) {
+            if (MangledName.size() < 1 || BytesDecoded >= MaxStringByteLength) return Fail();
+
+            // Characters up to the next escape or the terminator stand for
+            // themselves and are copied at once.
+            size_t Plain = demangler::itanium_demangle::find_either(MangledName, '@', '?');
+            if (Plain == std::string_view::npos) Plain = MangledName.size();
+            if (Plain == 0) {
+                StringBytes[BytesDecoded++] = getDerived().demangleCharLiteral(MangledName);
+                continue;
+            }
+            Plain = std::min<size_t>(Plain, MaxStringByteLength - BytesDecoded);
+            std::copy_n(MangledName.data(), Plain, StringBytes + BytesDecoded);
+            BytesDecoded += static_cast<unsigned>(Plain);
+            MangledName.remove_prefix(Plain);
+        }
+
+        if (StringByteSize > BytesDecoded) Result->IsTruncated = true;
+
+        unsigned CharBytes = guessCharByteSize(StringBytes, BytesDecoded, StringByteSize);
+        assert(StringByteSize % CharBytes == 0);
+        switch (CharBytes) {
+        case 1:
+            Result->Char = CharKind::Char;
+            break;
+        case 2:
+            Result->Char = CharKind::Char16;
+            break;
+        case 4:
+            Result->Char = CharKind::Char32;
+            break;
+        default:
+            DEMANGLE_UNREACHABLE;
+        }
+        const unsigned NumChars = BytesDecoded / CharBytes;
+        for (unsigned CharIndex = 0; CharIndex < NumChars; ++CharIndex) {
+            unsigned NextChar = decodeMultiByteChar(StringBytes, CharIndex, CharBytes);
+            if (CharIndex + 1 < NumChars || Result->IsTruncated) outputEscapedChar(OB, NextChar);
+        }
+    }
+
+    Result->DecodedString = getDerived().copyString(OB);
+    OB.freeBuffer();
+    return Result;
+}
+
+// Returns MangledName's prefix before the first '@', or an error if
+// MangledName contains no '@' or the prefix has length 0.
+template <typename Derived, typename Alloc>
+constexpr std::string_view
+MicrosoftDemanglerBase<Derived, Alloc>::demangleSimpleString(std::string_view& MangledName, bool Memorize) {
+    size_t End = demangler::itanium_demangle::find_char(MangledName, '@');
+    if (End == 0 || End == std::string_view::npos) {
+        Error = true;
+        return {};
+    }
+
+    std::string_view S = MangledName.substr(0, End);
+    MangledName.remove_prefix(End + 1);
+
+    if (Memorize) getDerived().memorizeString(S);
+    return S;
+}
+
+template <typename Derived, typename Alloc>
+constexpr NamedIdentifierNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleAnonymousNamespaceName(std::string_view& MangledName) {
+    assert(demangler::itanium_demangle::starts_with(MangledName, "?A"));
+    consumeFront(MangledName, "?A");
+
+    NamedIdentifierNode* Node = Arena.template alloc<NamedIdentifierNode>();
+    Node->Name                = "`anonymous namespace'";
+    size_t EndPos             = demangler::itanium_demangle::find_char(MangledName, '@');
+    if (EndPos == std::string_view::npos) {
+        Error = true;
+        return nullptr;
+    }
+    std::string_view NamespaceKey = MangledName.substr(0, EndPos);
+    getDerived().memorizeString(NamespaceKey);
+    MangledName = MangledName.substr(EndPos + 1);
+    return Node;
+}
+
+template <typename Derived, typename Alloc>
+constexpr NamedIdentifierNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleLocallyScopedNamePiece(std::string_view& MangledName) {
+    assert(startsWithLocalScopePattern(MangledName));
+
+    NamedIdentifierNode* Identifier = Arena.template alloc<NamedIdentifierNode>();
+    consumeFront(MangledName, '?');
+    uint64_t Number              = 0;
+    bool     IsNegative          = false;
+    std::tie(Number, IsNegative) = getDerived().demangleNumber(MangledName);
+    assert(!IsNegative);
+
+    // One ? to terminate the number
+    consumeFront(MangledName, '?');
+
+    assert(!Error);
+    Node* Scope = getDerived().parse(MangledName);
+    if (Error) return nullptr;
+
+    // Render the parent symbol's name into a buffer.
+    OutputBuffer OB;
+    OB << '`';
+    Scope->print(OB, OF_Default);
+    OB << '\'';
+    OB << "::`" << Number << "'";
+
+    Identifier->Name = getDerived().copyString(OB);
+    OB.freeBuffer();
+    return Identifier;
+}
+
+// Parses a type name in the form of A@B@C@@ which represents C::B::A.
+template <typename Derived, typename Alloc>
+constexpr QualifiedNameNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleFullyQualifiedTypeName(std::string_view& MangledName) {
+    DEMANGLE_PROFILE_SCOPE(MicrosoftFullyQualifiedTypeName);
+    IdentifierNode* Identifier = getDerived().demangleUnqualifiedTypeName(MangledName, /*Memorize=*/true);
+    if (Error) return nullptr;
+    assert(Identifier);
+
+    QualifiedNameNode* QN = getDerived().demangleNameScopeChain(MangledName, Identifier);
+    if (Error) return nullptr;
+    assert(QN);
+    return QN;
+}
+
+// Parses a symbol name in the form of A@B@C@@ which represents C::B::A.
+// Symbol names have slightly different rules regarding what can appear
+// so we separate out the implementations for flexibility.
+template <typename Derived, typename Alloc>
+constexpr QualifiedNameNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleFullyQualifiedSymbolName(std::string_view& MangledName) {
+    DEMANGLE_PROFILE_SCOPE(MicrosoftFullyQualifiedSymbolName);
+    // This is the final component of a symbol name (i.e. the leftmost component
+    // of a mangled name.  Since the only possible template instantiation that
+    // can appear in this context is a function template, and since those are
+    // not saved for the purposes of name backreferences, only backref simple
+    // names.
+    IdentifierNode* Identifier = getDerived().demangleUnqualifiedSymbolName(MangledName, NBB_Simple);
+    if (Error) return nullptr;
+
+    QualifiedNameNode* QN = getDerived().demangleNameScopeChain(MangledName, Identifier);
+    if (Error) return nullptr;
+
+    if (Identifier->kind() == NodeKind::StructorIdentifier) {
+        if (QN->Components->Count < 2) {
+            Error = true;
+            return nullptr;
+        }
+        StructorIdentifierNode* SIN       = static_cast<StructorIdentifierNode*>(Identifier);
+        Node*                   ClassNode = QN->Components->Nodes[QN->Components->Count - 2];
+        SIN->Class                        = static_cast<IdentifierNode*>(ClassNode);
+    }
+    assert(QN);
+    return QN;
+}
+
+template <typename Derived, typename Alloc>
+constexpr IdentifierNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleUnqualifiedTypeName(std::string_view& MangledName, bool Memorize) {
+    // An inner-most name can be a back-reference, because a fully-qualified name
+    // (e.g. Scope + Inner) can contain other fully qualified names inside of
+    // them (for example template parameters), and these nested parameters can
+    // refer to previously mangled types.
+    if (startsWithDigit(MangledName)) return getDerived().demangleBackRefName(MangledName);
+
+    if (demangler::itanium_demangle::starts_with(MangledName, "?$"))
+        return getDerived().demangleTemplateInstantiationName(MangledName, NBB_Template);
+
+    return getDerived().demangleSimpleName(MangledName, Memorize);
+}
+
+template <typename Derived, typename Alloc>
+constexpr IdentifierNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleUnqualifiedSymbolName(
+    std::string_view&   MangledName,
+    NameBackrefBehavior NBB
+) {
+    if (startsWithDigit(MangledName)) return getDerived().demangleBackRefName(MangledName);
+    if (demangler::itanium_demangle::starts_with(MangledName, "?$"))
+        return getDerived().demangleTemplateInstantiationName(MangledName, NBB);
+    if (demangler::itanium_demangle::starts_with(MangledName, '?'))
+        return getDerived().demangleFunctionIdentifierCode(MangledName);
+    return getDerived().demangleSimpleName(MangledName, /*Memorize=*/(NBB & NBB_Simple) != 0);
+}
+
+template <typename Derived, typename Alloc>
+constexpr IdentifierNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleNameScopePiece(std::string_view& MangledName) {
+    if (startsWithDigit(MangledName)) return getDerived().demangleBackRefName(MangledName);
+
+    if (demangler::itanium_demangle::starts_with(MangledName, "?$"))
+        return getDerived().demangleTemplateInstantiationName(MangledName, NBB_Template);
+
+    if (demangler::itanium_demangle::starts_with(MangledName, "?A"))
+        return getDerived().demangleAnonymousNamespaceName(MangledName);
+
+    if (startsWithLocalScopePattern(MangledName)) return getDerived().demangleLocallyScopedNamePiece(MangledName);
+
+    return getDerived().demangleSimpleName(MangledName, /*Memorize=*/true);
+}
+
+template <typename Derived, typename Alloc>
+constexpr QualifiedNameNode* MicrosoftDemanglerBase<Derived, Alloc>::demangleNameScopeChain(
+    std::string_view& MangledName,
+    IdentifierNode*   UnqualifiedName
+) {
+    DEMANGLE_PROFILE_SCOPE(MicrosoftNameScopeChain);
+    NodeList* Head = Arena.template alloc<NodeList>();
+
+    Head->N = UnqualifiedName;
+
+    size_t Count = 1;
+    while (!consumeFront(MangledName, "@")) {
+        ++Count;
+        NodeList* NewHead = Arena.template alloc<NodeList>();
+        NewHead->Next     = Head;
+        Head              = NewHead;
+
+        if (MangledName.empty()) {
+            Error = true;
+            return nullptr;
+        }
+
+        assert(!Error);
+        IdentifierNode* Elem = getDerived().demangleNameScopePiece(MangledName);
+        if (Error) return nullptr;
+
+        Head->N = Elem;
+    }
+
+    QualifiedNameNode* QN = Arena.template alloc<QualifiedNameNode>();
+    QN->Components        = nodeListToNodeArray(Arena, Head, Count);
+    return QN;
+}
+
+template <typename Derived, typename Alloc>
+constexpr FuncClass MicrosoftDemanglerBase<Derived, Alloc>::demangleFunctionClass(std::string_view& MangledName) {
+    auto originalFunc = [&MangledName, this]() {
+        const char F = MangledName.front();
+        MangledName.remove_prefix(1);
+        switch (F) {
+        case '9':
+            return FuncClassValue(FC_ExternC | FC_NoParameterList);
+        case 'A':
+            return FC_Private;
+        case 'B':
+            return FuncClassValue(FC_Private | FC_Far);
+        case 'C':
+            return FuncClassValue(FC_Private | FC_Static);
+        case 'D':
+            return FuncClassValue(FC_Private | FC_Static | FC_Far);
+        case 'E':
+            return FuncClassValue(FC_Private | FC_Virtual);
+        case 'F':
+            return FuncClassValue(FC_Private | FC_Virtual | FC_Far);
+        case 'G':
+            return FuncClassValue(FC_Private | FC_StaticThisAdjust);
+        case 'H':
+            return FuncClassValue(FC_Private | FC_StaticThisAdjust | FC_Far);
+        case 'I':
+            return FuncClassValue(FC_Protected);
+        case 'J':
+            return FuncClassValue(FC_Protected | FC_Far);
+        case 'K':
+            return FuncClassValue(FC_Protected | FC_Static);
+        case 'L':
+            return FuncClassValue(FC_Protected | FC_Static | FC_Far);
+        case 'M':
+            return FuncClassValue(FC_Protected | FC_Virtual);
+        case 'N':
+            return FuncClassValue(FC_Protected | FC_Virtual | FC_Far);
+        case 'O':
+            return FuncClassValue(FC_Protected | FC_Virtual | FC_StaticThisAdjust);
+        case 'P':
+            return FuncClassValue(FC_Protected | FC_Virtual | FC_StaticThisAdjust | FC_Far);
+        case 'Q':
+            return FuncClassValue(FC_Public);
+        case 'R':
+            return FuncClassValue(FC_Public | FC_Far);
+        case 'S':
+            return FuncClassValue(FC_Public | FC_Static);
+        case 'T':
+            return FuncClassValue(FC_Public | FC_Static | FC_Far);
+        case 'U':
+            return FuncClassValue(FC_Public | FC_Virtual);
+        case 'V':
+            return FuncClassValue(FC_Public | FC_Virtual | FC_Far);
+        case 'W':
+            return FuncClassValue(FC_Public | FC_Virtual | FC_StaticThisAdjust);
+        case 'X':
+            return FuncClassValue(FC_Public | FC_Virtual | FC_StaticThisAdjust | FC_Far);
+        case 'Y':
+            return FuncClassValue(FC_Global);
+        case 'Z':
+            return FuncClassValue(FC_Global | FC_Far);
+        case '$': {
+            FuncClassValue VFlag = FC_VirtualThisAdjust;
+            if (consumeFront(MangledName, 'R')) VFlag = FuncClassValue(VFlag | FC_VirtualThisAdjustEx);
+            if (MangledName.empty()) break;
+            const char F = MangledName.front();
+            MangledName.remove_prefix(1);
+            switch (F) {
+            case '0':
+                return FuncClassValue(FC_Private | FC_Virtual | VFlag);
+            case '1':
+                return FuncClassValue(FC_Private | FC_Virtual | VFlag | FC_Far);
+            case '2':
+                return FuncClassValue(FC_Protected | FC_Virtual | VFlag);
+            case '3':
+                return FuncClassValue(FC_Protected | FC_Virtual | VFlag | FC_Far);
+            case '4':
+                return FuncClassValue(FC_Public | FC_Virtual | VFlag);
+            case '5':
+                return FuncClassValue(FC_Public | FC_Virtual | VFlag | FC_Far);
+            }
+        }
+        }
+
+        Error = true;
+        return FC_Public;
+    };
+    FuncClass result;
+    result.pos = MangledName;
+    result     = originalFunc();
+    return result;
+}
+
+template <typename Derived, typename Alloc>
+constexpr CallingConv MicrosoftDemanglerBase<Derived, Alloc>::demangleCallingConvention(std::string_view& MangledName) {
+    if (MangledName.empty()) {
+        Error = true;
+        return CallingConv::None;
+    }
+
+    const char F = MangledName.front();
+    MangledName.remove_prefix(1);
+    switch (F) {
+    case 'A':
+    case 'B':
+        return CallingConv::Cdecl;
+    case 'C':
+    case 'D':
+        return CallingConv::Pascal;
+    case 'E':
+    case 'F':
+        return CallingConv::Thiscall;
+    case 'G':
+    case 'H':
+        return CallingConv::Stdcall;
+    case 'I':
+    case 'J':
+        return CallingConv::Fastcall;
+    case 'M':
+    case 'N':
+        return CallingConv::Clrcall;
+    case 'O':
+    case 'P':
+        return CallingConv::Eabi;
+    case 'Q':
+        return CallingConv::Vectorcall;
+    case 'S':
+        return CallingConv::Swift;
+    case 'W':
+        return CallingConv::SwiftAsync;
+    }
+
+    return CallingConv::None;
+}
+
+template <typename Derived, typename Alloc>
+constexpr StorageClass
+MicrosoftDemanglerBase<Derived, Alloc>::demangleVariableStorageClass(std::string_view& MangledName) {
+
+    auto originalFunc = [&MangledName] {
+        assert(MangledName.front() >= '0' && MangledName.front() <= '4');
+
+        const char F = MangledName.front();
+        MangledName.remove_prefix(1);
+        switch (F) {
+        case '0':
+            return StorageClass::PrivateStatic;
+        case '1':
+            return StorageClass::ProtectedStatic;
+        case '2':
+            return StorageClass::PublicStatic;
+        case '3':
+            return StorageClass::Global;
+        case '4':
+            return StorageClass::FunctionLocalStatic;
+        }
+        DEMANGLE_UNREACHABLE;
+    };
+    // LeviLamina: track StorageClass locations
+    StorageClass result;
+    result.pos = MangledName;
+    result.val = originalFunc();
+    return result;
+}
+
+template <typename Derived, typename Alloc>
+constexpr std::pair<Qualifiers, bool>
+MicrosoftDemanglerBase<Derived, Alloc>::demangleQualifiers(std::string_view& MangledName) {
+    if (MangledName.empty()) {
+        Error = true;
+        return std::make_pair(Q_None, false);
+    }
+
+    const char F = MangledName.front();
+    MangledName.remove_prefix(1);
+    switch (F) {
+    // Member qualifiers
+    case 'Q':
+        return std::make_pair(Q_None, true);
+    case 'R':
+        return std::make_pair(Q_Const, true);
+    case 'S':
+        return std::make_pair(Q_Volatile, true);
+    case 'T':
+        return std::make_pair(Qualifiers(Q_Const | Q_Volatile), true);
+    // Non-Member qualifiers
+    case 'A':
+        return std::make_pair(Q_None, false);
+    case 'B':
+        return std::make_pair(Q_Const, false);
+    case 'C':
+        return std::make_pair(Q_Volatile, false);
+    case 'D':
+        return std::make_pair(Qualifiers(Q_Const | Q_Volatile), false);
+    }
+    Error = true;
+    return std::make_pair(Q_None, false);
+}
+
+// <variable-type> ::= <type> <cvr-qualifiers>
+//                 ::= <type> <pointee-cvr-qualifiers> # pointers, references
+template <typename Derived, typename Alloc>
+constexpr TypeNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleType(std::string_view& MangledName, QualifierMangleMode QMM) {
+    DEMANGLE_PROFILE_SCOPE(MicrosoftType);
+    DEMANGLE_STATS_DEPTH();
+    detail::LimitTracker::Scope LimitScope(Arena.Limits);
+    if (Arena.Limits.Exceeded) {
+        Error = true;
+        return nullptr;
+    }
+    Qualifiers Quals    = Q_None;
+    bool       IsMember = false;
+    if (QMM == QualifierMangleMode::Mangle) {
+        std::tie(Quals, IsMember) = getDerived().demangleQualifiers(MangledName);
+    } else if (QMM == QualifierMangleMode::Result) {
+        if (consumeFront(MangledName, '?')) std::tie(Quals, IsMember) = getDerived().demangleQualifiers(MangledName);
+    }
+
+    if (MangledName.empty()) {
+        Error = true;
+        return nullptr;
+    }
+
+    TypeNode* Ty = nullptr;
+    if (isTagType(MangledName)) Ty = getDerived().demangleClassType(MangledName);
+    else if (isPointerType(MangledName)) {
+        if (isMemberPointer(MangledName, Error)) Ty = getDerived().demangleMemberPointerType(MangledName);
+        else if (!Error) Ty = getDerived().demanglePointerType(MangledName);
+        else return nullptr;
+    } else if (isArrayType(MangledName)) Ty = getDerived().demangleArrayType(MangledName);
+    else if (isFunctionType(MangledName)) {
+        if (consumeFront(MangledName, "$$A8@@")) Ty = getDerived().demangleFunctionType(MangledName, true);
+        else {
+            assert(demangler::itanium_demangle::starts_with(MangledName, "$$A6"));
+            consumeFront(MangledName, "$$A6");
+            Ty = getDerived().demangleFunctionType(MangledName, false);
+        }
+    } else if (isCustomType(MangledName)) {
+        Ty = getDerived().demangleCustomType(MangledName);
+    } else {
+        Ty = getDerived().demanglePrimitiveType(MangledName);
+    }
+
+    if (!Ty || Error) return Ty;
+    Ty->Quals = Qualifiers(Ty->Quals | Quals);
+    return Ty;
+}
+
+template <typename Derived, typename Alloc>
+constexpr bool MicrosoftDemanglerBase<Derived, Alloc>::demangleThrowSpecification(std::string_view& MangledName) {
+    if (consumeFront(MangledName, "_E")) return true;
+    if (consumeFront(MangledName, 'Z')) return false;
+
+    Error = true;
+    return false;
+}
+
+template <typename Derived, typename Alloc>
+constexpr FunctionSignatureNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleFunctionType(std::string_view& MangledName, bool HasThisQuals) {
+    DEMANGLE_PROFILE_SCOPE(MicrosoftFunctionType);
+    FunctionSignatureNode* FTy = Arena.template alloc<FunctionSignatureNode>();
+
+    if (HasThisQuals) {
+        FTy->Quals        = getDerived().demanglePointerExtQualifiers(MangledName);
+        FTy->RefQualifier = demangleFunctionRefQualifier(MangledName);
+        FTy->Quals        = Qualifiers(FTy->Quals | getDerived().demangleQualifiers(MangledName).first);
+    }
+
+    // Fields that appear on both member and non-member functions.
+    FTy->CallConvention = getDerived().demangleCallingConvention(MangledName);
+
+    // <return-type> ::= <type>
+    //               ::= @ # structors (they have no declared return type)
+    bool IsStructor = consumeFront(MangledName, '@');
+    if (!IsStructor) FTy->ReturnType = getDerived().demangleType(MangledName, QualifierMangleMode::Result);
+
+    FTy->Params = getDerived().demangleFunctionParameterList(MangledName, FTy->IsVariadic);
+
+    FTy->IsNoexcept = getDerived().demangleThrowSpecification(MangledName);
+
+    return FTy;
+}
+
+template <typename Derived, typename Alloc>
+constexpr FunctionSymbolNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleFunctionEncoding(std::string_view& MangledName) {
+    FuncClass ExtraFlags = FC_None;
+    if (consumeFront(MangledName, "$$J0")) ExtraFlags = FC_ExternC;
+
+    if (MangledName.empty()) {
+        Error = true;
+        return nullptr;
+    }
+
+    FuncClass FC = getDerived().demangleFunctionClass(MangledName);
+    FC.set(ExtraFlags | FC); // avoid pos track lost
+
+    FunctionSignatureNode* FSN = nullptr;
+    ThunkSignatureNode*    TTN = nullptr;
+    if (FC & FC_StaticThisAdjust) {
+        TTN                          = Arena.template alloc<ThunkSignatureNode>();
+        TTN->ThisAdjust.StaticOffset = getDerived().demangleSigned(MangledName);
+    } else if (FC & FC_VirtualThisAdjust) {
+        TTN = Arena.template alloc<ThunkSignatureNode>();
+        if (FC & FC_VirtualThisAdjustEx) {
+            TTN->ThisAdjust.VBPtrOffset    = getDerived().demangleSigned(MangledName);
+            TTN->ThisAdjust.VBOffsetOffset = getDerived().demangleSigned(MangledName);
+        }
+        TTN->ThisAdjust.VtordispOffset = getDerived().demangleSigned(MangledName);
+        TTN->ThisAdjust.StaticOffset   = getDerived().demangleSigned(MangledName);
+    }
+
+    if (FC & FC_NoParameterList) {
+        // This is an extern "C" function whose full signature hasn't been mangled.
+        // This happens when we need to mangle a local symbol inside of an extern
+        // "C" function.
+        FSN = Arena.template alloc<FunctionSignatureNode>();
+    } else {
+        bool HasThisQuals = !(FC & (FuncClass)(FC_Global | FC_Static));
+        FSN               = getDerived().demangleFunctionType(MangledName, HasThisQuals);
+    }
+
+    if (Error) return nullptr;
+
+    if (TTN) {
+        *static_cast<FunctionSignatureNode*>(TTN) = *FSN;
+        FSN                                       = TTN;
+    }
+    FSN->FunctionClass = FC;
+
+    FunctionSymbolNode* Symbol = Arena.template alloc<FunctionSymbolNode>();
+    Symbol->Signature          = FSN;
+    return Symbol;
+}
+
+template <typename Derived, typename Alloc>
+constexpr CustomTypeNode* MicrosoftDemanglerBase<Derived, Alloc>::demangleCustomType(std::string_view& MangledName) {
+    assert(demangler::itanium_demangle::starts_with(MangledName, '?'));
+    MangledName.remove_prefix(1);
+
+    CustomTypeNode* CTN = Arena.template alloc<CustomTypeNode>();
+    CTN->Identifier     = getDerived().demangleUnqualifiedTypeName(MangledName, /*Memorize=*/true);
+    if (!consumeFront(MangledName, '@')) Error = true;
+    if (Error) return nullptr;
+    return CTN;
+}
+
+// Reads a primitive type.
+template <typename Derived, typename Alloc>
+constexpr PrimitiveTypeNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demanglePrimitiveType(std::string_view& MangledName) {
+    if (consumeFront(MangledName, "$$T")) return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Nullptr);
+
+    const char F = MangledName.front();
+    MangledName.remove_prefix(1);
+    switch (F) {
+    case 'X':
+        return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Void);
+    case 'D':
+        return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Char);
+    case 'C':
+        return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Schar);
+    case 'E':
+        return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Uchar);
+    case 'F':
+        return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Short);
+    case 'G':
+        return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Ushort);
+    case 'H':
+        return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Int);
+    case 'I':
+        return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Uint);
+    case 'J':
+        return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Long);
+    case 'K':
+        return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Ulong);
+    case 'M':
+        return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Float);
+    case 'N':
+        return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Double);
+    case 'O':
+        return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Ldouble);
+    case '_': {
+        if (MangledName.empty()) {
+            Error = true;
+            return nullptr;
+        }
+        const char F = MangledName.front();
+        MangledName.remove_prefix(1);
+        switch (F) {
+        case 'N':
+            return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Bool);
+        case 'J':
+            return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Int64);
+        case 'K':
+            return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Uint64);
+        case 'W':
+            return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Wchar);
+        case 'Q':
+            return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Char8);
+        case 'S':
+            return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Char16);
+        case 'U':
+            return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Char32);
+        case 'P':
+            return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::Auto);
+        case 'T':
+            return Arena.template alloc<PrimitiveTypeNode>(PrimitiveKind::DecltypeAuto);
+        }
+        break;
+    }
+    }
+    Error = true;
+    return nullptr;
+}
+
+template <typename Derived, typename Alloc>
+constexpr TagTypeNode* MicrosoftDemanglerBase<Derived, Alloc>::demangleClassType(std::string_view& MangledName) {
+    TagTypeNode* TT = nullptr;
+
+    const char F = MangledName.front();
+    MangledName.remove_prefix(1);
+    switch (F) {
+    case 'T':
+        TT = Arena.template alloc<TagTypeNode>(TagKind::Union);
+        break;
+    case 'U':
+        TT = Arena.template alloc<TagTypeNode>(TagKind::Struct);
+        break;
+    case 'V':
+        TT = Arena.template alloc<TagTypeNode>(TagKind::Class);
+        break;
+    case 'W':
+        if (!consumeFront(MangledName, '4')) {
+            Error = true;
+            return nullptr;
+        }
+        TT = Arena.template alloc<TagTypeNode>(TagKind::Enum);
+        break;
+    default:
+        assert(false);
+    }
+
+    TT->QualifiedName = getDerived().demangleFullyQualifiedTypeName(MangledName);
+    return TT;
+}
+
+// <pointer-type> ::= E? <pointer-cvr-qualifiers> <ext-qualifiers> <type>
+//                       # the E is required for 64-bit non-static pointers
+template <typename Derived, typename Alloc>
+constexpr PointerTypeNode* MicrosoftDemanglerBase<Derived, Alloc>::demanglePointerType(std::string_view& MangledName) {
+    PointerTypeNode* Pointer = Arena.template alloc<PointerTypeNode>();
+
+    std::tie(Pointer->Quals, Pointer->Affinity) = demanglePointerCVQualifiers(MangledName);
+
+    if (consumeFront(MangledName, "6")) {
+        Pointer->Pointee = getDerived().demangleFunctionType(MangledName, false);
+        return Pointer;
+    }
+
+    Qualifiers ExtQuals = getDerived().demanglePointerExtQualifiers(MangledName);
+    Pointer->Quals      = Qualifiers(Pointer->Quals | ExtQuals);
+
+    Pointer->Pointee = getDerived().demangleType(MangledName, QualifierMangleMode::Mangle);
+    return Pointer;
+}
+
+template <typename Derived, typename Alloc>
+constexpr PointerTypeNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleMemberPointerType(std::string_view& MangledName) {
+    PointerTypeNode* Pointer = Arena.template alloc<PointerTypeNode>();
+
+    std::tie(Pointer->Quals, Pointer->Affinity) = demanglePointerCVQualifiers(MangledName);
+    assert(Pointer->Affinity == PointerAffinity::Pointer);
+
+    Qualifiers ExtQuals = getDerived().demanglePointerExtQualifiers(MangledName);
+    Pointer->Quals      = Qualifiers(Pointer->Quals | ExtQuals);
+
+    // isMemberPointer() only returns true if there is at least one character
+    // after the qualifiers.
+    if (consumeFront(MangledName, "8")) {
+        Pointer->ClassParent = getDerived().demangleFullyQualifiedTypeName(MangledName);
+        Pointer->Pointee     = getDerived().demangleFunctionType(MangledName, true);
+    } else {
+        Qualifiers PointeeQuals          = Q_None;
+        bool       IsMember              = false;
+        std::tie(PointeeQuals, IsMember) = getDerived().demangleQualifiers(MangledName);
+        assert(IsMember || Error);
+        Pointer->ClassParent = getDerived().demangleFullyQualifiedTypeName(MangledName);
+
+        Pointer->Pointee = getDerived().demangleType(MangledName, QualifierMangleMode::Drop);
+        if (Pointer->Pointee) Pointer->Pointee->Quals = PointeeQuals;
+    }
+
+    return Pointer;
+}
+
+template <typename Derived, typename Alloc>
+constexpr Qualifiers
+MicrosoftDemanglerBase<Derived, Alloc>::demanglePointerExtQualifiers(std::string_view& MangledName) {
+    Qualifiers Quals = Q_None;
+    if (consumeFront(MangledName, 'E')) Quals = Qualifiers(Quals | Q_Pointer64);
+    if (consumeFront(MangledName, 'I')) Quals = Qualifiers(Quals | Q_Restrict);
+    if (consumeFront(MangledName, 'F')) Quals = Qualifiers(Quals | Q_Unaligned);
+
+    return Quals;
+}
+
+template <typename Derived, typename Alloc>
+constexpr ArrayTypeNode* MicrosoftDemanglerBase<Derived, Alloc>::demangleArrayType(std::string_view& MangledName) {
+    assert(MangledName.front() == 'Y');
+    MangledName.remove_prefix(1);
+
+    uint64_t Rank              = 0;
+    bool     IsNegative        = false;
+    std::tie(Rank, IsNegative) = getDerived().demangleNumber(MangledName);
+    if (IsNegative || Rank == 0) {
+        Error = true;
+        return nullptr;
+    }
+
+    ArrayTypeNode* ATy  = Arena.template alloc<ArrayTypeNode>();
+    NodeList*      Head = Arena.template alloc<NodeList>();
+    NodeList*      Tail = Head;
+
+    for (uint64_t I = 0; I < Rank; ++I) {
+        uint64_t D              = 0;
+        std::tie(D, IsNegative) = getDerived().demangleNumber(MangledName);
+        if (Error || IsNegative) {
+            Error = true;
+            return nullptr;
+        }
+        Tail->N = Arena.template alloc<IntegerLiteralNode>(D, IsNegative);
+        if (I + 1 < Rank) {
+            Tail->Next = Arena.template alloc<NodeList>();
+            Tail       = Tail->Next;
+        }
+    }
+    ATy->Dimensions = nodeListToNodeArray(Arena, Head, Rank);
+
+    if (consumeFront(MangledName, "$$C")) {
+        bool IsMember                  = false;
+        std::tie(ATy->Quals, IsMember) = getDerived().demangleQualifiers(MangledName);
+        if (IsMember) {
+            Error = true;
+            return nullptr;
+        }
+    }
+
+    ATy->ElementType = getDerived().demangleType(MangledName, QualifierMangleMode::Drop);
+    return ATy;
+}
+
+// Reads a function's parameters.
+template <typename Derived, typename Alloc>
+constexpr NodeArrayNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleFunctionParameterList(std::string_view& MangledName, bool& IsVariadic) {
+    DEMANGLE_PROFILE_SCOPE(MicrosoftFunctionParameterList);
+    // Empty parameter list.
+    if (consumeFront(MangledName, 'X')) return nullptr;
+
+    NodeList*  Head    = Arena.template alloc<NodeList>();
+    NodeList** Current = &Head;
+    size_t     Count   = 0;
+    while (!Error && !demangler::itanium_demangle::starts_with(MangledName, '@')
+           && !demangler::itanium_demangle::starts_with(MangledName, 'Z')) {
+        ++Count;
+
+        if (startsWithDigit(MangledName)) {
+            size_t N = MangledName[0] - '0';
+            if (N >= Backrefs->FunctionParamCount) {
+                Error = true;
+                return nullptr;
+            }
+            MangledName.remove_prefix(1);
+
+            *Current      = Arena.template alloc<NodeList>();
+            (*Current)->N = Backrefs->FunctionParams[N];
+            Current       = &(*Current)->Next;
+            continue;
+        }
+
+        size_t OldSize = MangledName.size();
+
+        *Current     = Arena.template alloc<NodeList>();
+        TypeNode* TN = getDerived().demangleType(MangledName, QualifierMangleMode::Drop);
+        if (!TN || Error) return nullptr;
+
+        (*Current)->N = TN;
+
+        size_t CharsConsumed = OldSize - MangledName.size();
+        assert(CharsConsumed != 0);
+
+        // Single-letter types are ignored for backreferences because memorizing
+        // them doesn't save anything.
+        if (Backrefs->FunctionParamCount <= 9 && CharsConsumed > 1)
+            Backrefs->FunctionParams[Backrefs->FunctionParamCount++] = TN;
+
+        Current = &(*Current)->Next;
+    }
+
+    if (Error) return nullptr;
+
+    NodeArrayNode* NA = nodeListToNodeArray(Arena, Head, Count);
+    // A non-empty parameter list is terminated by either 'Z' (variadic) parameter
+    // list or '@' (non variadic).  Careful not to consume "@Z", as in that case
+    // the following Z could be a throw specifier.
+    if (consumeFront(MangledName, '@')) return NA;
+
+    if (consumeFront(MangledName, 'Z')) {
+        IsVariadic = true;
+        return NA;
+    }
+
+    DEMANGLE_UNREACHABLE;
+}
+
+template <typename Derived, typename Alloc>
+constexpr NodeArrayNode*
+MicrosoftDemanglerBase<Derived, Alloc>::demangleTemplateParameterList(std::string_view& MangledName) {
+    DEMANGLE_PROFILE_SCOPE(MicrosoftTemplateParameterList);
+    DEMANGLE_STATS_DEPTH();
+    detail::LimitTracker::Scope LimitScope(Arena.Limits);
+    if (Arena.Limits.Exceeded) {
+        Error = true;
+        return nullptr;
+    }
+    NodeList*  Head    = nullptr;
+    NodeList** Current = &Head;
+    size_t     Count   = 0;
+
+    while (!demangler::itanium_demangle::starts_with(MangledName, '@')) {
+        if (consumeFront(MangledName, "$S") || consumeFront(MangledName, "$$V") || consumeFront(MangledName, "$$$V")
+            || consumeFront(MangledName, "$$Z")) {
+            // parameter pack separator
+            continue;
+        }
+
+        ++Count;
+
+        // Template parameter lists don't participate in back-referencing.
+        *Current = Arena.template alloc<NodeList>();
+
+        NodeList& TP = **Current;
+
+        // <auto-nttp> ::= $ M <type> <nttp>
+        const bool IsAutoNTTP = consumeFront(MangledName, "$M");
+        if (IsAutoNTTP) {
+            // The deduced type of the auto NTTP parameter isn't printed so
+            // we want to ignore the AST created from demangling the type.
+            //
+            // TODO: Avoid the extra allocations to the bump allocator in this case.
+            (void)getDerived().demangleType(MangledName, QualifierMangleMode::Drop);
+            if (Error) return nullptr;
+        }
+
+        TemplateParameterReferenceNode* TPRN = nullptr;
+        if (consumeFront(MangledName, "$$Y")) {
+            // Template alias
+            TP.N = getDerived().demangleFullyQualifiedTypeName(MangledName);
+        } else if (consumeFront(MangledName, "$$B")) {
+            // Array
+            TP.N = getDerived().demangleType(MangledName, QualifierMangleMode::Drop);
+        } else if (consumeFront(MangledName, "$$C")) {
+            // Type has qualifiers.
+            TP.N = getDerived().demangleType(MangledName, QualifierMangleMode::Mangle);
+        } else if (startsWith(MangledName, "$1", "1", !IsAutoNTTP) || startsWith(MangledName, "$H", "H", !IsAutoNTTP)
+                   || startsWith(MangledName, "$I", "I", !IsAutoNTTP)
+                   || startsWith(MangledName, "$J", "J", !IsAutoNTTP)) {
+            // Pointer to member
+            TP.N = TPRN           = Arena.template alloc<TemplateParameterReferenceNode>();
+            TPRN->IsMemberPointer = true;
+
+            if (!IsAutoNTTP) MangledName.remove_prefix(1); // Remove leading '$'
+
+            // 1 - single inheritance       <name>
+            // H - multiple inheritance     <name> <number>
+            // I - virtual inheritance      <name> <number> <number>
+            // J - unspecified inheritance  <name> <number> <number> <number>
+            char InheritanceSpecifier = MangledName.front();
+            MangledName.remove_prefix(1);
+            SymbolNode* S = nullptr;
+            if (demangler::itanium_demangle::starts_with(MangledName, '?')) {
+                S = getDerived().parse(MangledName);
+                if (Error || !S->Name) {
+                    Error = true;
+                    return nullptr;
+                }
+                getDerived().memorizeIdentifier(S->Name->getUnqualifiedIdentifier());
+            }
+
+            switch (InheritanceSpecifier) {
+            case 'J':
+                TPRN->ThunkOffsets[TPRN->ThunkOffsetCount++] = getDerived().demangleSigned(MangledName);
+                DEMANGLE_FALLTHROUGH;
+            case 'I':
+                TPRN->ThunkOffsets[TPRN->ThunkOffsetCount++] = getDerived().demangleSigned(MangledName);
+                DEMANGLE_FALLTHROUGH;
+            case 'H':
+                TPRN->ThunkOffsets[TPRN->ThunkOffsetCount++] = getDerived().demangleSigned(MangledName);
+                DEMANGLE_FALLTHROUGH;
+            case '1':
+                break;
+            default:
+                DEMANGLE_UNREACHABLE;
+            }
+            TPRN->Affinity = PointerAffinity::Pointer;
+            TPRN->Symbol   = S;
+        } else if (demangler::itanium_demangle::starts_with(MangledName, "$E?")) {
+            consumeFront(MangledName, "$E");
+            // Reference to symbol
+            TP.N = TPRN    = Arena.template alloc<TemplateParameterReferenceNode>();
+            TPRN->Symbol   = getDerived().parse(MangledName);
+            TPRN->Affinity = PointerAffinity::Reference;
+        } else if (startsWith(MangledName, "$F", "F", !IsAutoNTTP) || startsWith(MangledName, "$G", "G", !IsAutoNTTP)) {
+            TP.N = TPRN = Arena.template alloc<TemplateParameterReferenceNode>();
+
+            // Data member pointer.
+            if (!IsAutoNTTP) MangledName.remove_prefix(1); // Remove leading '$'
+            char InheritanceSpecifier = MangledName.front();
+            MangledName.remove_prefix(1);
+
+            switch (InheritanceSpecifier) {
+            case 'G':
+                TPRN->ThunkOffsets[TPRN->ThunkOffsetCount++] = getDerived().demangleSigned(MangledName);
+                DEMANGLE_FALLTHROUGH;
+            case 'F':
+                TPRN->ThunkOffsets[TPRN->ThunkOffsetCount++] = getDerived().demangleSigned(MangledName);
+                TPRN->ThunkOffsets[TPRN->ThunkOffsetCount++] = getDerived().demangleSigned(MangledName);
+                break;
+            default:
+                DEMANGLE_UNREACHABLE;
+            }
+            TPRN->IsMemberPointer = true;
+
+        } else if (consumeFront(MangledName, "$0", "0", !IsAutoNTTP)) {
+            // Integral non-type template parameter
+            bool     IsNegative         = false;
+            uint64_t Value              = 0;
+            std::tie(Value, IsNegative) = getDerived().demangleNumber(MangledName);
+
+            TP.N = Arena.template alloc<IntegerLiteralNode>(Value, IsNegative);
+        } else {
+            TP.N = getDerived().demangleType(MangledName, QualifierMangleMode::Drop);
+        }
+        if (Error) return nullptr;
+
+        Current = &TP.Next;
+    }
+
+    // The loop above returns nullptr on Error.
+    assert(!Error);
+
+    // Template parameter lists cannot be variadic, so it can only be terminated
+    // by @ (as opposed to 'Z' in the function parameter case).
+    assert(demangler::itanium_demangle::starts_with(MangledName, '@')); // The above loop exits only on '@'.
+    consumeFront(MangledName, '@');
+    return nodeListToNodeArray(Arena, Head, Count);
+}
+
+template <typename Derived, typename Alloc>
+void MicrosoftDemanglerBase<Derived, Alloc>::dumpBackReferences() {
+    std::printf("%d function parameter backreferences\n", (int)Backrefs->FunctionParamCount);
+
+    // Create an output stream so we can render each type.
+    OutputBuffer OB;
+    for (size_t I = 0; I < Backrefs->FunctionParamCount; ++I) {
+        OB.setCurrentPosition(0);
+
+        TypeNode* T = Backrefs->FunctionParams[I];
+        T->print(OB, OF_Default);
+
+        std::string_view B = OB;
+        std::printf("  [%d] - %.*s\n", (int)I, (int)B.size(), B.data());
+    }
+    std::free(OB.getBuffer());
+
+    if (Backrefs->FunctionParamCount > 0) std::printf("\n");
+    std::printf("%d name backreferences\n", (int)Backrefs->NamesCount);
+    for (size_t I = 0; I < Backrefs->NamesCount; ++I) {
+        std::printf("  [%d] - %.*s\n", (int)I, (int)Backrefs->Names[I]->Name.size(), Backrefs->Names[I]->Name.data());
+    }
+    if (Backrefs->NamesCount > 0) std::printf("\n");
+}
+
+// The demangler with every production virtual. It predates
+// MicrosoftDemanglerBase and is kept for subclasses that override productions
+// at run time; each override forwards to the base implementation, and calls
+// from one production to another go through the vtable as before.
+class Demangler : public MicrosoftDemanglerBase<Demangler> {
+    using Base = MicrosoftDemanglerBase<Demangler>;
+
+public:
+    Demangler() = default;
+    virtual ~Demangler();
+
+    virtual SymbolNode*  parse(std::string_view& MangledName);
+    virtual Node*        parseName(std::string_view& MangledName);
+    virtual TagTypeNode* parseTagUniqueName(std::string_view& MangledName);
+    virtual void         reset();
+    virtual void         dumpBackReferences();
+
+    virtual SymbolNode* demangleEncodedSymbol(std::string_view& MangledName, QualifiedNameNode* QN);
+    virtual SymbolNode* demangleDeclarator(std::string_view& MangledName);
+    virtual SymbolNode* demangleMD5Name(std::string_view& MangledName);
+    virtual SymbolNode* demangleTypeinfoName(std::string_view& MangledName);
+
+    virtual VariableSymbolNode* demangleVariableEncoding(std::string_view& MangledName, StorageClass SC);
+    virtual FunctionSymbolNode* demangleFunctionEncoding(std::string_view& MangledName);
+
+    virtual Qualifiers demanglePointerExtQualifiers(std::string_view& MangledName);
+
+    virtual TypeNode*              demangleType(std::string_view& MangledName, QualifierMangleMode QMM);
+    virtual PrimitiveTypeNode*     demanglePrimitiveType(std::string_view& MangledName);
+    virtual CustomTypeNode*        demangleCustomType(std::string_view& MangledName);
+    virtual TagTypeNode*           demangleClassType(std::string_view& MangledName);
+    virtual PointerTypeNode*       demanglePointerType(std::string_view& MangledName);
+    virtual PointerTypeNode*       demangleMemberPointerType(std::string_view& MangledName);
+    virtual FunctionSignatureNode* demangleFunctionType(std::string_view& MangledName, bool HasThisQuals);
+
+    virtual ArrayTypeNode* demangleArrayType(std::string_view& MangledName);
+
+    virtual NodeArrayNode* demangleFunctionParameterList(std::string_view& MangledName, bool& IsVariadic);
+    virtual NodeArrayNode* demangleTemplateParameterList(std::string_view& MangledName);
+
+    virtual std::pair<uint64_t, bool> demangleNumber(std::string_view& MangledName);
+    virtual uint64_t                  demangleUnsigned(std::string_view& MangledName);
+    virtual int64_t                   demangleSigned(std::string_view& MangledName);
+
+    virtual void memorizeString(std::string_view s);
+    virtual void memorizeIdentifier(IdentifierNode* Identifier);
+
+    virtual std::string_view copyString(std::string_view Borrowed);
+
+    virtual QualifiedNameNode* demangleFullyQualifiedTypeName(std::string_view& MangledName);
+    virtual QualifiedNameNode* demangleFullyQualifiedSymbolName(std::string_view& MangledName);
+
+    virtual IdentifierNode* demangleUnqualifiedTypeName(std::string_view& MangledName, bool Memorize);
+    virtual IdentifierNode* demangleUnqualifiedSymbolName(std::string_view& MangledName, NameBackrefBehavior NBB);
+
+    virtual QualifiedNameNode* demangleNameScopeChain(std::string_view& MangledName, IdentifierNode* UnqualifiedName);
+    virtual IdentifierNode*    demangleNameScopePiece(std::string_view& MangledName);
+
+    virtual NamedIdentifierNode* demangleBackRefName(std::string_view& MangledName);
+    virtual IdentifierNode* demangleTemplateInstantiationName(std::string_view& MangledName, NameBackrefBehavior NBB);
+    virtual IntrinsicFunctionKind translateIntrinsicFunctionCode(char CH, FunctionIdentifierCodeGroup Group);
+    virtual IdentifierNode*       demangleFunctionIdentifierCode(std::string_view& MangledName);
+    virtual IdentifierNode*
+    demangleFunctionIdentifierCode(std::string_view& MangledName, FunctionIdentifierCodeGroup Group);
+    virtual StructorIdentifierNode* demangleStructorIdentifier(std::string_view& MangledName, bool IsDestructor);
+    virtual ConversionOperatorIdentifierNode* demangleConversionOperatorIdentifier(std::string_view& MangledName);
+    virtual LiteralOperatorIdentifierNode*    demangleLiteralOperatorIdentifier(std::string_view& MangledName);
+
+    virtual SymbolNode* demangleSpecialIntrinsic(std::string_view& MangledName);
+    virtual SpecialTableSymbolNode*
+    demangleSpecialTableSymbolNode(std::string_view& MangledName, SpecialIntrinsicKind SIK);
+    virtual LocalStaticGuardVariableNode* demangleLocalStaticGuard(std::string_view& MangledName, bool IsThread);
+    virtual VariableSymbolNode* demangleUntypedVariable(std::string_view& MangledName, std::string_view VariableName);
+    virtual VariableSymbolNode* demangleRttiBaseClassDescriptorNode(std::string_view& MangledName);
+    virtual FunctionSymbolNode* demangleInitFiniStub(std::string_view& MangledName, bool IsDestructor);
+
+    virtual NamedIdentifierNode*      demangleSimpleName(std::string_view& MangledName, bool Memorize);
+    virtual NamedIdentifierNode*      demangleAnonymousNamespaceName(std::string_view& MangledName);
+    virtual NamedIdentifierNode*      demangleLocallyScopedNamePiece(std::string_view& MangledName);
+    virtual EncodedStringLiteralNode* demangleStringLiteral(std::string_view& MangledName);
+    virtual FunctionSymbolNode*       demangleVcallThunkNode(std::string_view& MangledName);
+
+    virtual std::string_view demangleSimpleString(std::string_view& MangledName, bool Memorize);
+
+    virtual FuncClass    demangleFunctionClass(std::string_view& MangledName);
+    virtual CallingConv  demangleCallingConvention(std::string_view& MangledName);
+    virtual StorageClass demangleVariableStorageClass(std::string_view& MangledName);
+    virtual bool         demangleThrowSpecification(std::string_view& MangledName);
+    virtual wchar_t      demangleWcharLiteral(std::string_view& MangledName);
+    virtual uint8_t      demangleCharLiteral(std::string_view& MangledName);
+
+    virtual std::pair<Qualifiers, bool> demangleQualifiers(std::string_view& MangledName);
+};
+
+extern template class MicrosoftDemanglerBase<Demangler>;
+
+// The demangler used by the entry points in Demangle.h. Every production call
+// is resolved at compile time.
+class StaticDemangler final : public MicrosoftDemanglerBase<StaticDemangler> {};
+
 } // namespace ms_demangle
 } // namespace demangler
 
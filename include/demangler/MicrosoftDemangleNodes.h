@@ -14,46 +14,44 @@
 #define LLVM_DEMANGLE_MICROSOFTDEMANGLENODES_H
 
 #include <array>
+#include <cassert>
 #include <cstdint>
 #include <span>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include <demangler/DemangleConfig.h>
+#include <demangler/Utility.h>
 
 #define LL_ENUM_EMU(EmuType, Enum, EnumType)                                                                           \
     constexpr EmuType(Enum type) : val(type) {}                                                                        \
-    inline EmuType(EnumType type) : val(static_cast<Enum>(type)) {}                                                    \
-    inline EmuType& operator=(Enum type) {                                                                             \
+    constexpr EmuType(EnumType type) : val(static_cast<Enum>(type)) {}                                                 \
+    constexpr EmuType& operator=(Enum type) {                                                                          \
         this->val = type;                                                                                              \
         return *this;                                                                                                  \
     }                                                                                                                  \
-    inline EmuType& operator=(const EnumType type) {                                                                   \
+    constexpr EmuType& operator=(const EnumType type) {                                                                \
         this->val = static_cast<Enum>(type);                                                                           \
         return *this;                                                                                                  \
     }                                                                                                                  \
-    inline EnumType operator&(EnumType type) const { return ((EnumType)this->val) & type; }                            \
-    inline EnumType operator|(EnumType type) const { return ((EnumType)this->val) | type; }                            \
+    constexpr EnumType operator&(EnumType type) const { return ((EnumType)this->val) & type; }                         \
+    constexpr EnumType operator|(EnumType type) const { return ((EnumType)this->val) | type; }                         \
                                                                                                                        \
-    inline bool operator==(EmuType type) const { return this->val == type.val; }                                       \
-    inline bool operator!=(EmuType type) const { return this->val != type.val; }                                       \
-    inline bool operator==(Enum type) const { return this->val == type; }                                              \
-    inline bool operator!=(Enum type) const { return this->val != type; }                                              \
-    inline      operator EnumType() const { return static_cast<EnumType>(this->val); }                                 \
-    inline      operator Enum() const { return this->val; }                                                            \
+    constexpr bool operator==(EmuType type) const { return this->val == type.val; }                                    \
+    constexpr bool operator!=(EmuType type) const { return this->val != type.val; }                                    \
+    constexpr bool operator==(Enum type) const { return this->val == type; }                                           \
+    constexpr bool operator!=(Enum type) const { return this->val != type; }                                           \
+    constexpr      operator EnumType() const { return static_cast<EnumType>(this->val); }                              \
+    constexpr      operator Enum() const { return this->val; }                                                         \
                                                                                                                        \
-    void        set(EmuType type) { this->val = type; }                                                                \
-    inline bool has(Enum type) const { return (this->val & type) == type; }                                            \
-    inline void remove(Enum type) { this->val = static_cast<Enum>(this->val & ~type); }                                \
-    inline void add(Enum type) { this->val = static_cast<Enum>(this->val | type); }
+    constexpr void set(EmuType type) { this->val = type; }                                                             \
+    constexpr bool has(Enum type) const { return (this->val & type) == type; }                                         \
+    constexpr void remove(Enum type) { this->val = static_cast<Enum>(this->val & ~type); }                             \
+    constexpr void add(Enum type) { this->val = static_cast<Enum>(this->val | type); }
 
 
-namespace demangler {
-namespace itanium_demangle {
-class OutputBuffer;
-}
-} // namespace demangler
-
 namespace demangler {
 namespace ms_demangle {
 
@@ -89,7 +87,7 @@ public:
     StorageClass() = default;
     LL_ENUM_EMU(StorageClass, StorageClassValue, uint8_t);
 
-    inline char toChar() const {
+    constexpr char toChar() const {
         switch (this->val) {
         case PrivateStatic:
             return '0';
@@ -411,21 +409,76 @@ enum class NodeKind {
 };
 
 struct Node {
+    explicit constexpr Node(NodeKind K) : Kind(K) {}
+    virtual ~Node() = default;
+
+    constexpr NodeKind kind() const { return Kind; }
+
+    constexpr virtual void output(OutputBuffer& OB, OutputFlags Flags) const = 0;
+
+    // Print the node the way output() does, except that this node and all the
+    // nodes below it are dispatched by a switch on their kind rather than
+    // through the vtable. Nodes of kinds not listed in MicrosoftNodes.def fall
+    // back to output().
+    constexpr void print(OutputBuffer& OB, OutputFlags Flags) const;
+
+    std::string toString(OutputFlags Flags = OF_Default) const;
+
+    /// Visit the most-derived object corresponding to this object. Calls
+    /// \c F(P), where \c P is the node cast to the class that
+    /// MicrosoftNodes.def lists for its kind, or \c this for other kinds.
+    template <typename Fn>
+    constexpr decltype(auto) visit(Fn F) const;
+
+private:
+    NodeKind Kind;
+};
+
+// Text that a client attaches around a node and data of its own. Only a few
+// nodes of a symbol ever carry any, so they live in a NodeDecorationTable
+// rather than in the nodes themselves.
+//
+// The library itself never reads or writes decorations: printing ignores
+// them, and a client that sets them prints them itself. They are reachable
+// only where the nodes are, through the Decorations table of a demangler
+// the client drives directly (ms_demangle::Demangler, a subclass of it, or
+// of MicrosoftDemanglerBase), for example from an overridden production:
+//
+//   Decorations.get(N).before = "[[deprecated]] ";
+//
+// The sessions and MicrosoftPartialDemangler keep their nodes, and with them
+// their tables, internal.
+struct NodeDecorations {
     std::string_view            before;
     std::span<std::string_view> after;
     void*                       extras{};
+};
 
-    explicit Node(NodeKind K) : Kind(K) {}
-    virtual ~Node() = default;
+// Decorations keyed by node. The table allocates nothing until the first
+// node is decorated, and lookups scan the few entries linearly.
+class NodeDecorationTable {
+public:
+    /// Return the decorations of \p N, adding empty ones if it has none.
+    constexpr NodeDecorations& get(const Node* N) {
+        for (auto& [Key, Value] : Entries)
+            if (Key == N) return Value;
+        return Entries.emplace_back(N, NodeDecorations{}).second;
+    }
 
-    NodeKind kind() const { return Kind; }
+    /// Return the decorations of \p N, or nullptr if it has none.
+    constexpr const NodeDecorations* find(const Node* N) const {
+        for (const auto& [Key, Value] : Entries)
+            if (Key == N) return &Value;
+        return nullptr;
+    }
 
-    virtual void output(OutputBuffer& OB, OutputFlags Flags) const = 0;
+    constexpr bool empty() const { return Entries.empty(); }
 
-    std::string toString(OutputFlags Flags = OF_Default) const;
+    // Forget every entry but keep the storage for the next symbol.
+    constexpr void clear() { Entries.clear(); }
 
 private:
-    NodeKind Kind;
+    std::vector<std::pair<const Node*, NodeDecorations>> Entries;
 };
 
 struct TypeNode;
@@ -455,34 +508,38 @@ struct VariableSymbolNode;
 struct SpecialTableSymbolNode;
 
 struct TypeNode : public Node {
-    explicit TypeNode(NodeKind K) : Node(K) {}
+    explicit constexpr TypeNode(NodeKind K) : Node(K) {}
 
-    virtual void outputPre(OutputBuffer& OB, OutputFlags Flags) const  = 0;
-    virtual void outputPost(OutputBuffer& OB, OutputFlags Flags) const = 0;
+    constexpr virtual void outputPre(OutputBuffer& OB, OutputFlags Flags) const  = 0;
+    constexpr virtual void outputPost(OutputBuffer& OB, OutputFlags Flags) const = 0;
 
-    void output(OutputBuffer& OB, OutputFlags Flags) const override {
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override {
         outputPre(OB, Flags);
         outputPost(OB, Flags);
     }
 
+    // Statically dispatched outputPre() and outputPost(); see Node::print().
+    constexpr void printPre(OutputBuffer& OB, OutputFlags Flags) const;
+    constexpr void printPost(OutputBuffer& OB, OutputFlags Flags) const;
+
     Qualifiers Quals = Q_None;
 };
 
-struct PrimitiveTypeNode : public TypeNode {
-    explicit PrimitiveTypeNode(PrimitiveKind K) : TypeNode(NodeKind::PrimitiveType), PrimKind(K) {}
+struct PrimitiveTypeNode final : public TypeNode {
+    explicit constexpr PrimitiveTypeNode(PrimitiveKind K) : TypeNode(NodeKind::PrimitiveType), PrimKind(K) {}
 
-    void outputPre(OutputBuffer& OB, OutputFlags Flags) const override;
-    void outputPost(OutputBuffer& OB, OutputFlags Flags) const override {}
+    constexpr void outputPre(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void outputPost(OutputBuffer& OB, OutputFlags Flags) const override {}
 
     PrimitiveKind PrimKind;
 };
 
 struct FunctionSignatureNode : public TypeNode {
-    explicit FunctionSignatureNode(NodeKind K) : TypeNode(K) {}
-    FunctionSignatureNode() : TypeNode(NodeKind::FunctionSignature) {}
+    explicit constexpr FunctionSignatureNode(NodeKind K) : TypeNode(K) {}
+    constexpr FunctionSignatureNode() : TypeNode(NodeKind::FunctionSignature) {}
 
-    void outputPre(OutputBuffer& OB, OutputFlags Flags) const override;
-    void outputPost(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void outputPre(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void outputPost(OutputBuffer& OB, OutputFlags Flags) const override;
 
     // Valid if this FunctionTypeNode is the Pointee of a PointerType or
     // MemberPointerType.
@@ -510,94 +567,94 @@ struct FunctionSignatureNode : public TypeNode {
 };
 
 struct IdentifierNode : public Node {
-    explicit IdentifierNode(NodeKind K) : Node(K) {}
+    explicit constexpr IdentifierNode(NodeKind K) : Node(K) {}
 
     NodeArrayNode* TemplateParams = nullptr;
 
 protected:
-    void outputTemplateParameters(OutputBuffer& OB, OutputFlags Flags) const;
+    constexpr void outputTemplateParameters(OutputBuffer& OB, OutputFlags Flags) const;
 };
 
-struct VcallThunkIdentifierNode : public IdentifierNode {
-    VcallThunkIdentifierNode() : IdentifierNode(NodeKind::VcallThunkIdentifier) {}
+struct VcallThunkIdentifierNode final : public IdentifierNode {
+    constexpr VcallThunkIdentifierNode() : IdentifierNode(NodeKind::VcallThunkIdentifier) {}
 
-    void output(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override;
 
     uint64_t OffsetInVTable = 0;
 };
 
-struct DynamicStructorIdentifierNode : public IdentifierNode {
-    DynamicStructorIdentifierNode() : IdentifierNode(NodeKind::DynamicStructorIdentifier) {}
+struct DynamicStructorIdentifierNode final : public IdentifierNode {
+    constexpr DynamicStructorIdentifierNode() : IdentifierNode(NodeKind::DynamicStructorIdentifier) {}
 
-    void output(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override;
 
     VariableSymbolNode* Variable     = nullptr;
     QualifiedNameNode*  Name         = nullptr;
     bool                IsDestructor = false;
 };
 
-struct NamedIdentifierNode : public IdentifierNode {
-    NamedIdentifierNode() : IdentifierNode(NodeKind::NamedIdentifier) {}
+struct NamedIdentifierNode final : public IdentifierNode {
+    constexpr NamedIdentifierNode() : IdentifierNode(NodeKind::NamedIdentifier) {}
 
-    void output(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override;
 
     std::string_view Name;
 };
 
-struct IntrinsicFunctionIdentifierNode : public IdentifierNode {
-    explicit IntrinsicFunctionIdentifierNode(IntrinsicFunctionKind Operator)
+struct IntrinsicFunctionIdentifierNode final : public IdentifierNode {
+    explicit constexpr IntrinsicFunctionIdentifierNode(IntrinsicFunctionKind Operator)
     : IdentifierNode(NodeKind::IntrinsicFunctionIdentifier),
       Operator(Operator) {}
 
-    void output(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override;
 
     IntrinsicFunctionKind Operator;
 };
 
-struct LiteralOperatorIdentifierNode : public IdentifierNode {
-    LiteralOperatorIdentifierNode() : IdentifierNode(NodeKind::LiteralOperatorIdentifier) {}
+struct LiteralOperatorIdentifierNode final : public IdentifierNode {
+    constexpr LiteralOperatorIdentifierNode() : IdentifierNode(NodeKind::LiteralOperatorIdentifier) {}
 
-    void output(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override;
 
     std::string_view Name;
 };
 
-struct LocalStaticGuardIdentifierNode : public IdentifierNode {
-    LocalStaticGuardIdentifierNode() : IdentifierNode(NodeKind::LocalStaticGuardIdentifier) {}
+struct LocalStaticGuardIdentifierNode final : public IdentifierNode {
+    constexpr LocalStaticGuardIdentifierNode() : IdentifierNode(NodeKind::LocalStaticGuardIdentifier) {}
 
-    void output(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override;
 
     bool     IsThread   = false;
     uint32_t ScopeIndex = 0;
 };
 
-struct ConversionOperatorIdentifierNode : public IdentifierNode {
-    ConversionOperatorIdentifierNode() : IdentifierNode(NodeKind::ConversionOperatorIdentifier) {}
+struct ConversionOperatorIdentifierNode final : public IdentifierNode {
+    constexpr ConversionOperatorIdentifierNode() : IdentifierNode(NodeKind::ConversionOperatorIdentifier) {}
 
-    void output(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override;
 
     // The type that this operator converts too.
     TypeNode* TargetType = nullptr;
 };
 
-struct StructorIdentifierNode : public IdentifierNode {
-    StructorIdentifierNode() : IdentifierNode(NodeKind::StructorIdentifier) {}
-    explicit StructorIdentifierNode(bool IsDestructor)
+struct StructorIdentifierNode final : public IdentifierNode {
+    constexpr StructorIdentifierNode() : IdentifierNode(NodeKind::StructorIdentifier) {}
+    explicit constexpr StructorIdentifierNode(bool IsDestructor)
     : IdentifierNode(NodeKind::StructorIdentifier),
       IsDestructor(IsDestructor) {}
 
-    void output(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override;
 
     // The name of the class that this is a structor of.
     IdentifierNode* Class        = nullptr;
     bool            IsDestructor = false;
 };
 
-struct ThunkSignatureNode : public FunctionSignatureNode {
-    ThunkSignatureNode() : FunctionSignatureNode(NodeKind::ThunkSignature) {}
+struct ThunkSignatureNode final : public FunctionSignatureNode {
+    constexpr ThunkSignatureNode() : FunctionSignatureNode(NodeKind::ThunkSignature) {}
 
-    void outputPre(OutputBuffer& OB, OutputFlags Flags) const override;
-    void outputPost(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void outputPre(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void outputPost(OutputBuffer& OB, OutputFlags Flags) const override;
 
     struct ThisAdjustor {
         uint32_t StaticOffset   = 0;
@@ -609,10 +666,10 @@ struct ThunkSignatureNode : public FunctionSignatureNode {
     ThisAdjustor ThisAdjust;
 };
 
-struct PointerTypeNode : public TypeNode {
-    PointerTypeNode() : TypeNode(NodeKind::PointerType) {}
-    void outputPre(OutputBuffer& OB, OutputFlags Flags) const override;
-    void outputPost(OutputBuffer& OB, OutputFlags Flags) const override;
+struct PointerTypeNode final : public TypeNode {
+    constexpr PointerTypeNode() : TypeNode(NodeKind::PointerType) {}
+    constexpr void outputPre(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void outputPost(OutputBuffer& OB, OutputFlags Flags) const override;
 
     // Is this a pointer, reference, or rvalue-reference?
     PointerAffinity Affinity = PointerAffinity::None;
@@ -625,24 +682,24 @@ struct PointerTypeNode : public TypeNode {
     TypeNode* Pointee = nullptr;
 };
 
-struct TagTypeNode : public TypeNode {
-    explicit TagTypeNode(TagKind Tag) : TypeNode(NodeKind::TagType), Tag(Tag) {}
+struct TagTypeNode final : public TypeNode {
+    explicit constexpr TagTypeNode(TagKind Tag) : TypeNode(NodeKind::TagType), Tag(Tag) {}
 
-    void outputPre(OutputBuffer& OB, OutputFlags Flags) const override;
-    void outputPost(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void outputPre(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void outputPost(OutputBuffer& OB, OutputFlags Flags) const override;
 
     QualifiedNameNode* QualifiedName = nullptr;
     TagKind            Tag;
 };
 
-struct ArrayTypeNode : public TypeNode {
-    ArrayTypeNode() : TypeNode(NodeKind::ArrayType) {}
+struct ArrayTypeNode final : public TypeNode {
+    constexpr ArrayTypeNode() : TypeNode(NodeKind::ArrayType) {}
 
-    void outputPre(OutputBuffer& OB, OutputFlags Flags) const override;
-    void outputPost(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void outputPre(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void outputPost(OutputBuffer& OB, OutputFlags Flags) const override;
 
-    void outputDimensionsImpl(OutputBuffer& OB, OutputFlags Flags) const;
-    void outputOneDimension(OutputBuffer& OB, OutputFlags Flags, Node* N) const;
+    constexpr void outputDimensionsImpl(OutputBuffer& OB, OutputFlags Flags) const;
+    constexpr void outputOneDimension(OutputBuffer& OB, OutputFlags Flags, Node* N) const;
 
     // A list of array dimensions.  e.g. [3,4,5] in `int Foo[3][4][5]`
     NodeArrayNode* Dimensions = nullptr;
@@ -652,47 +709,47 @@ struct ArrayTypeNode : public TypeNode {
 };
 
 struct IntrinsicNode : public TypeNode {
-    IntrinsicNode() : TypeNode(NodeKind::IntrinsicType) {}
-    void output(OutputBuffer& OB, OutputFlags Flags) const override {}
+    constexpr IntrinsicNode() : TypeNode(NodeKind::IntrinsicType) {}
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override {}
 };
 
-struct CustomTypeNode : public TypeNode {
-    CustomTypeNode() : TypeNode(NodeKind::Custom) {}
+struct CustomTypeNode final : public TypeNode {
+    constexpr CustomTypeNode() : TypeNode(NodeKind::Custom) {}
 
-    void outputPre(OutputBuffer& OB, OutputFlags Flags) const override;
-    void outputPost(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void outputPre(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void outputPost(OutputBuffer& OB, OutputFlags Flags) const override;
 
     IdentifierNode* Identifier = nullptr;
 };
 
-struct NodeArrayNode : public Node {
-    NodeArrayNode() : Node(NodeKind::NodeArray) {}
+struct NodeArrayNode final : public Node {
+    constexpr NodeArrayNode() : Node(NodeKind::NodeArray) {}
 
-    void output(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override;
 
-    void output(OutputBuffer& OB, OutputFlags Flags, std::string_view Separator) const;
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags, std::string_view Separator) const;
 
     Node** Nodes = nullptr;
     size_t Count = 0;
 };
 
-struct QualifiedNameNode : public Node {
-    QualifiedNameNode() : Node(NodeKind::QualifiedName) {}
+struct QualifiedNameNode final : public Node {
+    constexpr QualifiedNameNode() : Node(NodeKind::QualifiedName) {}
 
-    void output(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override;
 
     NodeArrayNode* Components = nullptr;
 
-    IdentifierNode* getUnqualifiedIdentifier() {
+    constexpr IdentifierNode* getUnqualifiedIdentifier() {
         Node* LastComponent = Components->Nodes[Components->Count - 1];
         return static_cast<IdentifierNode*>(LastComponent);
     }
 };
 
-struct TemplateParameterReferenceNode : public Node {
-    TemplateParameterReferenceNode() : Node(NodeKind::TemplateParameterReference) {}
+struct TemplateParameterReferenceNode final : public Node {
+    constexpr TemplateParameterReferenceNode() : Node(NodeKind::TemplateParameterReference) {}
 
-    void output(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override;
 
     SymbolNode* Symbol = nullptr;
 
@@ -702,23 +759,23 @@ struct TemplateParameterReferenceNode : public Node {
     bool                   IsMemberPointer = false;
 };
 
-struct IntegerLiteralNode : public Node {
-    IntegerLiteralNode() : Node(NodeKind::IntegerLiteral) {}
-    IntegerLiteralNode(uint64_t Value, bool IsNegative)
+struct IntegerLiteralNode final : public Node {
+    constexpr IntegerLiteralNode() : Node(NodeKind::IntegerLiteral) {}
+    constexpr IntegerLiteralNode(uint64_t Value, bool IsNegative)
     : Node(NodeKind::IntegerLiteral),
       Value(Value),
       IsNegative(IsNegative) {}
 
-    void output(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override;
 
     uint64_t Value      = 0;
     bool     IsNegative = false;
 };
 
-struct RttiBaseClassDescriptorNode : public IdentifierNode {
-    RttiBaseClassDescriptorNode() : IdentifierNode(NodeKind::RttiBaseClassDescriptor) {}
+struct RttiBaseClassDescriptorNode final : public IdentifierNode {
+    constexpr RttiBaseClassDescriptorNode() : IdentifierNode(NodeKind::RttiBaseClassDescriptor) {}
 
-    void output(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override;
 
     uint32_t NVOffset      = 0;
     int32_t  VBPtrOffset   = 0;
@@ -727,54 +784,670 @@ struct RttiBaseClassDescriptorNode : public IdentifierNode {
 };
 
 struct SymbolNode : public Node {
-    explicit SymbolNode(NodeKind K) : Node(K) {}
-    void               output(OutputBuffer& OB, OutputFlags Flags) const override;
+    explicit constexpr SymbolNode(NodeKind K) : Node(K) {}
+    constexpr void     output(OutputBuffer& OB, OutputFlags Flags) const override;
     QualifiedNameNode* Name = nullptr;
 };
 
-struct SpecialTableSymbolNode : public SymbolNode {
-    explicit SpecialTableSymbolNode() : SymbolNode(NodeKind::SpecialTableSymbol) {}
+struct SpecialTableSymbolNode final : public SymbolNode {
+    explicit constexpr SpecialTableSymbolNode() : SymbolNode(NodeKind::SpecialTableSymbol) {}
 
-    void               output(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void     output(OutputBuffer& OB, OutputFlags Flags) const override;
     QualifiedNameNode* TargetName = nullptr;
     Qualifiers         Quals      = Qualifiers::Q_None;
 };
 
-struct LocalStaticGuardVariableNode : public SymbolNode {
-    LocalStaticGuardVariableNode() : SymbolNode(NodeKind::LocalStaticGuardVariable) {}
+struct LocalStaticGuardVariableNode final : public SymbolNode {
+    constexpr LocalStaticGuardVariableNode() : SymbolNode(NodeKind::LocalStaticGuardVariable) {}
 
-    void output(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override;
 
     bool IsVisible = false;
 };
 
-struct EncodedStringLiteralNode : public SymbolNode {
-    EncodedStringLiteralNode() : SymbolNode(NodeKind::EncodedStringLiteral) {}
+struct EncodedStringLiteralNode final : public SymbolNode {
+    constexpr EncodedStringLiteralNode() : SymbolNode(NodeKind::EncodedStringLiteral) {}
 
-    void output(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override;
 
     std::string_view DecodedString;
     bool             IsTruncated = false;
     CharKind         Char        = CharKind::Char;
 };
 
-struct VariableSymbolNode : public SymbolNode {
-    VariableSymbolNode() : SymbolNode(NodeKind::VariableSymbol) {}
+struct VariableSymbolNode final : public SymbolNode {
+    constexpr VariableSymbolNode() : SymbolNode(NodeKind::VariableSymbol) {}
 
-    void output(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override;
 
     StorageClass SC   = StorageClass::None;
     TypeNode*    Type = nullptr;
 };
 
-struct FunctionSymbolNode : public SymbolNode {
-    FunctionSymbolNode() : SymbolNode(NodeKind::FunctionSymbol) {}
+struct FunctionSymbolNode final : public SymbolNode {
+    constexpr FunctionSymbolNode() : SymbolNode(NodeKind::FunctionSymbol) {}
 
-    void output(OutputBuffer& OB, OutputFlags Flags) const override;
+    constexpr void output(OutputBuffer& OB, OutputFlags Flags) const override;
 
     FunctionSignatureNode* Signature = nullptr;
 };
 
+template <typename Fn>
+constexpr decltype(auto) Node::visit(Fn F) const {
+    switch (Kind) {
+#define NODE(K, X)                                                                                                     \
+    case NodeKind::K:                                                                                                  \
+        return F(static_cast<const X*>(this));
+#include "MicrosoftNodes.def"
+    default:
+        break;
+    }
+    return F(this);
+}
+
+#define OUTPUT_ENUM_CLASS_VALUE(Enum, Value, Desc)                                                                     \
+    case Enum::Value:                                                                                                  \
+        OB << Desc;                                                                                                    \
+        break;
+
+// Writes a space if the last token does not end with a punctuation.
+constexpr void outputSpaceIfNecessary(OutputBuffer& OB) {
+    if (OB.empty()) return;
+
+    char C = OB.back();
+    if ((C >= '0' && C <= '9') || (C >= 'a' && C <= 'z') || (C >= 'A' && C <= 'Z') || C == '>') OB << " ";
+}
+
+constexpr void outputSingleQualifier(OutputBuffer& OB, Qualifiers Q) {
+    switch (Q) {
+    case Q_Const:
+        OB << "const";
+        break;
+    case Q_Volatile:
+        OB << "volatile";
+        break;
+    case Q_Restrict:
+        OB << "__restrict";
+        break;
+    default:
+        break;
+    }
+}
+
+constexpr bool outputQualifierIfPresent(OutputBuffer& OB, Qualifiers Q, Qualifiers Mask, bool NeedSpace) {
+    if (!(Q & Mask)) return NeedSpace;
+
+    if (NeedSpace) OB << " ";
+
+    outputSingleQualifier(OB, Mask);
+    return true;
+}
+
+constexpr void outputQualifiers(OutputBuffer& OB, Qualifiers Q, bool SpaceBefore, bool SpaceAfter) {
+    if (Q == Q_None) return;
+
+    size_t Pos1 = OB.getCurrentPosition();
+    SpaceBefore = outputQualifierIfPresent(OB, Q, Q_Const, SpaceBefore);
+    SpaceBefore = outputQualifierIfPresent(OB, Q, Q_Volatile, SpaceBefore);
+    SpaceBefore = outputQualifierIfPresent(OB, Q, Q_Restrict, SpaceBefore);
+    size_t Pos2 = OB.getCurrentPosition();
+    if (SpaceAfter && Pos2 > Pos1) OB << " ";
+}
+
+constexpr void outputCallingConvention(OutputBuffer& OB, CallingConv CC) {
+    outputSpaceIfNecessary(OB);
+
+    switch (CC) {
+    case CallingConv::Cdecl:
+        OB << "__cdecl";
+        break;
+    case CallingConv::Fastcall:
+        OB << "__fastcall";
+        break;
+    case CallingConv::Pascal:
+        OB << "__pascal";
+        break;
+    case CallingConv::Regcall:
+        OB << "__regcall";
+        break;
+    case CallingConv::Stdcall:
+        OB << "__stdcall";
+        break;
+    case CallingConv::Thiscall:
+        OB << "__thiscall";
+        break;
+    case CallingConv::Eabi:
+        OB << "__eabi";
+        break;
+    case CallingConv::Vectorcall:
+        OB << "__vectorcall";
+        break;
+    case CallingConv::Clrcall:
+        OB << "__clrcall";
+        break;
+    case CallingConv::Swift:
+        OB << "__attribute__((__swiftcall__)) ";
+        break;
+    case CallingConv::SwiftAsync:
+        OB << "__attribute__((__swiftasynccall__)) ";
+        break;
+    default:
+        break;
+    }
+}
+
+// Node::print() and TypeNode::printPre/printPost() are the only places that
+// dispatch on the node type. Each case calls the implementation of the most
+// derived class by its qualified name, which is not a virtual call, and all
+// the implementations are in this header, so the compiler can inline them and
+// constant evaluation can run them.
+template <typename T>
+constexpr void printAs(const Node* N, OutputBuffer& OB, OutputFlags Flags) {
+    const T* Derived = static_cast<const T*>(N);
+    if constexpr (std::is_base_of_v<TypeNode, T>) {
+        Derived->T::outputPre(OB, Flags);
+        Derived->T::outputPost(OB, Flags);
+    } else {
+        Derived->T::output(OB, Flags);
+    }
+}
+
+template <typename T>
+constexpr void printPreAs(const TypeNode* N, OutputBuffer& OB, OutputFlags Flags) {
+    if constexpr (std::is_base_of_v<TypeNode, T>) static_cast<const T*>(N)->T::outputPre(OB, Flags);
+    else DEMANGLE_UNREACHABLE;
+}
+
+template <typename T>
+constexpr void printPostAs(const TypeNode* N, OutputBuffer& OB, OutputFlags Flags) {
+    if constexpr (std::is_base_of_v<TypeNode, T>) static_cast<const T*>(N)->T::outputPost(OB, Flags);
+    else DEMANGLE_UNREACHABLE;
+}
+
+constexpr void Node::print(OutputBuffer& OB, OutputFlags Flags) const {
+    if (OB.isPastPrintLimit()) return;
+    switch (Kind) {
+#define NODE(K, X)                                                                                                     \
+    case NodeKind::K:                                                                                                  \
+        return printAs<X>(this, OB, Flags);
+#include "MicrosoftNodes.def"
+    default:
+        return output(OB, Flags);
+    }
+}
+
+constexpr void TypeNode::printPre(OutputBuffer& OB, OutputFlags Flags) const {
+    switch (kind()) {
+#define NODE(K, X)                                                                                                     \
+    case NodeKind::K:                                                                                                  \
+        return printPreAs<X>(this, OB, Flags);
+#include "MicrosoftNodes.def"
+    default:
+        return outputPre(OB, Flags);
+    }
+}
+
+constexpr void TypeNode::printPost(OutputBuffer& OB, OutputFlags Flags) const {
+    switch (kind()) {
+#define NODE(K, X)                                                                                                     \
+    case NodeKind::K:                                                                                                  \
+        return printPostAs<X>(this, OB, Flags);
+#include "MicrosoftNodes.def"
+    default:
+        return outputPost(OB, Flags);
+    }
+}
+
+constexpr void PrimitiveTypeNode::outputPre(OutputBuffer& OB, OutputFlags Flags) const {
+    switch (PrimKind) {
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Void, "void");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Bool, "bool");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Char, "char");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Schar, "signed char");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Uchar, "unsigned char");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Char8, "char8_t");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Char16, "char16_t");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Char32, "char32_t");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Short, "short");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Ushort, "unsigned short");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Int, "int");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Uint, "unsigned int");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Long, "long");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Ulong, "unsigned long");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Int64, "__int64");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Uint64, "unsigned __int64");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Wchar, "wchar_t");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Float, "float");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Double, "double");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Ldouble, "long double");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Nullptr, "std::nullptr_t");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, Auto, "auto");
+        OUTPUT_ENUM_CLASS_VALUE(PrimitiveKind, DecltypeAuto, "decltype(auto)");
+    }
+    outputQualifiers(OB, Quals, true, false);
+}
+
+constexpr void NodeArrayNode::output(OutputBuffer& OB, OutputFlags Flags) const { output(OB, Flags, ", "); }
+
+constexpr void NodeArrayNode::output(OutputBuffer& OB, OutputFlags Flags, std::string_view Separator) const {
+    if (Count == 0) return;
+    if (Nodes[0]) Nodes[0]->print(OB, Flags);
+    for (size_t I = 1; I < Count; ++I) {
+        OB << Separator;
+        Nodes[I]->print(OB, Flags);
+    }
+}
+
+constexpr void EncodedStringLiteralNode::output(OutputBuffer& OB, OutputFlags Flags) const {
+    switch (Char) {
+    case CharKind::Wchar:
+        OB << "L\"";
+        break;
+    case CharKind::Char:
+        OB << "\"";
+        break;
+    case CharKind::Char16:
+        OB << "u\"";
+        break;
+    case CharKind::Char32:
+        OB << "U\"";
+        break;
+    }
+    OB << DecodedString << "\"";
+    if (IsTruncated) OB << "...";
+}
+
+constexpr void IntegerLiteralNode::output(OutputBuffer& OB, OutputFlags Flags) const {
+    if (IsNegative) OB << '-';
+    OB << Value;
+}
+
+constexpr void TemplateParameterReferenceNode::output(OutputBuffer& OB, OutputFlags Flags) const {
+    if (ThunkOffsetCount > 0) OB << "{";
+    else if (Affinity == PointerAffinity::Pointer) OB << "&";
+
+    if (Symbol) {
+        Symbol->print(OB, Flags);
+        if (ThunkOffsetCount > 0) OB << ", ";
+    }
+
+    if (ThunkOffsetCount > 0) OB << ThunkOffsets[0];
+    for (int I = 1; I < ThunkOffsetCount; ++I) {
+        OB << ", " << ThunkOffsets[I];
+    }
+    if (ThunkOffsetCount > 0) OB << "}";
+}
+
+constexpr void IdentifierNode::outputTemplateParameters(OutputBuffer& OB, OutputFlags Flags) const {
+    if (!TemplateParams || (Flags & OF_NoTemplateParameters)) return;
+    OB << "<";
+    TemplateParams->output(OB, Flags);
+    OB << ">";
+}
+
+constexpr void DynamicStructorIdentifierNode::output(OutputBuffer& OB, OutputFlags Flags) const {
+    if (IsDestructor) OB << "`dynamic atexit destructor for ";
+    else OB << "`dynamic initializer for ";
+
+    if (Variable) {
+        OB << "`";
+        Variable->output(OB, Flags);
+        OB << "''";
+    } else {
+        OB << "'";
+        Name->output(OB, Flags);
+        OB << "''";
+    }
+}
+
+constexpr void NamedIdentifierNode::output(OutputBuffer& OB, OutputFlags Flags) const {
+    OB << Name;
+    outputTemplateParameters(OB, Flags);
+}
+
+constexpr void IntrinsicFunctionIdentifierNode::output(OutputBuffer& OB, OutputFlags Flags) const {
+    switch (Operator) {
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, New, "operator new");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, Delete, "operator delete");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, Assign, "operator=");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, RightShift, "operator>>");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, LeftShift, "operator<<");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, LogicalNot, "operator!");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, Equals, "operator==");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, NotEquals, "operator!=");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, ArraySubscript, "operator[]");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, Pointer, "operator->");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, Increment, "operator++");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, Decrement, "operator--");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, Minus, "operator-");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, Plus, "operator+");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, Dereference, "operator*");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, BitwiseAnd, "operator&");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, MemberPointer, "operator->*");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, Divide, "operator/");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, Modulus, "operator%");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, LessThan, "operator<");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, LessThanEqual, "operator<=");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, GreaterThan, "operator>");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, GreaterThanEqual, "operator>=");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, Comma, "operator,");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, Parens, "operator()");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, BitwiseNot, "operator~");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, BitwiseXor, "operator^");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, BitwiseOr, "operator|");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, LogicalAnd, "operator&&");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, LogicalOr, "operator||");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, TimesEqual, "operator*=");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, PlusEqual, "operator+=");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, MinusEqual, "operator-=");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, DivEqual, "operator/=");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, ModEqual, "operator%=");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, RshEqual, "operator>>=");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, LshEqual, "operator<<=");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, BitwiseAndEqual, "operator&=");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, BitwiseOrEqual, "operator|=");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, BitwiseXorEqual, "operator^=");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, VbaseDtor, "`vbase dtor'");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, VecDelDtor, "`vector deleting dtor'");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, DefaultCtorClosure, "`default ctor closure'");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, ScalarDelDtor, "`scalar deleting dtor'");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, VecCtorIter, "`vector ctor iterator'");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, VecDtorIter, "`vector dtor iterator'");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, VecVbaseCtorIter, "`vector vbase ctor iterator'");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, VdispMap, "`virtual displacement map'");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, EHVecCtorIter, "`eh vector ctor iterator'");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, EHVecDtorIter, "`eh vector dtor iterator'");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, EHVecVbaseCtorIter, "`eh vector vbase ctor iterator'");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, CopyCtorClosure, "`copy ctor closure'");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, LocalVftableCtorClosure, "`local vftable ctor closure'");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, ArrayNew, "operator new[]");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, ArrayDelete, "operator delete[]");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, ManVectorCtorIter, "`managed vector ctor iterator'");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, ManVectorDtorIter, "`managed vector dtor iterator'");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, EHVectorCopyCtorIter, "`EH vector copy ctor iterator'");
+        OUTPUT_ENUM_CLASS_VALUE(
+            IntrinsicFunctionKind,
+            EHVectorVbaseCopyCtorIter,
+            "`EH vector vbase copy ctor iterator'"
+        );
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, VectorCopyCtorIter, "`vector copy ctor iterator'");
+        OUTPUT_ENUM_CLASS_VALUE(
+            IntrinsicFunctionKind,
+            VectorVbaseCopyCtorIter,
+            "`vector vbase copy constructor iterator'"
+        );
+        OUTPUT_ENUM_CLASS_VALUE(
+            IntrinsicFunctionKind,
+            ManVectorVbaseCopyCtorIter,
+            "`managed vector vbase copy constructor iterator'"
+        );
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, CoAwait, "operator co_await");
+        OUTPUT_ENUM_CLASS_VALUE(IntrinsicFunctionKind, Spaceship, "operator<=>");
+    case IntrinsicFunctionKind::MaxIntrinsic:
+    case IntrinsicFunctionKind::None:
+        break;
+    }
+    outputTemplateParameters(OB, Flags);
+}
+
+constexpr void LocalStaticGuardIdentifierNode::output(OutputBuffer& OB, OutputFlags Flags) const {
+    if (IsThread) OB << "`local static thread guard'";
+    else OB << "`local static guard'";
+    if (ScopeIndex > 0) OB << "{" << ScopeIndex << "}";
+}
+
+constexpr void ConversionOperatorIdentifierNode::output(OutputBuffer& OB, OutputFlags Flags) const {
+    OB << "operator";
+    outputTemplateParameters(OB, Flags);
+    OB << " ";
+    TargetType->print(OB, Flags);
+}
+
+constexpr void StructorIdentifierNode::output(OutputBuffer& OB, OutputFlags Flags) const {
+    if (IsDestructor) OB << "~";
+    Class->print(OB, Flags);
+    outputTemplateParameters(OB, Flags);
+}
+
+constexpr void LiteralOperatorIdentifierNode::output(OutputBuffer& OB, OutputFlags Flags) const {
+    OB << "operator \"\"" << Name;
+    outputTemplateParameters(OB, Flags);
+}
+
+constexpr void FunctionSignatureNode::outputPre(OutputBuffer& OB, OutputFlags Flags) const {
+    if (!(Flags & OF_NoAccessSpecifier)) {
+        if (FunctionClass & FC_Public) OB << "public: ";
+        if (FunctionClass & FC_Protected) OB << "protected: ";
+        if (FunctionClass & FC_Private) OB << "private: ";
+    }
+
+    if (!(Flags & OF_NoMemberType)) {
+        if (!(FunctionClass & FC_Global)) {
+            if (FunctionClass & FC_Static) OB << "static ";
+        }
+        if (FunctionClass & FC_Virtual) OB << "virtual ";
+
+        if (FunctionClass & FC_ExternC) OB << "extern \"C\" ";
+    }
+
+    if (!(Flags & OF_NoReturnType) && ReturnType) {
+        ReturnType->printPre(OB, Flags);
+        OB << " ";
+    }
+
+    if (!(Flags & OF_NoCallingConvention)) outputCallingConvention(OB, CallConvention);
+}
+
+constexpr void FunctionSignatureNode::outputPost(OutputBuffer& OB, OutputFlags Flags) const {
+    if (!(FunctionClass & FC_NoParameterList)) {
+        OB << "(";
+        if (Params) Params->output(OB, Flags);
+        else OB << "void";
+
+        if (IsVariadic) {
+            if (OB.back() != '(') OB << ", ";
+            OB << "...";
+        }
+        OB << ")";
+    }
+
+    if (Quals & Q_Const) OB << " const";
+    if (Quals & Q_Volatile) OB << " volatile";
+    if (Quals & Q_Restrict) OB << " __restrict";
+    if (Quals & Q_Unaligned) OB << " __unaligned";
+
+    if (IsNoexcept) OB << " noexcept";
+
+    if (RefQualifier == FunctionRefQualifier::Reference) OB << " &";
+    else if (RefQualifier == FunctionRefQualifier::RValueReference) OB << " &&";
+
+    if (!(Flags & OF_NoReturnType) && ReturnType) ReturnType->printPost(OB, Flags);
+}
+
+constexpr void ThunkSignatureNode::outputPre(OutputBuffer& OB, OutputFlags Flags) const {
+    OB << "[thunk]: ";
+
+    FunctionSignatureNode::outputPre(OB, Flags);
+}
+
+constexpr void ThunkSignatureNode::outputPost(OutputBuffer& OB, OutputFlags Flags) const {
+    if (FunctionClass & FC_StaticThisAdjust) {
+        OB << "`adjustor{" << ThisAdjust.StaticOffset << "}'";
+    } else if (FunctionClass & FC_VirtualThisAdjust) {
+        if (FunctionClass & FC_VirtualThisAdjustEx) {
+            OB << "`vtordispex{" << ThisAdjust.VBPtrOffset << ", " << ThisAdjust.VBOffsetOffset << ", "
+               << ThisAdjust.VtordispOffset << ", " << ThisAdjust.StaticOffset << "}'";
+        } else {
+            OB << "`vtordisp{" << ThisAdjust.VtordispOffset << ", " << ThisAdjust.StaticOffset << "}'";
+        }
+    }
+
+    FunctionSignatureNode::outputPost(OB, Flags);
+}
+
+constexpr void PointerTypeNode::outputPre(OutputBuffer& OB, OutputFlags Flags) const {
+    if (Pointee->kind() == NodeKind::FunctionSignature) {
+        // If this is a pointer to a function, don't output the calling convention.
+        // It needs to go inside the parentheses.
+        const FunctionSignatureNode* Sig = static_cast<const FunctionSignatureNode*>(Pointee);
+        Sig->printPre(OB, OF_NoCallingConvention);
+    } else Pointee->printPre(OB, Flags);
+
+    outputSpaceIfNecessary(OB);
+
+    if (Quals & Q_Unaligned) OB << "__unaligned ";
+
+    if (Pointee->kind() == NodeKind::ArrayType) {
+        OB << "(";
+    } else if (Pointee->kind() == NodeKind::FunctionSignature) {
+        OB << "(";
+        const FunctionSignatureNode* Sig = static_cast<const FunctionSignatureNode*>(Pointee);
+        outputCallingConvention(OB, Sig->CallConvention);
+        OB << " ";
+    }
+
+    if (ClassParent) {
+        ClassParent->output(OB, Flags);
+        OB << "::";
+    }
+
+    switch (Affinity) {
+    case PointerAffinity::Pointer:
+        OB << "*";
+        break;
+    case PointerAffinity::Reference:
+        OB << "&";
+        break;
+    case PointerAffinity::RValueReference:
+        OB << "&&";
+        break;
+    default:
+        assert(false);
+    }
+    outputQualifiers(OB, Quals, false, false);
+}
+
+constexpr void PointerTypeNode::outputPost(OutputBuffer& OB, OutputFlags Flags) const {
+    if (Pointee->kind() == NodeKind::ArrayType || Pointee->kind() == NodeKind::FunctionSignature) OB << ")";
+
+    Pointee->printPost(OB, Flags);
+}
+
+constexpr void TagTypeNode::outputPre(OutputBuffer& OB, OutputFlags Flags) const {
+    if (!(Flags & OF_NoTagSpecifier)) {
+        switch (Tag) {
+            OUTPUT_ENUM_CLASS_VALUE(TagKind, Class, "class");
+            OUTPUT_ENUM_CLASS_VALUE(TagKind, Struct, "struct");
+            OUTPUT_ENUM_CLASS_VALUE(TagKind, Union, "union");
+            OUTPUT_ENUM_CLASS_VALUE(TagKind, Enum, "enum");
+        }
+        OB << " ";
+    }
+    QualifiedName->output(OB, Flags);
+    outputQualifiers(OB, Quals, true, false);
+}
+
+constexpr void TagTypeNode::outputPost(OutputBuffer& OB, OutputFlags Flags) const {}
+
+constexpr void ArrayTypeNode::outputPre(OutputBuffer& OB, OutputFlags Flags) const {
+    ElementType->printPre(OB, Flags);
+    outputQualifiers(OB, Quals, true, false);
+}
+
+constexpr void ArrayTypeNode::outputOneDimension(OutputBuffer& OB, OutputFlags Flags, Node* N) const {
+    assert(N->kind() == NodeKind::IntegerLiteral);
+    IntegerLiteralNode* ILN = static_cast<IntegerLiteralNode*>(N);
+    if (ILN->Value != 0) ILN->output(OB, Flags);
+}
+
+constexpr void ArrayTypeNode::outputDimensionsImpl(OutputBuffer& OB, OutputFlags Flags) const {
+    if (Dimensions->Count == 0) return;
+
+    outputOneDimension(OB, Flags, Dimensions->Nodes[0]);
+    for (size_t I = 1; I < Dimensions->Count; ++I) {
+        OB << "][";
+        outputOneDimension(OB, Flags, Dimensions->Nodes[I]);
+    }
+}
+
+constexpr void ArrayTypeNode::outputPost(OutputBuffer& OB, OutputFlags Flags) const {
+    OB << "[";
+    outputDimensionsImpl(OB, Flags);
+    OB << "]";
+
+    ElementType->printPost(OB, Flags);
+}
+
+constexpr void SymbolNode::output(OutputBuffer& OB, OutputFlags Flags) const { Name->output(OB, Flags); }
+
+constexpr void FunctionSymbolNode::output(OutputBuffer& OB, OutputFlags Flags) const {
+    Signature->printPre(OB, Flags);
+    outputSpaceIfNecessary(OB);
+    Name->output(OB, Flags);
+    Signature->printPost(OB, Flags);
+}
+
+constexpr void VariableSymbolNode::output(OutputBuffer& OB, OutputFlags Flags) const {
+    const char* AccessSpec = nullptr;
+    bool        IsStatic   = true;
+    switch (SC.val) {
+    case StorageClass::PrivateStatic:
+        AccessSpec = "private";
+        break;
+    case StorageClass::PublicStatic:
+        AccessSpec = "public";
+        break;
+    case StorageClass::ProtectedStatic:
+        AccessSpec = "protected";
+        break;
+    default:
+        IsStatic = false;
+        break;
+    }
+    if (!(Flags & OF_NoAccessSpecifier) && AccessSpec) OB << AccessSpec << ": ";
+    if (!(Flags & OF_NoMemberType) && IsStatic) OB << "static ";
+
+    if (!(Flags & OF_NoVariableType) && Type) {
+        Type->printPre(OB, Flags);
+        outputSpaceIfNecessary(OB);
+    }
+    Name->output(OB, Flags);
+    if (!(Flags & OF_NoVariableType) && Type) Type->printPost(OB, Flags);
+}
+
+constexpr void CustomTypeNode::outputPre(OutputBuffer& OB, OutputFlags Flags) const { Identifier->print(OB, Flags); }
+constexpr void CustomTypeNode::outputPost(OutputBuffer& OB, OutputFlags Flags) const {}
+
+constexpr void QualifiedNameNode::output(OutputBuffer& OB, OutputFlags Flags) const {
+    Components->output(OB, Flags, "::");
+}
+
+constexpr void RttiBaseClassDescriptorNode::output(OutputBuffer& OB, OutputFlags Flags) const {
+    OB << "`RTTI Base Class Descriptor at (";
+    OB << NVOffset << ", " << VBPtrOffset << ", " << VBTableOffset << ", " << this->Flags;
+    OB << ")'";
+}
+
+constexpr void LocalStaticGuardVariableNode::output(OutputBuffer& OB, OutputFlags Flags) const {
+    Name->output(OB, Flags);
+}
+
+constexpr void VcallThunkIdentifierNode::output(OutputBuffer& OB, OutputFlags Flags) const {
+    OB << "`vcall'{" << OffsetInVTable << ", {flat}}";
+}
+
+constexpr void SpecialTableSymbolNode::output(OutputBuffer& OB, OutputFlags Flags) const {
+    outputQualifiers(OB, Quals, false, true);
+    Name->output(OB, Flags);
+    if (TargetName) {
+        OB << "{for `";
+        TargetName->output(OB, Flags);
+        OB << "'}";
+    }
+}
+
+#undef OUTPUT_ENUM_CLASS_VALUE
+
 } // namespace ms_demangle
 } // namespace demangler
 
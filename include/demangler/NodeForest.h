@@ -0,0 +1,326 @@
+//===--- NodeForest.h -------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Long-lived ASTs shared between symbols. A node forest hash-conses nodes by
+// their kind and operands, the way LLVM's ItaniumManglingCanonicalizer does,
+// so a subtree such as std::basic_string<char, ...> is stored once however
+// many of the retained symbols contain it. Names and arrays of operands are
+// interned along with the nodes, so the ASTs do not point into the mangled
+// names they were parsed from:
+//
+//   ItaniumNodeForest                      Forest;
+//   ManglingParser<ItaniumForestAllocator> Parser(nullptr, nullptr);
+//   Parser.ASTAllocator.setForest(&Forest);
+//   for (std::string_view Name : Exports) {
+//       Parser.reset(Name.data(), Name.data() + Name.size());
+//       Symbols.push_back(Parser.parse());
+//   }
+//   Forest.freeze();
+//
+// Microsoft nodes are filled in after they are allocated, so they cannot be
+// looked up as they are made. A MicrosoftNodeForest copies a parsed AST into
+// the forest instead, sharing every subtree it already holds.
+//
+// Parsers add to a forest under its lock. Once it is frozen nothing is added,
+// and lookups take no lock. Shared nodes are never changed after they are
+// added, so threads may print different symbols of a forest at the same time.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEMANGLE_NODEFOREST_H
+#define LLVM_DEMANGLE_NODEFOREST_H
+
+#include "ItaniumAllocator.h"
+#include "ItaniumDemangle.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace demangler {
+namespace ms_demangle {
+struct Node;
+struct SymbolNode;
+} // namespace ms_demangle
+
+namespace detail {
+constexpr uint64_t mixWord(uint64_t H, uint64_t W) {
+    H ^= W;
+    H *= 0x9e3779b97f4a7c15ull;
+    return H ^ (H >> 32);
+}
+
+// An open-addressed set of pointers by hash. Callers compare what the
+// pointers refer to themselves.
+class InternTable {
+    struct Slot {
+        uint64_t    Hash;
+        const void* Ptr;
+    };
+
+    std::vector<Slot> Slots;
+    size_t            Count = 0;
+
+public:
+    template <typename Fn>
+    const void* find(uint64_t Hash, Fn&& Equal) const {
+        if (Slots.empty()) return nullptr;
+        size_t Mask = Slots.size() - 1;
+        for (size_t I = Hash & Mask;; I = (I + 1) & Mask) {
+            const Slot& S = Slots[I];
+            if (!S.Ptr) return nullptr;
+            if (S.Hash == Hash && Equal(S.Ptr)) return S.Ptr;
+        }
+    }
+
+    void insert(uint64_t Hash, const void* Ptr);
+
+    size_t size() const { return Count; }
+    size_t memoryUsage() const { return Slots.capacity() * sizeof(Slot); }
+};
+
+// The words a node is compared by: its kind and its operands, with names
+// spelled out and nodes by address.
+class NodeProfile {
+    std::vector<uint64_t> Words;
+
+public:
+    void clear() { Words.clear(); }
+    void add(uint64_t W) { Words.push_back(W); }
+    void add(const void* P) { add(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(P))); }
+    void add(std::string_view S);
+
+    uint64_t hash() const;
+
+    bool operator==(const NodeProfile& Other) const { return Words == Other.Words; }
+};
+
+// What the Itanium and Microsoft forests have in common: the arena, the
+// interned names and arrays, and the lock writers take until the forest is
+// frozen.
+class NodeForestBase {
+public:
+    struct Stats {
+        /// Nodes stored in the forest.
+        uint64_t Nodes = 0;
+        /// Nodes that were looked up rather than stored again.
+        uint64_t Hits = 0;
+        /// Bytes allocated for nodes, names, arrays and the lookup tables.
+        uint64_t Bytes = 0;
+    };
+
+    NodeForestBase();
+    ~NodeForestBase();
+
+    NodeForestBase(const NodeForestBase&)            = delete;
+    NodeForestBase& operator=(const NodeForestBase&) = delete;
+
+    /// Stop adding to the forest. From then on parsers only look nodes up,
+    /// without taking the lock.
+    void freeze();
+    bool isFrozen() const { return Frozen.load(std::memory_order_acquire); }
+
+    Stats getStats() const;
+
+protected:
+    mutable std::mutex    Mutex;
+    std::atomic<bool>     Frozen{false};
+    std::atomic<uint64_t> Hits{0};
+    uint64_t              NumNodes = 0;
+
+    // Whether this thread may add to the forest. If so, Lock holds the lock.
+    bool lockForWriting(std::unique_lock<std::mutex>& Lock) {
+        if (isFrozen()) return false;
+        Lock = std::unique_lock<std::mutex>(Mutex);
+        return !Frozen.load(std::memory_order_relaxed);
+    }
+
+    // The rest need the lock.
+    void*            allocate(size_t Size);
+    std::string_view internString(std::string_view S);
+
+    // The interned array of the given elements. If there is none, it is
+    // added, or nullptr is returned if Add is false.
+    template <typename T>
+    T** internArray(T* const* Elements, size_t Size, bool Add = true) {
+        if (Size == 0) return nullptr;
+        uint64_t Hash = Size;
+        for (size_t I = 0; I != Size; ++I) Hash = mixWord(Hash, reinterpret_cast<uintptr_t>(Elements[I]));
+        // An array is stored after its size.
+        auto Equal = [&](const void* P) {
+            const size_t* Stored = static_cast<const size_t*>(P);
+            if (*Stored != Size) return false;
+            T* const* StoredElements = reinterpret_cast<T* const*>(Stored + 1);
+            for (size_t I = 0; I != Size; ++I)
+                if (StoredElements[I] != Elements[I]) return false;
+            return true;
+        };
+        if (const void* Found = Arrays.find(Hash, Equal))
+            return reinterpret_cast<T**>(const_cast<size_t*>(static_cast<const size_t*>(Found)) + 1);
+        if (!Add) return nullptr;
+
+        size_t* Stored = static_cast<size_t*>(allocate(sizeof(size_t) + Size * sizeof(T*)));
+        *Stored        = Size;
+        T** Copy       = reinterpret_cast<T**>(Stored + 1);
+        for (size_t I = 0; I != Size; ++I) Copy[I] = Elements[I];
+        Arrays.insert(Hash, Stored);
+        return Copy;
+    }
+
+    InternTable Nodes;
+
+private:
+    itanium_demangle::BumpPointerAllocator<64 * 1024, 1024> Arena;
+    InternTable                                             Arrays;
+    InternTable                                             Strings;
+    std::vector<std::unique_ptr<char[]>>                    CharBlocks;
+    char*                                                   NextChar  = nullptr;
+    size_t                                                  CharsLeft = 0;
+    size_t                                                  Bytes     = 0;
+};
+} // namespace detail
+
+/// A forest of Itanium nodes that parsers with an ItaniumForestAllocator add
+/// to. Nodes of the same kind with the same operands are stored once.
+/// ReferenceType and ForwardTemplateReference nodes mark themselves while
+/// printing, and a forward reference is resolved after it is made, so those
+/// two kinds are never shared.
+///
+/// Nodes live as long as the forest.
+class ItaniumNodeForest : public detail::NodeForestBase {
+    friend class ItaniumForestAllocator;
+
+    template <typename T>
+    static void profile(detail::NodeProfile& Profile, const T* N) {
+        Profile.clear();
+        Profile.add(uint64_t(N->getKind()));
+        N->match([&](const auto&... Operands) { (addOperand(Profile, Operands), ...); });
+    }
+
+    template <typename T>
+    static void addOperand(detail::NodeProfile& Profile, const T& Operand) {
+        if constexpr (std::is_pointer_v<T>) {
+            static_assert(std::is_base_of_v<itanium_demangle::Node, std::remove_cv_t<std::remove_pointer_t<T>>>);
+            Profile.add(static_cast<const void*>(Operand));
+        } else if constexpr (std::is_same_v<T, std::string_view>) {
+            Profile.add(Operand);
+        } else if constexpr (std::is_same_v<T, itanium_demangle::NodeArray>) {
+            Profile.add(uint64_t(Operand.size()));
+            for (const itanium_demangle::Node* N : Operand) Profile.add(N);
+        } else {
+            static_assert(std::is_integral_v<T> || std::is_enum_v<T>);
+            Profile.add(uint64_t(Operand));
+        }
+    }
+
+    // The operands of a node copied into the forest.
+    template <typename T>
+    T internOperand(const T& Operand) {
+        return Operand;
+    }
+    std::string_view internOperand(std::string_view S) { return internString(S); }
+    itanium_demangle::NodeArray internOperand(itanium_demangle::NodeArray A) {
+        return itanium_demangle::NodeArray(internArray(A.begin(), A.size()), A.size());
+    }
+
+    // The node of the forest equal to Probe, with Profile its profile. If
+    // there is none, Probe is copied into the forest, unless it is frozen and
+    // Probe is returned as it is.
+    template <typename T>
+    itanium_demangle::Node* intern(T* Probe, const detail::NodeProfile& Profile, detail::NodeProfile& Other) {
+        uint64_t                     Hash = Profile.hash();
+        std::unique_lock<std::mutex> Lock;
+        bool                         CanAdd = lockForWriting(Lock);
+
+        auto Equal = [&](const void* P) {
+            const itanium_demangle::Node* N = static_cast<const itanium_demangle::Node*>(P);
+            if (N->getKind() != Probe->getKind()) return false;
+            profile(Other, static_cast<const T*>(N));
+            return Other == Profile;
+        };
+        if (const void* Found = Nodes.find(Hash, Equal)) {
+            Hits.fetch_add(1, std::memory_order_relaxed);
+            return static_cast<itanium_demangle::Node*>(const_cast<void*>(Found));
+        }
+        if (!CanAdd) return Probe;
+
+        T* Copy = nullptr;
+        Probe->match([&](const auto&... Operands) { Copy = new (allocate(sizeof(T))) T(internOperand(Operands)...); });
+        Nodes.insert(Hash, Copy);
+        ++NumNodes;
+        return Copy;
+    }
+
+    // Make a node that is never shared.
+    template <typename T, typename Scratch, typename... Args>
+    T* makeUnshared(Scratch& Alloc, Args&&... args) {
+        std::unique_lock<std::mutex> Lock;
+        if (!lockForWriting(Lock)) return new (Alloc.allocate(sizeof(T))) T(std::forward<Args>(args)...);
+        ++NumNodes;
+        return new (allocate(sizeof(T))) T(std::forward<Args>(args)...);
+    }
+};
+
+/// The node allocator of an Itanium parser that adds the nodes it makes to an
+/// ItaniumNodeForest. Once the forest is frozen, nodes that are not in it are
+/// made in the allocator's own arena, and live until the parser is reset.
+/// Without a forest it is a plain arena allocator.
+class ItaniumForestAllocator {
+    ItaniumNodeForest*                       Forest = nullptr;
+    itanium_demangle::BumpPointerAllocator<> Scratch;
+    detail::NodeProfile                      Profile;
+    detail::NodeProfile                      Other;
+
+public:
+    void setForest(ItaniumNodeForest* F) { Forest = F; }
+
+    void reset() { Scratch.reset(); }
+
+    template <typename T, typename... Args>
+    itanium_demangle::Node* makeNode(Args&&... args) {
+        using namespace itanium_demangle;
+        if (!Forest) return new (Scratch.allocate(sizeof(T))) T(std::forward<Args>(args)...);
+        if constexpr (std::is_same_v<T, ForwardTemplateReference> || std::is_same_v<T, ReferenceType>) {
+            return Forest->makeUnshared<T>(Scratch, std::forward<Args>(args)...);
+        } else {
+            // Nodes are made here first, so that they can be compared by
+            // what match() reports, however they were constructed.
+            T* Probe = new (Scratch.allocate(sizeof(T))) T(std::forward<Args>(args)...);
+            ItaniumNodeForest::profile(Profile, Probe);
+            return Forest->intern(Probe, Profile, Other);
+        }
+    }
+
+    // Arrays are interned along with the node that holds them, so until then
+    // they live in the allocator's own arena.
+    itanium_demangle::Node** allocateNodeArray(size_t sz) {
+        return new (Scratch.allocate(sizeof(itanium_demangle::Node*) * sz)) itanium_demangle::Node*[sz];
+    }
+};
+
+/// A forest of Microsoft ASTs. intern() copies a parsed AST into it, and the
+/// copy shares every subtree the forest already holds. The pos of storage and
+/// function classes is not kept, as it points into the mangled name.
+class MicrosoftNodeForest : public detail::NodeForestBase {
+public:
+    /// The copy of AST in the forest. Once the forest is frozen this is only
+    /// found if all of AST is already in it, and is nullptr otherwise.
+    ms_demangle::SymbolNode* intern(const ms_demangle::SymbolNode* AST);
+
+private:
+    struct Interner;
+};
+
+} // namespace demangler
+
+#endif // LLVM_DEMANGLE_NODEFOREST_H
@@ -17,18 +17,185 @@
 
 #include "DemangleConfig.h"
 
+#include <bit>
+#include <cstddef>
+#include <cstdint>
 #include <string_view>
+#include <type_traits>
+
+#if defined(DEMANGLE_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(DEMANGLE_SIMD_SSE2)
+#include <emmintrin.h>
+#elif defined(DEMANGLE_SIMD_NEON)
+#include <arm_neon.h>
+#endif
 
 DEMANGLE_NAMESPACE_BEGIN
 
-inline bool starts_with(std::string_view self, char C) noexcept { return !self.empty() && *self.begin() == C; }
+constexpr bool starts_with(std::string_view self, char C) noexcept { return !self.empty() && *self.begin() == C; }
 
-inline bool starts_with(std::string_view haystack, std::string_view needle) noexcept {
+constexpr bool starts_with(std::string_view haystack, std::string_view needle) noexcept {
     if (needle.size() > haystack.size()) return false;
     haystack.remove_suffix(haystack.size() - needle.size());
     return haystack == needle;
 }
 
+constexpr bool is_digit(char C) noexcept { return C >= '0' && C <= '9'; }
+
+constexpr bool is_identifier_char(char C) noexcept {
+    return is_digit(C) || (C >= 'a' && C <= 'z') || (C >= 'A' && C <= 'Z') || C == '_';
+}
+
+// Scanning helpers for the lexers. Each tests whole blocks of bytes with the
+// instruction set DemangleConfig.h picks and finishes the tail, or the whole
+// string without one, a byte at a time.
+namespace simd {
+#if defined(DEMANGLE_SIMD_AVX2)
+using Block = __m256i;
+
+constexpr size_t BlockSize = 32;
+
+inline Block load(const char* P) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(P)); }
+inline Block splat(char C) { return _mm256_set1_epi8(C); }
+inline Block equal(Block A, Block B) { return _mm256_cmpeq_epi8(A, B); }
+inline Block either(Block A, Block B) { return _mm256_or_si256(A, B); }
+// Bytes of A in [Lo, Lo + Span].
+inline Block inRange(Block A, char Lo, char Span) {
+    Block D = _mm256_sub_epi8(A, splat(Lo));
+    return equal(_mm256_min_epu8(D, splat(Span)), D);
+}
+inline Block toLower(Block A) { return _mm256_or_si256(A, splat(0x20)); }
+// One bit per matching byte, lowest first.
+inline uint64_t matches(Block M) { return static_cast<uint32_t>(_mm256_movemask_epi8(M)); }
+
+constexpr unsigned BitsPerByte = 1;
+constexpr uint64_t AllBytes    = 0xffffffffull;
+#elif defined(DEMANGLE_SIMD_SSE2)
+using Block = __m128i;
+
+constexpr size_t BlockSize = 16;
+
+inline Block load(const char* P) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(P)); }
+inline Block splat(char C) { return _mm_set1_epi8(C); }
+inline Block equal(Block A, Block B) { return _mm_cmpeq_epi8(A, B); }
+inline Block either(Block A, Block B) { return _mm_or_si128(A, B); }
+inline Block inRange(Block A, char Lo, char Span) {
+    Block D = _mm_sub_epi8(A, splat(Lo));
+    return equal(_mm_min_epu8(D, splat(Span)), D);
+}
+inline Block toLower(Block A) { return _mm_or_si128(A, splat(0x20)); }
+inline uint64_t matches(Block M) { return static_cast<uint32_t>(_mm_movemask_epi8(M)); }
+
+constexpr unsigned BitsPerByte = 1;
+constexpr uint64_t AllBytes    = 0xffffull;
+#elif defined(DEMANGLE_SIMD_NEON)
+using Block = uint8x16_t;
+
+constexpr size_t BlockSize = 16;
+
+inline Block load(const char* P) { return vld1q_u8(reinterpret_cast<const uint8_t*>(P)); }
+inline Block splat(char C) { return vdupq_n_u8(static_cast<uint8_t>(C)); }
+inline Block equal(Block A, Block B) { return vceqq_u8(A, B); }
+inline Block either(Block A, Block B) { return vorrq_u8(A, B); }
+inline Block inRange(Block A, char Lo, char Span) { return vcleq_u8(vsubq_u8(A, splat(Lo)), splat(Span)); }
+inline Block toLower(Block A) { return vorrq_u8(A, splat(0x20)); }
+// NEON has no movemask; narrowing each 16-bit lane by 4 leaves a nibble per byte.
+inline uint64_t matches(Block M) {
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(M), 4)), 0);
+}
+
+constexpr unsigned BitsPerByte = 4;
+constexpr uint64_t AllBytes    = ~0ull;
+#endif
+
+#if defined(DEMANGLE_SIMD_AVX2) || defined(DEMANGLE_SIMD_SSE2) || defined(DEMANGLE_SIMD_NEON)
+#define DEMANGLE_SIMD_BLOCKS 1
+#else
+#define DEMANGLE_SIMD_BLOCKS 0
+#endif
+
+// The position of the first byte of S that M stops at, or S.size(). A matcher
+// tests single bytes with stops(char) and, with SIMD, whole blocks with
+// stops(Block), which returns a matches() mask. Constant evaluation only takes
+// single bytes.
+template <typename Matcher>
+constexpr size_t scan(std::string_view S, const Matcher& M) {
+    const char* P = S.data();
+    size_t      I = 0;
+#if DEMANGLE_SIMD_BLOCKS
+    if (!std::is_constant_evaluated()) {
+        for (; S.size() - I >= BlockSize; I += BlockSize)
+            if (uint64_t Mask = M.stops(load(P + I))) return I + std::countr_zero(Mask) / BitsPerByte;
+    }
+#endif
+    for (; I != S.size(); ++I)
+        if (M.stops(P[I])) return I;
+    return I;
+}
+
+struct CharMatcher {
+    char A, B;
+
+#if DEMANGLE_SIMD_BLOCKS
+    uint64_t stops(Block V) const { return matches(either(equal(V, splat(A)), equal(V, splat(B)))); }
+#endif
+    constexpr bool stops(char C) const { return C == A || C == B; }
+};
+
+struct DigitMatcher {
+#if DEMANGLE_SIMD_BLOCKS
+    uint64_t stops(Block V) const { return matches(inRange(V, '0', 9)) ^ AllBytes; }
+#endif
+    constexpr bool stops(char C) const { return !is_digit(C); }
+};
+
+struct IdentifierMatcher {
+#if DEMANGLE_SIMD_BLOCKS
+    uint64_t stops(Block V) const {
+        return matches(either(either(inRange(V, '0', 9), inRange(toLower(V), 'a', 25)), equal(V, splat('_'))))
+             ^ AllBytes;
+    }
+#endif
+    constexpr bool stops(char C) const { return !is_identifier_char(C); }
+};
+} // namespace simd
+
+/// The position of the first C in S, or npos. The same as S.find(C), for the
+/// terminators the lexers search for, such as Microsoft's '@'.
+constexpr size_t find_char(std::string_view S, char C) noexcept {
+    size_t I = simd::scan(S, simd::CharMatcher{C, C});
+    return I == S.size() ? std::string_view::npos : I;
+}
+
+/// The position of the first A or B in S, or npos.
+constexpr size_t find_either(std::string_view S, char A, char B) noexcept {
+    size_t I = simd::scan(S, simd::CharMatcher{A, B});
+    return I == S.size() ? std::string_view::npos : I;
+}
+
+/// The number of decimal digits S starts with.
+constexpr size_t span_digits(std::string_view S) noexcept { return simd::scan(S, simd::DigitMatcher{}); }
+
+/// The number of identifier characters, [0-9A-Za-z_], S starts with.
+constexpr size_t span_identifier(std::string_view S) noexcept { return simd::scan(S, simd::IdentifierMatcher{}); }
+
+/// The number of bytes A and B have in common at their start.
+constexpr size_t common_prefix(std::string_view A, std::string_view B) noexcept {
+    size_t N = A.size() < B.size() ? A.size() : B.size();
+    size_t I = 0;
+#if DEMANGLE_SIMD_BLOCKS
+    if (!std::is_constant_evaluated()) {
+        for (; N - I >= simd::BlockSize; I += simd::BlockSize) {
+            uint64_t Mask = simd::matches(simd::equal(simd::load(A.data() + I), simd::load(B.data() + I)));
+            if (Mask != simd::AllBytes) return I + std::countr_one(Mask) / simd::BitsPerByte;
+        }
+    }
+#endif
+    while (I != N && A[I] == B[I]) ++I;
+    return I;
+}
+
 DEMANGLE_NAMESPACE_END
 
 #endif
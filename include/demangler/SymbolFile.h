@@ -0,0 +1,95 @@
+//===--- SymbolFile.h -------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// The symbol names of a binary, read straight from its mapping. A PE image
+// yields the names of its export table, an ELF file those of its symbol table
+// (or, if it has been stripped, its dynamic symbol table). Every name is a
+// view into the mapping, so no name is copied before it is demangled:
+//
+//   SymbolFile Symbols;
+//   if (Symbols.open("bedrock_server.exe")) {
+//       DemangleBatchResult Result = demangleSymbols(Symbols);
+//       for (size_t I = 0; I != Result.size(); ++I) use(Symbols[I], Result[I]);
+//   }
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEMANGLE_SYMBOLFILE_H
+#define LLVM_DEMANGLE_SYMBOLFILE_H
+
+#include "demangler/Demangle.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace demangler {
+
+/// A read-only view of the symbol names of a binary, usually mapped from
+/// disk. The names stay valid until the file is closed.
+class SymbolFile {
+public:
+    enum class Format : uint8_t { None, PE, ELF };
+
+    SymbolFile() = default;
+    ~SymbolFile();
+
+    SymbolFile(SymbolFile&& Other);
+    SymbolFile& operator=(SymbolFile&& Other);
+
+    SymbolFile(const SymbolFile&)            = delete;
+    SymbolFile& operator=(const SymbolFile&) = delete;
+
+    /// Map the binary at Path and read its names. Fails if it cannot be
+    /// mapped or is not a PE image or ELF file, or if its tables do not lie
+    /// inside it. A binary without exports or symbols has no names.
+    bool open(const char* Path);
+
+    /// Read the names of a binary that is already in memory. Data must stay
+    /// alive and unchanged while the names are in use.
+    bool load(std::span<const char> Data);
+
+    /// Drop the names. Every string obtained from them becomes invalid.
+    void close();
+
+    Format getFormat() const { return FileFormat; }
+
+    /// The names, in the order of the table they were read from. PE export
+    /// names are sorted; ELF names are not, and may repeat.
+    std::span<const std::string_view> names() const { return Names; }
+
+    size_t size() const { return Names.size(); }
+
+    std::string_view operator[](size_t I) const { return Names[I]; }
+
+private:
+    bool loadPE(std::span<const char> Data);
+    bool loadELF(std::span<const char> Data);
+
+    const char*                   Mapping     = nullptr;
+    size_t                        MappingSize = 0;
+    std::vector<std::string_view> Names;
+    Format                        FileFormat = Format::None;
+    bool                          Mapped     = false;
+};
+
+/// Demangle the names of Symbols with demangleBatch. Export and symbol tables
+/// hold each name on its own, so a Microsoft name fails unless the demangler
+/// consumes all of it.
+DemangleBatchResult demangleSymbols(
+    const SymbolFile&     Symbols,
+    unsigned              NumThreads = 0,
+    MSDemangleFlags       Flags      = MSDF_None,
+    const DemangleLimits& Limits     = {}
+);
+
+} // namespace demangler
+
+#endif // LLVM_DEMANGLE_SYMBOLFILE_H
@@ -17,13 +17,16 @@
 #define DEMANGLE_UTILITY_H
 
 #include "DemangleConfig.h"
+#include "DemangleStats.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <limits>
 #include <string_view>
+#include <type_traits>
 
 DEMANGLE_NAMESPACE_BEGIN
 
@@ -34,9 +37,41 @@ class OutputBuffer {
     size_t CurrentPosition = 0;
     size_t BufferCapacity  = 0;
 
-    // Ensure there are at least N more positions in the buffer.
-    void grow(size_t N) {
+    // Set when constant evaluation allocated Buffer, which realloc() and free()
+    // cannot handle.
+    bool ConstantBuffer = false;
+
+    // See setPrintLimit().
+    size_t PrintLimit        = std::numeric_limits<size_t>::max();
+    bool   PrintLimitReached = false;
+
+    // See setDrain(). Drained characters were passed to DrainFn and are no
+    // longer in Buffer, which starts at position Drained of the output.
+    // Nothing from HoldFrom on is drained while Holds is not 0.
+    void (*DrainFn)(void* Ctx, std::string_view S) = nullptr;
+    void*    DrainCtx                              = nullptr;
+    size_t   Drained                               = 0;
+    size_t   HoldFrom                              = 0;
+    unsigned Holds                                 = 0;
+
+    // Ensure there are at least N more positions in the buffer, and note if
+    // they take the output past PrintLimit.
+    constexpr void grow(size_t N) {
         size_t Need = N + CurrentPosition;
+        if (Drained + Need > PrintLimit) PrintLimitReached = true;
+        if (std::is_constant_evaluated()) {
+            if (Need > BufferCapacity) growConstant(Need);
+            return;
+        }
+        if (Need > BufferCapacity && DrainFn) {
+            // Keep the last character, which nodes may look back at. Growing
+            // is cheaper than moving most of the buffer for a small drain.
+            size_t Free = std::min(Holds ? HoldFrom - Drained : CurrentPosition, CurrentPosition - 1);
+            if (Free != 0 && Free >= CurrentPosition / 2) {
+                drain(Free);
+                Need = N + CurrentPosition;
+            }
+        }
         if (Need > BufferCapacity) {
             // Reduce the number of reallocations, with a bit of hysteresis. The
             // number here is chosen so the first allocation will more-than-likely not
@@ -45,11 +80,53 @@ class OutputBuffer {
             BufferCapacity *= 2;
             if (BufferCapacity < Need) BufferCapacity = Need;
             Buffer = static_cast<char*>(std::realloc(Buffer, BufferCapacity));
+            DEMANGLE_STATS_ADD(OutputReallocs, 1);
             if (Buffer == nullptr) std::abort();
         }
     }
 
-    OutputBuffer& writeUnsigned(uint64_t N, bool isNeg = false) {
+    // A buffer handed in by the caller cannot grow during constant evaluation,
+    // and running out of it stops the evaluation.
+    constexpr void growConstant(size_t Need) {
+        if (Buffer && !ConstantBuffer) std::abort();
+        size_t NewCapacity = std::max(Need, 2 * BufferCapacity);
+        char*  NewBuffer   = new char[NewCapacity];
+        copyChars(NewBuffer, Buffer, CurrentPosition);
+        delete[] Buffer;
+        Buffer         = NewBuffer;
+        BufferCapacity = NewCapacity;
+        ConstantBuffer = true;
+    }
+
+    // Pass the first N characters of Buffer to DrainFn and drop them.
+    void drain(size_t N) {
+        DrainFn(DrainCtx, std::string_view(Buffer, N));
+        std::memmove(Buffer, Buffer + N, CurrentPosition - N);
+        CurrentPosition -= N;
+        Drained         += N;
+    }
+
+    // memcpy() and memmove(), which constant evaluation cannot call.
+    static constexpr void copyChars(char* Dst, const char* Src, size_t N) {
+        if (!std::is_constant_evaluated()) {
+            std::memcpy(Dst, Src, N);
+            return;
+        }
+        for (size_t I = 0; I != N; ++I) Dst[I] = Src[I];
+    }
+
+    static constexpr void moveChars(char* Dst, const char* Src, size_t N) {
+        if (!std::is_constant_evaluated()) {
+            std::memmove(Dst, Src, N);
+            return;
+        }
+        if (Dst < Src)
+            for (size_t I = 0; I != N; ++I) Dst[I] = Src[I];
+        else
+            for (size_t I = N; I != 0; --I) Dst[I - 1] = Src[I - 1];
+    }
+
+    constexpr OutputBuffer& writeUnsigned(uint64_t N, bool isNeg = false) {
         std::array<char, 21> Temp;
         char*                TempPtr = Temp.data() + Temp.size();
 
@@ -66,14 +143,15 @@ class OutputBuffer {
     }
 
 public:
-    OutputBuffer(char* StartBuf, size_t Size) : Buffer(StartBuf), BufferCapacity(Size) {}
-    OutputBuffer(char* StartBuf, size_t* SizePtr) : OutputBuffer(StartBuf, StartBuf ? *SizePtr : 0) {}
-    OutputBuffer() = default;
+    constexpr OutputBuffer(char* StartBuf, size_t Size) : Buffer(StartBuf), BufferCapacity(Size) {}
+    constexpr OutputBuffer(char* StartBuf, size_t* SizePtr) : OutputBuffer(StartBuf, StartBuf ? *SizePtr : 0) {}
+    constexpr OutputBuffer() = default;
     // Non-copyable
     OutputBuffer(const OutputBuffer&)            = delete;
     OutputBuffer& operator=(const OutputBuffer&) = delete;
 
-    operator std::string_view() const { return std::string_view(Buffer, CurrentPosition); }
+    /// The output, or what has not been drained of it yet.
+    constexpr operator std::string_view() const { return std::string_view(Buffer, CurrentPosition); }
 
     /// If a ParameterPackExpansion (or similar type) is encountered, the offset
     /// into the pack that we're currently printing.
@@ -84,81 +162,158 @@ public:
     /// Use a counter so we can simply increment inside parentheses.
     unsigned GtIsGt = 1;
 
-    bool isGtInsideTemplateArgs() const { return GtIsGt == 0; }
+    constexpr bool isGtInsideTemplateArgs() const { return GtIsGt == 0; }
+
+    /// Once the output has been longer than Limit, isPastPrintLimit() is true
+    /// and nodes stop printing, so that an AST that would print far too much
+    /// gives up early. What was printed by then is incomplete.
+    constexpr void setPrintLimit(size_t Limit) {
+        PrintLimit        = Limit;
+        PrintLimitReached = getCurrentPosition() > Limit;
+    }
+    constexpr size_t getPrintLimit() const { return PrintLimit; }
+    constexpr bool   isPastPrintLimit() const { return PrintLimitReached; }
+
+    /// Pass the output to Fn, with Ctx, as it is produced instead of keeping
+    /// all of it. Whenever the buffer is full, what comes before the oldest
+    /// live Hold, and before the last character, is passed on and dropped;
+    /// call flush() for the rest at the end. Positions still count from the start of the output.
+    /// The buffer must be empty. Passing a null Fn stops draining.
+    void setDrain(void (*Fn)(void* Ctx, std::string_view S), void* Ctx) {
+        DEMANGLE_ASSERT(CurrentPosition == 0, "");
+        DrainFn         = Fn;
+        DrainCtx        = Ctx;
+        Drained         = 0;
+        CurrentPosition = 0;
+    }
+
+    /// Pass what is left in the buffer to the drain function.
+    void flush() {
+        DEMANGLE_ASSERT(DrainFn && Holds == 0, "");
+        if (CurrentPosition) drain(CurrentPosition);
+    }
+
+    /// While a Hold is alive, the output printed since it was created is not
+    /// drained, so that it can be rewound, read back or inserted into.
+    class Hold {
+        OutputBuffer& OB;
+        bool          Active;
+
+    public:
+        // Without a drain function there is nothing to hold back.
+        explicit constexpr Hold(OutputBuffer& OB, bool Active = true) : OB(OB), Active(Active && OB.DrainFn) {
+            if (this->Active && OB.Holds++ == 0) OB.HoldFrom = OB.getCurrentPosition();
+        }
+        constexpr ~Hold() { OB.Holds -= Active; }
+
+        Hold(const Hold&)            = delete;
+        Hold& operator=(const Hold&) = delete;
+    };
 
-    void printOpen(char Open = '(') {
+    constexpr void printOpen(char Open = '(') {
         GtIsGt++;
         *this += Open;
     }
-    void printClose(char Close = ')') {
+    constexpr void printClose(char Close = ')') {
         GtIsGt--;
         *this += Close;
     }
 
-    OutputBuffer& operator+=(std::string_view R) {
+    constexpr OutputBuffer& operator+=(std::string_view R) {
         if (size_t Size = R.size()) {
             grow(Size);
-            std::memcpy(Buffer + CurrentPosition, &*R.begin(), Size);
+            copyChars(Buffer + CurrentPosition, R.data(), Size);
             CurrentPosition += Size;
         }
         return *this;
     }
 
-    OutputBuffer& operator+=(char C) {
+    constexpr OutputBuffer& operator+=(char C) {
         grow(1);
         Buffer[CurrentPosition++] = C;
         return *this;
     }
 
-    OutputBuffer& prepend(std::string_view R) {
+    /// Append a copy of the characters at [Begin, End) of this buffer.
+    constexpr OutputBuffer& appendRange(size_t Begin, size_t End) {
+        DEMANGLE_ASSERT(Drained <= Begin && Begin <= End && End <= getCurrentPosition(), "");
+        if (size_t Size = End - Begin) {
+            grow(Size);
+            copyChars(Buffer + CurrentPosition, Buffer + (Begin - Drained), Size);
+            CurrentPosition += Size;
+        }
+        return *this;
+    }
+
+    constexpr OutputBuffer& prepend(std::string_view R) {
+        DEMANGLE_ASSERT(Drained == 0, "");
         size_t Size = R.size();
 
         grow(Size);
-        std::memmove(Buffer + Size, Buffer, CurrentPosition);
-        std::memcpy(Buffer, &*R.begin(), Size);
+        moveChars(Buffer + Size, Buffer, CurrentPosition);
+        copyChars(Buffer, R.data(), Size);
         CurrentPosition += Size;
 
         return *this;
     }
 
-    OutputBuffer& operator<<(std::string_view R) { return (*this += R); }
+    constexpr OutputBuffer& operator<<(std::string_view R) { return (*this += R); }
 
-    OutputBuffer& operator<<(char C) { return (*this += C); }
+    constexpr OutputBuffer& operator<<(char C) { return (*this += C); }
 
-    OutputBuffer& operator<<(long long N) { return writeUnsigned(static_cast<unsigned long long>(std::abs(N)), N < 0); }
+    constexpr OutputBuffer& operator<<(long long N) {
+        unsigned long long Magnitude = static_cast<unsigned long long>(N);
+        return writeUnsigned(N < 0 ? 0 - Magnitude : Magnitude, N < 0);
+    }
 
-    OutputBuffer& operator<<(unsigned long long N) { return writeUnsigned(N, false); }
+    constexpr OutputBuffer& operator<<(unsigned long long N) { return writeUnsigned(N, false); }
 
-    OutputBuffer& operator<<(long N) { return this->operator<<(static_cast<long long>(N)); }
+    constexpr OutputBuffer& operator<<(long N) { return this->operator<<(static_cast<long long>(N)); }
 
-    OutputBuffer& operator<<(unsigned long N) { return this->operator<<(static_cast<unsigned long long>(N)); }
+    constexpr OutputBuffer& operator<<(unsigned long N) { return this->operator<<(static_cast<unsigned long long>(N)); }
 
-    OutputBuffer& operator<<(int N) { return this->operator<<(static_cast<long long>(N)); }
+    constexpr OutputBuffer& operator<<(int N) { return this->operator<<(static_cast<long long>(N)); }
 
-    OutputBuffer& operator<<(unsigned int N) { return this->operator<<(static_cast<unsigned long long>(N)); }
+    constexpr OutputBuffer& operator<<(unsigned int N) { return this->operator<<(static_cast<unsigned long long>(N)); }
 
-    void insert(size_t Pos, const char* S, size_t N) {
-        DEMANGLE_ASSERT(Pos <= CurrentPosition, "");
+    constexpr void insert(size_t Pos, const char* S, size_t N) {
+        DEMANGLE_ASSERT(Drained <= Pos && Pos <= getCurrentPosition(), "");
         if (N == 0) return;
         grow(N);
-        std::memmove(Buffer + Pos + N, Buffer + Pos, CurrentPosition - Pos);
-        std::memcpy(Buffer + Pos, S, N);
+        Pos -= Drained;
+        moveChars(Buffer + Pos + N, Buffer + Pos, CurrentPosition - Pos);
+        copyChars(Buffer + Pos, S, N);
         CurrentPosition += N;
     }
 
-    size_t getCurrentPosition() const { return CurrentPosition; }
-    void   setCurrentPosition(size_t NewPos) { CurrentPosition = NewPos; }
+    constexpr size_t getCurrentPosition() const { return Drained + CurrentPosition; }
+    constexpr void   setCurrentPosition(size_t NewPos) {
+        DEMANGLE_ASSERT(NewPos >= Drained, "");
+        CurrentPosition = NewPos - Drained;
+    }
 
-    char back() const {
+    constexpr char back() const {
         DEMANGLE_ASSERT(CurrentPosition, "");
         return Buffer[CurrentPosition - 1];
     }
 
-    bool empty() const { return CurrentPosition == 0; }
+    constexpr bool empty() const { return Drained + CurrentPosition == 0; }
+
+    /// Free a buffer that grow() allocated and forget the output. Unlike
+    /// std::free(getBuffer()), this also works during constant evaluation.
+    constexpr void freeBuffer() {
+        if (ConstantBuffer) delete[] Buffer;
+        else std::free(Buffer);
+        Buffer          = nullptr;
+        BufferCapacity  = 0;
+        CurrentPosition = 0;
+        Drained         = 0;
+        ConstantBuffer  = false;
+    }
 
-    char*  getBuffer() { return Buffer; }
-    char*  getBufferEnd() { return Buffer + CurrentPosition - 1; }
-    size_t getBufferCapacity() const { return BufferCapacity; }
+    constexpr char*  getBuffer() { return Buffer; }
+    constexpr char*  getBufferEnd() { return Buffer + CurrentPosition - 1; }
+    constexpr size_t getBufferCapacity() const { return BufferCapacity; }
 };
 
 template <class T>
@@ -167,10 +322,10 @@ class ScopedOverride {
     T  Original;
 
 public:
-    ScopedOverride(T& Loc_) : ScopedOverride(Loc_, Loc_) {}
+    constexpr ScopedOverride(T& Loc_) : ScopedOverride(Loc_, Loc_) {}
 
-    ScopedOverride(T& Loc_, T NewVal) : Loc(Loc_), Original(Loc_) { Loc_ = std::move(NewVal); }
-    ~ScopedOverride() { Loc = std::move(Original); }
+    constexpr ScopedOverride(T& Loc_, T NewVal) : Loc(Loc_), Original(Loc_) { Loc_ = std::move(NewVal); }
+    constexpr ~ScopedOverride() { Loc = std::move(Original); }
 
     ScopedOverride(const ScopedOverride&)            = delete;
     ScopedOverride& operator=(const ScopedOverride&) = delete;
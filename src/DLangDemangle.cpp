@@ -14,9 +14,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "demangler/Demangle.h"
+#include "demangler/DemangleProfile.h"
 #include "demangler/StringViewExtras.h"
 #include "demangler/Utility.h"
 
+#include <algorithm>
 #include <cctype>
 #include <cstring>
 #include <limits>
@@ -24,6 +26,7 @@
 
 using namespace demangler;
 using demangler::itanium_demangle::OutputBuffer;
+using demangler::itanium_demangle::span_digits;
 using demangler::itanium_demangle::starts_with;
 
 namespace {
@@ -46,6 +49,11 @@ struct Demangler {
     /// \see https://dlang.org/spec/abi.html#MangledName .
     const char* parseMangle(OutputBuffer* Demangled);
 
+    /// What the parse has used of its DemangleLimits. The D demangler builds
+    /// no AST, so only MaxDepth is counted here; MaxOutputSize is checked
+    /// against the output buffer.
+    detail::LimitTracker Limits;
+
 private:
     /// Extract and demangle a given mangled symbol and append it to the output
     /// string.
@@ -161,26 +169,25 @@ private:
     const std::string_view Str;
     /// The index of the last back reference.
     int LastBackref;
+    /// Position in the output buffer where this symbol starts.
+    size_t OutputStart = 0;
 };
 
 } // namespace
 
 void Demangler::decodeNumber(std::string_view& Mangled, unsigned long& Ret) {
-    // Clear Mangled if trying to extract something that isn't a digit.
-    if (Mangled.empty()) {
-        Mangled = {};
-        return;
-    }
-
-    if (!std::isdigit(Mangled.front())) {
+    // Clear Mangled if trying to extract something that isn't a digit, or if
+    // nothing follows the number.
+    size_t Digits = span_digits(Mangled);
+    if (Digits == 0 || Digits == Mangled.size()) {
         Mangled = {};
         return;
     }
 
     unsigned long Val = 0;
 
-    do {
-        unsigned long Digit = Mangled[0] - '0';
+    for (char C : Mangled.substr(0, Digits)) {
+        unsigned long Digit = C - '0';
 
         // Check for overflow.
         if (Val > (std::numeric_limits<unsigned int>::max() - Digit) / 10) {
@@ -189,14 +196,9 @@ void Demangler::decodeNumber(std::string_view& Mangled, unsigned long& Ret) {
         }
 
         Val = Val * 10 + Digit;
-        Mangled.remove_prefix(1);
-    } while (!Mangled.empty() && std::isdigit(Mangled.front()));
-
-    if (Mangled.empty()) {
-        Mangled = {};
-        return;
     }
 
+    Mangled.remove_prefix(Digits);
     Ret = Val;
 }
 
@@ -345,6 +347,7 @@ bool Demangler::isSymbolName(std::string_view Mangled) {
 }
 
 void Demangler::parseMangle(OutputBuffer* Demangled, std::string_view& Mangled) {
+    DEMANGLE_PROFILE_SCOPE(DLangMangle);
     // A D mangled symbol is comprised of both scope and type information.
     //    MangleName:
     //        _D QualifiedName Type
@@ -370,6 +373,7 @@ void Demangler::parseMangle(OutputBuffer* Demangled, std::string_view& Mangled)
 }
 
 void Demangler::parseQualified(OutputBuffer* Demangled, std::string_view& Mangled) {
+    DEMANGLE_PROFILE_SCOPE(DLangQualified);
     // Qualified names are identifiers separated by their encoded length.
     // Nested functions also encode their argument types without specifying
     // what they return.
@@ -403,7 +407,11 @@ void Demangler::parseQualified(OutputBuffer* Demangled, std::string_view& Mangle
 }
 
 void Demangler::parseIdentifier(OutputBuffer* Demangled, std::string_view& Mangled) {
-    if (Mangled.empty()) {
+    DEMANGLE_PROFILE_SCOPE(DLangIdentifier);
+    DEMANGLE_STATS_DEPTH();
+    detail::LimitTracker::Scope LimitScope(Limits);
+    if (Demangled->isPastPrintLimit()) Limits.Exceeded = true;
+    if (Limits.Exceeded || Mangled.empty()) {
         Mangled = {};
         return;
     }
@@ -432,7 +440,8 @@ void Demangler::parseIdentifier(OutputBuffer* Demangled, std::string_view& Mangl
     if (Len >= 4 && starts_with(Mangled, "__S")) {
         const size_t     SuffixLen = Mangled.length() - Len;
         std::string_view P         = Mangled.substr(3);
-        while (P.length() > SuffixLen && std::isdigit(P.front())) P.remove_prefix(1);
+        size_t           Digits    = span_digits(P);
+        if (P.length() > SuffixLen) P.remove_prefix(std::min(Digits, P.length() - SuffixLen));
         if (P.length() == SuffixLen) {
             // Skip over the fake parent.
             Mangled.remove_prefix(Len);
@@ -446,7 +455,10 @@ void Demangler::parseIdentifier(OutputBuffer* Demangled, std::string_view& Mangl
 }
 
 bool Demangler::parseType(std::string_view& Mangled) {
-    if (Mangled.empty()) {
+    DEMANGLE_PROFILE_SCOPE(DLangType);
+    DEMANGLE_STATS_DEPTH();
+    detail::LimitTracker::Scope LimitScope(Limits);
+    if (Limits.Exceeded || Mangled.empty()) {
         Mangled = {};
         return false;
     }
@@ -483,14 +495,14 @@ void Demangler::parseLName(OutputBuffer* Demangled, std::string_view& Mangled, u
     case 6:
         if (starts_with(Mangled, "__initZ")) {
             // The static initializer for a given symbol.
-            Demangled->prepend("initializer for ");
+            Demangled->insert(OutputStart, "initializer for ", 16);
             Demangled->setCurrentPosition(Demangled->getCurrentPosition() - 1);
             Mangled.remove_prefix(Len);
             return;
         }
         if (starts_with(Mangled, "__vtblZ")) {
             // The vtable symbol for a given class.
-            Demangled->prepend("vtable for ");
+            Demangled->insert(OutputStart, "vtable for ", 11);
             Demangled->setCurrentPosition(Demangled->getCurrentPosition() - 1);
             Mangled.remove_prefix(Len);
             return;
@@ -500,7 +512,7 @@ void Demangler::parseLName(OutputBuffer* Demangled, std::string_view& Mangled, u
     case 7:
         if (starts_with(Mangled, "__ClassZ")) {
             // The classinfo symbol for a given class.
-            Demangled->prepend("ClassInfo for ");
+            Demangled->insert(OutputStart, "ClassInfo for ", 14);
             Demangled->setCurrentPosition(Demangled->getCurrentPosition() - 1);
             Mangled.remove_prefix(Len);
             return;
@@ -510,7 +522,7 @@ void Demangler::parseLName(OutputBuffer* Demangled, std::string_view& Mangled, u
     case 11:
         if (starts_with(Mangled, "__InterfaceZ")) {
             // The interface symbol for a given class.
-            Demangled->prepend("Interface for ");
+            Demangled->insert(OutputStart, "Interface for ", 14);
             Demangled->setCurrentPosition(Demangled->getCurrentPosition() - 1);
             Mangled.remove_prefix(Len);
             return;
@@ -520,7 +532,7 @@ void Demangler::parseLName(OutputBuffer* Demangled, std::string_view& Mangled, u
     case 12:
         if (starts_with(Mangled, "__ModuleInfoZ")) {
             // The ModuleInfo symbol for a given module.
-            Demangled->prepend("ModuleInfo for ");
+            Demangled->insert(OutputStart, "ModuleInfo for ", 15);
             Demangled->setCurrentPosition(Demangled->getCurrentPosition() - 1);
             Mangled.remove_prefix(Len);
             return;
@@ -536,36 +548,69 @@ Demangler::Demangler(std::string_view Mangled) : Str(Mangled), LastBackref(Mangl
 
 const char* Demangler::parseMangle(OutputBuffer* Demangled) {
     std::string_view M(this->Str);
+    OutputStart = Demangled->getCurrentPosition();
     parseMangle(Demangled, M);
     return M.data();
 }
 
 char* demangler::dlangDemangle(std::string_view MangledName) {
-    if (MangledName.empty() || !starts_with(MangledName, "_D")) return nullptr;
-
     OutputBuffer Demangled;
-    if (MangledName == "_Dmain") {
-        Demangled << "D main";
-    } else {
-
-        Demangler   D(MangledName);
-        const char* M = D.parseMangle(&Demangled);
-
-        // Check that the entire symbol was successfully demangled.
-        if (M == nullptr || *M != '\0') {
-            std::free(Demangled.getBuffer());
-            return nullptr;
-        }
+    if (!dlangDemangle(MangledName, Demangled)) {
+        std::free(Demangled.getBuffer());
+        return nullptr;
     }
 
     // OutputBuffer's internal buffer is not null terminated and therefore we need
     // to add it to comply with C null terminated strings.
-    if (Demangled.getCurrentPosition() > 0) {
-        Demangled << '\0';
-        Demangled.setCurrentPosition(Demangled.getCurrentPosition() - 1);
-        return Demangled.getBuffer();
-    }
+    Demangled << '\0';
+    return Demangled.getBuffer();
+}
+
+bool demangler::dlangDemangle(std::string_view MangledName, OutputBuffer& Demangled) {
+    return dlangDemangle(MangledName, Demangled, DemangleLimits(), nullptr);
+}
 
-    std::free(Demangled.getBuffer());
-    return nullptr;
+bool demangler::dlangDemangle(
+    std::string_view      MangledName,
+    OutputBuffer&         Demangled,
+    const DemangleLimits& Limits,
+    int*                  Status
+) {
+    if (MangledName.empty() || !starts_with(MangledName, "_D")) {
+        if (Status) *Status = demangle_invalid_mangled_name;
+        return false;
+    }
+    DEMANGLE_STATS_CALL(Demangled);
+
+    // The demangler takes back parts of what it printed, and all of it if the
+    // name turns out to be invalid, so none of it may be drained yet.
+    OutputBuffer::Hold KeepOutput(Demangled);
+    size_t             Start          = Demangled.getCurrentPosition();
+    int                InternalStatus = demangle_success;
+
+    Demangler D(MangledName);
+    D.Limits.setLimits(Limits);
+    // The special name of the D main function is printed within the output
+    // limit like any other.
+    const char* M     = nullptr;
+    auto        Print = [&] {
+        if (MangledName != "_Dmain") M = D.parseMangle(&Demangled);
+        else {
+            Demangled << "D main";
+            M = MangledName.data() + MangledName.size();
+        }
+    };
+    if (!detail::printWithinLimit(Demangled, Limits.MaxOutputSize, Print)) D.Limits.Exceeded = true;
+
+    // Check that the entire symbol was successfully demangled. The input
+    // need not be null terminated, so compare against its end.
+    if (D.Limits.Exceeded) InternalStatus = demangle_limit_exceeded;
+    else if (M == nullptr || M != MangledName.data() + MangledName.size())
+        InternalStatus = demangle_invalid_mangled_name;
+    if (InternalStatus == demangle_success && Demangled.getCurrentPosition() == Start)
+        InternalStatus = demangle_invalid_mangled_name;
+    if (InternalStatus != demangle_success) Demangled.setCurrentPosition(Start);
+
+    if (Status) *Status = InternalStatus;
+    return InternalStatus == demangle_success;
 }
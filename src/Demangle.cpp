@@ -11,65 +11,594 @@
 //===----------------------------------------------------------------------===//
 
 #include "demangler/Demangle.h"
+#include "demangler/DemangleSink.h"
 #include "demangler/StringViewExtras.h"
+#include "demangler/Utility.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstdlib>
+#include <cstring>
+#include <mutex>
 #include <string_view>
+#include <thread>
 
+using namespace demangler;
+using demangler::itanium_demangle::OutputBuffer;
 using demangler::itanium_demangle::starts_with;
 
-std::string demangler::demangle(std::string_view MangledName) {
-    std::string Result;
+namespace {
+// Per-thread buffer that the std::string and span entry points print into
+// before copying out, so that it only reallocates for the longest symbol.
+struct ScratchBuffer {
+    OutputBuffer OB;
 
-    if (nonMicrosoftDemangle(MangledName, Result)) return Result;
+    ~ScratchBuffer() { std::free(OB.getBuffer()); }
+};
+} // namespace
 
-    if (starts_with(MangledName, '_')
-        && nonMicrosoftDemangle(
-            MangledName.substr(1),
-            Result,
-            /*CanHaveLeadingDot=*/false
-        ))
-        return Result;
+static OutputBuffer& getScratchBuffer() {
+    static thread_local ScratchBuffer Scratch;
+    Scratch.OB.setCurrentPosition(0);
+    return Scratch.OB;
+}
 
-    if (char* Demangled = microsoftDemangle(MangledName, nullptr, nullptr)) {
-        Result = Demangled;
-        std::free(Demangled);
-    } else {
-        Result = MangledName;
+// The Itanium scheme with the given number of leading underscores.
+static ManglingScheme getItaniumScheme(size_t Underscores) {
+    switch (Underscores) {
+    case 1:
+        return ManglingScheme::Itanium;
+    case 2:
+        return ManglingScheme::Itanium2;
+    case 3:
+        return ManglingScheme::Itanium3;
+    case 4:
+        return ManglingScheme::Itanium4;
+    default:
+        return ManglingScheme::None;
     }
-    return Result;
 }
 
-static bool isItaniumEncoding(std::string_view S) {
+static ManglingScheme detectNonMicrosoftScheme(std::string_view S) {
     // Itanium demangler supports prefixes with 1-4 underscores.
     const size_t Pos = S.find_first_not_of('_');
-    return Pos > 0 && Pos <= 4 && S[Pos] == 'Z';
+    if (Pos != std::string_view::npos && S[Pos] == 'Z') return getItaniumScheme(Pos);
+    if (starts_with(S, "_R")) return ManglingScheme::Rust;
+    if (starts_with(S, "_D")) return ManglingScheme::DLang;
+    return ManglingScheme::None;
 }
 
-static bool isRustEncoding(std::string_view S) { return starts_with(S, "_R"); }
+namespace {
+// Whether a front-end of the demangle() cascade gave up on a limit.
+struct LimitStatus {
+    bool LimitExceeded = false;
 
-static bool isDLangEncoding(std::string_view S) { return starts_with(S, "_D"); }
+    // Record the demangle_ status of a front-end and return whether it
+    // succeeded.
+    bool succeeded(int Status) {
+        LimitExceeded |= Status == demangle_limit_exceeded;
+        return Status == demangle_success;
+    }
+};
 
-bool demangler::nonMicrosoftDemangle(
+// The front-ends that the demangle() cascade uses, all within Limits.
+// demangleBatch substitutes its per-thread sessions.
+struct DefaultFrontEnds : LimitStatus {
+    const DemangleLimits& Limits;
+
+    explicit DefaultFrontEnds(const DemangleLimits& Limits) : Limits(Limits) {}
+
+    bool itanium(std::string_view MangledName, OutputBuffer& OB, bool ParseParams) {
+        int Status;
+        itaniumDemangle(MangledName, OB, Limits, &Status, ParseParams);
+        return succeeded(Status);
+    }
+    bool microsoft(std::string_view MangledName, OutputBuffer& OB) {
+        int Status;
+        microsoftDemangle(MangledName, OB, nullptr, &Status, MSDF_None, Limits);
+        return succeeded(Status);
+    }
+    bool rust(std::string_view MangledName, OutputBuffer& OB) {
+        int Status;
+        rustDemangle(MangledName, OB, Limits, &Status);
+        return succeeded(Status);
+    }
+    bool dlang(std::string_view MangledName, OutputBuffer& OB) {
+        int Status;
+        dlangDemangle(MangledName, OB, Limits, &Status);
+        return succeeded(Status);
+    }
+};
+} // namespace
+
+// The status a demangle() overload taking DemangleLimits reports.
+template <typename FrontEnds>
+static void setStatus(int* Status, const FrontEnds& FE, bool Demangled) {
+    if (!Status) return;
+    if (Demangled) *Status = demangle_success;
+    else *Status = FE.LimitExceeded ? demangle_limit_exceeded : demangle_invalid_mangled_name;
+}
+
+// Demangle a non-Microsoft name with the front-end its prefix selects.
+// Returns the scheme it was demangled with, or None with OB left as it was.
+template <typename FrontEnds>
+static ManglingScheme demangleNonMicrosoft(
+    FrontEnds&       FE,
     std::string_view MangledName,
-    std::string&     Result,
+    OutputBuffer&    OB,
     bool             CanHaveLeadingDot,
     bool             ParseParams
 ) {
-    char* Demangled = nullptr;
+    size_t Start = OB.getCurrentPosition();
 
     // Do not consider the dot prefix as part of the demangled symbol name.
     if (CanHaveLeadingDot && MangledName.size() > 0 && MangledName[0] == '.') {
         MangledName.remove_prefix(1);
-        Result = ".";
+        OB += '.';
+    }
+
+    ManglingScheme Scheme    = detectNonMicrosoftScheme(MangledName);
+    bool           Demangled = false;
+    if (getItaniumUnderscores(Scheme)) Demangled = FE.itanium(MangledName, OB, ParseParams);
+    else if (Scheme == ManglingScheme::Rust) Demangled = FE.rust(MangledName, OB);
+    else if (Scheme == ManglingScheme::DLang) Demangled = FE.dlang(MangledName, OB);
+
+    if (Demangled) return Scheme;
+    OB.setCurrentPosition(Start);
+    return ManglingScheme::None;
+}
+
+// The demangle() cascade. Returns the scheme MangledName was demangled with,
+// or None with OB left as it was.
+template <typename FrontEnds>
+static ManglingScheme demangleAny(FrontEnds& FE, std::string_view MangledName, OutputBuffer& OB) {
+    ManglingScheme Scheme = demangleNonMicrosoft(FE, MangledName, OB, /*CanHaveLeadingDot=*/true, true);
+    if (Scheme != ManglingScheme::None) return Scheme;
+
+    // Retry without one leading underscore. "__Z" and "____Z" are parsed
+    // exactly like "_Z" and "___Z", so for them the retry cannot succeed.
+    unsigned Underscores = getItaniumUnderscores(detectNonMicrosoftScheme(MangledName));
+    if (starts_with(MangledName, '_') && Underscores != 2 && Underscores != 4) {
+        Scheme = demangleNonMicrosoft(FE, MangledName.substr(1), OB, /*CanHaveLeadingDot=*/false, true);
+        if (Scheme != ManglingScheme::None) return Scheme;
+    }
+
+    // The Microsoft demangler rejects anything else without parsing it.
+    if ((starts_with(MangledName, '?') || starts_with(MangledName, '.')) && FE.microsoft(MangledName, OB))
+        return starts_with(MangledName, "??@") ? ManglingScheme::MicrosoftMD5 : ManglingScheme::Microsoft;
+    return ManglingScheme::None;
+}
+
+std::string demangler::demangle(std::string_view MangledName) {
+    OutputBuffer& OB = getScratchBuffer();
+    demangle(MangledName, OB);
+    return std::string(std::string_view(OB));
+}
+
+bool demangler::demangle(std::string_view MangledName, std::string& Result) {
+    return demangle(MangledName, Result, DemangleLimits(), nullptr);
+}
+
+bool demangler::demangle(std::string_view MangledName, OutputBuffer& OB) {
+    return demangle(MangledName, OB, DemangleLimits(), nullptr);
+}
+
+demangler::DemangleBufferResult demangler::demangle(std::string_view MangledName, std::span<char> Buf) {
+    return demangle(MangledName, Buf, DemangleLimits(), nullptr);
+}
+
+bool demangler::demangle(std::string_view MangledName, std::string& Result, const DemangleLimits& Limits, int* Status) {
+    OutputBuffer& OB        = getScratchBuffer();
+    bool          Demangled = demangle(MangledName, OB, Limits, Status);
+    Result                 += std::string_view(OB);
+    return Demangled;
+}
+
+bool demangler::demangle(std::string_view MangledName, OutputBuffer& OB, const DemangleLimits& Limits, int* Status) {
+    DefaultFrontEnds FE(Limits);
+    bool             Demangled = demangleAny(FE, MangledName, OB) != ManglingScheme::None;
+    setStatus(Status, FE, Demangled);
+    if (!Demangled) OB += MangledName;
+    return Demangled;
+}
+
+demangler::DemangleBufferResult demangler::demangle(
+    std::string_view      MangledName,
+    std::span<char>       Buf,
+    const DemangleLimits& Limits,
+    int*                  Status
+) {
+    OutputBuffer&        OB = getScratchBuffer();
+    DemangleBufferResult Result;
+    Result.Demangled = demangle(MangledName, OB, Limits, Status);
+    Result.Size      = OB.getCurrentPosition();
+    Result.Truncated = Result.Size >= Buf.size();
+    if (!Buf.empty()) {
+        size_t N = Result.Truncated ? Buf.size() - 1 : Result.Size;
+        std::memcpy(Buf.data(), OB.getBuffer(), N);
+        Buf[N] = '\0';
+    }
+    return Result;
+}
+
+bool demangler::detail::demangle(
+    std::string_view      MangledName,
+    SinkRef               Sink,
+    const DemangleLimits& Limits,
+    int*                  Status
+) {
+    // The sink is written to while the name is being printed, so a sink that
+    // demangles from its write() must not reuse the buffer that is in use.
+    // Only the outermost call on a thread takes the per-thread one.
+    static thread_local ScratchBuffer Scratch;
+    static thread_local bool          ScratchInUse = false;
+
+    OutputBuffer Own;
+
+    bool          Nested = ScratchInUse;
+    OutputBuffer& OB     = Nested ? Own : Scratch.OB;
+    ScratchInUse         = true;
+
+    OB.setCurrentPosition(0);
+    OB.setDrain(Sink.Write, Sink.Sink);
+    bool Demangled = demangle(MangledName, OB, Limits, Status);
+    OB.flush();
+    OB.setDrain(nullptr, nullptr);
+
+    ScratchInUse = Nested;
+    if (Nested) Own.freeBuffer();
+    return Demangled;
+}
+
+ManglingScheme demangler::detectManglingScheme(std::string_view MangledName) {
+    std::string_view Name = MangledName;
+    if (starts_with(Name, '.')) Name.remove_prefix(1);
+    ManglingScheme Scheme = detectNonMicrosoftScheme(Name);
+    if (Scheme == ManglingScheme::None && starts_with(MangledName, '_'))
+        Scheme = detectNonMicrosoftScheme(MangledName.substr(1));
+    if (Scheme != ManglingScheme::None) return Scheme;
+
+    if (starts_with(MangledName, "??@")) return ManglingScheme::MicrosoftMD5;
+    // Like demangle(), take any other name with a leading '.' as a Microsoft
+    // typeinfo name, such as ".H" for int.
+    if (starts_with(MangledName, '?') || starts_with(MangledName, '.')) return ManglingScheme::Microsoft;
+    return ManglingScheme::None;
+}
+
+std::string demangler::demangle(std::string_view MangledName, ManglingScheme Scheme) {
+    OutputBuffer& OB = getScratchBuffer();
+    if (!demangle(MangledName, Scheme, OB)) OB += MangledName;
+    return std::string(std::string_view(OB));
+}
+
+bool demangler::demangle(std::string_view MangledName, ManglingScheme Scheme, OutputBuffer& OB) {
+    return demangle(MangledName, Scheme, OB, DemangleLimits(), nullptr);
+}
+
+// Demangle MangledName as Scheme with FE, for demangle(MangledName, Scheme).
+template <typename FrontEnds>
+static bool demangleAs(FrontEnds& FE, std::string_view MangledName, ManglingScheme Scheme, OutputBuffer& OB) {
+    if (Scheme == ManglingScheme::None) return false;
+    if (Scheme == ManglingScheme::Microsoft || Scheme == ManglingScheme::MicrosoftMD5)
+        return FE.microsoft(MangledName, OB);
+
+    size_t Start = OB.getCurrentPosition();
+    if (starts_with(MangledName, '.')) {
+        MangledName.remove_prefix(1);
+        OB += '.';
+    }
+
+    // Drop underscores beyond those the scheme's own prefix has.
+    bool     IsItanium   = getItaniumUnderscores(Scheme) != 0;
+    unsigned Underscores = IsItanium ? getItaniumUnderscores(Scheme) : 1;
+    size_t   Pos         = MangledName.find_first_not_of('_');
+    if (Pos != std::string_view::npos && Pos > Underscores) MangledName.remove_prefix(Pos - Underscores);
+
+    bool Demangled = false;
+    if (detectNonMicrosoftScheme(MangledName) == Scheme) {
+        if (IsItanium) Demangled = FE.itanium(MangledName, OB, true);
+        else if (Scheme == ManglingScheme::Rust) Demangled = FE.rust(MangledName, OB);
+        else Demangled = FE.dlang(MangledName, OB);
     }
 
-    if (isItaniumEncoding(MangledName)) Demangled = itaniumDemangle(MangledName, ParseParams);
-    else if (isRustEncoding(MangledName)) Demangled = rustDemangle(MangledName);
-    else if (isDLangEncoding(MangledName)) Demangled = dlangDemangle(MangledName);
+    if (!Demangled) OB.setCurrentPosition(Start);
+    return Demangled;
+}
+
+bool demangler::demangle(
+    std::string_view      MangledName,
+    ManglingScheme        Scheme,
+    OutputBuffer&         OB,
+    const DemangleLimits& Limits,
+    int*                  Status
+) {
+    DefaultFrontEnds FE(Limits);
+    bool             Demangled = demangleAs(FE, MangledName, Scheme, OB);
+    setStatus(Status, FE, Demangled);
+    return Demangled;
+}
 
-    if (!Demangled) return false;
+bool demangler::nonMicrosoftDemangle(
+    std::string_view MangledName,
+    std::string&     Result,
+    bool             CanHaveLeadingDot,
+    bool             ParseParams
+) {
+    OutputBuffer& OB = getScratchBuffer();
+    if (!nonMicrosoftDemangle(MangledName, OB, CanHaveLeadingDot, ParseParams)) return false;
 
-    Result += Demangled;
-    std::free(Demangled);
+    Result += std::string_view(OB);
     return true;
 }
+
+bool demangler::nonMicrosoftDemangle(
+    std::string_view MangledName,
+    OutputBuffer&    OB,
+    bool             CanHaveLeadingDot,
+    bool             ParseParams
+) {
+    return nonMicrosoftDemangle(MangledName, OB, DemangleLimits(), nullptr, CanHaveLeadingDot, ParseParams);
+}
+
+bool demangler::nonMicrosoftDemangle(
+    std::string_view      MangledName,
+    OutputBuffer&         OB,
+    const DemangleLimits& Limits,
+    int*                  Status,
+    bool                  CanHaveLeadingDot,
+    bool                  ParseParams
+) {
+    DefaultFrontEnds FE(Limits);
+    bool Demangled = demangleNonMicrosoft(FE, MangledName, OB, CanHaveLeadingDot, ParseParams) != ManglingScheme::None;
+    setStatus(Status, FE, Demangled);
+    return Demangled;
+}
+
+namespace {
+// Front-end state owned by one batch thread and reused for every symbol it
+// demangles. Results are appended to OB back to back.
+struct BatchWorker : LimitStatus {
+    ItaniumDemangleSession   Itanium;
+    MicrosoftDemangleSession Microsoft;
+    OutputBuffer             OB;
+    MSDemangleFlags          Flags      = MSDF_None;
+    bool                     WholeNames = false;
+    DemangleLimits           Limits;
+
+    BatchWorker()                              = default;
+    BatchWorker(const BatchWorker&)            = delete;
+    BatchWorker& operator=(const BatchWorker&) = delete;
+    ~BatchWorker() { std::free(OB.getBuffer()); }
+
+    void setLimits(const DemangleLimits& NewLimits) {
+        Limits = NewLimits;
+        Itanium.setLimits(Limits);
+        Microsoft.setLimits(Limits);
+    }
+
+    bool itanium(std::string_view MangledName, OutputBuffer& Out, bool ParseParams) {
+        Itanium.demangle(MangledName, Out, ParseParams);
+        return succeeded(Itanium.getStatus());
+    }
+    bool microsoft(std::string_view MangledName, OutputBuffer& Out) {
+        size_t Start = Out.getCurrentPosition();
+        size_t NRead = 0;
+        int    Status;
+        Microsoft.demangle(MangledName, Out, &NRead, &Status, Flags);
+        if (!succeeded(Status)) return false;
+        // Trailing bytes the demangler did not look at.
+        if (!WholeNames || (Flags & MSDF_NameOnly) || NRead == MangledName.size()) return true;
+        Out.setCurrentPosition(Start);
+        return false;
+    }
+    bool rust(std::string_view MangledName, OutputBuffer& Out) {
+        int Status;
+        rustDemangle(MangledName, Out, Limits, &Status);
+        return succeeded(Status);
+    }
+    bool dlang(std::string_view MangledName, OutputBuffer& Out) {
+        int Status;
+        dlangDemangle(MangledName, Out, Limits, &Status);
+        return succeeded(Status);
+    }
+
+    void demangle(std::string_view MangledName, DemangleBatchEntry& Entry);
+};
+
+// A contiguous range of chunks assigned to one worker. Other workers steal
+// from it through the same counter once their own range is exhausted.
+struct alignas(64) ChunkRange {
+    std::atomic<size_t> Next{0};
+    size_t              End = 0;
+};
+
+// Number of symbols claimed at once, to keep the atomic traffic low.
+constexpr size_t BatchChunkSize = 64;
+} // namespace
+
+// Same cascade as demangler::demangle, using this worker's sessions.
+void BatchWorker::demangle(std::string_view MangledName, DemangleBatchEntry& Entry) {
+    LimitExceeded       = false;
+    Entry.Offset        = OB.getCurrentPosition();
+    Entry.Scheme        = demangleAny(*this, MangledName, OB);
+    Entry.Demangled     = Entry.Scheme != ManglingScheme::None;
+    Entry.LimitExceeded = !Entry.Demangled && LimitExceeded;
+    if (!Entry.Demangled) {
+        Entry.Scheme  = detectManglingScheme(MangledName);
+        OB           += MangledName;
+    }
+
+    Entry.Size  = OB.getCurrentPosition() - Entry.Offset;
+    OB         += '\0';
+}
+
+namespace {
+// The threads and workers of a DemangleBatchPool. Worker 0 is the thread that
+// calls demangle(); the others each have a thread of their own, which waits
+// for the next batch in between.
+struct BatchPool {
+    std::vector<BatchWorker> Workers;
+    std::vector<ChunkRange>  Ranges;
+    std::vector<std::thread> Threads;
+
+    std::mutex              Lock;
+    std::condition_variable BatchReady;
+    std::condition_variable BatchDone;
+    uint64_t                Generation = 0;
+    unsigned                Busy       = 0;
+    bool                    Stop       = false;
+
+    // The batch being demangled, and which worker demangled each chunk; its
+    // output is contiguous in that worker's buffer.
+    std::span<const std::string_view> MangledNames;
+    DemangleBatchEntry*               Entries = nullptr;
+    std::vector<unsigned>             ChunkOwner;
+
+    BatchPool(
+        unsigned              NumThreads,
+        MSDemangleFlags       Flags,
+        bool                  SharePrefixes,
+        const DemangleLimits& Limits,
+        bool                  WholeNames
+    )
+    : Workers(NumThreads),
+      Ranges(NumThreads) {
+        for (BatchWorker& W : Workers) {
+            W.Flags      = Flags;
+            W.WholeNames = WholeNames;
+            W.setLimits(Limits);
+            W.Itanium.setSharePrefixes(SharePrefixes);
+            W.Microsoft.setSharePrefixes(SharePrefixes);
+        }
+        Threads.reserve(NumThreads - 1);
+        for (unsigned I = 1; I != NumThreads; ++I) Threads.emplace_back([this, I] { serve(I); });
+    }
+
+    ~BatchPool() {
+        {
+            std::lock_guard<std::mutex> Guard(Lock);
+            Stop = true;
+        }
+        BatchReady.notify_all();
+        for (std::thread& T : Threads) T.join();
+    }
+
+    // Demangle chunks of the current batch, starting with those of worker
+    // Self and then stealing from the others.
+    void run(unsigned Self) {
+        BatchWorker& W          = Workers[Self];
+        unsigned     NumWorkers = static_cast<unsigned>(Workers.size());
+        for (unsigned I = 0; I != NumWorkers; ++I) {
+            ChunkRange& R = Ranges[(Self + I) % NumWorkers];
+            for (size_t Chunk; (Chunk = R.Next.fetch_add(1, std::memory_order_relaxed)) < R.End;) {
+                ChunkOwner[Chunk] = Self;
+                size_t End        = std::min(MangledNames.size(), (Chunk + 1) * BatchChunkSize);
+                for (size_t J = Chunk * BatchChunkSize; J != End; ++J) W.demangle(MangledNames[J], Entries[J]);
+            }
+        }
+    }
+
+    // The loop of the thread of worker Self.
+    void serve(unsigned Self) {
+        uint64_t Seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> Guard(Lock);
+                BatchReady.wait(Guard, [&] { return Stop || Generation != Seen; });
+                if (Stop) return;
+                Seen = Generation;
+            }
+            run(Self);
+            std::lock_guard<std::mutex> Guard(Lock);
+            if (--Busy == 0) BatchDone.notify_one();
+        }
+    }
+
+    DemangleBatchResult demangle(std::span<const std::string_view> Names);
+};
+} // namespace
+
+DemangleBatchResult BatchPool::demangle(std::span<const std::string_view> Names) {
+    DemangleBatchResult Result;
+    Result.Entries.resize(Names.size());
+    if (Names.empty()) return Result;
+
+    size_t   NumChunks  = (Names.size() + BatchChunkSize - 1) / BatchChunkSize;
+    unsigned NumWorkers = static_cast<unsigned>(Workers.size());
+    for (unsigned I = 0; I != NumWorkers; ++I) {
+        Workers[I].OB.setCurrentPosition(0);
+        Ranges[I].Next = NumChunks * I / NumWorkers;
+        Ranges[I].End  = NumChunks * (I + 1) / NumWorkers;
+    }
+    MangledNames = Names;
+    Entries      = Result.Entries.data();
+    ChunkOwner.assign(NumChunks, 0);
+
+    if (!Threads.empty()) {
+        {
+            std::lock_guard<std::mutex> Guard(Lock);
+            ++Generation;
+            Busy = static_cast<unsigned>(Threads.size());
+        }
+        BatchReady.notify_all();
+    }
+    run(0);
+    if (!Threads.empty()) {
+        std::unique_lock<std::mutex> Guard(Lock);
+        BatchDone.wait(Guard, [&] { return Busy == 0; });
+    }
+
+    size_t Total = 0;
+    for (BatchWorker& W : Workers) Total += W.OB.getCurrentPosition();
+    Result.Buffer.resize(Total);
+
+    // Copy the chunks into place in input order and rebase their offsets.
+    size_t Pos = 0;
+    for (size_t Chunk = 0; Chunk != NumChunks; ++Chunk) {
+        size_t              Begin = Chunk * BatchChunkSize;
+        size_t              End   = std::min(Names.size(), Begin + BatchChunkSize);
+        const OutputBuffer& OB    = Workers[ChunkOwner[Chunk]].OB;
+        size_t              From  = Result.Entries[Begin].Offset;
+        size_t              Size  = Result.Entries[End - 1].Offset + Result.Entries[End - 1].Size + 1 - From;
+        std::memcpy(Result.Buffer.data() + Pos, std::string_view(OB).data() + From, Size);
+        for (size_t J = Begin; J != End; ++J) Result.Entries[J].Offset += Pos - From;
+        Pos += Size;
+    }
+    return Result;
+}
+
+// The number of threads a batch pool starts for NumThreads.
+static unsigned getBatchThreads(unsigned NumThreads) {
+    return NumThreads ? NumThreads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+demangler::DemangleBatchResult demangler::demangleBatch(
+    std::span<const std::string_view> MangledNames,
+    unsigned                          NumThreads,
+    MSDemangleFlags                   Flags,
+    bool                              SharePrefixes,
+    const DemangleLimits&             Limits,
+    bool                              WholeNames
+) {
+    if (MangledNames.empty()) return DemangleBatchResult();
+
+    // A one-off batch needs no more threads than it has chunks.
+    size_t NumChunks = (MangledNames.size() + BatchChunkSize - 1) / BatchChunkSize;
+    NumThreads       = static_cast<unsigned>(std::min<size_t>(getBatchThreads(NumThreads), NumChunks));
+    return DemangleBatchPool(NumThreads, Flags, SharePrefixes, Limits, WholeNames).demangle(MangledNames);
+}
+
+DemangleBatchPool::DemangleBatchPool(
+    unsigned              NumThreads,
+    MSDemangleFlags       Flags,
+    bool                  SharePrefixes,
+    const DemangleLimits& Limits,
+    bool                  WholeNames
+)
+: Context(new BatchPool(getBatchThreads(NumThreads), Flags, SharePrefixes, Limits, WholeNames)) {}
+
+DemangleBatchPool::~DemangleBatchPool() { delete static_cast<BatchPool*>(Context); }
+
+DemangleBatchResult DemangleBatchPool::demangle(std::span<const std::string_view> MangledNames) {
+    return static_cast<BatchPool*>(Context)->demangle(MangledNames);
+}
@@ -0,0 +1,345 @@
+//===--- DemangleCache.cpp ------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "demangler/DemangleCache.h"
+
+#include "demangler/DemangleHash.h"
+#include "demangler/Utility.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+using namespace demangler;
+using demangler::itanium_demangle::OutputBuffer;
+
+namespace {
+// Which entry point produced a cached result. Microsoft results also encode
+// their MSDemangleFlags above MK_Microsoft.
+enum ModeKind : uint32_t {
+    MK_Auto,
+    MK_Itanium,
+    MK_ItaniumNoParams,
+    MK_Rust,
+    MK_DLang,
+    MK_Microsoft,
+};
+
+// A cached result, followed in memory by the mangled name and then the
+// demangled name.
+struct Entry {
+    uint64_t Hash;
+    size_t   KeySize;
+    size_t   ValueSize;
+    uint32_t Mode;
+    bool     Demangled;
+    // Set by hits; gives the entry a second chance when its segment is reclaimed.
+    bool Referenced;
+
+    char*            key() { return reinterpret_cast<char*>(this + 1); }
+    std::string_view keyRef() { return {key(), KeySize}; }
+    std::string_view valueRef() { return {key() + KeySize, ValueSize}; }
+
+    static size_t sizeFor(size_t KeySize, size_t ValueSize) {
+        size_t Size = sizeof(Entry) + KeySize + ValueSize;
+        return (Size + alignof(Entry) - 1) & ~(alignof(Entry) - 1);
+    }
+    size_t size() const { return sizeFor(KeySize, ValueSize); }
+};
+
+// A block of entries. Segments form a FIFO ring from Oldest to Newest.
+struct Segment {
+    Segment* Next;
+    size_t   Capacity;
+    size_t   Used;
+    // The epoch in which the segment was reclaimed, once it has been.
+    uint64_t RetiredEpoch;
+
+    char* begin() { return reinterpret_cast<char*>(this + 1); }
+};
+
+struct KeyRef {
+    std::string_view Name;
+    uint64_t         Hash;
+    uint32_t         Mode;
+
+    bool operator==(const KeyRef& Other) const { return Mode == Other.Mode && Name == Other.Name; }
+};
+
+struct KeyRefHash {
+    size_t operator()(const KeyRef& K) const { return static_cast<size_t>(K.Hash); }
+};
+
+void freeSegments(Segment* S) {
+    while (S) {
+        Segment* Next = S->Next;
+        std::free(S);
+        S = Next;
+    }
+}
+
+// Per-thread buffer that misses are demangled into before being interned.
+struct ScratchBuffer {
+    OutputBuffer OB;
+
+    ~ScratchBuffer() { std::free(OB.getBuffer()); }
+};
+
+OutputBuffer& getScratchBuffer() {
+    static thread_local ScratchBuffer Scratch;
+    Scratch.OB.setCurrentPosition(0);
+    return Scratch.OB;
+}
+
+bool demangleMode(std::string_view MangledName, uint32_t Mode, OutputBuffer& OB) {
+    switch (Mode) {
+    case MK_Auto:
+        return demangler::demangle(MangledName, OB);
+    case MK_Itanium:
+        return demangler::itaniumDemangle(MangledName, OB, true);
+    case MK_ItaniumNoParams:
+        return demangler::itaniumDemangle(MangledName, OB, false);
+    case MK_Rust:
+        return demangler::rustDemangle(MangledName, OB);
+    case MK_DLang:
+        return demangler::dlangDemangle(MangledName, OB);
+    default:
+        return demangler::microsoftDemangle(MangledName, OB, nullptr, nullptr, MSDemangleFlags(Mode - MK_Microsoft));
+    }
+}
+} // namespace
+
+struct DemangleCache::Shard {
+    std::mutex                                     Lock;
+    std::unordered_map<KeyRef, Entry*, KeyRefHash> Index;
+
+    Segment* Oldest  = nullptr;
+    Segment* Newest  = nullptr;
+    // Reclaimed segments, the most recently reclaimed first.
+    Segment* Retired = nullptr;
+
+    DemangleCache* Cache        = nullptr;
+    size_t         Budget       = 0;
+    size_t         SegmentSize  = 0;
+    size_t         Bytes        = 0;
+    size_t         RetiredBytes = 0;
+
+    uint64_t Hits      = 0;
+    uint64_t Misses    = 0;
+    uint64_t Evictions = 0;
+
+    ~Shard() {
+        freeSegments(Oldest);
+        freeSegments(Retired);
+    }
+
+    void* bump(size_t Size) {
+        if (!Newest || Newest->Capacity - Newest->Used < Size) return nullptr;
+        void* P       = Newest->begin() + Newest->Used;
+        Newest->Used += Size;
+        return P;
+    }
+
+    void* allocate(size_t Size) {
+        for (;;) {
+            if (void* P = bump(Size)) return P;
+            addSegment(std::max(SegmentSize, Size));
+        }
+    }
+
+    void addSegment(size_t Capacity) {
+        Segment* S = static_cast<Segment*>(std::malloc(sizeof(Segment) + Capacity));
+        if (S == nullptr) std::abort();
+        S->Next         = nullptr;
+        S->Capacity     = Capacity;
+        S->Used         = 0;
+        S->RetiredEpoch = 0;
+        if (Newest) Newest->Next = S;
+        else Oldest = S;
+        Newest  = S;
+        Bytes  += Capacity;
+
+        // Make room by reclaiming the oldest segments. Their surviving entries
+        // move into the segment just added.
+        while (Bytes > Budget && Oldest != Newest) reclaimOldest();
+    }
+
+    void reclaimOldest() {
+        Segment* S  = Oldest;
+        Oldest      = S->Next;
+        S->Next     = nullptr;
+        Bytes      -= S->Capacity;
+
+        for (size_t Pos = 0; Pos != S->Used;) {
+            Entry* E  = reinterpret_cast<Entry*>(S->begin() + Pos);
+            Pos      += E->size();
+
+            auto It = Index.find(KeyRef{E->keyRef(), E->Hash, E->Mode});
+            DEMANGLE_ASSERT(It != Index.end() && It->second == E, "DemangleCache entry is not indexed");
+            void* P = E->Referenced ? bump(E->size()) : nullptr;
+            if (P == nullptr) {
+                Index.erase(It);
+                ++Evictions;
+                continue;
+            }
+
+            Entry* Moved      = static_cast<Entry*>(std::memcpy(P, E, E->size()));
+            Moved->Referenced = false;
+            auto Node         = Index.extract(It);
+            Node.key().Name   = Moved->keyRef();
+            Node.mapped()     = Moved;
+            Index.insert(std::move(Node));
+        }
+
+        // Guards alive now may still view S. They all belong to the current
+        // epoch or the one before, so S can be freed once the epoch has moved
+        // on twice.
+        S->RetiredEpoch  = Cache->Epoch.load();
+        S->Next          = Retired;
+        Retired          = S;
+        RetiredBytes    += S->Capacity;
+        freeRetired(Cache->advanceEpoch());
+    }
+
+    void freeRetired(uint64_t Epoch) {
+        Segment** Link = &Retired;
+        while (*Link && (*Link)->RetiredEpoch + 2 > Epoch) Link = &(*Link)->Next;
+        for (Segment* Seg = *Link; Seg; Seg = Seg->Next) RetiredBytes -= Seg->Capacity;
+        freeSegments(*Link);
+        *Link = nullptr;
+    }
+
+    Entry* insert(const KeyRef& Key, std::string_view Value, bool Demangled) {
+        Entry* E      = static_cast<Entry*>(allocate(Entry::sizeFor(Key.Name.size(), Value.size())));
+        E->Hash       = Key.Hash;
+        E->KeySize    = Key.Name.size();
+        E->ValueSize  = Value.size();
+        E->Mode       = Key.Mode;
+        E->Demangled  = Demangled;
+        E->Referenced = false;
+        if (!Key.Name.empty()) std::memcpy(E->key(), Key.Name.data(), Key.Name.size());
+        if (!Value.empty()) std::memcpy(E->key() + Key.Name.size(), Value.data(), Value.size());
+        Index.emplace(KeyRef{E->keyRef(), Key.Hash, Key.Mode}, E);
+        return E;
+    }
+
+    void clear() {
+        Index.clear();
+        freeSegments(Oldest);
+        freeSegments(Retired);
+        Oldest = Newest = Retired = nullptr;
+        Bytes                     = 0;
+        RetiredBytes              = 0;
+    }
+};
+
+DemangleCache::DemangleCache(size_t ByteBudget, unsigned NumShards) {
+    ShardBits = 0;
+    while ((1u << ShardBits) < NumShards) ++ShardBits;
+    NumShards = 1u << ShardBits;
+
+    Shards.reset(new Shard[NumShards]);
+    size_t Budget = std::max<size_t>(ByteBudget / NumShards, 4096);
+    for (unsigned I = 0; I != NumShards; ++I) {
+        Shards[I].Cache       = this;
+        Shards[I].Budget      = Budget;
+        Shards[I].SegmentSize = std::max<size_t>(Budget / 8, 4096);
+    }
+}
+
+DemangleCache::~DemangleCache() = default;
+
+// Moves to the next epoch if no guard of the previous one is left, and
+// returns the current epoch.
+uint64_t DemangleCache::advanceEpoch() {
+    uint64_t Current = Epoch.load();
+    if (Readers[(Current - 1) & 1].load() == 0 && Epoch.compare_exchange_strong(Current, Current + 1)) ++Current;
+    return Current;
+}
+
+// Sets Result to the cached (or newly cached) result for MangledName in Mode
+// and returns whether it was demangled.
+bool DemangleCache::lookup(std::string_view MangledName, uint32_t Mode, std::string_view& Result) {
+    KeyRef Key{MangledName, detail::hashString(MangledName, Mode), Mode};
+    Shard& S = Shards[ShardBits ? Key.Hash >> (64 - ShardBits) : 0];
+
+    auto Found = [&](Entry* E) {
+        if (E->Demangled) Result = E->valueRef();
+        else Result = Mode == MK_Auto ? E->keyRef() : std::string_view();
+        return E->Demangled;
+    };
+
+    {
+        std::lock_guard<std::mutex> Lock(S.Lock);
+        auto                        It = S.Index.find(Key);
+        if (It != S.Index.end()) {
+            ++S.Hits;
+            It->second->Referenced = true;
+            return Found(It->second);
+        }
+    }
+
+    // Demangle without holding the lock, then intern the result unless another
+    // thread got there first.
+    OutputBuffer&    OB        = getScratchBuffer();
+    bool             Demangled = demangleMode(MangledName, Mode, OB);
+    std::string_view Value     = Demangled ? std::string_view(OB) : std::string_view();
+
+    std::lock_guard<std::mutex> Lock(S.Lock);
+    ++S.Misses;
+    auto It = S.Index.find(Key);
+    return Found(It != S.Index.end() ? It->second : S.insert(Key, Value, Demangled));
+}
+
+std::string_view DemangleCache::demangle(std::string_view MangledName) {
+    std::string_view Result;
+    lookup(MangledName, MK_Auto, Result);
+    return Result;
+}
+
+bool DemangleCache::itaniumDemangle(std::string_view MangledName, std::string_view& Result, bool ParseParams) {
+    return lookup(MangledName, ParseParams ? MK_Itanium : MK_ItaniumNoParams, Result);
+}
+
+bool DemangleCache::microsoftDemangle(std::string_view MangledName, std::string_view& Result, MSDemangleFlags Flags) {
+    // Dumping back references is a side effect that cannot be cached.
+    Flags = MSDemangleFlags(Flags & ~MSDF_DumpBackrefs);
+    return lookup(MangledName, MK_Microsoft + static_cast<uint32_t>(Flags), Result);
+}
+
+bool DemangleCache::rustDemangle(std::string_view MangledName, std::string_view& Result) {
+    return lookup(MangledName, MK_Rust, Result);
+}
+
+bool DemangleCache::dlangDemangle(std::string_view MangledName, std::string_view& Result) {
+    return lookup(MangledName, MK_DLang, Result);
+}
+
+DemangleCache::Stats DemangleCache::getStats() const {
+    Stats Result;
+    for (unsigned I = 0, E = 1u << ShardBits; I != E; ++I) {
+        Shard&                      S = Shards[I];
+        std::lock_guard<std::mutex> Lock(S.Lock);
+        Result.Hits      += S.Hits;
+        Result.Misses    += S.Misses;
+        Result.Evictions += S.Evictions;
+        Result.Entries   += S.Index.size();
+        for (Segment* Seg = S.Oldest; Seg; Seg = Seg->Next) Result.Bytes += Seg->Used;
+        Result.RetiredBytes += S.RetiredBytes;
+    }
+    return Result;
+}
+
+void DemangleCache::clear() {
+    for (unsigned I = 0, E = 1u << ShardBits; I != E; ++I) {
+        std::lock_guard<std::mutex> Lock(Shards[I].Lock);
+        Shards[I].clear();
+    }
+}
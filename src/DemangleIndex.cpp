@@ -0,0 +1,690 @@
+//===--- DemangleIndex.cpp ------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// An index file is laid out in native byte order as
+//
+//   IndexHeader
+//   IndexSymbolRecord[NumSymbols]
+//   uint32_t[NumBuckets]          open-addressed hash table of the mangled names
+//   char[StringsSize]             the strings the records refer to
+//
+// with every section aligned to 8 bytes. A bucket holds one plus the number
+// of a symbol, or 0 if it is empty. A reverse index is laid out as
+//
+//   ReverseIndexHeader
+//   uint32_t[NumPilots]           the pilot of each bucket of keys
+//   ReverseIndexSlot[NumSlots]    the keys in their perfect hash order
+//   uint32_t[NumMatches]          the symbols of each key, one range per key
+//   IndexStringRef[NumSymbols]    the mangled name of each symbol
+//   char[StringsSize]             the mangled names, then the keys
+//
+// Its keys hash into buckets of about four. The builder picks for each bucket
+// a pilot that moves all of its keys into free slots, so a lookup computes
+// the slot from the hash and the pilot of the bucket and compares one key
+// (the PTHash scheme). About one slot in nine is left empty, which keeps the
+// search for the pilots of the last buckets short; if a search still runs
+// too long, or two keys share a hash, the builder starts over with the keys
+// hashed under another seed.
+//
+//===----------------------------------------------------------------------===//
+
+#include "demangler/DemangleIndex.h"
+
+#include "demangler/DemangleHash.h"
+#include "demangler/FileMapping.h"
+#include "demangler/MicrosoftDemangleNodes.h"
+#include "demangler/Utility.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+using namespace demangler;
+using demangler::detail::hashString;
+using demangler::detail::IndexStringRef;
+using demangler::detail::IndexSymbolRecord;
+using demangler::detail::mapFile;
+using demangler::detail::mixHash;
+using demangler::detail::ReverseIndexSlot;
+using demangler::detail::unmapFile;
+using demangler::itanium_demangle::OutputBuffer;
+
+namespace {
+struct IndexHeader {
+    char     Magic[4];
+    uint32_t Version;
+    uint64_t Key;
+    uint32_t NumSymbols;
+    uint32_t NumBuckets;
+    uint64_t RecordsOffset;
+    uint64_t BucketsOffset;
+    uint64_t StringsOffset;
+    uint64_t StringsSize;
+};
+
+struct ReverseIndexHeader {
+    char     Magic[4];
+    uint32_t Version;
+    uint64_t Key;
+    uint64_t Seed;
+    uint32_t Flags;
+    uint32_t NumSymbols;
+    uint32_t NumKeys;
+    uint32_t NumSlots;
+    uint32_t NumPilots;
+    uint32_t NumMatches;
+    uint64_t PilotsOffset;
+    uint64_t SlotsOffset;
+    uint64_t MatchesOffset;
+    uint64_t SymbolsOffset;
+    uint64_t StringsOffset;
+    uint64_t StringsSize;
+};
+
+constexpr char     IndexMagic[4]        = {'D', 'M', 'I', 'X'};
+constexpr char     ReverseIndexMagic[4] = {'D', 'M', 'R', 'X'};
+constexpr uint32_t IndexVersion         = 1;
+
+static_assert(sizeof(IndexSymbolRecord) == 64, "IndexSymbolRecord is part of the file format");
+static_assert(sizeof(IndexHeader) % 8 == 0, "IndexHeader is part of the file format");
+static_assert(sizeof(ReverseIndexHeader) % 8 == 0, "ReverseIndexHeader is part of the file format");
+
+enum SymbolFlags : uint8_t {
+    SF_Demangled          = 1 << 0,
+    SF_Function           = 1 << 1,
+    SF_Data               = 1 << 2,
+    SF_SpecialName        = 1 << 3,
+    SF_CtorOrDtor         = 1 << 4,
+    SF_FunctionQualifiers = 1 << 5,
+};
+
+// The bucket of a reverse index key, from the high half of its hash.
+uint32_t pilotBucket(uint64_t Hash, uint32_t NumPilots) {
+    return static_cast<uint32_t>(((Hash >> 32) * NumPilots) >> 32);
+}
+
+// The slot of a reverse index key in a bucket with the given pilot.
+uint32_t pilotSlot(uint64_t Hash, uint32_t Pilot, uint32_t NumSlots) {
+    return static_cast<uint32_t>(mixHash(Hash ^ (Pilot * 0x9e3779b97f4a7c15ull)) % NumSlots);
+}
+
+// The pilots a bucket may try before the build starts over with a new seed.
+constexpr uint32_t MaxPilot = 1 << 20;
+
+// The seeds a build may try. Each one fails only by very bad luck.
+constexpr uint64_t MaxSeeds = 64;
+
+// Picks the pilot of every bucket, largest bucket first while there is the
+// most room, each the first that sends all of its keys to distinct free
+// slots. Fails if two keys share a hash or a bucket runs out of pilots.
+bool placeKeys(
+    const std::vector<uint64_t>& Hashes,
+    uint32_t                     NumSlots,
+    uint32_t                     NumPilots,
+    std::vector<uint32_t>&       Pilots,
+    std::vector<uint32_t>&       SlotOf
+) {
+    uint32_t                           NumKeys = static_cast<uint32_t>(Hashes.size());
+    std::vector<std::vector<uint32_t>> Buckets(NumPilots);
+    for (uint32_t K = 0; K != NumKeys; ++K) Buckets[pilotBucket(Hashes[K], NumPilots)].push_back(K);
+    std::vector<uint32_t> BucketOrder(NumPilots);
+    for (uint32_t B = 0; B != NumPilots; ++B) BucketOrder[B] = B;
+    std::stable_sort(BucketOrder.begin(), BucketOrder.end(), [&](uint32_t A, uint32_t B) {
+        return Buckets[A].size() > Buckets[B].size();
+    });
+
+    Pilots.assign(NumPilots, 0);
+    SlotOf.assign(NumKeys, std::numeric_limits<uint32_t>::max());
+    std::vector<bool>     Taken(NumSlots, false);
+    std::vector<uint32_t> Placed;
+    for (uint32_t B : BucketOrder) {
+        const std::vector<uint32_t>& Bucket = Buckets[B];
+        if (Bucket.empty()) break;
+        for (size_t I = 1; I < Bucket.size(); ++I)
+            for (size_t J = 0; J != I; ++J)
+                if (Hashes[Bucket[I]] == Hashes[Bucket[J]]) return false;
+        for (uint32_t Pilot = 0;; ++Pilot) {
+            if (Pilot == MaxPilot) return false;
+            Placed.clear();
+            for (uint32_t K : Bucket) {
+                uint32_t S = pilotSlot(Hashes[K], Pilot, NumSlots);
+                if (Taken[S]) break;
+                Taken[S] = true;
+                Placed.push_back(S);
+            }
+            if (Placed.size() == Bucket.size()) {
+                Pilots[B] = Pilot;
+                for (size_t I = 0; I != Bucket.size(); ++I) SlotOf[Bucket[I]] = Placed[I];
+                break;
+            }
+            for (uint32_t S : Placed) Taken[S] = false;
+        }
+    }
+    return true;
+}
+
+uint64_t alignTo8(uint64_t N) { return (N + 7) & ~uint64_t(7); }
+
+// At least twice as many buckets as symbols, so probe sequences stay short.
+uint32_t bucketsFor(size_t NumSymbols) {
+    uint32_t N = 16;
+    while (N < 2 * NumSymbols) N *= 2;
+    return N;
+}
+
+// Add a section of Count elements at Offset to what Size bytes of data must
+// hold, after the sections ending at End.
+bool addSection(uint64_t Size, uint64_t& End, uint64_t Offset, uint64_t Count, uint64_t ElementSize) {
+    if (Offset < End || Offset % 8 != 0 || Offset > Size || (Size - Offset) / ElementSize < Count) return false;
+    End = Offset + Count * ElementSize;
+    return true;
+}
+
+bool writeFile(const char* Path, const std::vector<char>& Data) {
+    std::FILE* F = std::fopen(Path, "wb");
+    if (F == nullptr) return false;
+    bool Ok = std::fwrite(Data.data(), 1, Data.size(), F) == Data.size();
+    return std::fclose(F) == 0 && Ok;
+}
+
+uint8_t classify(bool Function, bool Data, bool Special, bool CtorOrDtor, bool Qualifiers) {
+    return (Function ? SF_Function : 0) | (Data ? SF_Data : 0) | (Special ? SF_SpecialName : 0)
+         | (CtorOrDtor ? SF_CtorOrDtor : 0) | (Qualifiers ? SF_FunctionQualifiers : 0);
+}
+} // namespace
+
+ms_demangle::CallingConv DemangleIndex::Symbol::getCallingConvention() const {
+    return static_cast<ms_demangle::CallingConv>(Record->CallingConvention);
+}
+
+ms_demangle::FuncClassValue DemangleIndex::Symbol::getFunctionClass() const {
+    return static_cast<ms_demangle::FuncClassValue>(Record->FunctionClass);
+}
+
+ms_demangle::StorageClass DemangleIndex::Symbol::getStorageClass() const {
+    return ms_demangle::StorageClass(Record->StorageClass);
+}
+
+bool DemangleIndex::Symbol::isDemangled() const { return Record->Flags & SF_Demangled; }
+bool DemangleIndex::Symbol::isFunction() const { return Record->Flags & SF_Function; }
+bool DemangleIndex::Symbol::isData() const { return Record->Flags & SF_Data; }
+bool DemangleIndex::Symbol::isSpecialName() const { return Record->Flags & SF_SpecialName; }
+bool DemangleIndex::Symbol::isCtorOrDtor() const { return Record->Flags & SF_CtorOrDtor; }
+bool DemangleIndex::Symbol::hasFunctionQualifiers() const { return Record->Flags & SF_FunctionQualifiers; }
+
+DemangleIndex::~DemangleIndex() { close(); }
+
+DemangleIndex::DemangleIndex(DemangleIndex&& Other) { *this = std::move(Other); }
+
+DemangleIndex& DemangleIndex::operator=(DemangleIndex&& Other) {
+    std::swap(Mapping, Other.Mapping);
+    std::swap(MappingSize, Other.MappingSize);
+    std::swap(Records, Other.Records);
+    std::swap(Buckets, Other.Buckets);
+    std::swap(Strings, Other.Strings);
+    std::swap(StringsSize, Other.StringsSize);
+    std::swap(NumSymbols, Other.NumSymbols);
+    std::swap(NumBuckets, Other.NumBuckets);
+    std::swap(Mapped, Other.Mapped);
+    return *this;
+}
+
+bool DemangleIndex::open(const char* Path, uint64_t Key) {
+    close();
+    const char* Data;
+    size_t      Size;
+    if (!mapFile(Path, Data, Size)) return false;
+    if (!load(std::span<const char>(Data, Size), Key)) {
+        unmapFile(Data, Size);
+        return false;
+    }
+    Mapping     = Data;
+    MappingSize = Size;
+    Mapped      = true;
+    return true;
+}
+
+bool DemangleIndex::load(std::span<const char> Data, uint64_t Key) {
+    close();
+    if (Data.size() < sizeof(IndexHeader) || reinterpret_cast<uintptr_t>(Data.data()) % 8 != 0) return false;
+
+    IndexHeader H;
+    std::memcpy(&H, Data.data(), sizeof(H));
+    if (std::memcmp(H.Magic, IndexMagic, sizeof(IndexMagic)) != 0 || H.Version != IndexVersion || H.Key != Key)
+        return false;
+
+    // Each section must lie inside the data, in order, and be aligned.
+    uint64_t End = sizeof(IndexHeader);
+    if (!addSection(Data.size(), End, H.RecordsOffset, H.NumSymbols, sizeof(IndexSymbolRecord))
+        || !addSection(Data.size(), End, H.BucketsOffset, H.NumBuckets, sizeof(uint32_t))
+        || !addSection(Data.size(), End, H.StringsOffset, H.StringsSize, 1))
+        return false;
+    // find() relies on a power of two number of buckets with at least one free.
+    if (H.NumBuckets == 0 || (H.NumBuckets & (H.NumBuckets - 1)) != 0 || H.NumBuckets <= H.NumSymbols) return false;
+
+    Records     = reinterpret_cast<const IndexSymbolRecord*>(Data.data() + H.RecordsOffset);
+    Buckets     = reinterpret_cast<const uint32_t*>(Data.data() + H.BucketsOffset);
+    Strings     = Data.data() + H.StringsOffset;
+    StringsSize = H.StringsSize;
+    NumSymbols  = H.NumSymbols;
+    NumBuckets  = H.NumBuckets;
+    return true;
+}
+
+void DemangleIndex::close() {
+    if (Mapped) unmapFile(Mapping, MappingSize);
+    Mapping     = nullptr;
+    MappingSize = 0;
+    Records     = nullptr;
+    Buckets     = nullptr;
+    Strings     = nullptr;
+    StringsSize = 0;
+    NumSymbols  = 0;
+    NumBuckets  = 0;
+    Mapped      = false;
+}
+
+// A damaged index yields empty strings rather than reads outside of it.
+std::string_view DemangleIndex::str(IndexStringRef Ref) const {
+    if (Ref.Offset > StringsSize || StringsSize - Ref.Offset < Ref.Size) return {};
+    return {Strings + Ref.Offset, Ref.Size};
+}
+
+DemangleIndex::Symbol DemangleIndex::find(std::string_view MangledName) const {
+    if (NumBuckets == 0) return {};
+    uint32_t Mask = NumBuckets - 1;
+    for (uint32_t I = static_cast<uint32_t>(hashString(MangledName)) & Mask, Probes = 0; Probes != NumBuckets;
+         I = (I + 1) & Mask, ++Probes) {
+        uint32_t Slot = Buckets[I];
+        if (Slot == 0) break;
+        if (Slot > NumSymbols) continue;
+        const IndexSymbolRecord* R = &Records[Slot - 1];
+        if (str(R->Mangled) == MangledName) return Symbol(R, this);
+    }
+    return {};
+}
+
+DemangleIndexBuilder::DemangleIndexBuilder() = default;
+
+DemangleIndexBuilder::~DemangleIndexBuilder() { std::free(Buf); }
+
+IndexStringRef DemangleIndexBuilder::addString(std::string_view S) {
+    if (S.empty()) return {0, 0};
+    auto It = Interned.find(std::string(S));
+    if (It != Interned.end()) return {It->second, static_cast<uint32_t>(S.size())};
+
+    if (Strings.size() + S.size() > std::numeric_limits<uint32_t>::max()) {
+        Overflow = true;
+        return {0, 0};
+    }
+    uint32_t Offset = static_cast<uint32_t>(Strings.size());
+    Strings.append(S);
+    Interned.emplace(S, Offset);
+    return {Offset, static_cast<uint32_t>(S.size())};
+}
+
+// Store Part, which is usually a substring of the demangled name, as a
+// reference into it, and intern it otherwise.
+IndexStringRef
+DemangleIndexBuilder::addPart(std::string_view Part, IndexStringRef Whole, std::string_view WholeText) {
+    if (Part.empty()) return {0, 0};
+    size_t Pos = WholeText.find(Part);
+    if (Pos == std::string_view::npos || Whole.Size != WholeText.size()) return addString(Part);
+    return {Whole.Offset + static_cast<uint32_t>(Pos), static_cast<uint32_t>(Part.size())};
+}
+
+void DemangleIndexBuilder::addItanium(IndexSymbolRecord& R) {
+    ItaniumNameComponents C;
+    char*                 Out = Itanium.finishDemangle(Buf, &BufSize, C);
+    if (Out == nullptr) return;
+    Buf = Out;
+
+    std::string_view Text(Buf);
+    R.Demangled = addString(Text);
+    R.Flags |= SF_Demangled
+             | classify(
+                   Itanium.isFunction(),
+                   Itanium.isData(),
+                   Itanium.isSpecialName(),
+                   Itanium.isCtorOrDtor(),
+                   Itanium.hasFunctionQualifiers()
+             );
+
+    // The parts are ranges of the demangled name, so they do not need strings
+    // of their own.
+    auto Slice = [&](ItaniumNameComponents::Range Range) -> IndexStringRef {
+        if (Range.empty() || R.Demangled.Size != Text.size()) return {0, 0};
+        return {R.Demangled.Offset + static_cast<uint32_t>(Range.Begin), static_cast<uint32_t>(Range.size())};
+    };
+    R.DeclContext = Slice(C.DeclContext);
+    R.BaseName    = Slice(C.BaseName);
+    R.Parameters  = Slice(C.Parameters);
+
+    ItaniumNameComponents::Range Name = C.BaseName;
+    if (!C.DeclContext.empty()) Name.Begin = C.DeclContext.Begin;
+    if (!C.TemplateArgs.empty()) Name.End = C.TemplateArgs.End;
+    if (!C.AbiTags.empty()) Name.End = C.AbiTags.End;
+    R.Name = Slice(Name);
+
+    // A return type with a suffix, such as the "int (*" and ")()" of a
+    // function returning a function pointer, is printed in two pieces.
+    if (C.ReturnTypeSuffix.empty()) {
+        R.ReturnType = Slice(C.ReturnType);
+    } else if (char* Ret = Itanium.getFunctionReturnType(Buf, &BufSize)) {
+        Buf          = Ret;
+        R.ReturnType = addString(Ret);
+    }
+}
+
+void DemangleIndexBuilder::addMicrosoft(IndexSymbolRecord& R) {
+    char* Out = Microsoft.finishDemangle(Buf, &BufSize);
+    if (Out == nullptr) return;
+    Buf = Out;
+
+    std::string Text(Buf);
+    R.Demangled = addString(Text);
+    R.Flags |= SF_Demangled
+             | classify(
+                   Microsoft.isFunction(),
+                   Microsoft.isData(),
+                   Microsoft.isSpecialName(),
+                   Microsoft.isCtorOrDtor(),
+                   Microsoft.hasFunctionQualifiers()
+             );
+    R.CallingConvention = static_cast<uint8_t>(Microsoft.getCallingConvention());
+    R.FunctionClass     = static_cast<uint16_t>(Microsoft.getFunctionClass());
+    R.StorageClass      = static_cast<uint8_t>(Microsoft.getStorageClass().val);
+
+    auto Part = [&](char* (MicrosoftPartialDemangler::*Print)(char*, size_t*) const) -> IndexStringRef {
+        char* P = (Microsoft.*Print)(Buf, &BufSize);
+        if (P == nullptr) return {0, 0};
+        Buf = P;
+        return addPart(P, R.Demangled, Text);
+    };
+    R.Name        = Part(&MicrosoftPartialDemangler::getName);
+    R.BaseName    = Part(&MicrosoftPartialDemangler::getBaseName);
+    R.DeclContext = Part(&MicrosoftPartialDemangler::getDeclContextName);
+    R.Parameters  = Part(&MicrosoftPartialDemangler::getFunctionParameters);
+    R.ReturnType  = Part(&MicrosoftPartialDemangler::getFunctionReturnType);
+}
+
+void DemangleIndexBuilder::add(std::string_view MangledName) {
+    IndexSymbolRecord R = {};
+    ManglingScheme    Scheme = detectManglingScheme(MangledName);
+    R.Mangled                = addString(MangledName);
+    R.Scheme                 = static_cast<uint8_t>(Scheme);
+
+    if (Scheme == ManglingScheme::Itanium && MangledName.front() == '_') {
+        // The Itanium parser wants a null-terminated name.
+        Name.assign(MangledName);
+        if (!Itanium.partialDemangle(Name.c_str())) addItanium(R);
+    } else if (Scheme == ManglingScheme::Microsoft) {
+        if (!Microsoft.partialDemangle(MangledName)) addMicrosoft(R);
+    }
+
+    // Everything else, and names the partial demanglers reject, get what
+    // demangle() makes of them.
+    if (!(R.Flags & SF_Demangled)) {
+        std::string Result;
+        if (demangle(MangledName, Result)) {
+            R.Flags     |= SF_Demangled;
+            R.Demangled  = addString(Result);
+        } else {
+            R.Demangled = R.Mangled;
+        }
+    }
+    Records.push_back(R);
+}
+
+bool DemangleIndexBuilder::serialize(uint64_t Key, std::vector<char>& Result) const {
+    if (Overflow || Records.size() >= std::numeric_limits<uint32_t>::max() / 2) return false;
+
+    IndexHeader H;
+    std::memcpy(H.Magic, IndexMagic, sizeof(IndexMagic));
+    H.Version       = IndexVersion;
+    H.Key           = Key;
+    H.NumSymbols    = static_cast<uint32_t>(Records.size());
+    H.NumBuckets    = bucketsFor(Records.size());
+    H.RecordsOffset = alignTo8(sizeof(IndexHeader));
+    H.BucketsOffset = alignTo8(H.RecordsOffset + Records.size() * sizeof(IndexSymbolRecord));
+    H.StringsOffset = alignTo8(H.BucketsOffset + uint64_t(H.NumBuckets) * sizeof(uint32_t));
+    H.StringsSize   = Strings.size();
+
+    // Later duplicates of a name are never reached, as the first one is found
+    // before them.
+    std::vector<uint32_t> Table(H.NumBuckets, 0);
+    uint32_t              Mask = H.NumBuckets - 1;
+    for (uint32_t S = 0; S != H.NumSymbols; ++S) {
+        const IndexStringRef& M = Records[S].Mangled;
+        uint32_t              I = static_cast<uint32_t>(hashString({Strings.data() + M.Offset, M.Size})) & Mask;
+        while (Table[I] != 0) I = (I + 1) & Mask;
+        Table[I] = S + 1;
+    }
+
+    Result.assign(H.StringsOffset + H.StringsSize, 0);
+    std::memcpy(Result.data(), &H, sizeof(H));
+    if (!Records.empty())
+        std::memcpy(Result.data() + H.RecordsOffset, Records.data(), Records.size() * sizeof(IndexSymbolRecord));
+    std::memcpy(Result.data() + H.BucketsOffset, Table.data(), Table.size() * sizeof(uint32_t));
+    if (!Strings.empty()) std::memcpy(Result.data() + H.StringsOffset, Strings.data(), Strings.size());
+    return true;
+}
+
+bool DemangleIndexBuilder::write(const char* Path, uint64_t Key) const {
+    std::vector<char> Data;
+    return serialize(Key, Data) && writeFile(Path, Data);
+}
+
+DemangleReverseIndex::~DemangleReverseIndex() { close(); }
+
+DemangleReverseIndex::DemangleReverseIndex(DemangleReverseIndex&& Other) { *this = std::move(Other); }
+
+DemangleReverseIndex& DemangleReverseIndex::operator=(DemangleReverseIndex&& Other) {
+    std::swap(Mapping, Other.Mapping);
+    std::swap(MappingSize, Other.MappingSize);
+    std::swap(Pilots, Other.Pilots);
+    std::swap(Slots, Other.Slots);
+    std::swap(Matches, Other.Matches);
+    std::swap(Symbols, Other.Symbols);
+    std::swap(Strings, Other.Strings);
+    std::swap(StringsSize, Other.StringsSize);
+    std::swap(Seed, Other.Seed);
+    std::swap(NumPilots, Other.NumPilots);
+    std::swap(NumKeys, Other.NumKeys);
+    std::swap(NumSlots, Other.NumSlots);
+    std::swap(NumMatches, Other.NumMatches);
+    std::swap(NumSymbols, Other.NumSymbols);
+    std::swap(Flags, Other.Flags);
+    std::swap(Mapped, Other.Mapped);
+    return *this;
+}
+
+bool DemangleReverseIndex::open(const char* Path, uint64_t Key) {
+    close();
+    const char* Data;
+    size_t      Size;
+    if (!mapFile(Path, Data, Size)) return false;
+    if (!load(std::span<const char>(Data, Size), Key)) {
+        unmapFile(Data, Size);
+        return false;
+    }
+    Mapping     = Data;
+    MappingSize = Size;
+    Mapped      = true;
+    return true;
+}
+
+bool DemangleReverseIndex::load(std::span<const char> Data, uint64_t Key) {
+    close();
+    if (Data.size() < sizeof(ReverseIndexHeader) || reinterpret_cast<uintptr_t>(Data.data()) % 8 != 0) return false;
+
+    ReverseIndexHeader H;
+    std::memcpy(&H, Data.data(), sizeof(H));
+    if (std::memcmp(H.Magic, ReverseIndexMagic, sizeof(ReverseIndexMagic)) != 0 || H.Version != IndexVersion
+        || H.Key != Key)
+        return false;
+
+    uint64_t End = sizeof(ReverseIndexHeader);
+    if (!addSection(Data.size(), End, H.PilotsOffset, H.NumPilots, sizeof(uint32_t))
+        || !addSection(Data.size(), End, H.SlotsOffset, H.NumSlots, sizeof(ReverseIndexSlot))
+        || !addSection(Data.size(), End, H.MatchesOffset, H.NumMatches, sizeof(uint32_t))
+        || !addSection(Data.size(), End, H.SymbolsOffset, H.NumSymbols, sizeof(IndexStringRef))
+        || !addSection(Data.size(), End, H.StringsOffset, H.StringsSize, 1))
+        return false;
+    // find() needs a bucket and a slot for every key.
+    if (H.NumKeys != 0 && (H.NumPilots == 0 || H.NumSlots < H.NumKeys)) return false;
+
+    Pilots      = reinterpret_cast<const uint32_t*>(Data.data() + H.PilotsOffset);
+    Slots       = reinterpret_cast<const ReverseIndexSlot*>(Data.data() + H.SlotsOffset);
+    Matches     = reinterpret_cast<const uint32_t*>(Data.data() + H.MatchesOffset);
+    Symbols     = reinterpret_cast<const IndexStringRef*>(Data.data() + H.SymbolsOffset);
+    Strings     = Data.data() + H.StringsOffset;
+    StringsSize = H.StringsSize;
+    Seed        = H.Seed;
+    NumPilots   = H.NumPilots;
+    NumKeys     = H.NumKeys;
+    NumSlots    = H.NumSlots;
+    NumMatches  = H.NumMatches;
+    NumSymbols  = H.NumSymbols;
+    Flags       = MSDemangleFlags(H.Flags);
+    return true;
+}
+
+void DemangleReverseIndex::close() {
+    if (Mapped) unmapFile(Mapping, MappingSize);
+    Mapping     = nullptr;
+    MappingSize = 0;
+    Pilots      = nullptr;
+    Slots       = nullptr;
+    Matches     = nullptr;
+    Symbols     = nullptr;
+    Strings     = nullptr;
+    StringsSize = 0;
+    Seed        = 0;
+    NumPilots   = 0;
+    NumKeys     = 0;
+    NumSlots    = 0;
+    NumMatches  = 0;
+    NumSymbols  = 0;
+    Flags       = MSDF_None;
+    Mapped      = false;
+}
+
+std::string_view DemangleReverseIndex::str(IndexStringRef Ref) const {
+    if (Ref.Offset > StringsSize || StringsSize - Ref.Offset < Ref.Size) return {};
+    return {Strings + Ref.Offset, Ref.Size};
+}
+
+std::span<const uint32_t> DemangleReverseIndex::find(std::string_view DemangledName) const {
+    if (NumKeys == 0) return {};
+    uint64_t                Hash = hashString(DemangledName, Seed);
+    const ReverseIndexSlot& S    = Slots[pilotSlot(Hash, Pilots[pilotBucket(Hash, NumPilots)], NumSlots)];
+    if (str(S.Key) != DemangledName || S.FirstMatch > NumMatches || NumMatches - S.FirstMatch < S.NumMatches) return {};
+    return {Matches + S.FirstMatch, S.NumMatches};
+}
+
+std::string_view DemangleReverseIndex::getMangledName(uint32_t I) const {
+    return I < NumSymbols ? str(Symbols[I]) : std::string_view();
+}
+
+DemangleReverseIndexBuilder::DemangleReverseIndexBuilder(MSDemangleFlags Flags)
+// Dumping back references is a side effect, not part of the keys.
+: Flags(MSDemangleFlags(Flags & ~MSDF_DumpBackrefs)) {}
+
+void DemangleReverseIndexBuilder::add(std::string_view MangledName) {
+    Symbols.push_back({static_cast<uint32_t>(Strings.size()), static_cast<uint32_t>(MangledName.size())});
+    Strings.append(MangledName);
+}
+
+bool DemangleReverseIndexBuilder::serialize(uint64_t Key, std::vector<char>& Result, unsigned NumThreads) const {
+    if (Strings.size() > std::numeric_limits<uint32_t>::max()) return false;
+
+    std::vector<std::string_view> Names;
+    Names.reserve(Symbols.size());
+    for (const IndexStringRef& S : Symbols) Names.emplace_back(Strings.data() + S.Offset, S.Size);
+    // A Microsoft name with bytes after the symbol must not be keyed by the
+    // demangling of its prefix.
+    DemangleBatchResult Batch = demangleBatch(Names, NumThreads, Flags, false, {}, /*WholeNames=*/true);
+
+    // Group the symbols by key. The sort is stable, so each key lists its
+    // symbols in the order they were added.
+    std::vector<uint32_t> Order;
+    for (uint32_t I = 0; I != Symbols.size(); ++I)
+        if (Batch.Entries[I].Demangled) Order.push_back(I);
+    std::stable_sort(Order.begin(), Order.end(), [&](uint32_t A, uint32_t B) { return Batch[A] < Batch[B]; });
+
+    std::string                   AllStrings = Strings;
+    std::vector<ReverseIndexSlot> Keys;
+    for (size_t I = 0; I != Order.size();) {
+        std::string_view Name = Batch[Order[I]];
+        size_t           J    = I + 1;
+        while (J != Order.size() && Batch[Order[J]] == Name) ++J;
+        if (AllStrings.size() + Name.size() > std::numeric_limits<uint32_t>::max()) return false;
+        Keys.push_back({{static_cast<uint32_t>(AllStrings.size()), static_cast<uint32_t>(Name.size())},
+                        static_cast<uint32_t>(I),
+                        static_cast<uint32_t>(J - I)});
+        AllStrings.append(Name);
+        I = J;
+    }
+
+    if (Keys.size() > std::numeric_limits<uint32_t>::max() / 9 * 8) return false;
+    uint32_t              NumKeys   = static_cast<uint32_t>(Keys.size());
+    uint32_t              NumSlots  = NumKeys + NumKeys / 8 + 1;
+    uint32_t              NumPilots = std::max<uint32_t>(1, (NumKeys + 3) / 4);
+    uint64_t              Seed      = 0;
+    std::vector<uint64_t> Hashes(NumKeys);
+    std::vector<uint32_t> Pilots;
+    std::vector<uint32_t> SlotOf;
+    for (;; ++Seed) {
+        if (Seed == MaxSeeds) return false;
+        for (uint32_t K = 0; K != NumKeys; ++K)
+            Hashes[K] = hashString({AllStrings.data() + Keys[K].Key.Offset, Keys[K].Key.Size}, Seed);
+        if (placeKeys(Hashes, NumSlots, NumPilots, Pilots, SlotOf)) break;
+    }
+
+    std::vector<ReverseIndexSlot> Table(NumSlots);
+    for (uint32_t K = 0; K != NumKeys; ++K) Table[SlotOf[K]] = Keys[K];
+
+    ReverseIndexHeader H;
+    std::memcpy(H.Magic, ReverseIndexMagic, sizeof(ReverseIndexMagic));
+    H.Version       = IndexVersion;
+    H.Key           = Key;
+    H.Seed          = Seed;
+    H.Flags         = static_cast<uint32_t>(Flags);
+    H.NumSymbols    = static_cast<uint32_t>(Symbols.size());
+    H.NumKeys       = NumKeys;
+    H.NumSlots      = NumSlots;
+    H.NumPilots     = NumPilots;
+    H.NumMatches    = static_cast<uint32_t>(Order.size());
+    H.PilotsOffset  = alignTo8(sizeof(ReverseIndexHeader));
+    H.SlotsOffset   = alignTo8(H.PilotsOffset + uint64_t(NumPilots) * sizeof(uint32_t));
+    H.MatchesOffset = alignTo8(H.SlotsOffset + uint64_t(NumSlots) * sizeof(ReverseIndexSlot));
+    H.SymbolsOffset = alignTo8(H.MatchesOffset + Order.size() * sizeof(uint32_t));
+    H.StringsOffset = alignTo8(H.SymbolsOffset + Symbols.size() * sizeof(IndexStringRef));
+    H.StringsSize   = AllStrings.size();
+
+    auto Copy = [&](uint64_t Offset, const void* Data, size_t Size) {
+        if (Size != 0) std::memcpy(Result.data() + Offset, Data, Size);
+    };
+    Result.assign(H.StringsOffset + H.StringsSize, 0);
+    Copy(0, &H, sizeof(H));
+    Copy(H.PilotsOffset, Pilots.data(), Pilots.size() * sizeof(uint32_t));
+    Copy(H.SlotsOffset, Table.data(), Table.size() * sizeof(ReverseIndexSlot));
+    Copy(H.MatchesOffset, Order.data(), Order.size() * sizeof(uint32_t));
+    Copy(H.SymbolsOffset, Symbols.data(), Symbols.size() * sizeof(IndexStringRef));
+    Copy(H.StringsOffset, AllStrings.data(), AllStrings.size());
+    return true;
+}
+
+bool DemangleReverseIndexBuilder::write(const char* Path, uint64_t Key, unsigned NumThreads) const {
+    std::vector<char> Data;
+    return serialize(Key, Data, NumThreads) && writeFile(Path, Data);
+}
@@ -0,0 +1,47 @@
+//===--- DemangleProfile.cpp ----------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "demangler/DemangleProfile.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+using namespace demangler;
+
+const char* demangler::getDemangleProductionName(DemangleProduction P) {
+    static constexpr const char* Names[] = {
+#define PRODUCTION(Id, Function) Function,
+#include "demangler/DemangleProductions.def"
+#undef PRODUCTION
+    };
+    return Names[static_cast<size_t>(P)];
+}
+
+void demangler::dumpDemangleProfile(const DemangleProfile& Profile, std::FILE* Out) {
+    size_t Order[NumDemangleProductions];
+    size_t NumSeen = 0;
+    for (size_t I = 0; I != NumDemangleProductions; ++I)
+        if (Profile.Productions[I].Calls != 0) Order[NumSeen++] = I;
+    std::stable_sort(Order, Order + NumSeen, [&](size_t A, size_t B) {
+        return Profile.Productions[A].Ticks > Profile.Productions[B].Ticks;
+    });
+
+    std::fprintf(Out, "%-64s %12s %16s %12s %9s\n", "production", "calls", "ticks", "ticks/call", "max depth");
+    for (size_t I = 0; I != NumSeen; ++I) {
+        const DemangleProductionProfile& P = Profile.Productions[Order[I]];
+        std::fprintf(
+            Out,
+            "%-64s %12" PRIu64 " %16" PRIu64 " %12.1f %9" PRIu64 "\n",
+            getDemangleProductionName(static_cast<DemangleProduction>(Order[I])),
+            P.Calls,
+            P.Ticks,
+            static_cast<double>(P.Ticks) / static_cast<double>(P.Calls),
+            P.MaxDepth
+        );
+    }
+}
@@ -0,0 +1,118 @@
+//===--- DemangleSink.cpp -------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "demangler/DemangleSink.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace demangler;
+
+// XXH64, as specified at https://github.com/Cyan4973/xxHash.
+static constexpr uint64_t Prime1 = 11400714785074694791ull;
+static constexpr uint64_t Prime2 = 14029467366897019727ull;
+static constexpr uint64_t Prime3 = 1609587929392839161ull;
+static constexpr uint64_t Prime4 = 9650029242287828579ull;
+static constexpr uint64_t Prime5 = 2870177450012600261ull;
+
+static uint64_t rotl(uint64_t X, unsigned R) { return (X << R) | (X >> (64 - R)); }
+
+// Little-endian loads, whatever the host's byte order.
+static uint64_t read64(const unsigned char* P) {
+    uint64_t V = 0;
+    for (unsigned I = 0; I != 8; ++I) V |= uint64_t(P[I]) << (8 * I);
+    return V;
+}
+
+static uint64_t read32(const unsigned char* P) {
+    uint64_t V = 0;
+    for (unsigned I = 0; I != 4; ++I) V |= uint64_t(P[I]) << (8 * I);
+    return V;
+}
+
+static uint64_t round(uint64_t Acc, uint64_t Input) { return rotl(Acc + Input * Prime2, 31) * Prime1; }
+
+static uint64_t mergeRound(uint64_t Acc, uint64_t Val) { return (Acc ^ round(0, Val)) * Prime1 + Prime4; }
+
+void HashingSink::reset(uint64_t NewSeed) {
+    Seed        = NewSeed;
+    Acc[0]      = Seed + Prime1 + Prime2;
+    Acc[1]      = Seed + Prime2;
+    Acc[2]      = Seed;
+    Acc[3]      = Seed - Prime1;
+    Total       = 0;
+    PendingSize = 0;
+}
+
+void HashingSink::write(std::string_view S) {
+    const unsigned char* P  = reinterpret_cast<const unsigned char*>(S.data());
+    size_t               N  = S.size();
+    Total                  += N;
+
+    if (PendingSize) {
+        size_t Take = std::min(N, sizeof(Pending) - PendingSize);
+        std::memcpy(Pending + PendingSize, P, Take);
+        PendingSize += Take;
+        P           += Take;
+        N           -= Take;
+        if (PendingSize != sizeof(Pending)) return;
+        for (unsigned I = 0; I != 4; ++I) Acc[I] = round(Acc[I], read64(Pending + 8 * I));
+        PendingSize = 0;
+    }
+
+    for (; N >= 32; P += 32, N -= 32)
+        for (unsigned I = 0; I != 4; ++I) Acc[I] = round(Acc[I], read64(P + 8 * I));
+
+    if (N) std::memcpy(Pending, P, N);
+    PendingSize = N;
+}
+
+uint64_t HashingSink::hash() const {
+    uint64_t H;
+    if (Total >= 32) {
+        H = rotl(Acc[0], 1) + rotl(Acc[1], 7) + rotl(Acc[2], 12) + rotl(Acc[3], 18);
+        for (unsigned I = 0; I != 4; ++I) H = mergeRound(H, Acc[I]);
+    } else {
+        H = Seed + Prime5;
+    }
+    H += Total;
+
+    const unsigned char* P = Pending;
+    size_t               N = PendingSize;
+    for (; N >= 8; P += 8, N -= 8) H = rotl(H ^ round(0, read64(P)), 27) * Prime1 + Prime4;
+    if (N >= 4) {
+        H  = rotl(H ^ (read32(P) * Prime1), 23) * Prime2 + Prime3;
+        P += 4;
+        N -= 4;
+    }
+    for (; N; ++P, --N) H = rotl(H ^ (*P * Prime5), 11) * Prime1;
+
+    H ^= H >> 33;
+    H *= Prime2;
+    H ^= H >> 29;
+    H *= Prime3;
+    H ^= H >> 32;
+    return H;
+}
+
+void FixedBufferSink::write(std::string_view S) {
+    if (S.empty()) return;
+    if (Spilled) {
+        Spill += S;
+        return;
+    }
+    if (S.size() <= Buf.size() - Size) {
+        std::memcpy(Buf.data() + Size, S.data(), S.size());
+        Size += S.size();
+        return;
+    }
+    Spill.reserve(Size + S.size());
+    Spill.assign(Buf.data(), Size);
+    Spill   += S;
+    Spilled  = true;
+}
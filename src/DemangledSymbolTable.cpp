@@ -0,0 +1,327 @@
+//===--- DemangledSymbolTable.cpp -----------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "demangler/DemangledSymbolTable.h"
+
+#include "demangler/DemangleHash.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace demangler;
+using demangler::detail::hashString;
+
+namespace {
+uint64_t hashScope(uint32_t Parent, uint32_t Name) {
+    uint64_t H  = (uint64_t(Parent) << 32 | Name) * 0x9e3779b97f4a7c15ull;
+    H          ^= H >> 29;
+    return H;
+}
+
+// Double Table, an open-addressed table of one plus an index, when it is half
+// full, rehashing its entries with Hash.
+template <typename HashFn>
+void reserveSlot(std::vector<uint32_t>& Table, size_t Size, HashFn Hash) {
+    if (2 * (Size + 1) <= Table.size()) return;
+    std::vector<uint32_t> Old = std::move(Table);
+    Table.assign(Old.empty() ? 64 : 2 * Old.size(), 0);
+    size_t Mask = Table.size() - 1;
+    for (uint32_t Slot : Old) {
+        if (Slot == 0) continue;
+        size_t I = Hash(Slot - 1) & Mask;
+        while (Table[I] != 0) I = (I + 1) & Mask;
+        Table[I] = Slot;
+    }
+}
+
+// Copy S to Buf at Pos, as far as Buf holds it with a null terminator.
+void put(std::span<char> Buf, size_t Pos, std::string_view S) {
+    if (Buf.empty() || Pos >= Buf.size() - 1) return;
+    std::memcpy(Buf.data() + Pos, S.data(), std::min(S.size(), Buf.size() - 1 - Pos));
+}
+
+// If Rest starts with Scope and "::", drop them from it.
+bool consumeScope(std::string_view& Rest, std::string_view Scope) {
+    if (Rest.size() < Scope.size() + 2 || !Rest.starts_with(Scope) || Rest.substr(Scope.size(), 2) != "::")
+        return false;
+    Rest.remove_prefix(Scope.size() + 2);
+    return true;
+}
+} // namespace
+
+DemangledSymbolTable::DemangledSymbolTable() {
+    // String 0 is the empty string and scope 0 the global scope.
+    Offsets = {0, 0};
+    Scopes.push_back({None, 0, None, None, None, None, None});
+}
+
+DemangledSymbolTable::~DemangledSymbolTable() { std::free(Buf); }
+
+uint32_t DemangledSymbolTable::findString(std::string_view S) const {
+    if (S.empty()) return 0;
+    if (StringTable.empty()) return None;
+    size_t Mask = StringTable.size() - 1;
+    for (size_t I = hashString(S) & Mask; StringTable[I] != 0; I = (I + 1) & Mask)
+        if (str(StringTable[I] - 1) == S) return StringTable[I] - 1;
+    return None;
+}
+
+uint32_t DemangledSymbolTable::intern(std::string_view S) {
+    uint32_t Id = findString(S);
+    if (Id != None) return Id;
+
+    reserveSlot(StringTable, Offsets.size() - 1, [&](uint32_t I) { return hashString(str(I)); });
+    Id = static_cast<uint32_t>(Offsets.size() - 1);
+    Chars.append(S);
+    Offsets.push_back(static_cast<uint32_t>(Chars.size()));
+
+    size_t Mask = StringTable.size() - 1;
+    size_t I    = hashString(S) & Mask;
+    while (StringTable[I] != 0) I = (I + 1) & Mask;
+    StringTable[I] = Id + 1;
+    return Id;
+}
+
+DemangledSymbolTable::ScopeId DemangledSymbolTable::findChild(ScopeId Parent, uint32_t Name) const {
+    if (ScopeTable.empty()) return NoScope;
+    size_t Mask = ScopeTable.size() - 1;
+    for (size_t I = hashScope(Parent, Name) & Mask; ScopeTable[I] != 0; I = (I + 1) & Mask) {
+        const ScopeNode& S = Scopes[ScopeTable[I] - 1];
+        if (S.Parent == Parent && S.Name == Name) return ScopeTable[I] - 1;
+    }
+    return NoScope;
+}
+
+DemangledSymbolTable::ScopeId DemangledSymbolTable::addScope(ScopeId Parent, uint32_t Name) {
+    ScopeId Id = findChild(Parent, Name);
+    if (Id != NoScope) return Id;
+
+    reserveSlot(ScopeTable, Scopes.size(), [&](uint32_t I) { return hashScope(Scopes[I].Parent, Scopes[I].Name); });
+    Id = static_cast<ScopeId>(Scopes.size());
+    Scopes.push_back({Parent, Name, None, None, None, None, None});
+
+    ScopeNode& P = Scopes[Parent];
+    if (P.LastChild == None) P.FirstChild = Id;
+    else Scopes[P.LastChild].NextSibling = Id;
+    P.LastChild = Id;
+
+    size_t Mask = ScopeTable.size() - 1;
+    size_t I    = hashScope(Parent, Name) & Mask;
+    while (ScopeTable[I] != 0) I = (I + 1) & Mask;
+    ScopeTable[I] = Id + 1;
+    return Id;
+}
+
+// Move the scopes D reports from the start of Leaf to Path. Fails, leaving
+// Path empty, unless Leaf starts with all of them, each followed by "::".
+template <typename Demangler>
+bool DemangledSymbolTable::addScopes(const Demangler& D, std::string_view& Leaf) {
+    std::string_view Rest = Leaf;
+    for (size_t I = 0, N = D.getNumScopes(); I != N; ++I) {
+        char* Scope = D.getScope(I, Buf, &BufSize);
+        if (Scope != nullptr) Buf = Scope;
+        if (Scope == nullptr || !consumeScope(Rest, Scope)) {
+            Path.clear();
+            return false;
+        }
+        Path.push_back(intern(Scope));
+    }
+    Leaf = Rest;
+    return true;
+}
+
+// Name is the part of Text that the scopes in Path and Leaf were split from,
+// or empty if Text was not split up.
+void DemangledSymbolTable::addSymbol(
+    SymbolRecord&    R,
+    std::string_view Text,
+    std::string_view Name,
+    std::string_view Leaf
+) {
+    if (Name.empty()) {
+        R.Prefix = intern(Text);
+        return;
+    }
+    size_t Begin = Name.data() - Text.data();
+    R.Prefix     = intern(Text.substr(0, Begin));
+    R.Name       = intern(Leaf);
+    R.Suffix     = intern(Text.substr(Begin + Name.size()));
+    for (uint32_t Component : Path) R.Scope = addScope(R.Scope, Component);
+}
+
+bool DemangledSymbolTable::addItanium(SymbolRecord& R) {
+    ItaniumNameComponents C;
+    char*                 Out = Itanium.finishDemangle(Buf, &BufSize, C);
+    if (Out == nullptr) return false;
+    Buf = Out;
+    Text.assign(Buf);
+
+    // Special names such as "vtable for a::b" have no components. They are
+    // split where the scopes of what they are for start, and the rest of
+    // the text is the name.
+    if (C.BaseName.empty()) {
+        std::string_view Name;
+        if (Itanium.getNumScopes() != 0) {
+            if (char* First = Itanium.getScope(0, Buf, &BufSize)) {
+                Buf        = First;
+                size_t Pos = Text.find(First);
+                if (Pos != std::string::npos) Name = std::string_view(Text).substr(Pos);
+            }
+        }
+        std::string_view Leaf = Name;
+        if (!Name.empty() && !addScopes(Itanium, Leaf)) Name = {};
+        addSymbol(R, Text, Name, Leaf);
+        return true;
+    }
+    ItaniumNameComponents::Range Range = C.BaseName;
+    if (!C.DeclContext.empty()) Range.Begin = C.DeclContext.Begin;
+    if (!C.TemplateArgs.empty()) Range.End = C.TemplateArgs.End;
+    if (!C.AbiTags.empty()) Range.End = C.AbiTags.End;
+    std::string_view Name = std::string_view(Text).substr(Range.Begin, Range.size());
+
+    // If the scopes do not spell out the declaration context, as for names
+    // in unusual contexts, the whole context is one scope.
+    std::string_view Leaf        = Name;
+    std::string_view DeclContext = std::string_view(Text).substr(C.DeclContext.Begin, C.DeclContext.size());
+    size_t           Joined      = DeclContext.empty() ? 0 : DeclContext.size() + 2;
+    if (!addScopes(Itanium, Leaf) || Leaf.size() + Joined != Name.size()) {
+        Path.clear();
+        Leaf = Name;
+        if (!DeclContext.empty() && consumeScope(Leaf, DeclContext)) Path.push_back(intern(DeclContext));
+    }
+    addSymbol(R, Text, Name, Leaf);
+    return true;
+}
+
+bool DemangledSymbolTable::addMicrosoft(SymbolRecord& R) {
+    char* Out = Microsoft.finishDemangle(Buf, &BufSize);
+    if (Out == nullptr) return false;
+    Buf = Out;
+    Text.assign(Buf);
+
+    // The qualified name is printed once in the demangled name, or several
+    // times in the same form if it also names a parameter type, so the first
+    // occurrence is as good as any.
+    size_t Begin = std::string_view::npos;
+    size_t Size  = 0;
+    if (char* QN = Microsoft.getName(Buf, &BufSize)) {
+        Buf   = QN;
+        Size  = std::strlen(QN);
+        Begin = Size == 0 ? std::string_view::npos : Text.find(QN, 0, Size);
+    }
+    if (Begin == std::string_view::npos) {
+        addSymbol(R, Text, {}, {});
+        return true;
+    }
+    std::string_view Name = std::string_view(Text).substr(Begin, Size);
+
+    std::string_view Leaf = Name;
+    if (!addScopes(Microsoft, Leaf)) Leaf = Name;
+    addSymbol(R, Text, Name, Leaf);
+    return true;
+}
+
+uint32_t DemangledSymbolTable::add(std::string_view MangledName) {
+    ManglingScheme Scheme = detectManglingScheme(MangledName);
+    SymbolRecord   R      = {GlobalScope, 0, 0, 0, None, static_cast<uint8_t>(Scheme), false};
+    Path.clear();
+
+    bool Split = false;
+    if (Scheme == ManglingScheme::Itanium && MangledName.front() == '_') {
+        // The Itanium parser wants a null-terminated name.
+        Name.assign(MangledName);
+        Split = !Itanium.partialDemangle(Name.c_str()) && addItanium(R);
+    } else if (Scheme == ManglingScheme::Microsoft) {
+        Split = !Microsoft.partialDemangle(MangledName) && addMicrosoft(R);
+    }
+
+    // Everything else, and names the partial demanglers reject, are kept
+    // whole as what demangle() makes of them.
+    if (Split) {
+        R.Demangled = true;
+    } else {
+        Text.clear();
+        R.Demangled = demangle(MangledName, Text);
+        R.Prefix    = intern(Text);
+    }
+
+    uint32_t Id = static_cast<uint32_t>(Symbols.size());
+    ScopeNode& S = Scopes[R.Scope];
+    if (S.LastSymbol == None) S.FirstSymbol = Id;
+    else Symbols[S.LastSymbol].NextInScope = Id;
+    S.LastSymbol = Id;
+    Symbols.push_back(R);
+    return Id;
+}
+
+DemangleBufferResult DemangledSymbolTable::getDemangledName(size_t I, std::span<char> Buf) const {
+    const SymbolRecord& R = Symbols[I];
+
+    // The scopes are linked from the innermost out, so they are written from
+    // the end of the path backwards.
+    size_t PathSize = 0;
+    for (ScopeId S = R.Scope; S != GlobalScope; S = Scopes[S].Parent) PathSize += str(Scopes[S].Name).size() + 2;
+
+    std::string_view Prefix = str(R.Prefix);
+    std::string_view Leaf   = str(R.Name);
+    std::string_view Suffix = str(R.Suffix);
+    size_t           End    = Prefix.size() + PathSize;
+    put(Buf, 0, Prefix);
+    for (ScopeId S = R.Scope; S != GlobalScope; S = Scopes[S].Parent) {
+        std::string_view Component  = str(Scopes[S].Name);
+        End                        -= Component.size() + 2;
+        put(Buf, End, Component);
+        put(Buf, End + Component.size(), "::");
+    }
+    put(Buf, Prefix.size() + PathSize, Leaf);
+    put(Buf, Prefix.size() + PathSize + Leaf.size(), Suffix);
+
+    DemangleBufferResult Result;
+    Result.Size      = Prefix.size() + PathSize + Leaf.size() + Suffix.size();
+    Result.Demangled = R.Demangled;
+    Result.Truncated = Result.Size >= Buf.size();
+    if (!Buf.empty()) Buf[Result.Truncated ? Buf.size() - 1 : Result.Size] = '\0';
+    return Result;
+}
+
+std::string DemangledSymbolTable::getDemangledName(size_t I) const {
+    std::string Result;
+    Result.resize(getDemangledName(I, std::span<char>()).Size);
+    getDemangledName(I, std::span<char>(Result.data(), Result.size() + 1));
+    return Result;
+}
+
+DemangledSymbolTable::ScopeId DemangledSymbolTable::findScope(ScopeId Parent, std::string_view Component) const {
+    if (Parent >= Scopes.size()) return NoScope;
+    uint32_t Name = findString(Component);
+    return Name == None ? NoScope : findChild(Parent, Name);
+}
+
+DemangledSymbolTable::ScopeId DemangledSymbolTable::findScope(std::string_view Path) const {
+    ScopeId Scope = GlobalScope;
+    int     Depth = 0;
+    size_t  Begin = 0;
+    for (size_t I = 0; I != Path.size() && Scope != NoScope; ++I) {
+        char C = Path[I];
+        if (C == '<' || C == '(' || C == '[') ++Depth;
+        else if (C == '>' || C == ')' || C == ']') --Depth;
+        else if (Depth == 0 && C == ':' && Path.substr(I, 2) == "::") {
+            Scope = findScope(Scope, Path.substr(Begin, I - Begin));
+            Begin = ++I + 1;
+        }
+    }
+    if (Scope == NoScope || Begin == Path.size()) return Scope;
+    return findScope(Scope, Path.substr(Begin));
+}
+
+size_t DemangledSymbolTable::memoryUsage() const {
+    return Chars.capacity() + Offsets.capacity() * sizeof(uint32_t) + StringTable.capacity() * sizeof(uint32_t)
+         + Scopes.capacity() * sizeof(ScopeNode) + ScopeTable.capacity() * sizeof(uint32_t)
+         + Symbols.capacity() * sizeof(SymbolRecord);
+}
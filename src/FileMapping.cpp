@@ -0,0 +1,63 @@
+//===--- FileMapping.cpp --------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "demangler/FileMapping.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace demangler;
+
+bool detail::mapFile(const char* Path, const char*& Data, size_t& Size) {
+#ifdef _WIN32
+    HANDLE File = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr);
+    if (File == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER FileSize;
+    if (!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart == 0) {
+        CloseHandle(File);
+        return false;
+    }
+    HANDLE Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(File);
+    if (Mapping == nullptr) return false;
+    Data = static_cast<const char*>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+    CloseHandle(Mapping);
+    if (Data == nullptr) return false;
+    Size = static_cast<size_t>(FileSize.QuadPart);
+    return true;
+#else
+    int FD = open(Path, O_RDONLY);
+    if (FD < 0) return false;
+    struct stat St;
+    if (fstat(FD, &St) != 0 || St.st_size == 0) {
+        close(FD);
+        return false;
+    }
+    void* Map = mmap(nullptr, St.st_size, PROT_READ, MAP_PRIVATE, FD, 0);
+    close(FD);
+    if (Map == MAP_FAILED) return false;
+    Data = static_cast<const char*>(Map);
+    Size = static_cast<size_t>(St.st_size);
+    return true;
+#endif
+}
+
+void detail::unmapFile(const char* Data, size_t Size) {
+#ifdef _WIN32
+    (void)Size;
+    UnmapViewOfFile(Data);
+#else
+    munmap(const_cast<char*>(Data), Size);
+#endif
+}
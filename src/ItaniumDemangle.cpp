@@ -12,7 +12,9 @@
 
 #include "demangler/ItaniumDemangle.h"
 #include "demangler/Demangle.h"
+#include "demangler/ItaniumAllocator.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cctype>
 #include <cstdio>
@@ -20,7 +22,9 @@
 #include <cstring>
 #include <exception>
 #include <functional>
+#include <string>
 #include <utility>
+#include <vector>
 
 using namespace demangler;
 using namespace demangler::itanium_demangle;
@@ -29,30 +33,6 @@ constexpr const char* itanium_demangle::FloatData<float>::spec;
 constexpr const char* itanium_demangle::FloatData<double>::spec;
 constexpr const char* itanium_demangle::FloatData<long double>::spec;
 
-// <discriminator> := _ <non-negative number>      # when number < 10
-//                 := __ <non-negative number> _   # when number >= 10
-//  extension      := decimal-digit+               # at the end of string
-const char* itanium_demangle::parse_discriminator(const char* first, const char* last) {
-    // parse but ignore discriminator
-    if (first != last) {
-        if (*first == '_') {
-            const char* t1 = first + 1;
-            if (t1 != last) {
-                if (std::isdigit(*t1)) first = t1 + 1;
-                else if (*t1 == '_') {
-                    for (++t1; t1 != last && std::isdigit(*t1); ++t1);
-                    if (t1 != last && *t1 == '_') first = t1 + 1;
-                }
-            }
-        } else if (std::isdigit(*first)) {
-            const char* t1 = first + 1;
-            for (; t1 != last && std::isdigit(*t1); ++t1);
-            if (t1 == last) first = last;
-        }
-    }
-    return first;
-}
-
 #ifndef NDEBUG
 namespace {
 struct DumpVisitor {
@@ -261,9 +241,9 @@ struct DumpVisitor {
         Depth += 2;
         fprintf(stderr, "ForwardTemplateReference(");
         if (Node->Ref && !Node->Printing) {
-            Node->Printing = true;
+            Node->printing() = true;
             CtorArgPrinter{*this}(Node->Ref);
-            Node->Printing = false;
+            Node->printing() = false;
         } else {
             CtorArgPrinter{*this}(Node->Index);
         }
@@ -280,93 +260,464 @@ void itanium_demangle::Node::dump() const {
 }
 #endif
 
-namespace {
-class BumpPointerAllocator {
-    struct BlockMeta {
-        BlockMeta* Next;
-        size_t     Current;
-    };
+//===----------------------------------------------------------------------===//
+// Code beyond this point should not be synchronized with libc++abi.
+//===----------------------------------------------------------------------===//
 
-    static constexpr size_t AllocSize       = 4096;
-    static constexpr size_t UsableAllocSize = AllocSize - sizeof(BlockMeta);
+using Demangler = itanium_demangle::ManglingParser<DefaultAllocator<>>;
 
-    alignas(long double) char InitialBuffer[AllocSize];
-    BlockMeta* BlockList = nullptr;
+char* demangler::itaniumDemangle(std::string_view MangledName, bool ParseParams) {
+    return itaniumDemangle(MangledName, DemangleLimits(), nullptr, ParseParams);
+}
 
-    void grow() {
-        char* NewMeta = static_cast<char*>(std::malloc(AllocSize));
-        if (NewMeta == nullptr) std::terminate();
-        BlockList = new (NewMeta) BlockMeta{BlockList, 0};
-    }
+bool demangler::itaniumDemangle(std::string_view MangledName, OutputBuffer& OB, bool ParseParams) {
+    return itaniumDemangle(MangledName, OB, DemangleLimits(), nullptr, ParseParams);
+}
 
-    void* allocateMassive(size_t NBytes) {
-        NBytes             += sizeof(BlockMeta);
-        BlockMeta* NewMeta  = reinterpret_cast<BlockMeta*>(std::malloc(NBytes));
-        if (NewMeta == nullptr) std::terminate();
-        BlockList->Next = new (NewMeta) BlockMeta{BlockList->Next, 0};
-        return static_cast<void*>(NewMeta + 1);
+char* demangler::itaniumDemangle(
+    std::string_view      MangledName,
+    const DemangleLimits& Limits,
+    int*                  Status,
+    bool                  ParseParams
+) {
+    OutputBuffer OB;
+    if (!itaniumDemangle(MangledName, OB, Limits, Status, ParseParams)) {
+        // A name that reached MaxOutputSize was printed and then rewound.
+        std::free(OB.getBuffer());
+        return nullptr;
     }
 
-public:
-    BumpPointerAllocator() : BlockList(new(InitialBuffer) BlockMeta{nullptr, 0}) {}
+    OB += '\0';
+    return OB.getBuffer();
+}
+
+// The demangle_ status of a parse by Parser that returned AST.
+template <typename ParserT>
+static int getParseStatus(const ParserT& Parser, const Node* AST) {
+    if (Parser.Limits.Exceeded) return demangle_limit_exceeded;
+    return AST ? demangle_success : demangle_invalid_mangled_name;
+}
+
+// Call Print, which prints into OB, within MaxOutputSize. Returns the
+// demangle_ status.
+template <typename PrintFn>
+static int printStatus(OutputBuffer& OB, size_t MaxOutputSize, PrintFn&& Print) {
+    return detail::printWithinLimit(OB, MaxOutputSize, Print) ? demangle_success : demangle_limit_exceeded;
+}
 
-    void* allocate(size_t N) {
-        N = (N + 15u) & ~15u;
-        if (N + BlockList->Current >= UsableAllocSize) {
-            if (N > UsableAllocSize) return allocateMassive(N);
-            grow();
+bool demangler::itaniumDemangle(
+    std::string_view      MangledName,
+    OutputBuffer&         OB,
+    const DemangleLimits& Limits,
+    int*                  Status,
+    bool                  ParseParams
+) {
+    int InternalStatus = demangle_invalid_mangled_name;
+    if (!MangledName.empty()) {
+        DEMANGLE_STATS_CALL(OB);
+
+        Demangler Parser(MangledName.data(), MangledName.data() + MangledName.length());
+        Parser.Limits.setLimits(Limits);
+        Node* AST      = Parser.parse(ParseParams);
+        InternalStatus = getParseStatus(Parser, AST);
+        if (InternalStatus == demangle_success) {
+            assert(Parser.ForwardTemplateRefs.empty());
+            InternalStatus = printStatus(OB, Limits.MaxOutputSize, [&] { AST->print(OB); });
         }
-        BlockList->Current += N;
-        return static_cast<void*>(reinterpret_cast<char*>(BlockList + 1) + BlockList->Current - N);
     }
 
-    void reset() {
-        while (BlockList) {
-            BlockMeta* Tmp = BlockList;
-            BlockList      = BlockList->Next;
-            if (reinterpret_cast<char*>(Tmp) != InitialBuffer) std::free(Tmp);
+    if (Status) *Status = InternalStatus;
+    return InternalStatus == demangle_success;
+}
+
+namespace {
+// Prints a node exactly like Node::print while recording where the parts of
+// the outermost function or variable name went. Only the name nodes that
+// ItaniumPartialDemangler looks through are taken apart; everything nested
+// in them prints as usual.
+class ComponentPrinter {
+    using Range = ItaniumNameComponents::Range;
+
+    OutputBuffer&          OB;
+    ItaniumNameComponents& Components;
+
+    // Print N into R.
+    void printInto(const Node* N, Range& R) {
+        R.Begin = OB.getCurrentPosition();
+        N->print(OB);
+        R.End = OB.getCurrentPosition();
+    }
+
+    // Extend R to cover [Begin, OB's position).
+    void extend(Range& R, size_t Begin) {
+        if (R.empty()) R.Begin = Begin;
+        R.End = OB.getCurrentPosition();
+    }
+
+    // Print a name node. Like Node::print if Left is false, otherwise like
+    // Node::printLeft, which is all AbiTagAttr prints of its base.
+    void printName(const Node* Name, bool Left) {
+        switch (Name->getKind()) {
+        case Node::KAbiTagAttr: {
+            auto* ATA = static_cast<const AbiTagAttr*>(Name);
+            printName(ATA->Base, /*Left=*/true);
+            size_t Begin  = OB.getCurrentPosition();
+            OB           += "[abi:";
+            OB           += ATA->Tag;
+            OB           += "]";
+            extend(Components.AbiTags, Begin);
+            return;
+        }
+        case Node::KNameWithTemplateArgs: {
+            auto* NTA = static_cast<const NameWithTemplateArgs*>(Name);
+            printName(NTA->Name, /*Left=*/false);
+            printInto(NTA->TemplateArgs, Components.TemplateArgs);
+            return;
+        }
+        case Node::KNestedName: {
+            auto*  NN    = static_cast<const NestedName*>(Name);
+            size_t Begin = OB.getCurrentPosition();
+            NN->Qual->print(OB);
+            extend(Components.DeclContext, Begin);
+            OB += "::";
+            printName(NN->Name, /*Left=*/false);
+            return;
+        }
+        case Node::KLocalName: {
+            auto*  LN    = static_cast<const LocalName*>(Name);
+            size_t Begin = OB.getCurrentPosition();
+            LN->Encoding->print(OB);
+            extend(Components.DeclContext, Begin);
+            OB += "::";
+            printName(LN->Entity, /*Left=*/false);
+            return;
+        }
+        case Node::KModuleEntity: {
+            auto* ME = static_cast<const ModuleEntity*>(Name);
+            printName(ME->Name, /*Left=*/false);
+            OB += '@';
+            ME->Module->print(OB);
+            return;
+        }
+        default:
+            Components.BaseName.Begin = OB.getCurrentPosition();
+            if (Left) Name->printLeft(OB);
+            else Name->print(OB);
+            Components.BaseName.End = OB.getCurrentPosition();
+            return;
         }
-        BlockList = new (InitialBuffer) BlockMeta{nullptr, 0};
     }
 
-    ~BumpPointerAllocator() { reset(); }
-};
+    // FunctionEncoding::printLeft and printRight, split up.
+    void printFunction(const FunctionEncoding* FE) {
+        const Node* Ret = FE->getReturnType();
+        if (Ret) {
+            Components.ReturnType.Begin = OB.getCurrentPosition();
+            Ret->printLeft(OB);
+            Components.ReturnType.End = OB.getCurrentPosition();
+            if (!Ret->hasRHSComponent(OB)) OB += " ";
+        }
+        printName(FE->getName(), /*Left=*/false);
+
+        Components.Parameters.Begin = OB.getCurrentPosition();
+        OB.printOpen();
+        FE->getParams().printWithComma(OB);
+        OB.printClose();
+        Components.Parameters.End = OB.getCurrentPosition();
+
+        if (Ret) {
+            Components.ReturnTypeSuffix.Begin = OB.getCurrentPosition();
+            Ret->printRight(OB);
+            Components.ReturnTypeSuffix.End = OB.getCurrentPosition();
+        }
 
-class DefaultAllocator {
-    BumpPointerAllocator Alloc;
+        // The qualifiers start with a space that is not part of them.
+        size_t          Begin   = OB.getCurrentPosition() + 1;
+        Qualifiers      CVQuals = FE->getCVQuals();
+        FunctionRefQual RefQual = FE->getRefQual();
+        if (CVQuals & QualConst) OB += " const";
+        if (CVQuals & QualVolatile) OB += " volatile";
+        if (CVQuals & QualRestrict) OB += " restrict";
+        if (RefQual == FrefQualLValue) OB += " &";
+        else if (RefQual == FrefQualRValue) OB += " &&";
+        if (OB.getCurrentPosition() >= Begin) extend(Components.Qualifiers, Begin);
+
+        if (const Node* Attrs = FE->getAttrs()) Attrs->print(OB);
+        if (const Node* Requires = FE->getRequires()) {
+            OB += " requires ";
+            Requires->print(OB);
+        }
+    }
 
 public:
-    void reset() { Alloc.reset(); }
+    ComponentPrinter(OutputBuffer& OB, ItaniumNameComponents& Components) : OB(OB), Components(Components) {}
 
-    template <typename T, typename... Args>
-    T* makeNode(Args&&... args) {
-        return new (Alloc.allocate(sizeof(T))) T(std::forward<Args>(args)...);
+    void print(const Node* Root) {
+        Components = ItaniumNameComponents();
+        switch (Root->getKind()) {
+        case Node::KFunctionEncoding:
+            printFunction(static_cast<const FunctionEncoding*>(Root));
+            return;
+        case Node::KDotSuffix:
+            // A clone such as "f() (.cold)" has the parts of what it clones.
+            static_cast<const DotSuffix*>(Root)->match([&](const Node* Prefix, std::string_view Suffix) {
+                print(Prefix);
+                OB += " (";
+                OB += Suffix;
+                OB += ")";
+            });
+            return;
+        case Node::KSpecialName:
+        case Node::KCtorVtableSpecialName:
+            Root->print(OB);
+            return;
+        default:
+            printName(Root, /*Left=*/false);
+            return;
+        }
     }
+};
+} // namespace
 
-    void* allocateNodeArray(size_t sz) { return Alloc.allocate(sizeof(Node*) * sz); }
+namespace {
+// The parser of an ItaniumDemangleSession. With SharePrefixes set it parses a
+// copy of each name, Input, and records checkpoints in the first <nested-name>
+// of the symbol after each component of its <prefix>. The next name resumes
+// from the last checkpoint within the prefix it shares with Input, instead of
+// parsing those components again. The nodes before the checkpoint stay in the
+// arena, and their strings in the part of Input that is not overwritten.
+//
+// Parsing the same bytes from the same state always gives the same result, so
+// a checkpoint is only taken where everything the rest of the parse depends
+// on is in it: Names is empty, and the only template parameters in scope are
+// the <template-args> of the last component.
+struct SessionDemangler : AbstractManglingParser<SessionDemangler, DefaultAllocator<>> {
+    using AbstractManglingParser::AbstractManglingParser;
+
+    struct Checkpoint {
+        // Where parsing resumes. The parser has looked at the byte there, so
+        // the next name has to share it too.
+        const char*                   Position;
+        Node*                         SoFar;
+        size_t                        NumSubs;
+        NameState                     State;
+        DefaultAllocator<>::Watermark Mark;
+        // OuterTemplateParams, in CheckpointTemplateArgs, and whether they
+        // were in scope.
+        size_t TemplateArgsBegin;
+        size_t NumTemplateArgs;
+        bool   TemplateArgsInScope;
+    };
+
+    bool SharePrefixes = false;
+    // DemangleLimits::MaxOutputSize; the other limits are in Limits.
+    size_t MaxOutputSize = 0;
+    // The demangle_ status of the last name.
+    int Status = demangle_success;
+
+    std::string             Input;
+    std::vector<Checkpoint> Checkpoints;
+    // Subs at the last checkpoint. Earlier ones have a prefix of it.
+    std::vector<Node*> CheckpointSubs;
+    std::vector<Node*> CheckpointTemplateArgs;
+    // Where the <prefix> of the checkpoints begins.
+    const char* PrefixBegin = nullptr;
+    // The checkpoint that start() picked for this name.
+    const Checkpoint* ResumeFrom = nullptr;
+    // Whether this name has reached its first <nested-name>.
+    bool EnteredNestedName = false;
+
+    // Prepare to parse MangledName.
+    void start(std::string_view MangledName);
+
+    void enterNestedName(const char* Begin, NameState* State, Node*& SoFar);
+    void leaveNestedNamePrefix(const char* Begin, NameState* State, Node* SoFar);
 };
-} // unnamed namespace
+} // namespace
 
-//===----------------------------------------------------------------------===//
-// Code beyond this point should not be synchronized with libc++abi.
-//===----------------------------------------------------------------------===//
+void SessionDemangler::start(std::string_view MangledName) {
+    EnteredNestedName = false;
+    ResumeFrom        = nullptr;
+    if (!SharePrefixes) {
+        reset(MangledName.data(), MangledName.data() + MangledName.size());
+        return;
+    }
 
-using Demangler = itanium_demangle::ManglingParser<DefaultAllocator>;
+    size_t Shared = common_prefix(Input, MangledName);
+    // Input cannot be reallocated without invalidating the nodes.
+    if (MangledName.size() <= Input.capacity()) {
+        for (size_t I = Checkpoints.size(); I-- != 0 && !ResumeFrom;)
+            if (static_cast<size_t>(Checkpoints[I].Position - Input.data()) < Shared) ResumeFrom = &Checkpoints[I];
+    }
 
-char* demangler::itaniumDemangle(std::string_view MangledName, bool ParseParams) {
-    if (MangledName.empty()) return nullptr;
+    if (ResumeFrom) {
+        // The nodes of the later checkpoints are about to be released.
+        Checkpoints.erase(Checkpoints.begin() + (ResumeFrom - Checkpoints.data() + 1), Checkpoints.end());
+        CheckpointSubs.resize(ResumeFrom->NumSubs);
+        CheckpointTemplateArgs.resize(ResumeFrom->TemplateArgsBegin + ResumeFrom->NumTemplateArgs);
+        Input.resize(Shared);
+        Input.append(MangledName.substr(Shared));
+        ASTAllocator.rewind(ResumeFrom->Mark);
+        restart(Input.data(), Input.data() + Input.size());
+    } else {
+        Checkpoints.clear();
+        CheckpointSubs.clear();
+        CheckpointTemplateArgs.clear();
+        PrefixBegin = nullptr;
+        if (MangledName.size() > Input.capacity()) Input.reserve(std::max<size_t>(256, 2 * MangledName.size()));
+        Input = MangledName;
+        reset(Input.data(), Input.data() + Input.size());
+    }
+}
 
-    Demangler Parser(MangledName.data(), MangledName.data() + MangledName.length());
-    Node*     AST = Parser.parse(ParseParams);
-    if (!AST) return nullptr;
+void SessionDemangler::enterNestedName(const char* Begin, NameState* State, Node*& SoFar) {
+    if (!SharePrefixes) return;
+    if (EnteredNestedName) {
+        // The <prefix> is parsed again after backtracking, and Subs may no
+        // longer extend CheckpointSubs.
+        if (Begin == PrefixBegin) {
+            Checkpoints.clear();
+            CheckpointSubs.clear();
+            CheckpointTemplateArgs.clear();
+            PrefixBegin = nullptr;
+            ResumeFrom  = nullptr;
+        }
+        return;
+    }
+    if (!State || !Names.empty() || !Subs.empty() || !hasDefaultTemplateState()) return;
+    EnteredNestedName = true;
+
+    if (ResumeFrom && Begin == PrefixBegin) {
+        First = ResumeFrom->Position;
+        SoFar = ResumeFrom->SoFar;
+        for (Node* Sub : CheckpointSubs) Subs.push_back(Sub);
+        *State = ResumeFrom->State;
+        for (size_t I = 0; I != ResumeFrom->NumTemplateArgs; ++I)
+            OuterTemplateParams.push_back(CheckpointTemplateArgs[ResumeFrom->TemplateArgsBegin + I]);
+        if (ResumeFrom->TemplateArgsInScope) TemplateParams.push_back(&OuterTemplateParams);
+        return;
+    }
+
+    Checkpoints.clear();
+    CheckpointSubs.clear();
+    CheckpointTemplateArgs.clear();
+    PrefixBegin = Begin;
+}
+
+void SessionDemangler::leaveNestedNamePrefix(const char* Begin, NameState* State, Node* SoFar) {
+    if (!EnteredNestedName || Begin != PrefixBegin || !Names.empty() || !hasDefaultTemplateMode()) return;
+    // What parseTemplateArgs leaves in scope after the <template-args> of a
+    // component, if anything.
+    bool TemplateArgsInScope = !TemplateParams.empty();
+    if (TemplateArgsInScope && (TemplateParams.size() != 1 || TemplateParams[0] != &OuterTemplateParams)) return;
+
+    // Each component only adds to Subs, so CheckpointSubs just catches up.
+    assert(CheckpointSubs.size() <= Subs.size());
+    CheckpointSubs.insert(CheckpointSubs.end(), Subs.begin() + CheckpointSubs.size(), Subs.end());
+    size_t TemplateArgsBegin = CheckpointTemplateArgs.size();
+    CheckpointTemplateArgs.insert(CheckpointTemplateArgs.end(), OuterTemplateParams.begin(), OuterTemplateParams.end());
+    Checkpoints.push_back(
+        {First,
+         SoFar,
+         Subs.size(),
+         *State,
+         ASTAllocator.watermark(),
+         TemplateArgsBegin,
+         OuterTemplateParams.size(),
+         TemplateArgsInScope}
+    );
+}
+
+ItaniumDemangleSession::ItaniumDemangleSession(size_t RetainedBytes)
+: Context(new SessionDemangler{nullptr, nullptr}) {
+    setRetainedBytes(RetainedBytes);
+}
+
+ItaniumDemangleSession::~ItaniumDemangleSession() { delete static_cast<SessionDemangler*>(Context); }
+
+ItaniumDemangleSession::ItaniumDemangleSession(ItaniumDemangleSession&& Other) : ItaniumDemangleSession() {
+    std::swap(Context, Other.Context);
+}
+
+ItaniumDemangleSession& ItaniumDemangleSession::operator=(ItaniumDemangleSession&& Other) {
+    std::swap(Context, Other.Context);
+    return *this;
+}
+
+void ItaniumDemangleSession::setRetainedBytes(size_t Bytes) {
+    static_cast<SessionDemangler*>(Context)->ASTAllocator.setRetainedBytes(Bytes);
+}
+
+void ItaniumDemangleSession::setLimits(const DemangleLimits& Limits) {
+    SessionDemangler* Parser = static_cast<SessionDemangler*>(Context);
+    Parser->Limits.setLimits(Limits);
+    Parser->MaxOutputSize = Limits.MaxOutputSize;
+}
+
+int ItaniumDemangleSession::getStatus() const { return static_cast<const SessionDemangler*>(Context)->Status; }
+
+void ItaniumDemangleSession::setSharePrefixes(bool Enable) {
+    SessionDemangler* Parser = static_cast<SessionDemangler*>(Context);
+    Parser->SharePrefixes    = Enable;
+    reset();
+}
+
+void ItaniumDemangleSession::reset() {
+    SessionDemangler* Parser = static_cast<SessionDemangler*>(Context);
+    Parser->reset(nullptr, nullptr);
+    Parser->Input.clear();
+    Parser->Checkpoints.clear();
+    Parser->CheckpointSubs.clear();
+    Parser->CheckpointTemplateArgs.clear();
+    Parser->PrefixBegin = nullptr;
+}
+
+char* ItaniumDemangleSession::demangle(std::string_view MangledName, char* Buf, size_t* N, bool ParseParams) {
+    OutputBuffer OB(Buf, N);
+    if (!demangle(MangledName, OB, ParseParams)) return nullptr;
 
-    OutputBuffer OB;
-    assert(Parser.ForwardTemplateRefs.empty());
-    AST->print(OB);
     OB += '\0';
+    if (N != nullptr) *N = OB.getBufferCapacity();
     return OB.getBuffer();
 }
 
+bool ItaniumDemangleSession::demangle(std::string_view MangledName, OutputBuffer& OB, bool ParseParams) {
+    SessionDemangler* Parser = static_cast<SessionDemangler*>(Context);
+    Parser->Status           = demangle_invalid_mangled_name;
+    if (MangledName.empty()) return false;
+    DEMANGLE_STATS_CALL(OB);
+
+    Parser->start(MangledName);
+    Node* AST      = Parser->parse(ParseParams);
+    Parser->Status = getParseStatus(*Parser, AST);
+    if (Parser->Status != demangle_success) return false;
+
+    assert(Parser->ForwardTemplateRefs.empty());
+    Parser->Status = printStatus(OB, Parser->MaxOutputSize, [&] { AST->print(OB); });
+    return Parser->Status == demangle_success;
+}
+
+bool ItaniumDemangleSession::demangle(
+    std::string_view       MangledName,
+    OutputBuffer&          OB,
+    ItaniumNameComponents& Components,
+    bool                   ParseParams
+) {
+    SessionDemangler* Parser = static_cast<SessionDemangler*>(Context);
+    Parser->Status           = demangle_invalid_mangled_name;
+    if (MangledName.empty()) return false;
+    DEMANGLE_STATS_CALL(OB);
+
+    Parser->start(MangledName);
+    Node* AST      = Parser->parse(ParseParams);
+    Parser->Status = getParseStatus(*Parser, AST);
+    if (Parser->Status != demangle_success) return false;
+
+    assert(Parser->ForwardTemplateRefs.empty());
+    Parser->Status = printStatus(OB, Parser->MaxOutputSize, [&] { ComponentPrinter(OB, Components).print(AST); });
+    return Parser->Status == demangle_success;
+}
+
 ItaniumPartialDemangler::ItaniumPartialDemangler() : RootNode(nullptr), Context(new Demangler{nullptr, nullptr}) {}
 
 ItaniumPartialDemangler::~ItaniumPartialDemangler() { delete static_cast<Demangler*>(Context); }
@@ -389,9 +740,14 @@ bool ItaniumPartialDemangler::partialDemangle(const char* MangledName) {
     size_t     Len    = std::strlen(MangledName);
     Parser->reset(MangledName, MangledName + Len);
     RootNode = Parser->parse();
+    if (Parser->Limits.Exceeded) RootNode = nullptr;
     return RootNode == nullptr;
 }
 
+void ItaniumPartialDemangler::setLimits(const DemangleLimits& Limits) {
+    static_cast<Demangler*>(Context)->Limits.setLimits(Limits);
+}
+
 static char* printNode(const Node* RootNode, char* Buf, size_t* N) {
     OutputBuffer OB(Buf, N);
     RootNode->print(OB);
@@ -468,6 +824,140 @@ KeepGoingLocalFunction:
     return OB.getBuffer();
 }
 
+// The name of the function or variable Root declares, or of the entity a
+// special name such as "vtable for a::b" is for. CtorVtableSpecialName is for
+// two types, so it has none.
+static const Node* getEntityName(const Node* Root) {
+    switch (Root->getKind()) {
+    case Node::KFunctionEncoding:
+        return static_cast<const FunctionEncoding*>(Root)->getName();
+    case Node::KDotSuffix: {
+        const Node* Name = nullptr;
+        static_cast<const DotSuffix*>(Root)->match([&](const Node* Prefix, std::string_view) {
+            Name = getEntityName(Prefix);
+        });
+        return Name;
+    }
+    case Node::KSpecialName: {
+        const Node* Name = nullptr;
+        static_cast<const SpecialName*>(Root)->match([&](std::string_view, const Node* Child) {
+            Name = getEntityName(Child);
+        });
+        return Name;
+    }
+    case Node::KCtorVtableSpecialName:
+        return nullptr;
+    default:
+        return Root;
+    }
+}
+
+// The scope the abbreviations such as "Sa" for std::allocator are in.
+static const NameType StdScope("std");
+
+// Append the scopes Name is nested in to Scopes, outermost first. The
+// function a local name is nested in is a single scope.
+static void collectScopes(const Node* Name, PODSmallVector<const Node*, 8>& Scopes) {
+    switch (Name->getKind()) {
+    case Node::KSpecialSubstitution:
+    case Node::KExpandedSpecialSubstitution:
+        Scopes.push_back(&StdScope);
+        return;
+    case Node::KAbiTagAttr:
+        collectScopes(static_cast<const AbiTagAttr*>(Name)->Base, Scopes);
+        return;
+    case Node::KNameWithTemplateArgs:
+        collectScopes(static_cast<const NameWithTemplateArgs*>(Name)->Name, Scopes);
+        return;
+    case Node::KModuleEntity:
+        collectScopes(static_cast<const ModuleEntity*>(Name)->Name, Scopes);
+        return;
+    case Node::KNestedName: {
+        const Node* Qual = static_cast<const NestedName*>(Name)->Qual;
+        collectScopes(Qual, Scopes);
+        Scopes.push_back(Qual);
+        return;
+    }
+    case Node::KLocalName: {
+        auto* LN = static_cast<const LocalName*>(Name);
+        Scopes.push_back(LN->Encoding);
+        collectScopes(LN->Entity, Scopes);
+        return;
+    }
+    default:
+        return;
+    }
+}
+
+// Print a scope that collectScopes found without the scopes it is nested in.
+static void printScope(const Node* Scope, OutputBuffer& OB) {
+    switch (Scope->getKind()) {
+    case Node::KAbiTagAttr: {
+        auto* ATA = static_cast<const AbiTagAttr*>(Scope);
+        printScope(ATA->Base, OB);
+        OB += "[abi:";
+        OB += ATA->Tag;
+        OB += "]";
+        return;
+    }
+    case Node::KNameWithTemplateArgs: {
+        auto* NTA = static_cast<const NameWithTemplateArgs*>(Scope);
+        printScope(NTA->Name, OB);
+        NTA->TemplateArgs->print(OB);
+        return;
+    }
+    case Node::KModuleEntity: {
+        auto* ME = static_cast<const ModuleEntity*>(Scope);
+        printScope(ME->Name, OB);
+        OB += '@';
+        ME->Module->print(OB);
+        return;
+    }
+    case Node::KNestedName:
+        static_cast<const NestedName*>(Scope)->Name->print(OB);
+        return;
+    case Node::KLocalName:
+        printScope(static_cast<const LocalName*>(Scope)->Entity, OB);
+        return;
+    case Node::KSpecialSubstitution:
+    case Node::KExpandedSpecialSubstitution: {
+        // These print as "std::" and the name, of which StdScope is the first
+        // part.
+        size_t Begin = OB.getCurrentPosition();
+        Scope->print(OB);
+        size_t Size = OB.getCurrentPosition() - Begin - 5;
+        std::memmove(OB.getBuffer() + Begin, OB.getBuffer() + Begin + 5, Size);
+        OB.setCurrentPosition(Begin + Size);
+        return;
+    }
+    default:
+        Scope->print(OB);
+        return;
+    }
+}
+
+size_t ItaniumPartialDemangler::getNumScopes() const {
+    assert(RootNode != nullptr && "must call partialDemangle()");
+    const Node* Name = getEntityName(static_cast<const Node*>(RootNode));
+    if (Name == nullptr) return 0;
+
+    PODSmallVector<const Node*, 8> Scopes;
+    collectScopes(Name, Scopes);
+    return Scopes.size();
+}
+
+char* ItaniumPartialDemangler::getScope(size_t Index, char* Buf, size_t* N) const {
+    assert(Index < getNumScopes() && "scope index out of range");
+    PODSmallVector<const Node*, 8> Scopes;
+    collectScopes(getEntityName(static_cast<const Node*>(RootNode)), Scopes);
+
+    OutputBuffer OB(Buf, N);
+    printScope(Scopes[Index], OB);
+    OB += '\0';
+    if (N != nullptr) *N = OB.getCurrentPosition();
+    return OB.getBuffer();
+}
+
 char* ItaniumPartialDemangler::getFunctionName(char* Buf, size_t* N) const {
     if (!isFunction()) return nullptr;
     auto* Name = static_cast<FunctionEncoding*>(RootNode)->getName();
@@ -505,6 +995,15 @@ char* ItaniumPartialDemangler::finishDemangle(char* Buf, size_t* N) const {
     return printNode(static_cast<Node*>(RootNode), Buf, N);
 }
 
+char* ItaniumPartialDemangler::finishDemangle(char* Buf, size_t* N, ItaniumNameComponents& Components) const {
+    assert(RootNode != nullptr && "must call partialDemangle()");
+    OutputBuffer OB(Buf, N);
+    ComponentPrinter(OB, Components).print(static_cast<Node*>(RootNode));
+    OB += '\0';
+    if (N != nullptr) *N = OB.getCurrentPosition();
+    return OB.getBuffer();
+}
+
 bool ItaniumPartialDemangler::hasFunctionQualifiers() const {
     assert(RootNode != nullptr && "must call partialDemangle()");
     if (!isFunction()) return false;
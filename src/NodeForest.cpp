@@ -0,0 +1,420 @@
+//===--- NodeForest.cpp ---------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "demangler/NodeForest.h"
+
+#include "demangler/MicrosoftDemangleNodes.h"
+
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <unordered_map>
+
+using namespace demangler;
+using namespace demangler::ms_demangle;
+using demangler::detail::InternTable;
+using demangler::detail::mixWord;
+using demangler::detail::NodeForestBase;
+using demangler::detail::NodeProfile;
+
+void InternTable::insert(uint64_t Hash, const void* Ptr) {
+    // Keep the table at most half full.
+    if (2 * (Count + 1) > Slots.size()) {
+        std::vector<Slot> Old(std::max<size_t>(64, 2 * Slots.size()), Slot{0, nullptr});
+        Old.swap(Slots);
+        size_t Mask = Slots.size() - 1;
+        for (const Slot& S : Old) {
+            if (!S.Ptr) continue;
+            size_t I = S.Hash & Mask;
+            while (Slots[I].Ptr) I = (I + 1) & Mask;
+            Slots[I] = S;
+        }
+    }
+    size_t Mask = Slots.size() - 1;
+    size_t I    = Hash & Mask;
+    while (Slots[I].Ptr) I = (I + 1) & Mask;
+    Slots[I] = Slot{Hash, Ptr};
+    ++Count;
+}
+
+void NodeProfile::add(std::string_view S) {
+    add(uint64_t(S.size()));
+    for (size_t I = 0; I < S.size(); I += 8) {
+        uint64_t W = 0;
+        std::memcpy(&W, S.data() + I, std::min<size_t>(8, S.size() - I));
+        add(W);
+    }
+}
+
+uint64_t NodeProfile::hash() const {
+    uint64_t H = Words.size();
+    for (uint64_t W : Words) H = mixWord(H, W);
+    return H;
+}
+
+NodeForestBase::NodeForestBase()  = default;
+NodeForestBase::~NodeForestBase() = default;
+
+void NodeForestBase::freeze() {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Frozen.store(true, std::memory_order_release);
+}
+
+NodeForestBase::Stats NodeForestBase::getStats() const {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Stats                       S;
+    S.Nodes = NumNodes;
+    S.Hits  = Hits.load(std::memory_order_relaxed);
+    S.Bytes = Bytes + Nodes.memoryUsage() + Arrays.memoryUsage() + Strings.memoryUsage();
+    return S;
+}
+
+void* NodeForestBase::allocate(size_t Size) {
+    Bytes += (Size + 15) & ~size_t(15);
+    return Arena.allocate(Size);
+}
+
+std::string_view NodeForestBase::internString(std::string_view S) {
+    if (S.empty()) return {};
+    uint64_t Hash = S.size();
+    for (char C : S) Hash = mixWord(Hash, static_cast<unsigned char>(C));
+
+    // A name is stored after its size.
+    auto Stored = [](const void* P) {
+        const char* Chars = static_cast<const char*>(P);
+        uint32_t    Size;
+        std::memcpy(&Size, Chars, sizeof(Size));
+        return std::string_view(Chars + sizeof(Size), Size);
+    };
+    if (const void* Found = Strings.find(Hash, [&](const void* P) { return Stored(P) == S; })) return Stored(Found);
+
+    size_t Need = sizeof(uint32_t) + S.size();
+    if (Need > CharsLeft) {
+        size_t BlockSize = std::max<size_t>(Need, 16 * 1024);
+        CharBlocks.push_back(std::make_unique<char[]>(BlockSize));
+        NextChar   = CharBlocks.back().get();
+        CharsLeft  = BlockSize;
+        Bytes     += BlockSize;
+    }
+    char*    Chars = NextChar;
+    uint32_t Size  = static_cast<uint32_t>(S.size());
+    std::memcpy(Chars, &Size, sizeof(Size));
+    std::memcpy(Chars + sizeof(Size), S.data(), S.size());
+    NextChar  += Need;
+    CharsLeft -= Need;
+    Strings.insert(Hash, Chars);
+    return Stored(Chars);
+}
+
+// The fields that make up each kind of Microsoft node. F is called with a
+// reference to each, including those of the base classes.
+template <typename Fn>
+static void fields(TypeNode& N, Fn& F) {
+    F(N.Quals);
+}
+
+template <typename Fn>
+static void fields(IdentifierNode& N, Fn& F) {
+    F(N.TemplateParams);
+}
+
+template <typename Fn>
+static void fields(SymbolNode& N, Fn& F) {
+    F(N.Name);
+}
+
+template <typename Fn>
+static void fields(PrimitiveTypeNode& N, Fn& F) {
+    fields(static_cast<TypeNode&>(N), F);
+    F(N.PrimKind);
+}
+
+template <typename Fn>
+static void fields(FunctionSignatureNode& N, Fn& F) {
+    fields(static_cast<TypeNode&>(N), F);
+    F(N.Affinity);
+    F(N.CallConvention);
+    F(N.FunctionClass);
+    F(N.RefQualifier);
+    F(N.ReturnType);
+    F(N.IsVariadic);
+    F(N.Params);
+    F(N.IsNoexcept);
+}
+
+template <typename Fn>
+static void fields(ThunkSignatureNode& N, Fn& F) {
+    fields(static_cast<FunctionSignatureNode&>(N), F);
+    F(N.ThisAdjust);
+}
+
+template <typename Fn>
+static void fields(VcallThunkIdentifierNode& N, Fn& F) {
+    fields(static_cast<IdentifierNode&>(N), F);
+    F(N.OffsetInVTable);
+}
+
+template <typename Fn>
+static void fields(DynamicStructorIdentifierNode& N, Fn& F) {
+    fields(static_cast<IdentifierNode&>(N), F);
+    F(N.Variable);
+    F(N.Name);
+    F(N.IsDestructor);
+}
+
+template <typename Fn>
+static void fields(NamedIdentifierNode& N, Fn& F) {
+    fields(static_cast<IdentifierNode&>(N), F);
+    F(N.Name);
+}
+
+template <typename Fn>
+static void fields(IntrinsicFunctionIdentifierNode& N, Fn& F) {
+    fields(static_cast<IdentifierNode&>(N), F);
+    F(N.Operator);
+}
+
+template <typename Fn>
+static void fields(LiteralOperatorIdentifierNode& N, Fn& F) {
+    fields(static_cast<IdentifierNode&>(N), F);
+    F(N.Name);
+}
+
+template <typename Fn>
+static void fields(LocalStaticGuardIdentifierNode& N, Fn& F) {
+    fields(static_cast<IdentifierNode&>(N), F);
+    F(N.IsThread);
+    F(N.ScopeIndex);
+}
+
+template <typename Fn>
+static void fields(ConversionOperatorIdentifierNode& N, Fn& F) {
+    fields(static_cast<IdentifierNode&>(N), F);
+    F(N.TargetType);
+}
+
+template <typename Fn>
+static void fields(StructorIdentifierNode& N, Fn& F) {
+    fields(static_cast<IdentifierNode&>(N), F);
+    F(N.Class);
+    F(N.IsDestructor);
+}
+
+template <typename Fn>
+static void fields(PointerTypeNode& N, Fn& F) {
+    fields(static_cast<TypeNode&>(N), F);
+    F(N.Affinity);
+    F(N.ClassParent);
+    F(N.Pointee);
+}
+
+template <typename Fn>
+static void fields(TagTypeNode& N, Fn& F) {
+    fields(static_cast<TypeNode&>(N), F);
+    F(N.QualifiedName);
+    F(N.Tag);
+}
+
+template <typename Fn>
+static void fields(ArrayTypeNode& N, Fn& F) {
+    fields(static_cast<TypeNode&>(N), F);
+    F(N.Dimensions);
+    F(N.ElementType);
+}
+
+template <typename Fn>
+static void fields(CustomTypeNode& N, Fn& F) {
+    fields(static_cast<TypeNode&>(N), F);
+    F(N.Identifier);
+}
+
+// The elements are interned as an array, so the array is compared by
+// address.
+template <typename Fn>
+static void fields(NodeArrayNode& N, Fn& F) {
+    F(N.Nodes);
+    F(N.Count);
+}
+
+template <typename Fn>
+static void fields(QualifiedNameNode& N, Fn& F) {
+    F(N.Components);
+}
+
+template <typename Fn>
+static void fields(TemplateParameterReferenceNode& N, Fn& F) {
+    F(N.Symbol);
+    F(N.ThunkOffsetCount);
+    // Offsets past ThunkOffsetCount are not initialized.
+    std::span<int64_t> Offsets(N.ThunkOffsets.data(), static_cast<size_t>(N.ThunkOffsetCount));
+    F(Offsets);
+    F(N.Affinity);
+    F(N.IsMemberPointer);
+}
+
+template <typename Fn>
+static void fields(IntegerLiteralNode& N, Fn& F) {
+    F(N.Value);
+    F(N.IsNegative);
+}
+
+template <typename Fn>
+static void fields(RttiBaseClassDescriptorNode& N, Fn& F) {
+    fields(static_cast<IdentifierNode&>(N), F);
+    F(N.NVOffset);
+    F(N.VBPtrOffset);
+    F(N.VBTableOffset);
+    F(N.Flags);
+}
+
+template <typename Fn>
+static void fields(SpecialTableSymbolNode& N, Fn& F) {
+    fields(static_cast<SymbolNode&>(N), F);
+    F(N.TargetName);
+    F(N.Quals);
+}
+
+template <typename Fn>
+static void fields(LocalStaticGuardVariableNode& N, Fn& F) {
+    fields(static_cast<SymbolNode&>(N), F);
+    F(N.IsVisible);
+}
+
+template <typename Fn>
+static void fields(EncodedStringLiteralNode& N, Fn& F) {
+    fields(static_cast<SymbolNode&>(N), F);
+    F(N.DecodedString);
+    F(N.IsTruncated);
+    F(N.Char);
+}
+
+template <typename Fn>
+static void fields(VariableSymbolNode& N, Fn& F) {
+    fields(static_cast<SymbolNode&>(N), F);
+    F(N.SC);
+    F(N.Type);
+}
+
+template <typename Fn>
+static void fields(FunctionSymbolNode& N, Fn& F) {
+    fields(static_cast<SymbolNode&>(N), F);
+    F(N.Signature);
+}
+
+template <typename T>
+static void addField(NodeProfile& Profile, const T& Field) {
+    if constexpr (std::is_pointer_v<T>) {
+        Profile.add(static_cast<const void*>(Field));
+    } else if constexpr (std::is_same_v<T, std::string_view>) {
+        Profile.add(Field);
+    } else if constexpr (std::is_same_v<T, StorageClass> || std::is_same_v<T, FuncClass>) {
+        Profile.add(uint64_t(Field.val));
+    } else if constexpr (std::is_same_v<T, ThunkSignatureNode::ThisAdjustor>) {
+        Profile.add(uint64_t(Field.StaticOffset));
+        Profile.add(uint64_t(Field.VBPtrOffset));
+        Profile.add(uint64_t(Field.VBOffsetOffset));
+        Profile.add(uint64_t(Field.VtordispOffset));
+    } else if constexpr (std::is_same_v<T, std::span<int64_t>>) {
+        for (int64_t Offset : Field) Profile.add(uint64_t(Offset));
+    } else {
+        static_assert(std::is_integral_v<T> || std::is_enum_v<T>);
+        Profile.add(uint64_t(Field));
+    }
+}
+
+template <typename T>
+static void profile(NodeProfile& Profile, const T& N) {
+    Profile.clear();
+    Profile.add(uint64_t(N.kind()));
+    auto Add = [&](const auto& Field) { addField(Profile, Field); };
+    fields(const_cast<T&>(N), Add);
+}
+
+// The state of one intern() call. Nodes reachable along several paths of an
+// AST, as back references make them, are interned once.
+struct MicrosoftNodeForest::Interner {
+    MicrosoftNodeForest&                   Forest;
+    bool                                   CanAdd;
+    std::unordered_map<const Node*, Node*> Done;
+    NodeProfile                            Profile;
+    NodeProfile                            Other;
+
+    Interner(MicrosoftNodeForest& Forest, bool CanAdd) : Forest(Forest), CanAdd(CanAdd) {}
+
+    template <typename T>
+    T* intern(const T* N) {
+        if (!N) return nullptr;
+        auto It = Done.find(N);
+        if (It != Done.end()) return static_cast<T*>(It->second);
+
+        Node* Result = N->visit([&](const auto* X) -> Node* {
+            using NodeT = std::remove_cv_t<std::remove_pointer_t<decltype(X)>>;
+            // Kinds without a class of their own are never parsed.
+            if constexpr (std::is_same_v<NodeT, Node>) return nullptr;
+            else return internCopy(*X);
+        });
+        Done.emplace(N, Result);
+        return static_cast<T*>(Result);
+    }
+
+    // Intern a copy of N whose fields refer to the forest.
+    template <typename T>
+    Node* internCopy(const T& N) {
+        T    Copy   = N;
+        bool Failed = false;
+        auto Intern = [&](auto& Field) {
+            using FieldT = std::remove_reference_t<decltype(Field)>;
+            if constexpr (std::is_pointer_v<FieldT> && std::is_base_of_v<Node, std::remove_pointer_t<FieldT>>) {
+                if (!Field) return;
+                Field  = intern(Field);
+                Failed = Failed || !Field;
+            } else if constexpr (std::is_same_v<FieldT, std::string_view>) {
+                if (CanAdd) Field = Forest.internString(Field);
+            } else if constexpr (std::is_same_v<FieldT, StorageClass> || std::is_same_v<FieldT, FuncClass>) {
+                Field.pos = {};
+            }
+        };
+        if constexpr (std::is_same_v<T, NodeArrayNode>) {
+            std::vector<Node*> Interned(Copy.Count);
+            for (size_t I = 0; I != Copy.Count; ++I) {
+                Interned[I] = intern(Copy.Nodes[I]);
+                if (Copy.Nodes[I] && !Interned[I]) return nullptr;
+            }
+            Copy.Nodes = Forest.internArray(Interned.data(), Interned.size(), CanAdd);
+            if (Copy.Count && !Copy.Nodes) return nullptr;
+        } else {
+            fields(Copy, Intern);
+            if (Failed) return nullptr;
+        }
+
+        profile(Profile, Copy);
+        uint64_t Hash  = Profile.hash();
+        auto     Equal = [&](const void* P) {
+            const Node* Candidate = static_cast<const Node*>(P);
+            if (Candidate->kind() != Copy.kind()) return false;
+            profile(Other, *static_cast<const T*>(Candidate));
+            return Other == Profile;
+        };
+        if (const void* Found = Forest.Nodes.find(Hash, Equal)) {
+            Forest.Hits.fetch_add(1, std::memory_order_relaxed);
+            return static_cast<Node*>(const_cast<void*>(Found));
+        }
+        if (!CanAdd) return nullptr;
+
+        T* Stored = new (Forest.allocate(sizeof(T))) T(Copy);
+        Forest.Nodes.insert(Hash, Stored);
+        ++Forest.NumNodes;
+        return Stored;
+    }
+};
+
+SymbolNode* MicrosoftNodeForest::intern(const SymbolNode* AST) {
+    std::unique_lock<std::mutex> Lock;
+    Interner                     I(*this, lockForWriting(Lock));
+    return I.intern(AST);
+}
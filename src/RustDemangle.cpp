@@ -12,10 +12,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "demangler/Demangle.h"
+#include "demangler/DemangleProfile.h"
 #include "demangler/StringViewExtras.h"
 #include "demangler/Utility.h"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstdint>
 #include <cstring>
@@ -26,6 +28,8 @@ using namespace demangler;
 
 using demangler::itanium_demangle::OutputBuffer;
 using demangler::itanium_demangle::ScopedOverride;
+using demangler::itanium_demangle::span_digits;
+using demangler::itanium_demangle::span_identifier;
 using demangler::itanium_demangle::starts_with;
 
 namespace {
@@ -71,11 +75,40 @@ enum class LeaveGenericsOpen {
     Yes,
 };
 
+enum class BackrefKind {
+    Path,
+    Type,
+    Const,
+};
+
+// The output of a backref that has been printed once. A later backref with
+// the same target and context copies the range instead of parsing it again.
+struct BackrefMemo {
+    uint64_t          Backref;
+    BackrefKind       Kind;
+    IsInType          InType;
+    LeaveGenericsOpen LeaveOpen;
+    size_t            BoundLifetimes;
+    // How many levels deeper than the backref the first visit recursed.
+    size_t Depth;
+    size_t Begin;
+    size_t End;
+    bool   IsOpen;
+};
+
+// The recursion limit, used to avoid stack overflow whatever the
+// DemangleLimits.
+constexpr size_t DefaultMaxRecursionLevel = 500;
+
 class Demangler {
     // Maximum recursion level. Used to avoid stack overflow.
     size_t MaxRecursionLevel;
+    // True if MaxRecursionLevel is the MaxDepth of the caller's DemangleLimits.
+    bool DepthLimited;
     // Current recursion level.
     size_t RecursionLevel;
+    // Deepest recursion level reached since the innermost backref started.
+    size_t DeepestLevel;
     size_t BoundLifetimes;
     // Input string that is being demangled with "_R" prefix removed.
     std::string_view Input;
@@ -86,16 +119,23 @@ class Demangler {
     bool Print;
     // True if an error occurred.
     bool Error;
+    // Backrefs printed so far. Once the table is full, further backrefs are
+    // parsed again on every visit.
+    std::array<BackrefMemo, 16> BackrefMemos;
+    size_t                      NumBackrefMemos;
 
 public:
     // Demangled output.
-    OutputBuffer Output;
+    OutputBuffer& Output;
+    // True if parsing stopped at one of the caller's DemangleLimits.
+    bool LimitExceeded;
 
-    Demangler(size_t MaxRecursionLevel = 500);
+    Demangler(OutputBuffer& Output, const DemangleLimits& Limits);
 
     bool demangle(std::string_view MangledName);
 
 private:
+    bool canRecurse();
     bool demanglePath(IsInType Type, LeaveGenericsOpen LeaveOpen = LeaveGenericsOpen::No);
     void demangleImplPath(IsInType InType);
     void demangleGenericArg();
@@ -109,21 +149,51 @@ private:
     void demangleConstBool();
     void demangleConstChar();
 
+    // Demangles the backref at Position with Demangler and returns its result.
+    // The printed output is memoized by target and by the context that it
+    // depends on, so that revisiting a backref is a copy of the output.
     template <typename Callable>
-    void demangleBackref(Callable Demangler) {
+    bool demangleBackref(
+        BackrefKind       Kind,
+        Callable          Demangler,
+        IsInType          InType    = IsInType::No,
+        LeaveGenericsOpen LeaveOpen = LeaveGenericsOpen::No
+    ) {
         uint64_t Backref = parseBase62Number();
         if (Error || Backref >= Position) {
             Error = true;
-            return;
+            return false;
         }
 
-        if (!Print) return;
+        if (!Print) return false;
+
+        if (const BackrefMemo* M = findBackrefMemo(Backref, Kind, InType, LeaveOpen)) {
+            DeepestLevel = std::max(DeepestLevel, RecursionLevel + M->Depth);
+            Output.appendRange(M->Begin, M->End);
+            return M->IsOpen;
+        }
 
         ScopedOverride<size_t> SavePosition(Position, Position);
         Position = Backref;
-        Demangler();
+
+        size_t OuterDeepest = DeepestLevel;
+        size_t Begin        = Output.getCurrentPosition();
+        DeepestLevel        = RecursionLevel;
+
+        bool IsOpen = Demangler();
+        if (!Error) {
+            size_t Depth = DeepestLevel - RecursionLevel;
+            size_t End   = Output.getCurrentPosition();
+            memoizeBackref({Backref, Kind, InType, LeaveOpen, BoundLifetimes, Depth, Begin, End, IsOpen});
+        }
+        DeepestLevel = std::max(DeepestLevel, OuterDeepest);
+        return IsOpen;
     }
 
+    const BackrefMemo*
+         findBackrefMemo(uint64_t Backref, BackrefKind Kind, IsInType InType, LeaveGenericsOpen LeaveOpen) const;
+    void memoizeBackref(const BackrefMemo& Memo);
+
     Identifier parseIdentifier();
     uint64_t   parseOptionalBase62Number(char Tag);
     uint64_t   parseBase62Number();
@@ -148,21 +218,56 @@ private:
 } // namespace
 
 char* demangler::rustDemangle(std::string_view MangledName) {
-    // Return early if mangled name doesn't look like a Rust symbol.
-    if (MangledName.empty() || !starts_with(MangledName, "_R")) return nullptr;
-
-    Demangler D;
-    if (!D.demangle(MangledName)) {
-        std::free(D.Output.getBuffer());
+    OutputBuffer OB;
+    if (!rustDemangle(MangledName, OB)) {
+        std::free(OB.getBuffer());
         return nullptr;
     }
 
-    D.Output += '\0';
+    OB += '\0';
+
+    return OB.getBuffer();
+}
+
+bool demangler::rustDemangle(std::string_view MangledName, OutputBuffer& OB) {
+    return rustDemangle(MangledName, OB, DemangleLimits(), nullptr);
+}
+
+bool demangler::rustDemangle(
+    std::string_view      MangledName,
+    OutputBuffer&         OB,
+    const DemangleLimits& Limits,
+    int*                  Status
+) {
+    // Return early if mangled name doesn't look like a Rust symbol.
+    if (MangledName.empty() || !starts_with(MangledName, "_R")) {
+        if (Status) *Status = demangle_invalid_mangled_name;
+        return false;
+    }
+    DEMANGLE_STATS_CALL(OB);
+
+    // Backrefs copy and insert into what was printed before, and a name that
+    // fails is taken back, so none of it may be drained yet.
+    OutputBuffer::Hold KeepOutput(OB);
+    size_t             Start = OB.getCurrentPosition();
+    Demangler          D(OB, Limits);
+
+    bool Demangled = false;
+    bool Fits      = detail::printWithinLimit(OB, Limits.MaxOutputSize, [&] { Demangled = D.demangle(MangledName); });
 
-    return D.Output.getBuffer();
+    int InternalStatus = demangle_success;
+    if (!Fits || D.LimitExceeded) InternalStatus = demangle_limit_exceeded;
+    else if (!Demangled) InternalStatus = demangle_invalid_mangled_name;
+    if (InternalStatus != demangle_success) OB.setCurrentPosition(Start);
+
+    if (Status) *Status = InternalStatus;
+    return InternalStatus == demangle_success;
 }
 
-Demangler::Demangler(size_t MaxRecursionLevel) : MaxRecursionLevel(MaxRecursionLevel) {}
+Demangler::Demangler(OutputBuffer& Output, const DemangleLimits& Limits)
+: MaxRecursionLevel(std::min(Limits.MaxDepth ? Limits.MaxDepth : SIZE_MAX, DefaultMaxRecursionLevel)),
+  DepthLimited(Limits.MaxDepth && Limits.MaxDepth <= DefaultMaxRecursionLevel),
+  Output(Output) {}
 
 static inline bool isDigit(const char C) { return '0' <= C && C <= '9'; }
 
@@ -181,11 +286,14 @@ static inline bool isValid(const char C) { return isDigit(C) || isLower(C) || is
 //
 // <symbol-name> = "_R" <path> [<instantiating-crate>]
 bool Demangler::demangle(std::string_view Mangled) {
-    Position       = 0;
-    Error          = false;
-    Print          = true;
-    RecursionLevel = 0;
-    BoundLifetimes = 0;
+    Position        = 0;
+    Error           = false;
+    Print           = true;
+    LimitExceeded   = false;
+    RecursionLevel  = 0;
+    DeepestLevel    = 0;
+    BoundLifetimes  = 0;
+    NumBackrefMemos = 0;
 
     if (!starts_with(Mangled, "_R")) {
         Error = true;
@@ -213,6 +321,40 @@ bool Demangler::demangle(std::string_view Mangled) {
     return !Error;
 }
 
+// Returns the memo of a backref to Backref printed in the same context, or
+// nullptr if there is none or if the recursion limit would now stop parsing
+// it again.
+const BackrefMemo* Demangler::findBackrefMemo(
+    uint64_t          Backref,
+    BackrefKind       Kind,
+    IsInType          InType,
+    LeaveGenericsOpen LeaveOpen
+) const {
+    for (size_t I = 0; I != NumBackrefMemos; ++I) {
+        const BackrefMemo& M = BackrefMemos[I];
+        if (M.Backref == Backref && M.Kind == Kind && M.InType == InType && M.LeaveOpen == LeaveOpen
+            && M.BoundLifetimes == BoundLifetimes)
+            return RecursionLevel + M.Depth <= MaxRecursionLevel ? &M : nullptr;
+    }
+    return nullptr;
+}
+
+void Demangler::memoizeBackref(const BackrefMemo& Memo) {
+    if (NumBackrefMemos != BackrefMemos.size()) BackrefMemos[NumBackrefMemos++] = Memo;
+}
+
+// Whether a production can go one recursion level deeper. If not, parsing
+// fails, and LimitExceeded is set if that is because of the caller's limits:
+// MaxDepth, or MaxOutputSize, for which the output is checked here too.
+bool Demangler::canRecurse() {
+    if (Error) return false;
+    if (RecursionLevel < MaxRecursionLevel && !Output.isPastPrintLimit()) return true;
+
+    LimitExceeded = DepthLimited || Output.isPastPrintLimit();
+    Error         = true;
+    return false;
+}
+
 // Demangles a path. InType indicates whether a path is inside a type. When
 // LeaveOpen is true, a closing `>` after generic arguments is omitted from the
 // output. Return value indicates whether generics arguments have been left
@@ -231,11 +373,11 @@ bool Demangler::demangle(std::string_view Mangled) {
 //      | <A-Z>    // other special namespaces
 //      | <a-z>    // internal namespaces
 bool Demangler::demanglePath(IsInType InType, LeaveGenericsOpen LeaveOpen) {
-    if (Error || RecursionLevel >= MaxRecursionLevel) {
-        Error = true;
-        return false;
-    }
+    DEMANGLE_PROFILE_SCOPE(RustPath);
+    if (!canRecurse()) return false;
     ScopedOverride<size_t> SaveRecursionLevel(RecursionLevel, RecursionLevel + 1);
+    DeepestLevel = std::max(DeepestLevel, RecursionLevel);
+    DEMANGLE_STATS_DEPTH();
 
     switch (consume()) {
     case 'C': {
@@ -313,11 +455,8 @@ bool Demangler::demanglePath(IsInType InType, LeaveGenericsOpen LeaveOpen) {
         else print(">");
         break;
     }
-    case 'B': {
-        bool IsOpen = false;
-        demangleBackref([&] { IsOpen = demanglePath(InType, LeaveOpen); });
-        return IsOpen;
-    }
+    case 'B':
+        return demangleBackref(BackrefKind::Path, [&] { return demanglePath(InType, LeaveOpen); }, InType, LeaveOpen);
     default:
         Error = true;
         break;
@@ -329,6 +468,7 @@ bool Demangler::demanglePath(IsInType InType, LeaveGenericsOpen LeaveOpen) {
 // <impl-path> = [<disambiguator>] <path>
 // <disambiguator> = "s" <base-62-number>
 void Demangler::demangleImplPath(IsInType InType) {
+    DEMANGLE_PROFILE_SCOPE(RustImplPath);
     ScopedOverride<bool> SavePrint(Print, false);
     parseOptionalBase62Number('s');
     demanglePath(InType);
@@ -339,6 +479,7 @@ void Demangler::demangleImplPath(IsInType InType) {
 //               | "K" <const>
 // <lifetime> = "L" <base-62-number>
 void Demangler::demangleGenericArg() {
+    DEMANGLE_PROFILE_SCOPE(RustGenericArg);
     if (consumeIf('L')) printLifetime(parseBase62Number());
     else if (consumeIf('K')) demangleConst();
     else demangleType();
@@ -516,11 +657,11 @@ void Demangler::printBasicType(BasicType Type) {
 //          | "D" <dyn-bounds> <lifetime> // dyn Trait<Assoc = X> + Send + 'a
 //          | <backref>                   // backref
 void Demangler::demangleType() {
-    if (Error || RecursionLevel >= MaxRecursionLevel) {
-        Error = true;
-        return;
-    }
+    DEMANGLE_PROFILE_SCOPE(RustType);
+    if (!canRecurse()) return;
     ScopedOverride<size_t> SaveRecursionLevel(RecursionLevel, RecursionLevel + 1);
+    DeepestLevel = std::max(DeepestLevel, RecursionLevel);
+    DEMANGLE_STATS_DEPTH();
 
     size_t    Start = Position;
     char      C     = consume();
@@ -586,7 +727,10 @@ void Demangler::demangleType() {
         }
         break;
     case 'B':
-        demangleBackref([&] { demangleType(); });
+        demangleBackref(BackrefKind::Type, [&] {
+            demangleType();
+            return false;
+        });
         break;
     default:
         Position = Start;
@@ -599,6 +743,7 @@ void Demangler::demangleType() {
 // <abi> = "C"
 //       | <undisambiguated-identifier>
 void Demangler::demangleFnSig() {
+    DEMANGLE_PROFILE_SCOPE(RustFnSig);
     ScopedOverride<size_t> SaveBoundLifetimes(BoundLifetimes, BoundLifetimes);
     demangleOptionalBinder();
 
@@ -693,11 +838,11 @@ void Demangler::demangleOptionalBinder() {
 //         | "p"                          // placeholder
 //         | <backref>
 void Demangler::demangleConst() {
-    if (Error || RecursionLevel >= MaxRecursionLevel) {
-        Error = true;
-        return;
-    }
+    DEMANGLE_PROFILE_SCOPE(RustConst);
+    if (!canRecurse()) return;
     ScopedOverride<size_t> SaveRecursionLevel(RecursionLevel, RecursionLevel + 1);
+    DeepestLevel = std::max(DeepestLevel, RecursionLevel);
+    DEMANGLE_STATS_DEPTH();
 
     char      C = consume();
     BasicType Type;
@@ -731,7 +876,10 @@ void Demangler::demangleConst() {
             break;
         }
     } else if (C == 'B') {
-        demangleBackref([&] { demangleConst(); });
+        demangleBackref(BackrefKind::Const, [&] {
+            demangleConst();
+            return false;
+        });
     } else {
         Error = true;
     }
@@ -823,7 +971,7 @@ Identifier Demangler::parseIdentifier() {
     std::string_view S  = Input.substr(Position, Bytes);
     Position           += Bytes;
 
-    if (!std::all_of(S.begin(), S.end(), isValid)) {
+    if (span_identifier(S) != S.size()) {
         Error = true;
         return {};
     }
@@ -900,15 +1048,17 @@ uint64_t Demangler::parseDecimalNumber() {
         return 0;
     }
 
-    uint64_t Value = 0;
+    uint64_t         Value  = 0;
+    std::string_view Digits = Input.substr(Position, span_digits(Input.substr(Position)));
+    Position               += Digits.size();
 
-    while (isDigit(look())) {
+    for (char C : Digits) {
         if (!mulAssign(Value, 10)) {
             Error = true;
             return 0;
         }
 
-        uint64_t D = consume() - '0';
+        uint64_t D = C - '0';
         if (!addAssign(Value, D)) return 0;
     }
 
@@ -0,0 +1,296 @@
+//===--- SymbolFile.cpp ---------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// A PE image is read as it is laid out on disk, not as it is loaded: the
+// export directory and the names it lists are found by RVA, and an RVA is
+// turned into a file offset through the section that holds it. An ELF file is
+// read through its section headers, in either byte order and either class.
+// Every offset and size taken from the file is checked against its size
+// before it is used, so a truncated or corrupt binary fails to load instead of
+// being read out of bounds.
+//
+//===----------------------------------------------------------------------===//
+
+#include "demangler/SymbolFile.h"
+
+#include "demangler/FileMapping.h"
+
+#include <cstring>
+#include <utility>
+
+using namespace demangler;
+using demangler::detail::mapFile;
+using demangler::detail::unmapFile;
+
+namespace {
+// Bounds-checked reads of the integers of a file in a given byte order.
+class FileReader {
+    std::span<const char> Data;
+    bool                  BigEndian;
+
+public:
+    FileReader(std::span<const char> Data, bool BigEndian) : Data(Data), BigEndian(BigEndian) {}
+
+    // Whether Size bytes at Offset lie inside the file.
+    bool has(uint64_t Offset, uint64_t Size) const { return Offset <= Data.size() && Size <= Data.size() - Offset; }
+
+    // The Size-byte integer at Offset, which must lie inside the file.
+    uint64_t read(uint64_t Offset, unsigned Size) const {
+        const unsigned char* P     = reinterpret_cast<const unsigned char*>(Data.data() + Offset);
+        uint64_t             Value = 0;
+        for (unsigned I = 0; I != Size; ++I) Value |= uint64_t(P[I]) << 8 * (BigEndian ? Size - 1 - I : I);
+        return Value;
+    }
+    uint8_t  u8(uint64_t Offset) const { return static_cast<uint8_t>(read(Offset, 1)); }
+    uint16_t u16(uint64_t Offset) const { return static_cast<uint16_t>(read(Offset, 2)); }
+    uint32_t u32(uint64_t Offset) const { return static_cast<uint32_t>(read(Offset, 4)); }
+    uint64_t u64(uint64_t Offset) const { return read(Offset, 8); }
+
+    // The null-terminated string at Offset, which must end before Limit.
+    // Returns false if it does not.
+    bool str(uint64_t Offset, uint64_t Limit, std::string_view& S) const {
+        if (Limit > Data.size() || Offset >= Limit) return false;
+        const char* Begin = Data.data() + Offset;
+        const void* End   = std::memchr(Begin, '\0', Limit - Offset);
+        if (End == nullptr) return false;
+        S = std::string_view(Begin, static_cast<const char*>(End) - Begin);
+        return true;
+    }
+};
+
+// The size of a PE section header and the offsets of its fields.
+constexpr unsigned PESectionSize        = 40;
+constexpr unsigned PESectionVirtualSize = 8;
+constexpr unsigned PESectionAddress     = 12;
+constexpr unsigned PESectionRawSize     = 16;
+constexpr unsigned PESectionRawOffset   = 20;
+
+// Turns the RVAs of a PE image into file offsets. Most lookups hit the same
+// section as the one before, which is kept.
+struct PESections {
+    const FileReader& R;
+    uint64_t          Headers;
+    unsigned          NumSections;
+    uint64_t          Begin  = 0;
+    uint64_t          End    = 0;
+    uint64_t          Offset = 0;
+
+    // The file offset of RVA, and the end of the section holding it in the
+    // file. Fails if no section holds it.
+    bool toOffset(uint32_t RVA, uint64_t& Result, uint64_t& Limit) {
+        if (RVA < Begin || RVA >= End) {
+            Begin = End = 0;
+            for (unsigned I = 0; I != NumSections; ++I) {
+                uint64_t Header  = Headers + uint64_t(I) * PESectionSize;
+                uint32_t Address = R.u32(Header + PESectionAddress);
+                uint32_t Virtual = R.u32(Header + PESectionVirtualSize);
+                uint32_t Raw     = R.u32(Header + PESectionRawSize);
+                // Past its raw data a section is zero-filled, and not in the
+                // file.
+                uint32_t Size = Virtual != 0 && Virtual < Raw ? Virtual : Raw;
+                if (RVA >= Address && RVA - Address < Size) {
+                    Begin  = Address;
+                    End    = uint64_t(Address) + Size;
+                    Offset = R.u32(Header + PESectionRawOffset);
+                    break;
+                }
+            }
+            if (End == 0 || !R.has(Offset, End - Begin)) {
+                Begin = End = 0;
+                return false;
+            }
+        }
+        Result = Offset + (RVA - Begin);
+        Limit  = Offset + (End - Begin);
+        return true;
+    }
+};
+
+// ELF section types and symbol types.
+constexpr unsigned ELFSymTab        = 2;
+constexpr unsigned ELFDynSym        = 11;
+constexpr unsigned ELFSymbolSection = 3;
+constexpr unsigned ELFSymbolFile    = 4;
+
+// The offsets of the fields of an ELF section header.
+struct ELFSectionLayout {
+    unsigned Type, Offset, Size, Link, EntrySize, Word;
+};
+constexpr ELFSectionLayout ELF32Section = {4, 16, 20, 24, 36, 4};
+constexpr ELFSectionLayout ELF64Section = {4, 24, 32, 40, 56, 8};
+} // namespace
+
+SymbolFile::~SymbolFile() { close(); }
+
+SymbolFile::SymbolFile(SymbolFile&& Other) { *this = std::move(Other); }
+
+SymbolFile& SymbolFile::operator=(SymbolFile&& Other) {
+    std::swap(Mapping, Other.Mapping);
+    std::swap(MappingSize, Other.MappingSize);
+    std::swap(Names, Other.Names);
+    std::swap(FileFormat, Other.FileFormat);
+    std::swap(Mapped, Other.Mapped);
+    return *this;
+}
+
+bool SymbolFile::open(const char* Path) {
+    close();
+    const char* Data;
+    size_t      Size;
+    if (!mapFile(Path, Data, Size)) return false;
+    if (!load(std::span<const char>(Data, Size))) {
+        unmapFile(Data, Size);
+        return false;
+    }
+    Mapping     = Data;
+    MappingSize = Size;
+    Mapped      = true;
+    return true;
+}
+
+bool SymbolFile::load(std::span<const char> Data) {
+    close();
+    bool Ok = false;
+    if (Data.size() >= 2 && std::memcmp(Data.data(), "MZ", 2) == 0) {
+        FileFormat = Format::PE;
+        Ok         = loadPE(Data);
+    } else if (Data.size() >= 4 && std::memcmp(Data.data(), "\x7f" "ELF", 4) == 0) {
+        FileFormat = Format::ELF;
+        Ok         = loadELF(Data);
+    }
+    if (!Ok) close();
+    return Ok;
+}
+
+void SymbolFile::close() {
+    if (Mapped) unmapFile(Mapping, MappingSize);
+    Mapping     = nullptr;
+    MappingSize = 0;
+    FileFormat  = Format::None;
+    Mapped      = false;
+    Names.clear();
+}
+
+bool SymbolFile::loadPE(std::span<const char> Data) {
+    FileReader R(Data, /*BigEndian=*/false);
+    if (!R.has(0x3C, 4)) return false;
+    uint64_t Signature = R.u32(0x3C);
+    if (!R.has(Signature, 24) || std::memcmp(Data.data() + Signature, "PE\0\0", 4) != 0) return false;
+
+    // The COFF file header follows the signature, and the optional header
+    // follows that.
+    uint64_t Coff        = Signature + 4;
+    unsigned NumSections = R.u16(Coff + 2);
+    unsigned OptSize     = R.u16(Coff + 16);
+    uint64_t Opt         = Coff + 20;
+    if (!R.has(Opt, OptSize) || OptSize < 2) return false;
+    uint16_t Magic = R.u16(Opt);
+    if (Magic != 0x10b && Magic != 0x20b) return false;
+    // The data directories of PE32 and PE32+, of which the export directory
+    // is the first.
+    unsigned Directories = Magic == 0x10b ? 96 : 112;
+    if (OptSize < Directories + 8 || R.u32(Opt + Directories - 4) == 0) return true;
+    uint32_t ExportRVA = R.u32(Opt + Directories);
+    if (ExportRVA == 0) return true;
+
+    uint64_t Sections = Opt + OptSize;
+    if (!R.has(Sections, uint64_t(NumSections) * PESectionSize)) return false;
+
+    PESections Map{R, Sections, NumSections};
+    uint64_t   Offset, Limit;
+    if (!Map.toOffset(ExportRVA, Offset, Limit) || Limit - Offset < 40) return false;
+    uint32_t NumNames = R.u32(Offset + 24);
+    if (NumNames == 0) return true;
+    if (!Map.toOffset(R.u32(Offset + 32), Offset, Limit) || (Limit - Offset) / 4 < NumNames) return false;
+
+    uint64_t NameRVAs = Offset;
+    Names.reserve(NumNames);
+    for (uint32_t I = 0; I != NumNames; ++I) {
+        std::string_view Name;
+        if (!Map.toOffset(R.u32(NameRVAs + uint64_t(I) * 4), Offset, Limit) || !R.str(Offset, Limit, Name))
+            return false;
+        Names.push_back(Name);
+    }
+    return true;
+}
+
+bool SymbolFile::loadELF(std::span<const char> Data) {
+    if (Data.size() < 16) return false;
+    uint8_t Class = static_cast<uint8_t>(Data[4]);
+    uint8_t Order = static_cast<uint8_t>(Data[5]);
+    if ((Class != 1 && Class != 2) || (Order != 1 && Order != 2)) return false;
+    bool       Is64 = Class == 2;
+    FileReader R(Data, /*BigEndian=*/Order == 2);
+    if (!R.has(0, Is64 ? 64 : 52)) return false;
+
+    uint64_t SectionsOffset = Is64 ? R.u64(0x28) : R.u32(0x20);
+    unsigned EntrySize      = R.u16(Is64 ? 0x3A : 0x2E);
+    uint64_t NumSections    = R.u16(Is64 ? 0x3C : 0x30);
+    if (SectionsOffset == 0) return true;
+    if (EntrySize < (Is64 ? 64u : 40u) || !R.has(SectionsOffset, EntrySize)) return false;
+
+    // The fields of the I-th section header.
+    const ELFSectionLayout& L      = Is64 ? ELF64Section : ELF32Section;
+    auto                    header = [&](uint64_t I, unsigned Field) { return SectionsOffset + I * EntrySize + Field; };
+    auto                    type   = [&](uint64_t I) { return R.u32(header(I, L.Type)); };
+    auto                    offset = [&](uint64_t I) { return R.read(header(I, L.Offset), L.Word); };
+    auto                    size   = [&](uint64_t I) { return R.read(header(I, L.Size), L.Word); };
+    auto                    link   = [&](uint64_t I) { return R.u32(header(I, L.Link)); };
+
+    // With too many sections for the header, the first section header holds
+    // their number.
+    if (NumSections == 0) NumSections = size(0);
+    if (NumSections > (Data.size() - SectionsOffset) / EntrySize) return false;
+
+    // The full symbol table if it has not been stripped, the dynamic one
+    // otherwise.
+    uint64_t Table = NumSections;
+    for (uint64_t I = 0; I != NumSections; ++I) {
+        if (type(I) == ELFSymTab) {
+            Table = I;
+            break;
+        }
+        if (type(I) == ELFDynSym && Table == NumSections) Table = I;
+    }
+    if (Table == NumSections) return true;
+
+    uint64_t SymbolSize = Is64 ? 24 : 16;
+    uint64_t Symbols    = offset(Table);
+    uint64_t TableSize  = size(Table);
+    uint64_t Stride     = R.read(header(Table, L.EntrySize), L.Word);
+    uint32_t StrTab     = link(Table);
+    if (Stride < SymbolSize || !R.has(Symbols, TableSize) || StrTab >= NumSections) return false;
+    uint64_t Strings     = offset(StrTab);
+    uint64_t StringsSize = size(StrTab);
+    if (!R.has(Strings, StringsSize)) return false;
+
+    // Symbol 0 is always the undefined symbol.
+    uint64_t NumSymbols = TableSize / Stride;
+    Names.reserve(NumSymbols > 0 ? NumSymbols - 1 : 0);
+    for (uint64_t I = 1; I < NumSymbols; ++I) {
+        uint64_t Symbol = Symbols + I * Stride;
+        uint32_t Name   = R.u32(Symbol);
+        unsigned Type   = R.u8(Symbol + (Is64 ? 4 : 12)) & 0xf;
+        if (Name == 0 || Type == ELFSymbolSection || Type == ELFSymbolFile) continue;
+        std::string_view S;
+        if (!R.str(Strings + Name, Strings + StringsSize, S)) return false;
+        if (!S.empty()) Names.push_back(S);
+    }
+    return true;
+}
+
+DemangleBatchResult demangler::demangleSymbols(
+    const SymbolFile&     Symbols,
+    unsigned              NumThreads,
+    MSDemangleFlags       Flags,
+    const DemangleLimits& Limits
+) {
+    // Export names are sorted, so overloads of a name are next to each other.
+    bool SharePrefixes = Symbols.getFormat() == SymbolFile::Format::PE;
+    return demangleBatch(Symbols.names(), NumThreads, Flags, SharePrefixes, Limits, /*WholeNames=*/true);
+}
@@ -0,0 +1,237 @@
+//===--- DemanglerFilter.cpp ----------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// A c++filt style filter. Every word of the input that is a mangled name in
+/// any of the supported schemes is replaced by its demangled form, everything
+/// else is copied through unchanged.
+///
+/// Files are memory-mapped and standard input is read in large chunks. Words
+/// are demangled as views into the input and the output of each chunk is
+/// written with a single call, so no per-line strings are built.
+///
+//===----------------------------------------------------------------------===//
+
+#include "demangler/Demangle.h"
+#include "demangler/Utility.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <fcntl.h>
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace demangler;
+using demangler::itanium_demangle::OutputBuffer;
+
+namespace {
+// Amount of input handed to the demangler at once.
+constexpr size_t ChunkSize = 8 << 20;
+
+// Characters that can appear in a name mangled by any supported scheme.
+// Anything else separates words.
+bool isSymbolChar(char C) {
+    return (C >= '0' && C <= '9') || (C >= 'a' && C <= 'z') || (C >= 'A' && C <= 'Z') || C == '_' || C == '$'
+        || C == '.' || C == '?' || C == '@';
+}
+
+// Characters that only Microsoft names have, in the names the compiler makes
+// up for entities such as <lambda_1> and <unnamed-tag>.
+bool isMicrosoftOnlySymbolChar(char C) { return C == '<' || C == '>' || C == '-' || C == '`'; }
+
+class Filter {
+    DemangleBatchPool             Pool;
+    std::vector<std::string_view> Words;
+    OutputBuffer                  OB;
+
+public:
+    // A Microsoft name followed by more symbol characters within the word is
+    // echoed unchanged, so that no input text is ever dropped.
+    explicit Filter(unsigned NumThreads) : Pool(NumThreads, MSDF_None, false, {}, /*WholeNames=*/true) {}
+    Filter(const Filter&)            = delete;
+    Filter& operator=(const Filter&) = delete;
+    ~Filter() { std::free(OB.getBuffer()); }
+
+    // Demangle a chunk that ends at a line boundary (or the end of input) and
+    // write the result to stdout.
+    bool process(std::string_view Chunk);
+};
+
+bool Filter::process(std::string_view Chunk) {
+    Words.clear();
+    for (size_t I = 0, E = Chunk.size(); I != E;) {
+        if (!isSymbolChar(Chunk[I])) {
+            ++I;
+            continue;
+        }
+        size_t Start = I;
+        if (Chunk[I] == '?') {
+            while (I != E && (isSymbolChar(Chunk[I]) || isMicrosoftOnlySymbolChar(Chunk[I]))) ++I;
+            // A Microsoft name never ends in one of those, so they belong to
+            // the text around it, as in "<?f@@YAXXZ>".
+            while (!isSymbolChar(Chunk[I - 1])) --I;
+        } else {
+            while (I != E && isSymbolChar(Chunk[I])) ++I;
+        }
+        Words.push_back(Chunk.substr(Start, I - Start));
+    }
+
+    DemangleBatchResult Result = Pool.demangle(Words);
+
+    OB.setCurrentPosition(0);
+    const char* Prev = Chunk.data();
+    for (size_t I = 0; I != Words.size(); ++I) {
+        OB   += std::string_view(Prev, Words[I].data() - Prev);
+        OB   += Result[I];
+        Prev  = Words[I].data() + Words[I].size();
+    }
+    OB += std::string_view(Prev, Chunk.data() + Chunk.size() - Prev);
+
+    std::string_view Out = OB;
+    return std::fwrite(Out.data(), 1, Out.size(), stdout) == Out.size();
+}
+
+// Hand Input to F in line-aligned pieces of about ChunkSize bytes.
+bool processBuffer(Filter& F, std::string_view Input) {
+    while (!Input.empty()) {
+        size_t End = Input.size();
+        if (End > ChunkSize) {
+            size_t NL = Input.find('\n', ChunkSize);
+            End       = NL == std::string_view::npos ? Input.size() : NL + 1;
+        }
+        if (!F.process(Input.substr(0, End))) return false;
+        Input.remove_prefix(End);
+    }
+    return true;
+}
+
+bool processStdin(Filter& F) {
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    std::vector<char> Buf(ChunkSize);
+    size_t            Used = 0;
+    for (;;) {
+        if (Used == Buf.size()) Buf.resize(Buf.size() * 2);
+        size_t Read  = std::fread(Buf.data() + Used, 1, Buf.size() - Used, stdin);
+        Used        += Read;
+        if (Read == 0) return std::ferror(stdin) == 0 && F.process(std::string_view(Buf.data(), Used));
+
+        // Only complete lines are processed; the tail is kept for the next read.
+        std::string_view Data(Buf.data(), Used);
+        size_t           NL = Data.rfind('\n');
+        if (NL == std::string_view::npos) continue;
+        if (!F.process(Data.substr(0, NL + 1))) return false;
+        Used -= NL + 1;
+        std::memmove(Buf.data(), Buf.data() + NL + 1, Used);
+    }
+}
+
+bool processFile(Filter& F, const char* Path) {
+#ifdef _WIN32
+    HANDLE File =
+        CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (File == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER Size;
+    if (!GetFileSizeEx(File, &Size)) {
+        CloseHandle(File);
+        return false;
+    }
+    if (Size.QuadPart == 0) {
+        CloseHandle(File);
+        return true;
+    }
+    HANDLE Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(File);
+    if (Mapping == nullptr) return false;
+    const char* Data = static_cast<const char*>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+    CloseHandle(Mapping);
+    if (Data == nullptr) return false;
+    bool Ok = processBuffer(F, std::string_view(Data, static_cast<size_t>(Size.QuadPart)));
+    UnmapViewOfFile(Data);
+    return Ok;
+#else
+    int FD = open(Path, O_RDONLY);
+    if (FD < 0) return false;
+    struct stat St;
+    if (fstat(FD, &St) != 0) {
+        close(FD);
+        return false;
+    }
+    if (St.st_size == 0) {
+        close(FD);
+        return true;
+    }
+    void* Data = mmap(nullptr, St.st_size, PROT_READ, MAP_PRIVATE, FD, 0);
+    close(FD);
+    if (Data == MAP_FAILED) return false;
+    madvise(Data, St.st_size, MADV_SEQUENTIAL);
+    bool Ok = processBuffer(F, std::string_view(static_cast<const char*>(Data), St.st_size));
+    munmap(Data, St.st_size);
+    return Ok;
+#endif
+}
+
+void printUsage(const char* Argv0) {
+    std::fprintf(stderr, "usage: %s [-j N] [file...]\n", Argv0);
+    std::fprintf(stderr, "  -j N  demangle on N threads, 0 for one per hardware thread (default: 1)\n");
+    std::fprintf(stderr, "Reads standard input if no file, or '-', is given.\n");
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned                 NumThreads = 1;
+    std::vector<const char*> Inputs;
+    for (int I = 1; I < argc; ++I) {
+        std::string_view Arg = argv[I];
+        if (Arg == "-j" && I + 1 < argc) {
+            NumThreads = static_cast<unsigned>(std::strtoul(argv[++I], nullptr, 10));
+        } else if (Arg.size() > 2 && Arg.substr(0, 2) == "-j") {
+            NumThreads = static_cast<unsigned>(std::strtoul(argv[I] + 2, nullptr, 10));
+        } else if (Arg == "-h" || Arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (Arg.size() > 1 && Arg[0] == '-') {
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            Inputs.push_back(argv[I]);
+        }
+    }
+
+#ifdef _WIN32
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    Filter F(NumThreads);
+    if (Inputs.empty()) Inputs.push_back("-");
+
+    int Status = 0;
+    for (const char* Input : Inputs) {
+        bool Ok = std::strcmp(Input, "-") == 0 ? processStdin(F) : processFile(F, Input);
+        if (!Ok) {
+            std::fprintf(stderr, "%s: error processing '%s'\n", argv[0], Input);
+            Status = 1;
+        }
+    }
+    std::fflush(stdout);
+    return Status;
+}
@@ -1,5 +1,17 @@
 add_rules("mode.debug", "mode.release")
 
+option("stats")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Collect demangler::DemangleStats in the demanglers")
+option_end()
+
+option("profile")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Profile the grammar productions of the demanglers into demangler::DemangleProfile")
+option_end()
+
 target("Demangler")
     set_kind("static")
     set_languages("c++20")
@@ -7,3 +19,27 @@ target("Demangler")
     add_includedirs("./include")
     add_cxflags("/utf-8", "/permissive-")
     add_files("src/**.cpp")
+    if has_config("stats") then
+        add_defines("DEMANGLE_ENABLE_STATS=1", {public = true})
+    end
+    if has_config("profile") then
+        add_defines("DEMANGLE_ENABLE_PROFILE=1", {public = true})
+    end
+
+target("DemanglerFilter")
+    set_kind("binary")
+    set_languages("c++20")
+    add_deps("Demangler")
+    add_includedirs("./include")
+    add_cxflags("/utf-8", "/permissive-")
+    add_files("tools/DemanglerFilter.cpp")
+
+target("DemanglerBenchmark")
+    set_kind("binary")
+    set_languages("c++20")
+    set_default(false)
+    set_rundir("$(projectdir)")
+    add_deps("Demangler")
+    add_includedirs("./include")
+    add_cxflags("/utf-8", "/permissive-")
+    add_files("benchmark/DemanglerBenchmark.cpp")